@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""Compares two neuron_bench JSON results and flags regressions.
+
+    neuron_bench --benchmark_repetitions=10 --benchmark_out=baseline.json --benchmark_out_format=json
+    # ... change the engine, rebuild ...
+    neuron_bench --benchmark_repetitions=10 --benchmark_out=current.json --benchmark_out_format=json
+    python3 bench/compare.py baseline.json current.json
+
+The neuron_bench_json target runs the second step. A benchmark regresses when its median time grew by more than --threshold and a two sided Mann-Whitney U test over
+the repetitions puts the chance of that being noise below --alpha. Benchmarks with fewer than three repetitions on either side are reported but never fail the
+comparison. Exits with 1 if anything regressed.
+"""
+
+import argparse
+import json
+import math
+import statistics
+import sys
+
+UNITS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def load(path, metric):
+    """Per benchmark, the times of every repetition in nanoseconds. Aggregates and failed or skipped runs are left out."""
+    with open(path) as file:
+        data = json.load(file)
+
+    runs = {}
+    for bench in data.get("benchmarks", []):
+        if bench.get("run_type", "iteration") != "iteration" or bench.get("error_occurred"):
+            continue
+        name = bench.get("run_name", bench["name"])
+        runs.setdefault(name, []).append(bench[metric] * UNITS[bench.get("time_unit", "ns")])
+    return runs
+
+
+def mann_whitney(a, b):
+    """Two sided p value of the U test, from the normal approximation with a tie correction."""
+    values = sorted([(value, 0) for value in a] + [(value, 1) for value in b])
+    n = len(values)
+
+    # average ranks for ties
+    ranks = [0.0] * n
+    ties = 0.0
+    i = 0
+    while i < n:
+        j = i
+        while j + 1 < n and values[j + 1][0] == values[i][0]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[k] = (i + j) / 2 + 1
+        count = j - i + 1
+        ties += count**3 - count
+        i = j + 1
+
+    n1, n2 = len(a), len(b)
+    rank_sum = sum(rank for rank, (_, side) in zip(ranks, values) if side == 0)
+    u = rank_sum - n1 * (n1 + 1) / 2
+
+    mean = n1 * n2 / 2
+    variance = n1 * n2 / 12 * ((n + 1) - ties / (n * (n - 1)))
+    if variance <= 0:
+        return 1.0
+
+    z = (abs(u - mean) - 0.5) / math.sqrt(variance)
+    return max(0.0, min(1.0, math.erfc(max(z, 0.0) / math.sqrt(2))))
+
+
+def format_time(nanoseconds):
+    for unit, scale in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if nanoseconds >= scale:
+            return f"{nanoseconds / scale:.3g} {unit}"
+    return f"{nanoseconds:.3g} ns"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Flags neuron_bench regressions against a saved baseline.")
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=0.05, help="relative slowdown of the median that counts (default 0.05)")
+    parser.add_argument("--alpha", type=float, default=0.01, help="significance level of the U test (default 0.01)")
+    parser.add_argument("--metric", choices=("real_time", "cpu_time"), default="real_time")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline, args.metric)
+    current = load(args.current, args.metric)
+
+    rows = []
+    regressions = 0
+    for name in sorted(baseline.keys() | current.keys()):
+        if name not in current:
+            rows.append((name, format_time(statistics.median(baseline[name])), "-", "-", "-", "missing"))
+            continue
+        if name not in baseline:
+            rows.append((name, "-", format_time(statistics.median(current[name])), "-", "-", "new"))
+            continue
+
+        before, after = baseline[name], current[name]
+        old, new = statistics.median(before), statistics.median(after)
+        change = new / old - 1 if old > 0 else 0.0
+
+        enough = len(before) >= 3 and len(after) >= 3
+        p = mann_whitney(before, after) if enough else None
+
+        if abs(change) <= args.threshold:
+            status = "ok"
+        elif not enough:
+            status = "slower?" if change > 0 else "faster?"
+        elif p >= args.alpha:
+            status = "noise"
+        elif change > 0:
+            status = "REGRESSION"
+            regressions += 1
+        else:
+            status = "improved"
+
+        rows.append((name, format_time(old), format_time(new), f"{change:+.1%}", "-" if p is None else f"{p:.3f}", status))
+
+    header = ("benchmark", "baseline", "current", "change", "p", "status")
+    widths = [max(len(str(row[i])) for row in rows + [header]) for i in range(len(header))]
+    for row in [header] + rows:
+        print("  ".join(str(cell).ljust(width) for cell, width in zip(row, widths)))
+
+    if regressions:
+        print(f"\n{regressions} regression(s) above {args.threshold:.0%} at p < {args.alpha}")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
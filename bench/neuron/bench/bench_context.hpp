@@ -0,0 +1,49 @@
+#pragma once
+
+#include "neuron/graphics/gcontext.hpp"
+#include "neuron/neuron.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+namespace neuron::bench {
+
+    /**
+     * The headless context shared by all benchmarks. Null when no Vulkan driver is available.
+     */
+    std::shared_ptr<neuron::graphics::GContext> &gc();
+
+    /**
+     * What main() initialized the engine with. Benchmarks that recreate the context use the same.
+     */
+    const neuron::Settings &settings();
+
+    /**
+     * Whether the instance has VK_EXT_headless_surface, which the swapchain benchmarks need.
+     */
+    bool hasHeadlessSurface();
+
+    /**
+     * The first init() and GContext of the process, while the loader and driver weren't loaded yet. Zero when there is no device.
+     */
+    struct ColdStart {
+        uint64_t                                 nanoseconds = 0;
+        std::vector<neuron::utils::StartupPhase> phases;
+    };
+
+    const ColdStart &coldStart();
+
+    /**
+     * Marks the benchmark as skipped when there is no device. Returns false in that case.
+     */
+    inline bool requireDevice(benchmark::State &state) {
+        if (!gc()) {
+            state.SkipWithError("No usable Vulkan device");
+            return false;
+        }
+        return true;
+    }
+
+} // namespace neuron::bench
@@ -0,0 +1,76 @@
+#include "neuron/bench/bench_context.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <string_view>
+
+namespace neuron::bench {
+    std::shared_ptr<neuron::graphics::GContext> &gc() {
+        static std::shared_ptr<neuron::graphics::GContext> instance;
+        return instance;
+    }
+
+    static neuron::Settings &mutableSettings() {
+        static neuron::Settings instance{.name = "neuron_bench", .version = {0, 1, 0}, .offscreenRenderingOnly = true};
+        return instance;
+    }
+
+    const neuron::Settings &settings() {
+        return mutableSettings();
+    }
+
+    bool hasHeadlessSurface() {
+        return !settings().requestedInstanceExtensions.empty();
+    }
+
+    static ColdStart &mutableColdStart() {
+        static ColdStart instance;
+        return instance;
+    }
+
+    const ColdStart &coldStart() {
+        return mutableColdStart();
+    }
+} // namespace neuron::bench
+
+int main(int argc, char **argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+
+    try {
+        neuron::Settings &settings = neuron::bench::mutableSettings();
+        const uint64_t    begin    = neuron::utils::Profiler::now();
+
+        // asking the loader up front instead of retrying a failed init()
+        VULKAN_HPP_DEFAULT_DISPATCHER.init();
+        const bool headless = std::ranges::any_of(vk::enumerateInstanceExtensionProperties(), [](const vk::ExtensionProperties &extension) {
+            return std::string_view(extension.extensionName.data()) == VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME;
+        });
+        if (headless) {
+            settings.requestedInstanceExtensions = {VK_KHR_SURFACE_EXTENSION_NAME, VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME};
+        } else {
+            spdlog::warn("No headless surfaces, swapchain benchmarks will be skipped");
+        }
+        neuron::init(settings);
+
+        neuron::bench::gc() = std::make_shared<neuron::graphics::GContext>();
+
+        // includes opening the loader for the probe
+        neuron::bench::ColdStart &cold = neuron::bench::mutableColdStart();
+        cold.nanoseconds               = neuron::utils::Profiler::now() - begin;
+        cold.phases                    = neuron::Context::get()->getStartupTimings().getPhases();
+        for (const auto &phase : neuron::bench::gc()->getStartupTimings().getPhases())
+            cold.phases.push_back(phase);
+    } catch (const std::exception &e) {
+        spdlog::warn("No usable Vulkan device, device benchmarks will be skipped: {}", e.what());
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    neuron::bench::gc().reset();
+    neuron::cleanup();
+    return 0;
+}
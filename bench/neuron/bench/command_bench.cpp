@@ -0,0 +1,140 @@
+#include "neuron/bench/bench_context.hpp"
+
+#include "neuron/graphics/commands.hpp"
+#include "neuron/graphics/pipelines.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <functional>
+#include <thread>
+
+using namespace neuron::graphics;
+
+namespace {
+    constexpr uint32_t DRAW_COUNT      = 100000;
+    constexpr uint32_t DRAWS_PER_CHUNK = 512;
+
+    struct DrawItem {
+        uint32_t pipeline;
+        uint32_t object[4];
+    };
+
+    /**
+     * Threads that are kept alive between iterations, since every new thread would get new command pools from the recorder.
+     */
+    class RecordThreads {
+      public:
+        RecordThreads(uint32_t count, std::function<void(uint32_t)> work) : m_Work(std::move(work)), m_Start(count + 1), m_Done(count + 1) {
+            for (uint32_t i = 0; i < count; i++) {
+                m_Threads.emplace_back([this, i] {
+                    while (true) {
+                        m_Start.arrive_and_wait();
+                        if (m_Stop)
+                            return;
+                        m_Work(i);
+                        m_Done.arrive_and_wait();
+                    }
+                });
+            }
+        }
+
+        ~RecordThreads() {
+            m_Stop = true;
+            m_Start.arrive_and_wait();
+        }
+
+        void run() {
+            m_Start.arrive_and_wait();
+            m_Done.arrive_and_wait();
+        }
+
+      private:
+        std::function<void(uint32_t)> m_Work;
+        std::barrier<>                m_Start;
+        std::barrier<>                m_Done;
+        std::atomic<bool>             m_Stop = false;
+        std::vector<std::jthread>     m_Threads;
+    };
+} // namespace
+
+// records a scene's draw list into secondaries on 1 to N threads and assembles them into one primary; the commands are never submitted
+static void BM_Commands_Record(benchmark::State &state) {
+    if (!neuron::bench::requireDevice(state))
+        return;
+
+    const std::shared_ptr<GContext> &gc          = neuron::bench::gc();
+    const auto                       threadCount = static_cast<uint32_t>(state.range(0));
+    const auto                      &device      = gc->getDevice();
+
+    // dispatches stand in for draws so no render pass is needed, the recording cost per command is the same
+    const vk::PushConstantRange range(vk::ShaderStageFlagBits::eCompute, 0, sizeof(uint32_t) * 4);
+    const vk::PipelineLayout    layout = device.createPipelineLayout(vk::PipelineLayoutCreateInfo({}, {}, range));
+
+    ShaderCompiler            shaders;
+    std::vector<vk::Pipeline> pipelines;
+    {
+        PipelineManager manager(gc, shaders);
+        for (int i = 0; i < 8; i++) {
+            ShaderSource shader{.name  = "draw.comp",
+                                .code  = "#version 450\n"
+                                         "layout(local_size_x = 64) in;\n"
+                                         "layout(push_constant) uniform Object { uvec4 object; };\n"
+                                         "void main() { if (object.x == VARIANT + 1000000u) return; }\n",
+                                .stage = ShaderStage::Compute};
+            shader.defines.emplace_back("VARIANT", std::to_string(i));
+            pipelines.push_back(manager.get(ComputePipelineDesc{.shader = shader, .layout = layout}));
+        }
+
+        // the manager owns its pipelines, so they are recorded while it is alive
+        std::vector<DrawItem> draws(DRAW_COUNT);
+        for (uint32_t i = 0; i < DRAW_COUNT; i++)
+            draws[i] = {i / (DRAW_COUNT / 8), {i, i * 3, i * 7, i * 11}};
+
+        CommandRecorder                        recorder(gc);
+        const vk::CommandBufferInheritanceInfo inheritance;
+        const uint32_t                         chunkCount = (DRAW_COUNT + DRAWS_PER_CHUNK - 1) / DRAWS_PER_CHUNK;
+        std::atomic<uint32_t>                  nextChunk  = 0;
+
+        RecordThreads threads(threadCount, [&](uint32_t) {
+            for (uint32_t chunk = nextChunk.fetch_add(1); chunk < chunkCount; chunk = nextChunk.fetch_add(1)) {
+                recorder.record(chunk, inheritance, [&](vk::CommandBuffer cmd) {
+                    uint32_t bound = UINT32_MAX;
+                    for (uint32_t i = chunk * DRAWS_PER_CHUNK; i < std::min(DRAW_COUNT, (chunk + 1) * DRAWS_PER_CHUNK); i++) {
+                        if (draws[i].pipeline != bound) {
+                            bound = draws[i].pipeline;
+                            cmd.bindPipeline(vk::PipelineBindPoint::eCompute, pipelines[bound]);
+                        }
+                        cmd.pushConstants(layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(draws[i].object), draws[i].object);
+                        cmd.dispatch(1, 1, 1);
+                    }
+                });
+            }
+        });
+
+        const vk::CommandPool   primaryPool = device.createCommandPool(vk::CommandPoolCreateInfo(vk::CommandPoolCreateFlagBits::eTransient, gc->getQueueFamily(QueueType::Primary).value()));
+        const vk::CommandBuffer primary     = device.allocateCommandBuffers(vk::CommandBufferAllocateInfo(primaryPool, vk::CommandBufferLevel::ePrimary, 1)).front();
+
+        uint32_t frame = 0;
+        for (auto _ : state) {
+            recorder.beginFrame(frame++ % recorder.getFramesInFlight());
+            device.resetCommandPool(primaryPool);
+            nextChunk = 0;
+
+            threads.run();
+
+            primary.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+            recorder.execute(primary);
+            primary.end();
+        }
+
+        state.SetItemsProcessed(state.iterations() * DRAW_COUNT);
+        state.counters["threads"] = threadCount;
+
+        device.destroyCommandPool(primaryPool);
+    }
+
+    device.destroy(layout);
+}
+
+BENCHMARK(BM_Commands_Record)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Arg(16)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,97 @@
+#include "neuron/bench/bench_context.hpp"
+
+#include "neuron/graphics/compute.hpp"
+
+#include <random>
+
+using namespace neuron::graphics;
+
+namespace {
+    /**
+     * What every primitive benchmark needs: the service, the kernels (compiled before timing starts) and random input.
+     */
+    struct PrimitiveBench {
+        ComputeService   &compute;
+        ShaderCompiler    shaders;
+        ComputePrimitives primitives;
+
+        DeviceBuffer<uint32_t> input;
+        DeviceBuffer<uint32_t> output;
+        DeviceBuffer<uint32_t> values;
+        DeviceBuffer<uint32_t> count;
+
+        PrimitiveBench(const std::shared_ptr<GContext> &gc, size_t size, uint32_t max)
+            : compute(gc->getComputeService()), primitives(gc, shaders), input(*gc, size), output(*gc, size), values(*gc, size), count(*gc, 1) {
+            std::mt19937                            random(42);
+            std::uniform_int_distribution<uint32_t> distribution(0, max);
+
+            std::vector<uint32_t> data(size);
+            for (auto &value : data)
+                value = distribution(random);
+            compute.write(input, std::span<const uint32_t>(data));
+            compute.write(values, std::span<const uint32_t>(data));
+        }
+
+        template<typename F> void run(F &&record) {
+            ComputeBatch batch = compute.begin();
+            record(batch);
+            compute.wait(compute.submit(std::move(batch)));
+        }
+    };
+
+    bool requireCompute(benchmark::State &state) {
+        if (!neuron::bench::requireDevice(state))
+            return false;
+        if (!neuron::bench::gc()->supportsTimelineSemaphores()) {
+            state.SkipWithError("Compute service needs timeline semaphores");
+            return false;
+        }
+        return true;
+    }
+
+    template<typename F> void runPrimitive(benchmark::State &state, uint32_t max, F &&record) {
+        if (!requireCompute(state))
+            return;
+
+        const auto     size = static_cast<size_t>(state.range(0));
+        PrimitiveBench bench(neuron::bench::gc(), size, max);
+
+        // the first run compiles the kernels and allocates the scratch buffers
+        bench.run([&](ComputeBatch &batch) { record(bench, batch); });
+        for (auto _ : state) {
+            bench.run([&](ComputeBatch &batch) { record(bench, batch); });
+        }
+
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * size));
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size * sizeof(uint32_t)));
+    }
+} // namespace
+
+// elements per second for every primitive, submit to completion; on lavapipe this measures the shaders as the CPU runs them
+static void BM_Compute_Reduce(benchmark::State &state) {
+    runPrimitive(state, 1000, [](PrimitiveBench &bench, ComputeBatch &batch) { bench.primitives.reduce(batch, bench.input, bench.count); });
+}
+
+static void BM_Compute_ExclusiveScan(benchmark::State &state) {
+    runPrimitive(state, 1000, [](PrimitiveBench &bench, ComputeBatch &batch) { bench.primitives.exclusiveScan(batch, bench.input, bench.output); });
+}
+
+static void BM_Compute_Compact(benchmark::State &state) {
+    runPrimitive(state, 1, [](PrimitiveBench &bench, ComputeBatch &batch) { bench.primitives.compact(batch, bench.values, bench.input, bench.output, bench.count); });
+}
+
+// the keys are sorted in place, so every iteration after the first sorts sorted keys; a radix sort doesn't care
+static void BM_Compute_RadixSort(benchmark::State &state) {
+    runPrimitive(state, UINT32_MAX, [](PrimitiveBench &bench, ComputeBatch &batch) { bench.primitives.radixSort(batch, bench.input, &bench.values); });
+}
+
+// the cost of a batch with one tiny dispatch, which bounds how small useful work can get
+static void BM_Compute_SubmitLatency(benchmark::State &state) {
+    runPrimitive(state, 1000, [](PrimitiveBench &bench, ComputeBatch &batch) { bench.primitives.reduce(batch, bench.input, bench.count, ReduceOp::Add, 1); });
+}
+
+BENCHMARK(BM_Compute_Reduce)->RangeMultiplier(16)->Range(1 << 12, 1 << 24)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_Compute_ExclusiveScan)->RangeMultiplier(16)->Range(1 << 12, 1 << 24)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_Compute_Compact)->RangeMultiplier(16)->Range(1 << 12, 1 << 24)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_Compute_RadixSort)->RangeMultiplier(16)->Range(1 << 12, 1 << 22)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_Compute_SubmitLatency)->Arg(1)->Unit(benchmark::kMicrosecond)->UseRealTime();
@@ -0,0 +1,139 @@
+#include "neuron/bench/bench_context.hpp"
+
+#include "neuron/os/headless_surface.hpp"
+#include "neuron/utils/utils.hpp"
+
+#include <map>
+#include <string>
+
+using namespace neuron::graphics;
+
+// tears the engine context down and creates it again: instance, debug messenger, loggers and job system
+static void BM_Context_Recreate(benchmark::State &state) {
+    if (!neuron::bench::requireDevice(state))
+        return;
+
+    // nothing may outlive the instance
+    neuron::bench::gc().reset();
+    for (auto _ : state) {
+        neuron::cleanup();
+        neuron::init(neuron::bench::settings());
+    }
+    neuron::bench::gc() = std::make_shared<GContext>();
+}
+
+static void addPhaseCounters(benchmark::State &state, const std::map<std::string, double> &milliseconds, benchmark::Counter::Flags flags) {
+    for (const auto &[name, value] : milliseconds)
+        state.counters[name + "_ms"] = benchmark::Counter(value, flags);
+}
+
+// main()'s init() and GContext, the only startup of the process that also loads the loader, layers and driver. There is one measurement per process, so it is
+// reported once even with --benchmark_repetitions; run the benchmark binary several times to see how it varies.
+static void BM_Startup_Cold(benchmark::State &state) {
+    if (!neuron::bench::requireDevice(state))
+        return;
+
+    const auto &cold = neuron::bench::coldStart();
+    for (auto _ : state)
+        state.SetIterationTime(static_cast<double>(cold.nanoseconds) / 1e9);
+
+    std::map<std::string, double> phases;
+    for (const auto &phase : cold.phases)
+        phases[phase.name] += phase.getMilliseconds();
+    addPhaseCounters(state, phases, benchmark::Counter::kDefaults);
+}
+
+// init() and GContext again with everything loaded, as a process that restarts the engine sees them. Counters break it down into phases.
+static void BM_Startup_Warm(benchmark::State &state) {
+    if (!neuron::bench::requireDevice(state))
+        return;
+
+    std::map<std::string, double> phases;
+    neuron::bench::gc().reset();
+    for (auto _ : state) {
+        neuron::cleanup();
+        neuron::init(neuron::bench::settings());
+        neuron::bench::gc() = std::make_shared<GContext>();
+
+        state.PauseTiming();
+        for (const auto &phase : neuron::Context::get()->getStartupTimings().getPhases())
+            phases[phase.name] += phase.getMilliseconds();
+        for (const auto &phase : neuron::bench::gc()->getStartupTimings().getPhases())
+            phases[phase.name] += phase.getMilliseconds();
+        neuron::bench::gc().reset();
+        state.ResumeTiming();
+    }
+    neuron::bench::gc() = std::make_shared<GContext>();
+
+    addPhaseCounters(state, phases, benchmark::Counter::kAvgIterations);
+}
+
+// device selection and creation with the engine defaults, including the allocator and upload service
+static void BM_GContext_Recreate(benchmark::State &state) {
+    if (!neuron::bench::requireDevice(state))
+        return;
+
+    for (auto _ : state) {
+        GContext gc;
+        benchmark::DoNotOptimize(gc.getDevice());
+    }
+}
+
+static void BM_GContext_GetQueue(benchmark::State &state) {
+    if (!neuron::bench::requireDevice(state))
+        return;
+
+    const GContext &gc = *neuron::bench::gc();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(gc.getQueue(QueueType::Primary));
+        benchmark::DoNotOptimize(gc.getQueue(QueueType::Transfer));
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * 2));
+}
+
+static void BM_RenderTarget_CreateImage(benchmark::State &state) {
+    if (!neuron::bench::requireDevice(state))
+        return;
+
+    for (auto _ : state) {
+        ImageRenderTarget target(neuron::bench::gc(), {.extent = {1280, 720}});
+        benchmark::DoNotOptimize(target.getImageTarget(0));
+    }
+}
+
+// a headless surface and the swapchain on it
+static void BM_RenderTarget_CreateSwapchain(benchmark::State &state) {
+    if (!neuron::bench::requireDevice(state))
+        return;
+    if (!neuron::bench::hasHeadlessSurface()) {
+        state.SkipWithError("No VK_EXT_headless_surface");
+        return;
+    }
+
+    for (auto _ : state) {
+        auto                surface = std::make_shared<neuron::os::HeadlessSurface>();
+        SurfaceRenderTarget target(neuron::bench::gc(), surface, {.fallbackExtent = {1280, 720}});
+        benchmark::DoNotOptimize(target.getSurfaceSwapchain());
+    }
+}
+
+static void BM_Utils_AllocateAndFillArray(benchmark::State &state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        uint32_t *array = neuron::utils::allocateAndFillArray<uint32_t>(size, 0x4d);
+        benchmark::DoNotOptimize(array);
+        delete[] array;
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size * sizeof(uint32_t)));
+}
+
+BENCHMARK(BM_Startup_Cold)->Unit(benchmark::kMillisecond)->UseManualTime()->Iterations(1)->Repetitions(1);
+BENCHMARK(BM_Startup_Warm)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_Context_Recreate)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_GContext_Recreate)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_GContext_GetQueue);
+BENCHMARK(BM_RenderTarget_CreateImage)->Unit(benchmark::kMicrosecond)->UseRealTime();
+BENCHMARK(BM_RenderTarget_CreateSwapchain)->Unit(benchmark::kMicrosecond)->UseRealTime();
+BENCHMARK(BM_Utils_AllocateAndFillArray)->Range(64, 1 << 20);
@@ -0,0 +1,124 @@
+#include "neuron/bench/bench_context.hpp"
+
+#include "neuron/graphics/descriptors.hpp"
+
+#include <array>
+#include <vector>
+
+using namespace neuron::graphics;
+
+namespace {
+    constexpr uint32_t DRAW_COUNT = 4096;
+
+    /**
+     * What a draw binds in both models: a texture and a storage buffer with its per-object data. The commands are recorded but never submitted.
+     */
+    class DrawResources {
+      public:
+        explicit DrawResources(const std::shared_ptr<GContext> &gc) : m_GC(gc) {
+            auto &allocator = gc->getAllocator();
+            m_Image = allocator.createImage(vk::ImageCreateInfo({}, vk::ImageType::e2D, vk::Format::eR8G8B8A8Unorm, vk::Extent3D(4, 4, 1), 1, 1, vk::SampleCountFlagBits::e1,
+                                                                 vk::ImageTiling::eOptimal, vk::ImageUsageFlagBits::eSampled, vk::SharingMode::eExclusive),
+                                            vk::MemoryPropertyFlagBits::eDeviceLocal);
+            m_Buffer = allocator.createBuffer(vk::BufferCreateInfo({}, DRAW_COUNT * 64, vk::BufferUsageFlagBits::eStorageBuffer, vk::SharingMode::eExclusive),
+                                              vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+            const auto &device = gc->getDevice();
+            view    = device.createImageView(vk::ImageViewCreateInfo({}, m_Image.image, vk::ImageViewType::e2D, vk::Format::eR8G8B8A8Unorm, STANDARD_COMPONENT_MAPPING, BASIC_ISR));
+            sampler = device.createSampler(vk::SamplerCreateInfo());
+            buffer  = m_Buffer.buffer;
+            pool    = device.createCommandPool(vk::CommandPoolCreateInfo(vk::CommandPoolCreateFlagBits::eResetCommandBuffer, gc->getQueueFamily(QueueType::Primary).value()));
+            cmd     = device.allocateCommandBuffers(vk::CommandBufferAllocateInfo(pool, vk::CommandBufferLevel::ePrimary, 1)).front();
+        }
+
+        ~DrawResources() {
+            const auto &device = m_GC->getDevice();
+            device.destroyCommandPool(pool);
+            device.destroySampler(sampler);
+            device.destroyImageView(view);
+            m_GC->getAllocator().destroy(m_Buffer);
+            m_GC->getAllocator().destroy(m_Image);
+        }
+
+        vk::ImageView     view;
+        vk::Sampler       sampler;
+        vk::Buffer        buffer;
+        vk::CommandPool   pool;
+        vk::CommandBuffer cmd;
+
+      private:
+        std::shared_ptr<GContext> m_GC;
+        AllocatedImage            m_Image;
+        AllocatedBuffer           m_Buffer;
+    };
+} // namespace
+
+// the classic model: every draw allocates a set from the frame's pools, writes its descriptors and binds it
+static void BM_Descriptors_PerDrawSets(benchmark::State &state) {
+    if (!neuron::bench::requireDevice(state))
+        return;
+
+    const std::shared_ptr<GContext> &gc     = neuron::bench::gc();
+    const auto                      &device = gc->getDevice();
+    DrawResources                    draw(gc);
+
+    const std::array bindings = {vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eAll),
+                                 vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eAll)};
+    const auto       setLayout = device.createDescriptorSetLayout(vk::DescriptorSetLayoutCreateInfo({}, bindings));
+    const auto       layout    = device.createPipelineLayout(vk::PipelineLayoutCreateInfo({}, setLayout));
+
+    FrameDescriptorAllocator allocator(gc, {.framesInFlight = 1});
+    for (auto _ : state) {
+        allocator.beginFrame(0);
+        draw.cmd.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+        for (uint32_t i = 0; i < DRAW_COUNT; i++) {
+            const vk::DescriptorSet        set = allocator.allocate(setLayout);
+            const vk::DescriptorImageInfo  image(draw.sampler, draw.view, vk::ImageLayout::eShaderReadOnlyOptimal);
+            const vk::DescriptorBufferInfo buffer(draw.buffer, i * 64, 64);
+            const std::array               writes = {vk::WriteDescriptorSet(set, 0, 0, vk::DescriptorType::eCombinedImageSampler, image),
+                                                     vk::WriteDescriptorSet(set, 1, 0, vk::DescriptorType::eStorageBuffer, {}, buffer)};
+            device.updateDescriptorSets(writes, {});
+            draw.cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, layout, 0, set, {});
+        }
+        draw.cmd.end();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * DRAW_COUNT);
+    state.counters["pools"] = allocator.getPoolCount();
+
+    device.destroyPipelineLayout(layout);
+    device.destroyDescriptorSetLayout(setLayout);
+}
+
+// the bindless model: resources are registered once, the heap is bound once per command buffer and every draw only pushes its indices
+static void BM_Descriptors_Bindless(benchmark::State &state) {
+    if (!neuron::bench::requireDevice(state))
+        return;
+
+    const std::shared_ptr<GContext> &gc = neuron::bench::gc();
+    if (!gc->getFastPaths().descriptorIndexing) {
+        state.SkipWithError("No descriptor indexing");
+        return;
+    }
+    DrawResources draw(gc);
+
+    BindlessHeap   heap(gc, {.sampledImages = 16, .storageImages = 16, .storageBuffers = DRAW_COUNT});
+    const uint32_t texture = heap.registerSampledImage(draw.view, draw.sampler);
+
+    std::vector<uint32_t> objects(DRAW_COUNT);
+    for (uint32_t i = 0; i < DRAW_COUNT; i++)
+        objects[i] = heap.registerStorageBuffer(draw.buffer, i * 64, 64);
+
+    for (auto _ : state) {
+        draw.cmd.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+        heap.bind(draw.cmd, vk::PipelineBindPoint::eGraphics, heap.getPipelineLayout());
+        for (uint32_t i = 0; i < DRAW_COUNT; i++) {
+            const std::array<uint32_t, 2> indices = {texture, objects[i]};
+            draw.cmd.pushConstants(heap.getPipelineLayout(), vk::ShaderStageFlagBits::eAll, 0, sizeof(indices), indices.data());
+        }
+        draw.cmd.end();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * DRAW_COUNT);
+}
+
+BENCHMARK(BM_Descriptors_PerDrawSets)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Descriptors_Bindless)->Unit(benchmark::kMicrosecond);
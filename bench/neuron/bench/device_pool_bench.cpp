@@ -0,0 +1,88 @@
+#include "neuron/bench/bench_context.hpp"
+
+#include "neuron/graphics/device_pool.hpp"
+
+#include <unordered_map>
+
+using namespace neuron::graphics;
+
+namespace {
+    constexpr uint32_t       JOBS       = 64;
+    constexpr vk::DeviceSize JOB_BYTES  = 16ULL * 1024 * 1024;
+    constexpr uint32_t       JOB_PASSES = 4;
+
+    /**
+     * What one context's jobs reuse. Only the context's own thread touches it.
+     */
+    struct JobResources {
+        GContext         *gc = nullptr;
+        AllocatedBuffer   buffer;
+        vk::CommandPool   pool;
+        vk::CommandBuffer cmd;
+        vk::Fence         fence;
+
+        explicit JobResources(GContext &gc) : gc(&gc) {
+            const vk::Device &device = gc.getDevice();
+
+            buffer = gc.getAllocator().createBuffer(vk::BufferCreateInfo({}, JOB_BYTES, vk::BufferUsageFlagBits::eTransferDst, vk::SharingMode::eExclusive),
+                                                    vk::MemoryPropertyFlagBits::eDeviceLocal);
+            pool   = device.createCommandPool(vk::CommandPoolCreateInfo({}, gc.getQueueFamily(QueueType::Primary).value()));
+            cmd    = device.allocateCommandBuffers(vk::CommandBufferAllocateInfo(pool, vk::CommandBufferLevel::ePrimary, 1)).front();
+            fence  = device.createFence(vk::FenceCreateInfo());
+        }
+
+        ~JobResources() {
+            const vk::Device &device = gc->getDevice();
+            device.destroyFence(fence);
+            device.destroyCommandPool(pool);
+            gc->getAllocator().destroy(buffer);
+        }
+
+        JobResources(const JobResources &)            = delete;
+        JobResources &operator=(const JobResources &) = delete;
+
+        // a stand-in for a frame or tile: a few full passes over a buffer
+        void run(uint32_t value) {
+            const vk::Device &device = gc->getDevice();
+            device.resetCommandPool(pool);
+
+            cmd.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+            for (uint32_t pass = 0; pass < JOB_PASSES; pass++) {
+                cmd.fillBuffer(buffer.buffer, 0, VK_WHOLE_SIZE, value + pass);
+                const vk::MemoryBarrier barrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eTransferWrite);
+                cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {}, barrier, {}, {});
+            }
+            cmd.end();
+
+            gc->submit(gc->getPrimaryQueue(), vk::SubmitInfo({}, {}, cmd), fence);
+            (void) device.waitForFences(fence, true, UINT64_MAX);
+            device.resetFences(fence);
+        }
+    };
+} // namespace
+
+// independent jobs over 1 to 4 logical devices of the best device, to see how throughput scales with the pool size
+static void BM_DevicePool_Throughput(benchmark::State &state) {
+    if (!neuron::bench::requireDevice(state))
+        return;
+
+    const auto contexts = static_cast<uint32_t>(state.range(0));
+    DevicePool pool({.devices = {DeviceSelection{}}, .contextsPerDevice = contexts});
+
+    std::unordered_map<const GContext *, std::unique_ptr<JobResources>> resources;
+    for (size_t i = 0; i < pool.getSize(); i++)
+        resources.emplace(pool.getContext(i).get(), std::make_unique<JobResources>(*pool.getContext(i)));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(pool.map(JOBS, [&](const std::shared_ptr<GContext> &gc, uint32_t i) {
+            resources.at(gc.get())->run(i);
+            return i;
+        }));
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * JOBS));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * JOBS * JOB_BYTES * JOB_PASSES));
+    state.counters["contexts"] = static_cast<double>(pool.getSize());
+}
+
+BENCHMARK(BM_DevicePool_Throughput)->DenseRange(1, 4)->Unit(benchmark::kMillisecond)->UseRealTime();
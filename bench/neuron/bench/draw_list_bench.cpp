@@ -0,0 +1,64 @@
+#include "neuron/bench/bench_context.hpp"
+
+#include "neuron/graphics/draw_list.hpp"
+#include "neuron/neuron.hpp"
+
+#include <random>
+
+using namespace neuron::graphics;
+
+namespace {
+    constexpr uint32_t ENTITY_COUNT = 100000;
+
+    /**
+     * A city block of props: 4 pipelines, 16 materials and 32 meshes, spread over 500 units in front of the camera. Every tenth object is
+     * transparent.
+     */
+    entt::registry &scene() {
+        static entt::registry registry = [] {
+            entt::registry result;
+            std::mt19937   random(42);
+            for (uint32_t i = 0; i < ENTITY_COUNT; i++) {
+                const bool       transparent = i % 10 == 0;
+                const Renderable renderable{.mesh     = static_cast<uint16_t>(random() % 32),
+                                            .material = static_cast<uint16_t>(random() % 16),
+                                            .pipeline = static_cast<uint16_t>(random() % 4),
+                                            .pass     = static_cast<uint8_t>(transparent ? 1 : 0)};
+
+                glm::mat4 matrix(1.f);
+                matrix[3] = glm::vec4(static_cast<float>(random() % 1000) - 500.f, 0.f, -static_cast<float>(random() % 500), 1.f);
+
+                const auto entity = result.create();
+                result.emplace<WorldTransform>(entity, WorldTransform{matrix});
+                result.emplace<Renderable>(entity, renderable);
+            }
+            return result;
+        }();
+        return registry;
+    }
+} // namespace
+
+// extraction, sorting and batching of the whole scene, on the calling thread or spread over the engine's job system
+static void BM_DrawList_Extract(benchmark::State &state) {
+    auto                     &registry = scene();
+    const DrawExtractSettings settings{.backToFrontPasses = 0b10, .jobs = state.range(0) != 0 ? &neuron::getJobSystem() : nullptr};
+
+    DrawList list;
+    uint64_t extract = 0, sort = 0, batch = 0;
+    for (auto _ : state) {
+        list.extract(registry, settings);
+        extract += list.getStats().extractNanoseconds;
+        sort += list.getStats().sortNanoseconds;
+        batch += list.getStats().batchNanoseconds;
+    }
+
+    const auto iterations = static_cast<double>(state.iterations());
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * ENTITY_COUNT);
+    state.counters["draws"]      = list.getStats().drawsBeforeBatching;
+    state.counters["batched"]    = list.getStats().drawsAfterBatching;
+    state.counters["extract_us"] = static_cast<double>(extract) / iterations / 1000.0;
+    state.counters["sort_us"]    = static_cast<double>(sort) / iterations / 1000.0;
+    state.counters["batch_us"]   = static_cast<double>(batch) / iterations / 1000.0;
+}
+
+BENCHMARK(BM_DrawList_Extract)->ArgName("parallel")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond)->UseRealTime();
@@ -0,0 +1,94 @@
+#include "neuron/bench/bench_context.hpp"
+
+#include "neuron/graphics/frame_capture.hpp"
+
+#include <fstream>
+
+using namespace neuron::graphics;
+
+namespace {
+    constexpr vk::Extent2D FRAME_EXTENT = {1280, 720};
+    constexpr uint32_t     FRAMES       = 32;
+
+    // stands in for rendering: something different every frame so the encoders can't take shortcuts
+    void renderFrame(vk::CommandBuffer cmd, vk::Image image, uint32_t frame) {
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::PipelineStageFlagBits::eTransfer, {}, {}, {},
+                            vk::ImageMemoryBarrier(vk::AccessFlagBits::eColorAttachmentWrite, vk::AccessFlagBits::eTransferWrite, vk::ImageLayout::eColorAttachmentOptimal,
+                                                   vk::ImageLayout::eTransferDstOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image, BASIC_ISR));
+        cmd.clearColorImage(image, vk::ImageLayout::eTransferDstOptimal, vk::ClearColorValue(std::array<float, 4>{(frame % 256) / 255.f, 0.5f, 0.25f, 1.f}), BASIC_ISR);
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eColorAttachmentOutput, {}, {}, {},
+                            vk::ImageMemoryBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eColorAttachmentWrite, vk::ImageLayout::eTransferDstOptimal,
+                                                   vk::ImageLayout::eColorAttachmentOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image, BASIC_ISR));
+    }
+
+    std::filesystem::path benchDirectory() { return std::filesystem::temp_directory_path() / "neuron_bench_capture"; }
+} // namespace
+
+// what capturing looked like before: read back and encode on the render thread after every frame
+static void BM_FrameCapture_Inline(benchmark::State &state) {
+    if (!neuron::bench::requireDevice(state))
+        return;
+
+    const auto                  format = static_cast<CaptureFormat>(state.range(0));
+    const std::filesystem::path path   = benchDirectory() / "inline";
+    std::filesystem::create_directories(benchDirectory());
+
+    ImageRenderTarget target(neuron::bench::gc(), {.extent = FRAME_EXTENT, .imageCount = 1});
+
+    uint32_t frameNumber = 0;
+    for (auto _ : state) {
+        for (uint32_t i = 0; i < FRAMES; i++) {
+            const FrameContext frame = target.beginFrame();
+            renderFrame(frame.commandBuffer, target.getImageTarget(), frameNumber++);
+            target.endFrame();
+
+            const std::span<const std::byte> pixels = target.readback(0);
+            std::vector<std::byte>           encoded;
+            if (format == CaptureFormat::Png)
+                encoded = FrameCapture::encodePng(pixels, FRAME_EXTENT.width, FRAME_EXTENT.height);
+            else if (format == CaptureFormat::Qoi)
+                encoded = FrameCapture::encodeQoi(pixels, FRAME_EXTENT.width, FRAME_EXTENT.height);
+
+            const std::span<const std::byte> bytes = format == CaptureFormat::Raw ? pixels : std::span<const std::byte>(encoded);
+            std::ofstream(path, std::ios::binary | std::ios::trunc).write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        }
+    }
+
+    std::filesystem::remove_all(benchDirectory());
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * FRAMES));
+}
+
+// the same frames through FrameCapture; stall_ms is how long the render thread waited on the ring per iteration
+static void BM_FrameCapture_Async(benchmark::State &state) {
+    if (!neuron::bench::requireDevice(state))
+        return;
+
+    const auto format  = static_cast<CaptureFormat>(state.range(0));
+    const auto workers = static_cast<uint32_t>(state.range(1));
+
+    ImageRenderTarget target(neuron::bench::gc(), {.extent = FRAME_EXTENT, .imageCount = 2});
+    FrameCapture      capture(neuron::bench::gc(), {.directory = benchDirectory(), .format = format, .ringSize = 4, .workerCount = workers});
+
+    for (auto _ : state) {
+        for (uint32_t i = 0; i < FRAMES; i++) {
+            const FrameContext frame = target.beginFrame();
+            renderFrame(frame.commandBuffer, target.getImageTarget(frame.imageIndex), i);
+            capture.record(frame, target);
+            target.endFrame();
+            capture.commit();
+        }
+        capture.flush();
+    }
+
+    const FrameCaptureStats stats = capture.getStats();
+    std::filesystem::remove_all(benchDirectory());
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * FRAMES));
+    state.counters["captured_fps"] = stats.framesPerSecond;
+    state.counters["stall_ms"]     = static_cast<double>(stats.stallNanoseconds) / 1e6 / static_cast<double>(state.iterations());
+    state.counters["stalls"]       = static_cast<double>(stats.stalls) / static_cast<double>(state.iterations());
+}
+
+// formats by CaptureFormat: 0 PNG, 1 QOI, 2 raw
+BENCHMARK(BM_FrameCapture_Inline)->ArgName("format")->DenseRange(0, 2)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_FrameCapture_Async)->ArgNames({"format", "workers"})->ArgsProduct({{0, 1, 2}, {1, 4}})->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,190 @@
+#include "neuron/bench/bench_context.hpp"
+
+#include "neuron/graphics/resources.hpp"
+#include "neuron/utils/handle_pool.hpp"
+
+#include <memory>
+#include <random>
+
+namespace {
+    constexpr size_t DRAWS = 4096;
+    constexpr size_t CHURN = 1024;
+
+    // what a buffer resource carries, without needing a device
+    struct BufferRecord {
+        uint64_t buffer = 0;
+        uint64_t memory = 0;
+        uint64_t offset = 0;
+        uint64_t size   = 0;
+    };
+
+    struct RecordTag;
+
+    // the same fields as columns: buffer, memory, offset, size
+    using RecordPool   = neuron::utils::HandlePool<RecordTag, uint64_t, uint64_t, uint64_t, uint64_t>;
+    using RecordHandle = RecordPool::HandleType;
+
+    std::vector<uint32_t> randomOrder(size_t count, size_t resources) {
+        std::mt19937                            random(42);
+        std::uniform_int_distribution<uint32_t> distribution(0, static_cast<uint32_t>(resources) - 1);
+
+        std::vector<uint32_t> order(count);
+        for (auto &index : order)
+            index = distribution(random);
+        return order;
+    }
+
+    std::shared_ptr<BufferRecord> makeShared(uint64_t i) { return std::make_shared<BufferRecord>(BufferRecord{i, i * 3, i * 256, 256}); }
+
+    RecordHandle makeHandle(RecordPool &pool, uint64_t i) { return pool.create(i, i * 3, i * 256, 256); }
+} // namespace
+
+// a frame's draws keep the resources they use alive and read them while recording: one atomic increment and decrement plus a pointer chase per draw
+static void BM_Resources_SharedPtrLookup(benchmark::State &state) {
+    const auto resourceCount = static_cast<size_t>(state.range(0));
+
+    std::vector<std::shared_ptr<BufferRecord>> resources;
+    for (size_t i = 0; i < resourceCount; i++)
+        resources.push_back(makeShared(i));
+    const std::vector<uint32_t> order = randomOrder(DRAWS, resourceCount);
+
+    std::vector<std::shared_ptr<BufferRecord>> draws;
+    draws.reserve(DRAWS);
+    for (auto _ : state) {
+        for (const uint32_t index : order)
+            draws.push_back(resources[index]);
+
+        uint64_t sum = 0;
+        for (const auto &draw : draws)
+            sum += draw->buffer + draw->offset;
+        benchmark::DoNotOptimize(sum);
+        draws.clear();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * DRAWS));
+}
+
+// the same with handles: the draws hold 32-bit values and recording reads two dense columns
+static void BM_Resources_HandleLookup(benchmark::State &state) {
+    const auto resourceCount = static_cast<size_t>(state.range(0));
+
+    RecordPool                pool;
+    std::vector<RecordHandle> resources;
+    pool.reserve(resourceCount);
+    for (size_t i = 0; i < resourceCount; i++)
+        resources.push_back(makeHandle(pool, i));
+    const std::vector<uint32_t> order = randomOrder(DRAWS, resourceCount);
+
+    std::vector<RecordHandle> draws;
+    draws.reserve(DRAWS);
+    for (auto _ : state) {
+        for (const uint32_t index : order)
+            draws.push_back(resources[index]);
+
+        uint64_t sum = 0;
+        for (const RecordHandle draw : draws)
+            sum += pool.get<0>(draw) + pool.get<2>(draw);
+        benchmark::DoNotOptimize(sum);
+        draws.clear();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * DRAWS));
+    state.counters["validated"] = neuron::utils::VALIDATE_HANDLES ? 1 : 0;
+}
+
+// streaming: a random part of the resources is replaced every frame
+static void BM_Resources_SharedPtrChurn(benchmark::State &state) {
+    const auto resourceCount = static_cast<size_t>(state.range(0));
+
+    std::vector<std::shared_ptr<BufferRecord>> resources;
+    for (size_t i = 0; i < resourceCount; i++)
+        resources.push_back(makeShared(i));
+    const std::vector<uint32_t> order = randomOrder(CHURN, resourceCount);
+
+    uint64_t next = resourceCount;
+    for (auto _ : state) {
+        for (const uint32_t index : order)
+            resources[index] = makeShared(next++);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * CHURN));
+}
+
+static void BM_Resources_HandleChurn(benchmark::State &state) {
+    const auto resourceCount = static_cast<size_t>(state.range(0));
+
+    RecordPool                pool;
+    std::vector<RecordHandle> resources;
+    pool.reserve(resourceCount + RecordPool::MIN_FREE_SLOTS + 1);
+    for (size_t i = 0; i < resourceCount; i++)
+        resources.push_back(makeHandle(pool, i));
+    const std::vector<uint32_t> order = randomOrder(CHURN, resourceCount);
+
+    uint64_t next = resourceCount;
+    for (auto _ : state) {
+        for (const uint32_t index : order) {
+            pool.destroy(resources[index]);
+            resources[index] = makeHandle(pool, next++);
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * CHURN));
+}
+
+// real buffers: shared_ptrs destroy theirs when the last owner drops, the registry in one batch per frame once the frame left the GPU
+static void BM_Resources_SharedPtrBufferChurn(benchmark::State &state) {
+    if (!neuron::bench::requireDevice(state))
+        return;
+
+    const std::shared_ptr<neuron::graphics::GContext> &gc = neuron::bench::gc();
+    const vk::BufferCreateInfo                          createInfo({}, 4096, vk::BufferUsageFlagBits::eStorageBuffer, vk::SharingMode::eExclusive);
+
+    const auto create = [&] {
+        return std::shared_ptr<neuron::graphics::AllocatedBuffer>(
+            new neuron::graphics::AllocatedBuffer(gc->getAllocator().createBuffer(createInfo, vk::MemoryPropertyFlagBits::eDeviceLocal)),
+            [gc](neuron::graphics::AllocatedBuffer *buffer) {
+                gc->getAllocator().destroy(*buffer);
+                delete buffer;
+            });
+    };
+
+    std::vector<std::shared_ptr<neuron::graphics::AllocatedBuffer>> resources(static_cast<size_t>(state.range(0)));
+    for (auto &resource : resources)
+        resource = create();
+
+    for (auto _ : state) {
+        for (auto &resource : resources)
+            resource = create();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * resources.size()));
+}
+
+static void BM_Resources_RegistryBufferChurn(benchmark::State &state) {
+    if (!neuron::bench::requireDevice(state))
+        return;
+
+    neuron::graphics::ResourceRegistry registry(neuron::bench::gc());
+    const vk::BufferCreateInfo         createInfo({}, 4096, vk::BufferUsageFlagBits::eStorageBuffer, vk::SharingMode::eExclusive);
+
+    std::vector<neuron::graphics::BufferHandle> resources(static_cast<size_t>(state.range(0)));
+    for (auto &resource : resources)
+        resource = registry.createBuffer(createInfo, vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    for (auto _ : state) {
+        for (auto &resource : resources) {
+            registry.destroy(resource);
+            resource = registry.createBuffer(createInfo, vk::MemoryPropertyFlagBits::eDeviceLocal);
+        }
+        registry.nextFrame();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * resources.size()));
+}
+
+BENCHMARK(BM_Resources_SharedPtrLookup)->RangeMultiplier(16)->Range(1 << 10, 1 << 18)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Resources_HandleLookup)->RangeMultiplier(16)->Range(1 << 10, 1 << 18)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Resources_SharedPtrChurn)->RangeMultiplier(16)->Range(1 << 10, 1 << 18)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Resources_HandleChurn)->RangeMultiplier(16)->Range(1 << 10, 1 << 18)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Resources_SharedPtrBufferChurn)->Arg(256)->Unit(benchmark::kMicrosecond)->UseRealTime();
+BENCHMARK(BM_Resources_RegistryBufferChurn)->Arg(256)->Unit(benchmark::kMicrosecond)->UseRealTime();
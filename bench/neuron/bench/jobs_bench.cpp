@@ -0,0 +1,161 @@
+#include "neuron/bench/bench_context.hpp"
+
+#include "neuron/utils/jobs.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+using namespace neuron::utils;
+
+namespace {
+    constexpr uint32_t NESTED_PARENTS = 64;
+
+    uint32_t workerCount() { return std::max(1u, std::thread::hardware_concurrency() - 1); }
+
+    // a few hundred nanoseconds of work, about what culling one object or updating one transform costs
+    void tinyWork(uint32_t seed) {
+        uint32_t value = seed;
+        for (int i = 0; i < 64; i++)
+            value = value * 1664525u + 1013904223u;
+        benchmark::DoNotOptimize(value);
+    }
+
+    /**
+     * The baseline: one queue behind one mutex, shared by every worker and every submitter.
+     */
+    class MutexPool {
+      public:
+        explicit MutexPool(uint32_t count) {
+            for (uint32_t i = 0; i < count; i++) {
+                m_Workers.emplace_back([this](const std::stop_token &stop) {
+                    while (true) {
+                        std::function<void()> job;
+                        {
+                            std::unique_lock lock(m_Mutex);
+                            if (!m_Signal.wait(lock, stop, [this] { return !m_Jobs.empty(); }))
+                                return;
+                            job = std::move(m_Jobs.front());
+                            m_Jobs.pop_front();
+                        }
+                        job();
+                        if (m_Pending.fetch_sub(1) == 1)
+                            m_Pending.notify_all();
+                    }
+                });
+            }
+        }
+
+        void submit(std::function<void()> job) {
+            m_Pending.fetch_add(1);
+            {
+                std::lock_guard lock(m_Mutex);
+                m_Jobs.push_back(std::move(job));
+            }
+            m_Signal.notify_one();
+        }
+
+        void wait() {
+            for (uint64_t pending = m_Pending.load(); pending != 0; pending = m_Pending.load())
+                m_Pending.wait(pending);
+        }
+
+      private:
+        std::mutex                        m_Mutex;
+        std::condition_variable_any       m_Signal;
+        std::deque<std::function<void()>> m_Jobs;
+        std::atomic<uint64_t>             m_Pending = 0;
+        std::vector<std::jthread>         m_Workers;
+    };
+
+    MutexPool &mutexPool() {
+        static MutexPool pool(workerCount());
+        return pool;
+    }
+
+    JobSystem &jobSystem() {
+        static JobSystem jobs({.workerCount = workerCount()});
+        return jobs;
+    }
+} // namespace
+
+// many independent tiny tasks submitted from the main thread
+static void BM_Jobs_MutexQueue(benchmark::State &state) {
+    MutexPool     &pool  = mutexPool();
+    const uint32_t count = static_cast<uint32_t>(state.range(0));
+
+    for (auto _ : state) {
+        for (uint32_t i = 0; i < count; i++)
+            pool.submit([i] { tinyWork(i); });
+        pool.wait();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+static void BM_Jobs_WorkStealing(benchmark::State &state) {
+    JobSystem     &jobs  = jobSystem();
+    const uint32_t count = static_cast<uint32_t>(state.range(0));
+
+    for (auto _ : state) {
+        TaskGroup group(jobs);
+        for (uint32_t i = 0; i < count; i++)
+            group.submit([i] { tinyWork(i); });
+        group.wait();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+// tasks that fan out into children from the worker threads, where the per-worker deques avoid the shared lock
+static void BM_Jobs_MutexQueue_Nested(benchmark::State &state) {
+    MutexPool     &pool     = mutexPool();
+    const uint32_t children = static_cast<uint32_t>(state.range(0)) / NESTED_PARENTS;
+
+    for (auto _ : state) {
+        for (uint32_t parent = 0; parent < NESTED_PARENTS; parent++) {
+            pool.submit([&pool, children, parent] {
+                for (uint32_t i = 0; i < children; i++)
+                    pool.submit([parent, i] { tinyWork(parent ^ i); });
+            });
+        }
+        pool.wait();
+    }
+    state.SetItemsProcessed(state.iterations() * NESTED_PARENTS * children);
+}
+
+static void BM_Jobs_WorkStealing_Nested(benchmark::State &state) {
+    JobSystem     &jobs     = jobSystem();
+    const uint32_t children = static_cast<uint32_t>(state.range(0)) / NESTED_PARENTS;
+
+    for (auto _ : state) {
+        TaskGroup group(jobs);
+        for (uint32_t parent = 0; parent < NESTED_PARENTS; parent++) {
+            group.submit([&group, children, parent] {
+                for (uint32_t i = 0; i < children; i++)
+                    group.submit([parent, i] { tinyWork(parent ^ i); });
+            });
+        }
+        group.wait();
+    }
+    state.SetItemsProcessed(state.iterations() * NESTED_PARENTS * children);
+}
+
+static void BM_Jobs_ParallelFor(benchmark::State &state) {
+    JobSystem     &jobs  = jobSystem();
+    const uint32_t count = static_cast<uint32_t>(state.range(0));
+
+    for (auto _ : state) {
+        jobs.parallelFor(count, 64, [](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++)
+                tinyWork(i);
+        });
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(BM_Jobs_MutexQueue)->Arg(1 << 12)->Arg(1 << 16)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_Jobs_WorkStealing)->Arg(1 << 12)->Arg(1 << 16)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_Jobs_MutexQueue_Nested)->Arg(1 << 12)->Arg(1 << 16)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_Jobs_WorkStealing_Nested)->Arg(1 << 12)->Arg(1 << 16)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_Jobs_ParallelFor)->Arg(1 << 12)->Arg(1 << 16)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,134 @@
+#include "neuron/bench/bench_context.hpp"
+
+#include "neuron/math/batch.hpp"
+
+#include <array>
+#include <random>
+#include <vector>
+
+using namespace neuron::math;
+
+namespace {
+    constexpr size_t OBJECT_COUNT = 200000;
+
+    glm::mat4 randomAffine(std::mt19937 &random) {
+        std::uniform_real_distribution<float> value(-2.f, 2.f);
+        glm::mat4                             matrix(1.f);
+        for (int c = 0; c < 4; c++)
+            for (int r = 0; r < 3; r++)
+                matrix[c][r] = value(random);
+        return matrix;
+    }
+
+    // skips levels the CPU doesn't have instead of silently measuring a lower one
+    bool selectLevel(benchmark::State &state) {
+        const auto level = static_cast<SimdLevel>(state.range(0));
+        if (level > getSupportedSimdLevel()) {
+            state.SkipWithError("SIMD level not supported");
+            return false;
+        }
+        setSimdLevel(level);
+        return true;
+    }
+} // namespace
+
+// the baseline: one glm multiply per object over an array of matrices
+static void BM_Math_MultiplyGlm(benchmark::State &state) {
+    std::mt19937           random(1);
+    std::vector<glm::mat4> a(OBJECT_COUNT), b(OBJECT_COUNT), result(OBJECT_COUNT);
+    for (size_t i = 0; i < OBJECT_COUNT; i++) {
+        a[i] = randomAffine(random);
+        b[i] = randomAffine(random);
+    }
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < OBJECT_COUNT; i++)
+            result[i] = a[i] * b[i];
+        benchmark::DoNotOptimize(result.data());
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * OBJECT_COUNT));
+}
+
+static void BM_Math_Multiply(benchmark::State &state) {
+    if (!selectLevel(state))
+        return;
+
+    std::mt19937 random(1);
+    TransformSoA a(OBJECT_COUNT), b(OBJECT_COUNT), result;
+    for (size_t i = 0; i < OBJECT_COUNT; i++) {
+        a.set(i, randomAffine(random));
+        b.set(i, randomAffine(random));
+    }
+
+    for (auto _ : state) {
+        multiplyTransforms(a, b, result);
+        benchmark::DoNotOptimize(result.stream(0));
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * OBJECT_COUNT));
+    setSimdLevel(getSupportedSimdLevel());
+}
+
+// a scene graph in level order: 1000 roots with 199 descendants each, four levels deep
+static void BM_Math_Hierarchy(benchmark::State &state) {
+    if (!selectLevel(state))
+        return;
+
+    std::mt19937          random(2);
+    TransformSoA          local(OBJECT_COUNT), world;
+    std::vector<uint32_t> parents(OBJECT_COUNT);
+
+    constexpr size_t ROOTS = 1000;
+    for (size_t i = 0; i < OBJECT_COUNT; i++) {
+        local.set(i, randomAffine(random));
+        parents[i] = i < ROOTS ? NO_PARENT : static_cast<uint32_t>(i / 5 < ROOTS ? random() % ROOTS : i / 5);
+    }
+
+    for (auto _ : state) {
+        propagateHierarchy(local, parents, world);
+        benchmark::DoNotOptimize(world.stream(0));
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * OBJECT_COUNT));
+    setSimdLevel(getSupportedSimdLevel());
+}
+
+// world space bounds, then a frustum test of the result
+static void BM_Math_BoundsAndCull(benchmark::State &state) {
+    if (!selectLevel(state))
+        return;
+
+    std::mt19937                          random(3);
+    std::uniform_real_distribution<float> position(-50.f, 50.f);
+
+    TransformSoA transforms(OBJECT_COUNT);
+    AabbSoA      bounds(OBJECT_COUNT), world;
+    for (size_t i = 0; i < OBJECT_COUNT; i++) {
+        glm::mat4 matrix = randomAffine(random);
+        matrix[3]        = glm::vec4(position(random), position(random), position(random), 1.f);
+        transforms.set(i, matrix);
+        bounds.set(i, glm::vec3(-1.f), glm::vec3(1.f));
+    }
+
+    const std::array<glm::vec4, 6> planes = {glm::vec4(1, 0, 0, 20), glm::vec4(-1, 0, 0, 20), glm::vec4(0, 1, 0, 20),
+                                             glm::vec4(0, -1, 0, 20), glm::vec4(0, 0, 1, 20), glm::vec4(0, 0, -1, 20)};
+    std::vector<uint8_t>           visible(OBJECT_COUNT);
+
+    size_t count = 0;
+    for (auto _ : state) {
+        transformAabbs(transforms, bounds, world);
+        count = cullAabbs(planes, world, visible);
+        benchmark::DoNotOptimize(visible.data());
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * OBJECT_COUNT));
+    state.counters["visible"] = static_cast<double>(count);
+    setSimdLevel(getSupportedSimdLevel());
+}
+
+// args are the SimdLevel: 0 scalar, 1 SSE, 2 AVX2
+BENCHMARK(BM_Math_MultiplyGlm)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Math_Multiply)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Math_Hierarchy)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Math_BoundsAndCull)->DenseRange(0, 2)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,93 @@
+#include "neuron/bench/bench_context.hpp"
+
+#include <vector>
+
+using namespace neuron::graphics;
+
+namespace {
+    constexpr size_t BATCH = 256;
+
+    vk::MemoryRequirements requirementsFor(vk::DeviceSize size) {
+        auto &gc   = neuron::bench::gc();
+        auto  type = gc->findMemoryType(~0U, vk::MemoryPropertyFlagBits::eDeviceLocal);
+        return {size, 256, 1U << type};
+    }
+} // namespace
+
+// baseline: one vkAllocateMemory per resource
+static void BM_Memory_Direct(benchmark::State &state) {
+    if (!neuron::bench::requireDevice(state))
+        return;
+
+    const vk::Device &device       = neuron::bench::gc()->getDevice();
+    const auto        requirements = requirementsFor(state.range(0));
+    const uint32_t    type         = neuron::bench::gc()->findMemoryType(requirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    std::vector<vk::DeviceMemory> memories(BATCH);
+    for (auto _ : state) {
+        for (auto &memory : memories)
+            memory = device.allocateMemory(vk::MemoryAllocateInfo(requirements.size, type));
+        for (auto &memory : memories)
+            device.free(memory);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * BATCH));
+}
+
+static void BM_Memory_Buddy(benchmark::State &state) {
+    if (!neuron::bench::requireDevice(state))
+        return;
+
+    MemoryAllocator &allocator    = neuron::bench::gc()->getAllocator();
+    const auto       requirements = requirementsFor(state.range(0));
+
+    std::vector<Allocation> allocations(BATCH);
+    for (auto _ : state) {
+        for (auto &allocation : allocations)
+            allocation = allocator.allocate(requirements, vk::MemoryPropertyFlagBits::eDeviceLocal);
+        for (auto &allocation : allocations)
+            allocator.free(allocation);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * BATCH));
+    state.counters["fragmentation"] = allocator.getStats().getFragmentation();
+}
+
+static void BM_Memory_Pool(benchmark::State &state) {
+    if (!neuron::bench::requireDevice(state))
+        return;
+
+    PoolAllocator pool(neuron::bench::gc()->getAllocator(), requirementsFor(state.range(0)), vk::MemoryPropertyFlagBits::eDeviceLocal, {}, ResourceKind::Linear, BATCH);
+
+    std::vector<Allocation> allocations(BATCH);
+    for (auto _ : state) {
+        for (auto &allocation : allocations)
+            allocation = pool.allocate();
+        for (auto &allocation : allocations)
+            pool.free(allocation);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * BATCH));
+}
+
+static void BM_Memory_Linear(benchmark::State &state) {
+    if (!neuron::bench::requireDevice(state))
+        return;
+
+    const auto      requirements = requirementsFor(state.range(0));
+    LinearAllocator linear(neuron::bench::gc()->getAllocator(), requirements.size * BATCH + 256 * BATCH, requirements.memoryTypeBits,
+                           vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < BATCH; i++)
+            benchmark::DoNotOptimize(linear.allocate(requirements.size, requirements.alignment));
+        linear.reset();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * BATCH));
+}
+
+BENCHMARK(BM_Memory_Direct)->Arg(4096)->Arg(256 * 1024);
+BENCHMARK(BM_Memory_Buddy)->Arg(4096)->Arg(256 * 1024);
+BENCHMARK(BM_Memory_Pool)->Arg(4096)->Arg(256 * 1024);
+BENCHMARK(BM_Memory_Linear)->Arg(4096)->Arg(256 * 1024);
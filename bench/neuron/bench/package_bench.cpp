@@ -0,0 +1,142 @@
+#include "neuron/bench/bench_context.hpp"
+
+#include "neuron/assets/package.hpp"
+#include "neuron/graphics/package_loader.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace neuron::assets;
+using namespace neuron::graphics;
+
+namespace {
+    constexpr uint32_t ASSET_COUNT = 2000;
+
+    /**
+     * 2000 assets of 4 to 64 KiB (around 70 MB), written once as loose files and as a package. Both stay in the page cache after the first iteration, so the benchmarks
+     * compare syscalls and copies rather than the disk.
+     */
+    struct AssetSet {
+        std::filesystem::path    directory = std::filesystem::temp_directory_path() / "neuron_bench_assets";
+        std::filesystem::path    package   = directory / "assets.npak";
+        std::vector<std::string> names;
+        size_t                   bytes = 0;
+
+        AssetSet() {
+            std::filesystem::remove_all(directory);
+            std::filesystem::create_directories(directory / "loose");
+
+            std::mt19937  random(42);
+            PackageWriter writer;
+            for (uint32_t i = 0; i < ASSET_COUNT; i++) {
+                std::vector<std::byte> data((4 + random() % 61) * 1024);
+                for (auto &b : data)
+                    b = static_cast<std::byte>(random());
+
+                names.push_back(std::to_string(i) + ".bin");
+                std::ofstream(directory / "loose" / names.back(), std::ios::binary).write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+                writer.add(names.back(), AssetType::Blob, data);
+                bytes += data.size();
+            }
+            writer.write(package);
+        }
+
+        ~AssetSet() { std::filesystem::remove_all(directory); }
+    };
+
+    AssetSet &assets() {
+        static AssetSet set;
+        return set;
+    }
+} // namespace
+
+// reads every loose file into memory and copies it into staging memory, as an engine without packages does
+static void BM_Assets_LooseFiles(benchmark::State &state) {
+    AssetSet              &set = assets();
+    std::vector<std::byte> staging(64 * 1024);
+
+    for (auto _ : state) {
+        for (const auto &name : set.names) {
+            std::ifstream          stream(set.directory / "loose" / name, std::ios::binary | std::ios::ate);
+            std::vector<std::byte> data(static_cast<size_t>(stream.tellg()));
+            stream.seekg(0);
+            stream.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size()));
+            std::memcpy(staging.data(), data.data(), data.size());
+        }
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * set.bytes));
+}
+
+// opens the package and copies every asset from the mapping into staging memory
+static void BM_Assets_Package(benchmark::State &state) {
+    AssetSet              &set = assets();
+    std::vector<std::byte> staging(64 * 1024);
+
+    for (auto _ : state) {
+        Package package(set.package);
+        for (const auto &name : set.names) {
+            const PackageAsset asset = package.get(name);
+            std::memcpy(staging.data(), asset.data.data(), asset.data.size());
+        }
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * set.bytes));
+}
+
+// loads every asset into one device buffer, from loose files (0) or through PackageLoader (1)
+static void BM_Assets_Upload(benchmark::State &state) {
+    if (!neuron::bench::requireDevice(state))
+        return;
+    if (!neuron::bench::gc()->supportsTimelineSemaphores()) {
+        state.SkipWithError("Upload service needs timeline semaphores");
+        return;
+    }
+
+    AssetSet        &set       = assets();
+    UploadService   &uploads   = neuron::bench::gc()->getUploadService();
+    MemoryAllocator &allocator = neuron::bench::gc()->getAllocator();
+    AllocatedBuffer  target    = allocator.createBuffer(vk::BufferCreateInfo({}, set.bytes, vk::BufferUsageFlagBits::eTransferDst, vk::SharingMode::eExclusive),
+                                                        vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    const bool packaged = state.range(0) != 0;
+    bool       imported = false;
+
+    for (auto _ : state) {
+        vk::DeviceSize offset = 0;
+        if (packaged) {
+            Package       package(set.package);
+            PackageLoader loader(*neuron::bench::gc(), package);
+            for (const auto &name : set.names) {
+                (void)loader.uploadBuffer(name, target.buffer, offset);
+                offset += package.get(name).data.size();
+            }
+            uploads.wait(uploads.flush());
+            imported = loader.isImported();
+        } else {
+            for (const auto &name : set.names) {
+                std::ifstream          stream(set.directory / "loose" / name, std::ios::binary | std::ios::ate);
+                std::vector<std::byte> data(static_cast<size_t>(stream.tellg()));
+                stream.seekg(0);
+                stream.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size()));
+                (void)uploads.uploadBuffer(target.buffer, offset, data);
+                offset += data.size();
+            }
+            uploads.wait(uploads.flush());
+        }
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * set.bytes));
+    state.counters["host_import"] = imported ? 1 : 0;
+
+    allocator.destroy(target);
+}
+
+BENCHMARK(BM_Assets_LooseFiles)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_Assets_Package)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_Assets_Upload)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
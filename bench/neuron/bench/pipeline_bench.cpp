@@ -0,0 +1,107 @@
+#include "neuron/bench/bench_context.hpp"
+
+#include "neuron/graphics/pipelines.hpp"
+
+#include <filesystem>
+
+using namespace neuron::graphics;
+
+namespace {
+    constexpr int PIPELINE_VARIANTS = 32;
+
+    const ShaderSource VERTEX_SHADER = {.name  = "bench.vert",
+                                        .code  = "#version 450\n"
+                                                 "layout(location = 0) in vec3 position;\n"
+                                                 "layout(location = 1) in vec2 uv;\n"
+                                                 "layout(location = 0) out vec2 outUv;\n"
+                                                 "void main() { outUv = uv; gl_Position = vec4(position, 1.0); }\n",
+                                        .stage = ShaderStage::Vertex};
+
+    const ShaderSource FRAGMENT_SHADER = {.name  = "bench.frag",
+                                          .code  = "#version 450\n"
+                                                   "layout(location = 0) in vec2 uv;\n"
+                                                   "layout(location = 0) out vec4 color;\n"
+                                                   "void main() { color = vec4(sin(uv.x * 40.0), cos(uv.y * 40.0), VARIANT / 32.0, 1.0); }\n",
+                                          .stage = ShaderStage::Fragment};
+
+    /**
+     * Pipelines differing in fragment shader and fixed function state, like the material permutations of a real scene.
+     */
+    std::vector<GraphicsPipelineDesc> makeDescs(vk::PipelineLayout layout) {
+        std::vector<GraphicsPipelineDesc> descs;
+        for (int i = 0; i < PIPELINE_VARIANTS; i++) {
+            ShaderSource fragment = FRAGMENT_SHADER;
+            fragment.defines.emplace_back("VARIANT", std::to_string(i));
+
+            GraphicsPipelineDesc desc;
+            desc.shaders          = {VERTEX_SHADER, fragment};
+            desc.layout           = layout;
+            desc.vertexBindings   = {vk::VertexInputBindingDescription(0, sizeof(float) * 5, vk::VertexInputRate::eVertex)};
+            desc.vertexAttributes = {vk::VertexInputAttributeDescription(0, 0, vk::Format::eR32G32B32Sfloat, 0),
+                                     vk::VertexInputAttributeDescription(1, 0, vk::Format::eR32G32Sfloat, sizeof(float) * 3)};
+            desc.cullMode         = i % 2 == 0 ? vk::CullModeFlagBits::eBack : vk::CullModeFlagBits::eNone;
+            desc.depthWrite       = i % 4 < 2;
+            desc.colorFormats     = {vk::Format::eR8G8B8A8Unorm};
+            desc.depthFormat      = vk::Format::eD32Sfloat;
+            descs.push_back(std::move(desc));
+        }
+        return descs;
+    }
+
+    void runPipelineBench(benchmark::State &state, bool warm) {
+        if (!neuron::bench::requireDevice(state))
+            return;
+        if (!neuron::bench::gc()->supportsDynamicRendering()) {
+            state.SkipWithError("Needs dynamic rendering");
+            return;
+        }
+
+        const std::shared_ptr<GContext> &gc        = neuron::bench::gc();
+        const std::filesystem::path      cachePath = std::filesystem::temp_directory_path() / "neuron_bench_pipelines.bin";
+        const vk::PipelineLayout         layout    = gc->getDevice().createPipelineLayout(vk::PipelineLayoutCreateInfo());
+
+        // shaders are compiled once up front, so only pipeline creation is measured
+        ShaderCompiler shaders;
+        const auto     descs = makeDescs(layout);
+        for (const auto &desc : descs)
+            (void)shaders.compileAll(desc.shaders);
+
+        std::filesystem::remove(cachePath);
+        if (warm) {
+            PipelineManager seed(gc, shaders, {.cachePath = cachePath});
+            for (const auto &desc : descs)
+                (void)seed.get(desc);
+        }
+
+        bool cacheLoaded = false;
+        for (auto _ : state) {
+            if (!warm) {
+                std::filesystem::remove(cachePath);
+            }
+
+            auto pipelines = std::make_unique<PipelineManager>(gc, shaders, PipelineManagerSettings{.cachePath = cachePath});
+            for (const auto &desc : descs)
+                benchmark::DoNotOptimize(pipelines->get(desc));
+
+            state.PauseTiming();
+            cacheLoaded = pipelines->getStats().cacheLoaded;
+            pipelines.reset();
+            state.ResumeTiming();
+        }
+
+        state.SetItemsProcessed(state.iterations() * PIPELINE_VARIANTS);
+        state.counters["cache_loaded"] = cacheLoaded ? 1 : 0;
+
+        gc->getDevice().destroy(layout);
+        std::filesystem::remove(cachePath);
+    }
+} // namespace
+
+// creating a scene's worth of pipelines without a pipeline cache, as on first launch
+static void BM_Pipeline_Cold(benchmark::State &state) { runPipelineBench(state, false); }
+
+// the same pipelines with the cache saved by a previous run
+static void BM_Pipeline_Warm(benchmark::State &state) { runPipelineBench(state, true); }
+
+BENCHMARK(BM_Pipeline_Cold)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_Pipeline_Warm)->Unit(benchmark::kMillisecond)->UseRealTime();
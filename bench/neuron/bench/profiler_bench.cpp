@@ -0,0 +1,55 @@
+#include "neuron/bench/bench_context.hpp"
+
+#include "neuron/utils/profiler.hpp"
+
+using namespace neuron::utils;
+
+namespace {
+    // what a marked up frame does between two collect() calls
+    constexpr uint32_t SCOPES_PER_FRAME = 1024;
+
+    void BM_Profiler_Scope(benchmark::State &state) {
+        auto &profiler = Profiler::get();
+        profiler.setEnabled(state.range(0) != 0);
+        profiler.clear();
+
+        for (auto _ : state) {
+            for (uint32_t i = 0; i < SCOPES_PER_FRAME; i++) {
+                const ProfileScope scope("scope");
+                benchmark::ClobberMemory();
+            }
+
+            state.PauseTiming();
+            profiler.clear();
+            state.ResumeTiming();
+        }
+
+        profiler.setEnabled(true);
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * SCOPES_PER_FRAME);
+        state.counters["ns/scope"] = benchmark::Counter(static_cast<double>(state.iterations()) * SCOPES_PER_FRAME,
+                                                        benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    }
+
+    // moving a frame's worth of events out of the thread buffers, which the main loop pays once a frame
+    void BM_Profiler_Collect(benchmark::State &state) {
+        auto &profiler = Profiler::get();
+        profiler.clear();
+
+        for (auto _ : state) {
+            state.PauseTiming();
+            for (uint32_t i = 0; i < SCOPES_PER_FRAME; i++)
+                profiler.record("scope", i, i + 1);
+            state.ResumeTiming();
+
+            profiler.collect();
+
+            state.PauseTiming();
+            profiler.clear();
+            state.ResumeTiming();
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * SCOPES_PER_FRAME);
+    }
+} // namespace
+
+BENCHMARK(BM_Profiler_Scope)->ArgName("enabled")->Arg(0)->Arg(1);
+BENCHMARK(BM_Profiler_Collect);
@@ -0,0 +1,39 @@
+#include "neuron/bench/bench_context.hpp"
+
+#include <vector>
+
+using namespace neuron::graphics;
+
+// streaming throughput in MB/s for a given upload size, through the staging ring and transfer queue
+static void BM_Upload_Stream(benchmark::State &state) {
+    if (!neuron::bench::requireDevice(state))
+        return;
+    if (!neuron::bench::gc()->supportsTimelineSemaphores()) {
+        state.SkipWithError("Upload service needs timeline semaphores");
+        return;
+    }
+
+    constexpr vk::DeviceSize TOTAL = 64ULL * 1024 * 1024;
+
+    UploadService   &uploads   = neuron::bench::gc()->getUploadService();
+    MemoryAllocator &allocator = neuron::bench::gc()->getAllocator();
+    AllocatedBuffer target =
+        allocator.createBuffer(vk::BufferCreateInfo({}, TOTAL, vk::BufferUsageFlagBits::eTransferDst, vk::SharingMode::eExclusive), vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    const auto             chunk = static_cast<size_t>(state.range(0));
+    std::vector<std::byte> data(chunk, std::byte{0x5a});
+
+    for (auto _ : state) {
+        for (vk::DeviceSize offset = 0; offset + chunk <= TOTAL; offset += chunk) {
+            (void)uploads.uploadBuffer(target.buffer, offset, data);
+        }
+        uploads.wait(uploads.flush());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * (TOTAL / chunk) * chunk));
+    state.counters["dedicated_queue"] = uploads.usesDedicatedQueue() ? 1 : 0;
+
+    allocator.destroy(target);
+}
+
+BENCHMARK(BM_Upload_Stream)->Arg(4 * 1024)->Arg(64 * 1024)->Arg(1024 * 1024)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -20,6 +20,22 @@ int main() {
 
         while (!window->shouldClose()) {
             neuron::os::pollEvents();
+
+            auto frame = surfaceTarget->beginFrame();
+            auto image = surfaceTarget->getImageTarget(frame.imageIndex);
+
+            frame.commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::PipelineStageFlagBits::eTransfer, {}, {}, {},
+                                                vk::ImageMemoryBarrier(vk::AccessFlagBits::eColorAttachmentWrite, vk::AccessFlagBits::eTransferWrite,
+                                                                       vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::eTransferDstOptimal, VK_QUEUE_FAMILY_IGNORED,
+                                                                       VK_QUEUE_FAMILY_IGNORED, image, neuron::graphics::BASIC_ISR));
+            frame.commandBuffer.clearColorImage(image, vk::ImageLayout::eTransferDstOptimal, vk::ClearColorValue(std::array<float, 4>{0.1f, 0.1f, 0.2f, 1.0f}),
+                                                neuron::graphics::BASIC_ISR);
+            frame.commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eColorAttachmentOutput, {}, {}, {},
+                                                vk::ImageMemoryBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eColorAttachmentWrite,
+                                                                       vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eColorAttachmentOptimal, VK_QUEUE_FAMILY_IGNORED,
+                                                                       VK_QUEUE_FAMILY_IGNORED, image, neuron::graphics::BASIC_ISR));
+
+            surfaceTarget->endFrame();
         }
     }
 
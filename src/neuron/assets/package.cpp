@@ -0,0 +1,282 @@
+#include "package.hpp"
+
+#include "neuron/utils/utils.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace neuron::assets {
+
+    static uint64_t alignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    static bool entryLess(const PackageEntry &a, std::string_view aName, const PackageEntry &b, std::string_view bName) {
+        return a.hash != b.hash ? a.hash < b.hash : aName < bName;
+    }
+
+    uint64_t hashAssetName(std::string_view name) noexcept {
+        return utils::Hasher().update(name).finish().low;
+    }
+
+    AssetType assetTypeFromPath(const std::filesystem::path &path) {
+        std::string extension = path.extension().string();
+        std::ranges::transform(extension, extension.begin(), [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+
+        if (extension == ".spv")
+            return AssetType::Shader;
+        if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" || extension == ".bmp" || extension == ".hdr" ||
+            extension == ".qoi" || extension == ".ktx" || extension == ".ktx2" || extension == ".dds")
+            return AssetType::Texture;
+        if (extension == ".mesh" || extension == ".obj" || extension == ".gltf" || extension == ".glb")
+            return AssetType::Mesh;
+        return AssetType::Blob;
+    }
+
+    Package::Package(const std::filesystem::path &path) : m_Path(path) {
+        map();
+
+        try {
+            validate();
+        } catch (...) {
+            unmap();
+            throw;
+        }
+    }
+
+    Package::~Package() {
+        unmap();
+    }
+
+    void Package::map() {
+#if defined(_WIN32)
+        HANDLE file = CreateFileW(m_Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw std::runtime_error(std::format("Failed to open package {}", m_Path.string()));
+
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(file, &size) || static_cast<uint64_t>(size.QuadPart) < sizeof(PackageHeader)) {
+            CloseHandle(file);
+            throw std::runtime_error(std::format("{} is not a package", m_Path.string()));
+        }
+        m_Size = static_cast<size_t>(size.QuadPart);
+
+        // the view keeps the mapping and the file open
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping)
+            throw std::runtime_error(std::format("Failed to map package {}", m_Path.string()));
+
+        m_Mapping = static_cast<const std::byte *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        CloseHandle(mapping);
+        if (!m_Mapping)
+            throw std::runtime_error(std::format("Failed to map package {}", m_Path.string()));
+#else
+        const int file = ::open(m_Path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file < 0)
+            throw std::runtime_error(std::format("Failed to open package {}", m_Path.string()));
+
+        struct stat info {};
+        if (fstat(file, &info) != 0 || static_cast<uint64_t>(info.st_size) < sizeof(PackageHeader)) {
+            ::close(file);
+            throw std::runtime_error(std::format("{} is not a package", m_Path.string()));
+        }
+        m_Size = static_cast<size_t>(info.st_size);
+
+        void *mapping = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, file, 0);
+        ::close(file);
+        if (mapping == MAP_FAILED)
+            throw std::runtime_error(std::format("Failed to map package {}", m_Path.string()));
+
+        m_Mapping = static_cast<const std::byte *>(mapping);
+#endif
+    }
+
+    void Package::unmap() noexcept {
+        if (!m_Mapping)
+            return;
+
+#if defined(_WIN32)
+        UnmapViewOfFile(m_Mapping);
+#else
+        munmap(const_cast<std::byte *>(m_Mapping), m_Size);
+#endif
+        m_Mapping = nullptr;
+    }
+
+    void Package::validate() {
+        PackageHeader header;
+        std::memcpy(&header, m_Mapping, sizeof(header));
+
+        const auto fail = [&](std::string_view reason) { return std::runtime_error(std::format("Invalid package {}: {}", m_Path.string(), reason)); };
+
+        if (header.magic != PACKAGE_MAGIC)
+            throw fail("bad magic");
+        if (header.version != PACKAGE_VERSION)
+            throw fail(std::format("version {}, expected {}", header.version, PACKAGE_VERSION));
+        if (header.fileSize > m_Size)
+            throw fail("truncated");
+        if (header.alignment < 16 || (header.alignment & (header.alignment - 1)) != 0)
+            throw fail("bad alignment");
+
+        const uint64_t tableSize = static_cast<uint64_t>(header.entryCount) * sizeof(PackageEntry);
+        if (header.entriesOffset % alignof(PackageEntry) != 0 || header.entriesOffset > m_Size || tableSize > m_Size - header.entriesOffset)
+            throw fail("entry table out of bounds");
+        if (header.namesOffset > m_Size || header.namesSize > m_Size - header.namesOffset)
+            throw fail("names out of bounds");
+
+        m_Alignment = header.alignment;
+        m_Entries   = {reinterpret_cast<const PackageEntry *>(m_Mapping + header.entriesOffset), header.entryCount};
+        m_Names     = {reinterpret_cast<const char *>(m_Mapping + header.namesOffset), static_cast<size_t>(header.namesSize)};
+
+        for (size_t i = 0; i < m_Entries.size(); i++) {
+            const PackageEntry &entry = m_Entries[i];
+            if (entry.offset > m_Size || entry.size > m_Size - entry.offset)
+                throw fail("asset out of bounds");
+            if (static_cast<uint64_t>(entry.nameOffset) + entry.nameSize > m_Names.size())
+                throw fail("asset name out of bounds");
+
+            // lookups are binary searches
+            if (i > 0 && !entryLess(m_Entries[i - 1], get(m_Entries[i - 1]).name, entry, get(entry).name))
+                throw fail("entries not sorted");
+        }
+    }
+
+    PackageAsset Package::get(const PackageEntry &entry) const {
+        return {
+            .name   = m_Names.substr(entry.nameOffset, entry.nameSize),
+            .type   = entry.type,
+            .offset = entry.offset,
+            .data   = {m_Mapping + entry.offset, static_cast<size_t>(entry.size)},
+        };
+    }
+
+    std::optional<PackageAsset> Package::find(std::string_view name) const {
+        const uint64_t hash = hashAssetName(name);
+
+        auto it = std::ranges::lower_bound(m_Entries, hash, {}, &PackageEntry::hash);
+        for (; it != m_Entries.end() && it->hash == hash; ++it) {
+            PackageAsset asset = get(*it);
+            if (asset.name == name)
+                return asset;
+        }
+        return std::nullopt;
+    }
+
+    PackageAsset Package::get(std::string_view name) const {
+        if (auto asset = find(name))
+            return *asset;
+        throw std::runtime_error(std::format("No asset {} in package {}", name, m_Path.string()));
+    }
+
+    PackageWriter::PackageWriter(uint32_t alignment) : m_Alignment(alignment) {
+        if (alignment < 16 || (alignment & (alignment - 1)) != 0)
+            throw std::runtime_error("Package alignment must be a power of two of at least 16");
+    }
+
+    void PackageWriter::add(std::string name, AssetType type, std::span<const std::byte> data) {
+        if (!m_Names.insert(name).second)
+            throw std::runtime_error(std::format("Asset {} was added twice", name));
+
+        m_Assets.push_back({std::move(name), type, {data.begin(), data.end()}});
+    }
+
+    void PackageWriter::addFile(std::string name, AssetType type, const std::filesystem::path &path) {
+        std::ifstream stream(path, std::ios::binary | std::ios::ate);
+        if (!stream)
+            throw std::runtime_error(std::format("Failed to read {}", path.string()));
+
+        std::vector<std::byte> data(static_cast<size_t>(stream.tellg()));
+        stream.seekg(0);
+        stream.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!stream)
+            throw std::runtime_error(std::format("Failed to read {}", path.string()));
+
+        add(std::move(name), type, data);
+    }
+
+    void PackageWriter::write(const std::filesystem::path &path) const {
+        PackageHeader header{.entryCount = static_cast<uint32_t>(m_Assets.size()), .alignment = m_Alignment, .entriesOffset = sizeof(PackageHeader)};
+
+        std::vector<PackageEntry> entries(m_Assets.size());
+        std::string               names;
+        for (size_t i = 0; i < m_Assets.size(); i++) {
+            const Asset &asset = m_Assets[i];
+            entries[i]         = {.hash       = hashAssetName(asset.name),
+                                  .size       = asset.data.size(),
+                                  .nameOffset = static_cast<uint32_t>(names.size()),
+                                  .nameSize   = static_cast<uint32_t>(asset.name.size()),
+                                  .type       = asset.type};
+            names += asset.name;
+        }
+
+        header.namesOffset = header.entriesOffset + entries.size() * sizeof(PackageEntry);
+        header.namesSize   = names.size();
+
+        // the data stays in the order it was added, so assets added together are read together
+        uint64_t offset = alignUp(header.namesOffset + header.namesSize, m_Alignment);
+        for (PackageEntry &entry : entries) {
+            entry.offset = offset;
+            offset       = alignUp(offset + entry.size, m_Alignment);
+        }
+        header.fileSize = offset;
+
+        std::vector<uint32_t> order(entries.size());
+        for (uint32_t i = 0; i < order.size(); i++)
+            order[i] = i;
+        std::ranges::sort(order, [&](uint32_t a, uint32_t b) { return entryLess(entries[a], m_Assets[a].name, entries[b], m_Assets[b].name); });
+
+        std::vector<PackageEntry> table;
+        table.reserve(entries.size());
+        for (const uint32_t index : order)
+            table.push_back(entries[index]);
+
+        // written next to the package and renamed over it, so readers never map half a file
+        std::filesystem::path temp = path;
+        temp += ".tmp";
+
+        {
+            std::ofstream stream(temp, std::ios::binary | std::ios::trunc);
+            if (!stream)
+                throw std::runtime_error(std::format("Failed to write package {}", path.string()));
+
+            const auto pad = [&](uint64_t to) {
+                static constexpr char zeros[4096]{};
+                for (auto at = static_cast<uint64_t>(stream.tellp()); at < to;) {
+                    const uint64_t count = std::min<uint64_t>(to - at, sizeof(zeros));
+                    stream.write(zeros, static_cast<std::streamsize>(count));
+                    at += count;
+                }
+            };
+
+            stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            stream.write(reinterpret_cast<const char *>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(PackageEntry)));
+            stream.write(names.data(), static_cast<std::streamsize>(names.size()));
+            for (size_t i = 0; i < m_Assets.size(); i++) {
+                pad(entries[i].offset);
+                stream.write(reinterpret_cast<const char *>(m_Assets[i].data.data()), static_cast<std::streamsize>(m_Assets[i].data.size()));
+            }
+            pad(header.fileSize);
+
+            if (!stream)
+                throw std::runtime_error(std::format("Failed to write package {}", path.string()));
+        }
+
+        std::filesystem::rename(temp, path);
+    }
+
+} // namespace neuron::assets
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace neuron::assets {
+
+    constexpr uint32_t PACKAGE_MAGIC   = 0x4b41504e; // "NPAK"
+    constexpr uint32_t PACKAGE_VERSION = 1;
+
+    /**
+     * Blobs start on page boundaries by default, which is what importing host memory into Vulkan usually needs.
+     */
+    constexpr uint32_t PACKAGE_DEFAULT_ALIGNMENT = 4096;
+
+    enum class AssetType : uint32_t {
+        Blob,
+        Texture,
+        Shader,
+        Mesh,
+    };
+
+    /**
+     * At the start of the file. Everything is little endian; offsets are from the start of the file.
+     */
+    struct PackageHeader {
+        uint32_t magic         = PACKAGE_MAGIC;
+        uint32_t version       = PACKAGE_VERSION;
+        uint32_t entryCount    = 0;
+        uint32_t alignment     = PACKAGE_DEFAULT_ALIGNMENT;
+        uint64_t entriesOffset = 0;
+        uint64_t namesOffset   = 0;
+        uint64_t namesSize     = 0;
+        uint64_t fileSize      = 0;
+    };
+
+    /**
+     * The entry table is sorted by hash, then name, so lookups are a binary search. The names are stored back to back, without terminators.
+     */
+    struct PackageEntry {
+        uint64_t  hash       = 0;
+        uint64_t  offset     = 0;
+        uint64_t  size       = 0;
+        uint32_t  nameOffset = 0;
+        uint32_t  nameSize   = 0;
+        AssetType type       = AssetType::Blob;
+        uint32_t  reserved   = 0;
+    };
+
+    static_assert(sizeof(PackageHeader) == 48 && sizeof(PackageEntry) == 40);
+
+    [[nodiscard]] uint64_t hashAssetName(std::string_view name) noexcept;
+
+    /**
+     * Guesses the type from the extension, as the packer does: .spv is a shader, common image and texture container formats are textures, mesh formats are meshes.
+     */
+    [[nodiscard]] AssetType assetTypeFromPath(const std::filesystem::path &path);
+
+    struct PackageAsset {
+        std::string_view           name;
+        AssetType                  type   = AssetType::Blob;
+        uint64_t                   offset = 0;
+        std::span<const std::byte> data;
+    };
+
+    /**
+     *
+     * A package opened with mmap (MapViewOfFile on Windows). Nothing is read up front apart from the header and the entry table; asset data is paged in by the OS as it is
+     * touched, so uploads copy straight from the mapping into staging memory without an intermediate read buffer. Lookups are thread safe.
+     *
+     */
+    class Package final {
+      public:
+        /**
+         * @throws std::runtime_error if the file can't be mapped or isn't a valid package.
+         */
+        explicit Package(const std::filesystem::path &path);
+        ~Package();
+
+        Package(const Package &)            = delete;
+        Package &operator=(const Package &) = delete;
+
+        [[nodiscard]] std::optional<PackageAsset> find(std::string_view name) const;
+
+        /**
+         * @throws std::runtime_error if there is no asset of that name.
+         */
+        [[nodiscard]] PackageAsset get(std::string_view name) const;
+
+        [[nodiscard]] PackageAsset get(const PackageEntry &entry) const;
+
+        [[nodiscard]] inline std::span<const PackageEntry> getEntries() const noexcept { return m_Entries; }
+
+        /**
+         * The whole file, page aligned.
+         */
+        [[nodiscard]] inline std::span<const std::byte> getMapping() const noexcept { return {m_Mapping, m_Size}; }
+
+        [[nodiscard]] inline uint32_t getAlignment() const noexcept { return m_Alignment; }
+
+        [[nodiscard]] inline const std::filesystem::path &getPath() const noexcept { return m_Path; }
+
+      private:
+        std::filesystem::path         m_Path;
+        const std::byte              *m_Mapping = nullptr;
+        size_t                        m_Size    = 0;
+        std::span<const PackageEntry> m_Entries;
+        std::string_view              m_Names;
+        uint32_t                      m_Alignment = 0;
+
+        void map();
+        void unmap() noexcept;
+        void validate();
+    };
+
+    /**
+     *
+     * Builds a package in memory and writes it out. Used by the packer tool and tests.
+     *
+     */
+    class PackageWriter final {
+      public:
+        /**
+         * @throws std::runtime_error if alignment isn't a power of two of at least 16.
+         */
+        explicit PackageWriter(uint32_t alignment = PACKAGE_DEFAULT_ALIGNMENT);
+
+        /**
+         * @throws std::runtime_error if the name is taken.
+         */
+        void add(std::string name, AssetType type, std::span<const std::byte> data);
+
+        /**
+         * @throws std::runtime_error if the name is taken or the file can't be read.
+         */
+        void addFile(std::string name, AssetType type, const std::filesystem::path &path);
+
+        /**
+         * @throws std::runtime_error if the file can't be written.
+         */
+        void write(const std::filesystem::path &path) const;
+
+        [[nodiscard]] inline size_t getAssetCount() const noexcept { return m_Assets.size(); }
+
+      private:
+        struct Asset {
+            std::string            name;
+            AssetType              type;
+            std::vector<std::byte> data;
+        };
+
+        uint32_t                        m_Alignment;
+        std::vector<Asset>              m_Assets;
+        std::unordered_set<std::string> m_Names;
+    };
+
+} // namespace neuron::assets
@@ -0,0 +1,145 @@
+#include "commands.hpp"
+
+#include "neuron/utils/profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+
+namespace neuron::graphics {
+
+    static std::atomic<uint64_t> g_NextRecorderId = 1;
+
+    CommandRecorder::CommandRecorder(const std::shared_ptr<GContext> &gc, uint32_t framesInFlight, std::optional<uint32_t> queueFamily)
+        : m_GC(gc), m_FramesInFlight(std::max(framesInFlight, 1u)), m_QueueFamily(queueFamily.value_or(gc->getQueueFamily(QueueType::Primary).value())),
+          m_Id(g_NextRecorderId.fetch_add(1, std::memory_order_relaxed)) {}
+
+    CommandRecorder::~CommandRecorder() {
+        const auto &device = m_GC->getDevice();
+        for (const auto &thread : m_Threads) {
+            for (const auto &frame : thread->frames) {
+                device.destroyCommandPool(frame.commandPool);
+            }
+        }
+    }
+
+    void CommandRecorder::beginFrame(uint32_t frameIndex) {
+        if (frameIndex >= m_FramesInFlight) {
+            throw std::runtime_error("Frame index out of range for this command recorder");
+        }
+
+        const auto &device = m_GC->getDevice();
+
+        std::lock_guard lock(m_Mutex);
+        m_CurrentFrame = frameIndex;
+        for (const auto &thread : m_Threads) {
+            auto &frame = thread->frames[frameIndex];
+            if (frame.used == 0) {
+                continue;
+            }
+
+            // keeps the buffers and their memory, they are recorded again from scratch
+            device.resetCommandPool(frame.commandPool);
+            frame.used = 0;
+            frame.recorded.clear();
+        }
+    }
+
+    void CommandRecorder::record(uint64_t order, const vk::CommandBufferInheritanceInfo &inheritance, const std::function<void(vk::CommandBuffer)> &fn,
+                                 vk::CommandBufferUsageFlags usage) {
+        auto &thread = getThreadState();
+        auto &frame  = thread.frames[m_CurrentFrame];
+
+        if (frame.used == frame.commandBuffers.size()) {
+            // grow geometrically so a thread's pool settles after a few frames
+            const auto count = std::max<uint32_t>(static_cast<uint32_t>(frame.commandBuffers.size()), 4);
+            auto       more  = m_GC->getDevice().allocateCommandBuffers(vk::CommandBufferAllocateInfo(frame.commandPool, vk::CommandBufferLevel::eSecondary, count));
+            frame.commandBuffers.insert(frame.commandBuffers.end(), more.begin(), more.end());
+        }
+
+        const auto commandBuffer = frame.commandBuffers[frame.used++];
+        commandBuffer.begin(vk::CommandBufferBeginInfo(usage, &inheritance));
+        fn(commandBuffer);
+        commandBuffer.end();
+
+        frame.recorded.push_back({order, thread.index, static_cast<uint32_t>(frame.recorded.size()), commandBuffer});
+    }
+
+    void CommandRecorder::execute(vk::CommandBuffer primary) {
+        NEURON_PROFILE_SCOPE("CommandRecorder::execute");
+        std::vector<Recorded> recorded;
+        {
+            std::lock_guard lock(m_Mutex);
+            for (const auto &thread : m_Threads) {
+                const auto &frame = thread->frames[m_CurrentFrame];
+                recorded.insert(recorded.end(), frame.recorded.begin(), frame.recorded.end());
+            }
+        }
+
+        if (recorded.empty()) {
+            return;
+        }
+
+        std::ranges::sort(recorded, [](const Recorded &a, const Recorded &b) {
+            if (a.order != b.order) {
+                return a.order < b.order;
+            }
+            if (a.thread != b.thread) {
+                return a.thread < b.thread;
+            }
+            return a.sequence < b.sequence;
+        });
+
+        std::vector<vk::CommandBuffer> commandBuffers;
+        commandBuffers.reserve(recorded.size());
+        for (const auto &entry : recorded) {
+            commandBuffers.push_back(entry.commandBuffer);
+        }
+        primary.executeCommands(commandBuffers);
+    }
+
+    uint32_t CommandRecorder::getThreadCount() const {
+        std::lock_guard lock(m_Mutex);
+        return static_cast<uint32_t>(m_Threads.size());
+    }
+
+    uint32_t CommandRecorder::getRecordedCount() const {
+        std::lock_guard lock(m_Mutex);
+        uint32_t        count = 0;
+        for (const auto &thread : m_Threads) {
+            count += static_cast<uint32_t>(thread->frames[m_CurrentFrame].recorded.size());
+        }
+        return count;
+    }
+
+    CommandRecorder::ThreadState &CommandRecorder::getThreadState() {
+        struct CachedState {
+            uint64_t                  id;
+            std::weak_ptr<const bool> alive;
+            ThreadState              *state;
+        };
+
+        // recorder ids are never reused, so entries of destroyed recorders never match again, and are dropped the next time this thread meets a new recorder
+        thread_local std::vector<CachedState> t_States;
+        for (const auto &cached : t_States) {
+            if (cached.id == m_Id) {
+                return *cached.state;
+            }
+        }
+        std::erase_if(t_States, [](const CachedState &cached) { return cached.alive.expired(); });
+
+        auto state = std::make_unique<ThreadState>();
+        state->frames.resize(m_FramesInFlight);
+        for (auto &frame : state->frames) {
+            frame.commandPool = m_GC->getDevice().createCommandPool(vk::CommandPoolCreateInfo(vk::CommandPoolCreateFlagBits::eTransient, m_QueueFamily));
+        }
+
+        std::lock_guard lock(m_Mutex);
+        state->index = static_cast<uint32_t>(m_Threads.size());
+        auto &result = *m_Threads.emplace_back(std::move(state));
+        t_States.push_back({m_Id, m_Alive, &result});
+        return result;
+    }
+
+} // namespace neuron::graphics
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "neuron/graphics/gcontext.hpp"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace neuron::graphics {
+
+    /**
+     *
+     * Records secondary command buffers on many threads and assembles them into a primary one.
+     *
+     * Every thread that records gets its own command pool per frame in flight, so recording never takes a lock. Pools are reset as a whole in beginFrame() and their command
+     * buffers are reused, nothing is freed one by one. execute() inserts the secondaries in the order of their keys, independent of which thread finished first.
+     *
+     * record() is thread safe. beginFrame() and execute() must not overlap with recording.
+     *
+     */
+    class CommandRecorder final {
+      public:
+        /**
+         * @param queueFamily family the primary buffers are submitted to, the primary queue's by default.
+         */
+        explicit CommandRecorder(const std::shared_ptr<GContext> &gc, uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT, std::optional<uint32_t> queueFamily = {});
+        ~CommandRecorder();
+
+        CommandRecorder(const CommandRecorder &)            = delete;
+        CommandRecorder &operator=(const CommandRecorder &) = delete;
+
+        /**
+         * Resets every thread's pool of this frame slot. The GPU must be done with the buffers recorded into it framesInFlight frames ago, which it is once the frame's fence
+         * or timeline value (as waited on by SurfaceRenderTarget::beginFrame()) has signaled.
+         */
+        void beginFrame(uint32_t frameIndex);
+
+        /**
+         * Records a secondary command buffer on the calling thread. The buffer is begun with inheritance and usage, handed to fn, and ended afterwards.
+         *
+         * @param order where execute() puts this buffer. Buffers with equal keys keep the order one thread recorded them in, but are unordered across threads.
+         */
+        void record(uint64_t order, const vk::CommandBufferInheritanceInfo &inheritance, const std::function<void(vk::CommandBuffer)> &fn,
+                    vk::CommandBufferUsageFlags usage = vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+
+        /**
+         * Executes everything recorded since beginFrame() in primary, sorted by order.
+         */
+        void execute(vk::CommandBuffer primary);
+
+        [[nodiscard]] inline uint32_t getFramesInFlight() const noexcept { return m_FramesInFlight; }
+
+        /**
+         * Threads which recorded with this recorder so far, each owning framesInFlight pools.
+         */
+        [[nodiscard]] uint32_t getThreadCount() const;
+
+        /**
+         * Secondary buffers recorded since the last beginFrame().
+         */
+        [[nodiscard]] uint32_t getRecordedCount() const;
+
+      private:
+        struct Recorded {
+            uint64_t          order;
+            uint32_t          thread;
+            uint32_t          sequence;
+            vk::CommandBuffer commandBuffer;
+        };
+
+        struct ThreadFrame {
+            vk::CommandPool                commandPool;
+            std::vector<vk::CommandBuffer> commandBuffers;
+            uint32_t                       used = 0;
+            std::vector<Recorded>          recorded;
+        };
+
+        struct ThreadState {
+            uint32_t                 index;
+            std::vector<ThreadFrame> frames;
+        };
+
+        std::shared_ptr<GContext> m_GC;
+        uint32_t                  m_FramesInFlight;
+        uint32_t                  m_QueueFamily;
+        uint64_t                  m_Id;
+        uint32_t                  m_CurrentFrame = 0;
+
+        // expires with the recorder, so threads can drop the state they cached for it
+        std::shared_ptr<const bool> m_Alive = std::make_shared<const bool>(true);
+
+        mutable std::mutex                        m_Mutex;
+        std::vector<std::unique_ptr<ThreadState>> m_Threads;
+
+        [[nodiscard]] ThreadState &getThreadState();
+    };
+
+} // namespace neuron::graphics
@@ -0,0 +1,900 @@
+#include "compute.hpp"
+
+#include "neuron/graphics/gcontext.hpp"
+#include "neuron/utils/profiler.hpp"
+
+#include <array>
+#include <cstring>
+#include <limits>
+
+namespace neuron::graphics {
+
+    // ComputeBuffer
+
+    ComputeBuffer::ComputeBuffer(const GContext &gc, vk::DeviceSize size, ComputeMemory memory) : m_GC(&gc), m_Size(size), m_Memory(memory) {
+        using Usage = vk::BufferUsageFlagBits;
+
+        const uint32_t                primary = gc.getQueueFamily(QueueType::Primary).value();
+        const std::optional<uint32_t> compute = gc.getQueueFamily(QueueType::Compute);
+        const std::array              families = {primary, compute.value_or(primary)};
+
+        vk::BufferCreateInfo createInfo({}, size, Usage::eStorageBuffer | Usage::eTransferSrc | Usage::eTransferDst, vk::SharingMode::eExclusive);
+        if (families[1] != primary) {
+            createInfo.setSharingMode(vk::SharingMode::eConcurrent).setQueueFamilyIndices(families);
+        }
+
+        if (memory == ComputeMemory::Host) {
+            m_Buffer = gc.getAllocator().createBuffer(createInfo, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+                                                      vk::MemoryPropertyFlagBits::eHostCached);
+        } else {
+            m_Buffer = gc.getAllocator().createBuffer(createInfo, vk::MemoryPropertyFlagBits::eDeviceLocal);
+        }
+    }
+
+    ComputeBuffer::~ComputeBuffer() {
+        release();
+    }
+
+    ComputeBuffer::ComputeBuffer(ComputeBuffer &&other) noexcept {
+        *this = std::move(other);
+    }
+
+    ComputeBuffer &ComputeBuffer::operator=(ComputeBuffer &&other) noexcept {
+        if (this != &other) {
+            release();
+            m_GC     = std::exchange(other.m_GC, nullptr);
+            m_Buffer = std::exchange(other.m_Buffer, {});
+            m_Size   = std::exchange(other.m_Size, 0);
+            m_Memory = other.m_Memory;
+        }
+        return *this;
+    }
+
+    void ComputeBuffer::release() noexcept {
+        if (m_GC != nullptr && m_Buffer.buffer)
+            m_GC->getAllocator().destroy(m_Buffer);
+        m_GC = nullptr;
+    }
+
+    // ComputeKernel
+
+    ComputeKernel::ComputeKernel(const GContext &gc, const KernelDesc &desc)
+        : m_GC(gc), m_Name(desc.name), m_BufferCount(desc.bufferCount), m_PushConstantSize(desc.pushConstantSize) {
+        if (desc.bufferCount > MAX_KERNEL_BUFFERS) {
+            throw std::runtime_error("Kernel " + desc.name + " binds more than " + std::to_string(MAX_KERNEL_BUFFERS) + " buffers");
+        }
+        if (desc.pushConstantSize > 128 || desc.pushConstantSize % 4 != 0) {
+            throw std::runtime_error("Kernel " + desc.name + " needs a multiple of 4 up to 128 push constant bytes");
+        }
+        if (desc.spirv.empty()) {
+            throw std::runtime_error("Kernel " + desc.name + " has no SPIR-V");
+        }
+
+        const vk::Device &device = gc.getDevice();
+
+        std::vector<vk::DescriptorSetLayoutBinding> bindings;
+        for (uint32_t binding = 0; binding < desc.bufferCount; binding++)
+            bindings.emplace_back(binding, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute);
+
+        m_SetLayout = device.createDescriptorSetLayout(vk::DescriptorSetLayoutCreateInfo({}, bindings));
+
+        const vk::PushConstantRange  pushConstants(vk::ShaderStageFlagBits::eCompute, 0, desc.pushConstantSize);
+        vk::PipelineLayoutCreateInfo layoutInfo({}, m_SetLayout);
+        if (desc.pushConstantSize > 0)
+            layoutInfo.setPushConstantRanges(pushConstants);
+
+        vk::ShaderModule module;
+        try {
+            m_Layout = device.createPipelineLayout(layoutInfo);
+            module   = device.createShaderModule(vk::ShaderModuleCreateInfo({}, desc.spirv));
+            m_Pipeline =
+                device
+                    .createComputePipeline({}, vk::ComputePipelineCreateInfo(
+                                                   {}, vk::PipelineShaderStageCreateInfo({}, vk::ShaderStageFlagBits::eCompute, module, desc.entryPoint.c_str()), m_Layout))
+                    .value;
+            device.destroy(module);
+        } catch (...) {
+            device.destroy(module);
+            device.destroy(m_Layout);
+            device.destroy(m_SetLayout);
+            throw;
+        }
+    }
+
+    ComputeKernel::~ComputeKernel() {
+        const vk::Device &device = m_GC.getDevice();
+        device.destroy(m_Pipeline);
+        device.destroy(m_Layout);
+        device.destroy(m_SetLayout);
+    }
+
+    // ComputeBatch
+
+    ComputeBatch::ComputeBatch(ComputeService &service, uint32_t slot) : m_Service(&service), m_Slot(slot) {}
+
+    ComputeBatch::~ComputeBatch() {
+        if (m_Service != nullptr)
+            m_Service->discard(m_Slot);
+    }
+
+    ComputeBatch::ComputeBatch(ComputeBatch &&other) noexcept : m_Service(std::exchange(other.m_Service, nullptr)), m_Slot(other.m_Slot) {}
+
+    ComputeBatch &ComputeBatch::operator=(ComputeBatch &&other) noexcept {
+        if (this != &other) {
+            if (m_Service != nullptr)
+                m_Service->discard(m_Slot);
+            m_Service = std::exchange(other.m_Service, nullptr);
+            m_Slot    = other.m_Slot;
+        }
+        return *this;
+    }
+
+    void ComputeBatch::barrier() {
+        if (m_Service == nullptr) {
+            throw std::runtime_error("Compute batch was already submitted");
+        }
+
+        using Stage  = vk::PipelineStageFlagBits;
+        using Access = vk::AccessFlagBits;
+        m_Service->getSlot(m_Slot).commands.pipelineBarrier(
+            Stage::eComputeShader | Stage::eTransfer, Stage::eComputeShader | Stage::eTransfer, {},
+            vk::MemoryBarrier(Access::eShaderWrite | Access::eTransferWrite, Access::eShaderRead | Access::eShaderWrite | Access::eTransferRead | Access::eTransferWrite), {},
+            {});
+    }
+
+    void ComputeBatch::dispatch(const ComputeKernel &kernel, std::initializer_list<ComputeBinding> buffers, std::span<const std::byte> pushConstants, uint32_t groupsX,
+                                uint32_t groupsY, uint32_t groupsZ) {
+        if (buffers.size() != kernel.getBufferCount()) {
+            throw std::runtime_error("Kernel " + kernel.getName() + " binds " + std::to_string(kernel.getBufferCount()) + " buffers, got " + std::to_string(buffers.size()));
+        }
+        if (pushConstants.size() != kernel.getPushConstantSize()) {
+            throw std::runtime_error("Kernel " + kernel.getName() + " takes " + std::to_string(kernel.getPushConstantSize()) + " push constant bytes, got " +
+                                     std::to_string(pushConstants.size()));
+        }
+
+        barrier();
+
+        auto             &slot = m_Service->getSlot(m_Slot);
+        vk::CommandBuffer cmd  = slot.commands;
+
+        if (buffers.size() > 0) {
+            const vk::DescriptorSet set = m_Service->allocateSet(slot, kernel.getSetLayout());
+
+            std::array<vk::DescriptorBufferInfo, MAX_KERNEL_BUFFERS> infos;
+            std::array<vk::WriteDescriptorSet, MAX_KERNEL_BUFFERS>   writes;
+            uint32_t                                                 binding = 0;
+            for (const ComputeBinding &buffer : buffers) {
+                infos[binding]  = vk::DescriptorBufferInfo(buffer.buffer, buffer.offset, buffer.range);
+                writes[binding] = vk::WriteDescriptorSet(set, binding, 0, vk::DescriptorType::eStorageBuffer, {}, infos[binding]);
+                binding++;
+            }
+            m_Service->m_GC.getDevice().updateDescriptorSets(binding, writes.data(), 0, nullptr);
+            cmd.bindDescriptorSets(vk::PipelineBindPoint::eCompute, kernel.getLayout(), 0, set, {});
+        }
+
+        if (!pushConstants.empty())
+            cmd.pushConstants(kernel.getLayout(), vk::ShaderStageFlagBits::eCompute, 0, static_cast<uint32_t>(pushConstants.size()), pushConstants.data());
+
+        cmd.bindPipeline(vk::PipelineBindPoint::eCompute, kernel.getPipeline());
+        cmd.dispatch(groupsX, groupsY, groupsZ);
+        slot.dispatches++;
+    }
+
+    void ComputeBatch::fill(const ComputeBinding &buffer, uint32_t value) {
+        barrier();
+        m_Service->getSlot(m_Slot).commands.fillBuffer(buffer.buffer, buffer.offset, buffer.range, value);
+    }
+
+    void ComputeBatch::copy(const ComputeBinding &src, const ComputeBinding &dst) {
+        if (src.range == VK_WHOLE_SIZE) {
+            throw std::runtime_error("Compute copies need the size of the source range");
+        }
+        if (src.range == 0)
+            return;
+
+        barrier();
+        m_Service->getSlot(m_Slot).commands.copyBuffer(src.buffer, dst.buffer, vk::BufferCopy(src.offset, dst.offset, src.range));
+    }
+
+    void ComputeBatch::upload(const ComputeBinding &dst, std::span<const std::byte> data) {
+        if (data.empty())
+            return;
+
+        barrier();
+
+        auto                &slot    = m_Service->getSlot(m_Slot);
+        const ComputeBuffer &staging = m_Service->allocateScratch(slot, data.size(), ComputeMemory::Host);
+        std::memcpy(staging.getMapped(), data.data(), data.size());
+        slot.commands.copyBuffer(staging.getBuffer(), dst.buffer, vk::BufferCopy(0, dst.offset, data.size()));
+    }
+
+    ComputeBinding ComputeBatch::allocateScratch(vk::DeviceSize size, ComputeMemory memory) {
+        if (m_Service == nullptr) {
+            throw std::runtime_error("Compute batch was already submitted");
+        }
+        return {m_Service->allocateScratch(m_Service->getSlot(m_Slot), size, memory).getBuffer(), 0, size};
+    }
+
+    vk::CommandBuffer ComputeBatch::getCommandBuffer() {
+        barrier();
+        return m_Service->getSlot(m_Slot).commands;
+    }
+
+    // ComputeService
+
+    ComputeService::ComputeService(GContext &gc, const ComputeSettings &settings) : m_GC(gc), m_Settings(settings) {
+        if (settings.maxBatchesInFlight == 0 || settings.setsPerPool == 0) {
+            throw std::runtime_error("The compute service needs room for at least one batch and descriptor set");
+        }
+
+        const uint32_t primary = gc.getQueueFamily(QueueType::Primary).value();
+        m_Family               = gc.getQueueFamily(QueueType::Compute).value_or(primary);
+        m_Queue                = m_Family == primary ? gc.getPrimaryQueue() : gc.getQueue(QueueType::Compute).value();
+
+        vk::SemaphoreTypeCreateInfo timelineType(vk::SemaphoreType::eTimeline, 0);
+        m_Timeline = gc.getDevice().createSemaphore(vk::SemaphoreCreateInfo({}, &timelineType));
+
+        // slots are created as batches need them, never more than this
+        m_Slots.reserve(settings.maxBatchesInFlight);
+    }
+
+    ComputeService::~ComputeService() {
+        const vk::Device &device = m_GC.getDevice();
+        if (m_LastSubmitted > 0) {
+            (void)device.waitSemaphores(vk::SemaphoreWaitInfo({}, m_Timeline, m_LastSubmitted), std::numeric_limits<uint64_t>::max());
+        }
+
+        for (auto &slot : m_Slots) {
+            slot->scratch.clear();
+            for (const auto pool : slot->descriptorPools)
+                device.destroy(pool);
+            device.destroy(slot->commandPool);
+        }
+        device.destroy(m_Timeline);
+    }
+
+    ComputeBatch ComputeService::begin() {
+        const uint32_t index = acquireSlot();
+        Slot          &slot  = getSlot(index);
+
+        const vk::Device &device = m_GC.getDevice();
+        device.resetCommandPool(slot.commandPool);
+        for (uint32_t i = 0; i < std::min<size_t>(slot.currentPool + 1, slot.descriptorPools.size()); i++) {
+            device.resetDescriptorPool(slot.descriptorPools[i]);
+        }
+        slot.currentPool = 0;
+        slot.scratchUsed = 0;
+        slot.dispatches  = 0;
+
+        slot.commands.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+        return {*this, index};
+    }
+
+    uint32_t ComputeService::acquireSlot() {
+        const vk::Device &device = m_GC.getDevice();
+
+        std::unique_lock lock(m_Mutex);
+        while (true) {
+            const uint64_t completed = device.getSemaphoreCounterValue(m_Timeline);
+            while (!m_InFlight.empty() && m_Slots[m_InFlight.front()]->value <= completed) {
+                m_Free.push_back(m_InFlight.front());
+                m_InFlight.pop_front();
+            }
+
+            if (!m_Free.empty()) {
+                const uint32_t index = m_Free.back();
+                m_Free.pop_back();
+                m_Slots[index]->recording = true;
+                return index;
+            }
+
+            if (m_Slots.size() < m_Settings.maxBatchesInFlight) {
+                auto slot         = std::make_unique<Slot>();
+                slot->commandPool = device.createCommandPool(vk::CommandPoolCreateInfo(vk::CommandPoolCreateFlagBits::eTransient, m_Family));
+                slot->commands    = device.allocateCommandBuffers(vk::CommandBufferAllocateInfo(slot->commandPool, vk::CommandBufferLevel::ePrimary, 1)).front();
+                slot->recording   = true;
+                m_Slots.push_back(std::move(slot));
+                return static_cast<uint32_t>(m_Slots.size() - 1);
+            }
+
+            if (m_InFlight.empty()) {
+                throw std::runtime_error("More compute batches recording at once than ComputeSettings::maxBatchesInFlight");
+            }
+
+            // every slot is taken, wait for the oldest one without holding up other threads
+            const uint64_t oldest = m_Slots[m_InFlight.front()]->value;
+            m_Stats.batchStalls++;
+            lock.unlock();
+            (void)device.waitSemaphores(vk::SemaphoreWaitInfo({}, m_Timeline, oldest), std::numeric_limits<uint64_t>::max());
+            lock.lock();
+        }
+    }
+
+    ComputeService::Slot &ComputeService::getSlot(uint32_t slot) {
+        std::lock_guard lock(m_Mutex);
+        return *m_Slots[slot];
+    }
+
+    vk::DescriptorSet ComputeService::allocateSet(Slot &slot, vk::DescriptorSetLayout layout) {
+        const vk::Device &device = m_GC.getDevice();
+
+        while (true) {
+            const bool created = slot.currentPool == slot.descriptorPools.size();
+            if (created)
+                slot.descriptorPools.push_back(createPool());
+
+            const vk::DescriptorSetAllocateInfo info(slot.descriptorPools[slot.currentPool], layout);
+            vk::DescriptorSet                   set;
+            const vk::Result                    result = device.allocateDescriptorSets(&info, &set);
+            if (result == vk::Result::eSuccess)
+                return set;
+
+            if ((result != vk::Result::eErrorOutOfPoolMemory && result != vk::Result::eErrorFragmentedPool) || created) {
+                throw std::runtime_error("Failed to allocate a compute descriptor set: " + vk::to_string(result));
+            }
+            slot.currentPool++;
+        }
+    }
+
+    vk::DescriptorPool ComputeService::createPool() const {
+        const vk::DescriptorPoolSize size(vk::DescriptorType::eStorageBuffer, m_Settings.setsPerPool * MAX_KERNEL_BUFFERS);
+        return m_GC.getDevice().createDescriptorPool(vk::DescriptorPoolCreateInfo({}, m_Settings.setsPerPool, size));
+    }
+
+    ComputeBuffer &ComputeService::allocateScratch(Slot &slot, vk::DeviceSize size, ComputeMemory memory) {
+        // a batch recorded again the same way finds its buffers in the same places
+        if (slot.scratchUsed == slot.scratch.size()) {
+            slot.scratch.emplace_back();
+        }
+
+        ComputeBuffer &buffer = slot.scratch[slot.scratchUsed++];
+        if (buffer.getSize() < std::max<vk::DeviceSize>(size, 4) || buffer.getMemory() != memory) {
+            buffer = ComputeBuffer(m_GC, std::max<vk::DeviceSize>(size, 4), memory);
+        }
+        return buffer;
+    }
+
+    ComputeToken ComputeService::submit(ComputeBatch &&batch) {
+        NEURON_PROFILE_SCOPE("ComputeService::submit");
+        if (batch.m_Service != this) {
+            throw std::runtime_error("Compute batch doesn't belong to this service or was already submitted");
+        }
+
+        batch.m_Service      = nullptr;
+        const uint32_t index = batch.m_Slot;
+        Slot          &slot  = getSlot(index);
+
+        // results are read on the host once the token is reached
+        slot.commands.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {},
+                                      vk::MemoryBarrier(vk::AccessFlagBits::eShaderWrite | vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead), {}, {});
+        slot.commands.end();
+
+        // values must grow in submission order, so both happen under the lock
+        std::lock_guard lock(m_Mutex);
+        slot.value = ++m_LastSubmitted;
+        vk::TimelineSemaphoreSubmitInfo values({}, slot.value);
+        try {
+            m_GC.submit(m_Queue, vk::SubmitInfo({}, {}, slot.commands, m_Timeline, &values));
+        } catch (...) {
+            // nothing will signal the value, so the next submit reuses it
+            m_LastSubmitted--;
+            slot.value     = 0;
+            slot.recording = false;
+            m_Free.push_back(index);
+            throw;
+        }
+
+        slot.recording = false;
+        m_InFlight.push_back(index);
+        m_Stats.batchesSubmitted++;
+        m_Stats.dispatches += slot.dispatches;
+        return {slot.value};
+    }
+
+    void ComputeService::discard(uint32_t slot) {
+        std::lock_guard lock(m_Mutex);
+        m_Slots[slot]->recording = false;
+        m_Slots[slot]->value     = 0;
+        m_Free.push_back(slot);
+    }
+
+    bool ComputeService::isComplete(ComputeToken token) const {
+        return m_GC.getDevice().getSemaphoreCounterValue(m_Timeline) >= token.value;
+    }
+
+    void ComputeService::wait(ComputeToken token) const {
+        if (token.value == 0)
+            return;
+        (void)m_GC.getDevice().waitSemaphores(vk::SemaphoreWaitInfo({}, m_Timeline, token.value), std::numeric_limits<uint64_t>::max());
+    }
+
+    void ComputeService::readBytes(const ComputeBuffer &buffer, std::span<std::byte> data) {
+        if (data.empty())
+            return;
+
+        if (buffer.getMapped() != nullptr) {
+            uint64_t last;
+            {
+                std::lock_guard lock(m_Mutex);
+                last = m_LastSubmitted;
+            }
+            wait({last});
+            std::memcpy(data.data(), buffer.getMapped(), data.size());
+            return;
+        }
+
+        const ComputeBuffer staging(m_GC, data.size(), ComputeMemory::Host);
+
+        ComputeBatch batch = begin();
+        batch.copy(ComputeBinding(buffer.getBuffer(), 0, data.size()), staging);
+        wait(submit(std::move(batch)));
+        std::memcpy(data.data(), staging.getMapped(), data.size());
+    }
+
+    ComputeStats ComputeService::getStats() const {
+        std::lock_guard lock(m_Mutex);
+        return m_Stats;
+    }
+
+    // ComputePrimitives
+
+    static constexpr std::string_view PRIMITIVES_COMMON = R"(#version 450
+layout(local_size_x = GROUP_SIZE) in;
+
+layout(push_constant) uniform TileCounts {
+    uint count;
+    uint tiles;
+    uint shift;
+};
+
+// tiles are spread over two dimensions, one is only guaranteed 65535 workgroups
+uint tileIndex() {
+    return gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
+}
+)";
+
+    static constexpr std::string_view REDUCE_SHADER = R"(
+#if defined(OP_MIN)
+#define COMBINE(a, b) min(a, b)
+#elif defined(OP_MAX)
+#define COMBINE(a, b) max(a, b)
+#else
+#define COMBINE(a, b) ((a) + (b))
+#endif
+
+layout(set = 0, binding = 0, std430) readonly buffer Input { TYPE inputs[]; };
+layout(set = 0, binding = 1, std430) writeonly buffer Output { TYPE outputs[]; };
+
+shared TYPE partial[GROUP_SIZE];
+
+void main() {
+    uint tile = tileIndex();
+    if (tile >= tiles)
+        return;
+
+    uint local = gl_LocalInvocationID.x;
+    uint base  = tile * GROUP_SIZE * ITEMS + local;
+    TYPE value = IDENTITY;
+    for (uint i = 0; i < ITEMS; i++) {
+        uint index = base + i * GROUP_SIZE;
+        if (index < count)
+            value = COMBINE(value, inputs[index]);
+    }
+    partial[local] = value;
+    barrier();
+
+    for (uint stride = GROUP_SIZE / 2; stride > 0; stride >>= 1) {
+        if (local < stride)
+            partial[local] = COMBINE(partial[local], partial[local + stride]);
+        barrier();
+    }
+
+    if (local == 0)
+        outputs[tile] = partial[0];
+}
+)";
+
+    static constexpr std::string_view SCAN_SHADER = R"(
+layout(set = 0, binding = 0, std430) readonly buffer Input { uint inputs[]; };
+layout(set = 0, binding = 1, std430) writeonly buffer Output { uint outputs[]; };
+layout(set = 0, binding = 2, std430) writeonly buffer Sums { uint sums[]; };
+
+shared uint values[GROUP_SIZE * ITEMS];
+shared uint totals[GROUP_SIZE];
+
+void main() {
+    uint tile = tileIndex();
+    if (tile >= tiles)
+        return;
+
+    uint local = gl_LocalInvocationID.x;
+    uint base  = tile * GROUP_SIZE * ITEMS;
+
+    // coalesced loads, then every thread scans ITEMS neighbours
+    for (uint i = 0; i < ITEMS; i++) {
+        uint index = base + i * GROUP_SIZE + local;
+        uint value = index < count ? inputs[index] : 0u;
+#ifdef PREDICATE
+        value = value != 0u ? 1u : 0u;
+#endif
+        values[i * GROUP_SIZE + local] = value;
+    }
+    barrier();
+
+    uint sum = 0u;
+    for (uint i = 0; i < ITEMS; i++) {
+        uint value                = values[local * ITEMS + i];
+        values[local * ITEMS + i] = sum;
+        sum += value;
+    }
+    totals[local] = sum;
+    barrier();
+
+    // inclusive scan of the thread sums
+    for (uint offset = 1; offset < GROUP_SIZE; offset <<= 1) {
+        uint before = local >= offset ? totals[local - offset] : 0u;
+        barrier();
+        totals[local] += before;
+        barrier();
+    }
+
+    uint prefix = totals[local] - sum;
+    for (uint i = 0; i < ITEMS; i++)
+        values[local * ITEMS + i] += prefix;
+    barrier();
+
+    for (uint i = 0; i < ITEMS; i++) {
+        uint index = base + i * GROUP_SIZE + local;
+        if (index < count)
+            outputs[index] = values[i * GROUP_SIZE + local];
+    }
+    if (local == GROUP_SIZE - 1)
+        sums[tile] = totals[local];
+}
+)";
+
+    static constexpr std::string_view ADD_OFFSETS_SHADER = R"(
+layout(set = 0, binding = 0, std430) buffer Output { uint outputs[]; };
+layout(set = 0, binding = 1, std430) readonly buffer Offsets { uint offsets[]; };
+
+void main() {
+    uint tile = tileIndex();
+    if (tile == 0 || tile >= tiles)
+        return;
+
+    uint offset = offsets[tile];
+    uint base   = tile * GROUP_SIZE * ITEMS + gl_LocalInvocationID.x;
+    for (uint i = 0; i < ITEMS; i++) {
+        uint index = base + i * GROUP_SIZE;
+        if (index < count)
+            outputs[index] += offset;
+    }
+}
+)";
+
+    static constexpr std::string_view SCATTER_SHADER = R"(
+layout(set = 0, binding = 0, std430) readonly buffer Values { uint values[]; };
+layout(set = 0, binding = 1, std430) readonly buffer Flags { uint flags[]; };
+layout(set = 0, binding = 2, std430) readonly buffer Indices { uint indices[]; };
+layout(set = 0, binding = 3, std430) writeonly buffer Output { uint outputs[]; };
+layout(set = 0, binding = 4, std430) writeonly buffer Total { uint total; };
+
+void main() {
+    uint tile = tileIndex();
+    if (tile >= tiles)
+        return;
+
+    uint base = tile * GROUP_SIZE * ITEMS + gl_LocalInvocationID.x;
+    for (uint i = 0; i < ITEMS; i++) {
+        uint index = base + i * GROUP_SIZE;
+        if (index >= count)
+            break;
+
+        bool keep = flags[index] != 0u;
+        if (keep)
+            outputs[indices[index]] = values[index];
+        if (index == count - 1)
+            total = indices[index] + (keep ? 1u : 0u);
+    }
+}
+)";
+
+    static constexpr std::string_view HISTOGRAM_SHADER = R"(
+layout(set = 0, binding = 0, std430) readonly buffer Keys { uint keys[]; };
+layout(set = 0, binding = 1, std430) writeonly buffer Counts { uint counts[]; };
+
+shared uint histogram[RADIX];
+
+void main() {
+    uint tile = tileIndex();
+    if (tile >= tiles)
+        return;
+
+    uint local = gl_LocalInvocationID.x;
+    if (local < RADIX)
+        histogram[local] = 0u;
+    barrier();
+
+    uint base = tile * GROUP_SIZE * ITEMS + local;
+    for (uint i = 0; i < ITEMS; i++) {
+        uint index = base + i * GROUP_SIZE;
+        if (index < count)
+            atomicAdd(histogram[(keys[index] >> shift) & (RADIX - 1u)], 1u);
+    }
+    barrier();
+
+    // digit major, so one scan over all of it gives every tile the start of its digits
+    if (local < RADIX)
+        counts[local * tiles + tile] = histogram[local];
+}
+)";
+
+    static constexpr std::string_view SORT_SCATTER_SHADER = R"(
+layout(set = 0, binding = 0, std430) readonly buffer KeysIn { uint keysIn[]; };
+layout(set = 0, binding = 1, std430) writeonly buffer KeysOut { uint keysOut[]; };
+layout(set = 0, binding = 2, std430) readonly buffer Offsets { uint offsets[]; };
+#ifdef VALUES
+layout(set = 0, binding = 3, std430) readonly buffer ValuesIn { uint valuesIn[]; };
+layout(set = 0, binding = 4, std430) writeonly buffer ValuesOut { uint valuesOut[]; };
+#endif
+
+// ranks[digit * GROUP_SIZE + thread], each thread only writes its own column outside of the scan
+shared uint ranks[RADIX * GROUP_SIZE];
+shared uint totals[GROUP_SIZE];
+shared uint starts[RADIX];
+
+uint digitOf(uint key) {
+    return (key >> shift) & (RADIX - 1u);
+}
+
+void main() {
+    uint tile = tileIndex();
+    if (tile >= tiles)
+        return;
+
+    // every thread takes ITEMS consecutive elements, which keeps the sort stable
+    uint local = gl_LocalInvocationID.x;
+    uint first = tile * GROUP_SIZE * ITEMS + local * ITEMS;
+    for (uint digit = 0; digit < RADIX; digit++)
+        ranks[digit * GROUP_SIZE + local] = 0u;
+    for (uint i = 0; i < ITEMS; i++) {
+        if (first + i < count)
+            ranks[digitOf(keysIn[first + i]) * GROUP_SIZE + local]++;
+    }
+    barrier();
+
+    // exclusive scan over all of ranks: then it holds how many elements of the tile have a smaller digit, or the same digit in an earlier thread
+    uint sum = 0u;
+    for (uint i = 0; i < RADIX; i++) {
+        uint value                = ranks[local * RADIX + i];
+        ranks[local * RADIX + i] = sum;
+        sum += value;
+    }
+    totals[local] = sum;
+    barrier();
+
+    for (uint offset = 1; offset < GROUP_SIZE; offset <<= 1) {
+        uint before = local >= offset ? totals[local - offset] : 0u;
+        barrier();
+        totals[local] += before;
+        barrier();
+    }
+
+    uint prefix = totals[local] - sum;
+    for (uint i = 0; i < RADIX; i++)
+        ranks[local * RADIX + i] += prefix;
+    barrier();
+
+    if (local < RADIX)
+        starts[local] = ranks[local * GROUP_SIZE];
+    barrier();
+
+    for (uint i = 0; i < ITEMS; i++) {
+        uint index = first + i;
+        if (index >= count)
+            break;
+
+        uint key      = keysIn[index];
+        uint digit    = digitOf(key);
+        uint slot     = digit * GROUP_SIZE + local;
+        uint position = offsets[digit * tiles + tile] + ranks[slot] - starts[digit];
+        ranks[slot]++;
+
+        keysOut[position] = key;
+#ifdef VALUES
+        valuesOut[position] = valuesIn[index];
+#endif
+    }
+}
+)";
+
+    constexpr uint32_t PRIMITIVE_GROUP_SIZE = 256;
+    constexpr uint32_t PRIMITIVE_ITEMS      = 8;
+    constexpr uint32_t PRIMITIVE_TILE       = PRIMITIVE_GROUP_SIZE * PRIMITIVE_ITEMS;
+
+    // the sort keeps a rank per digit and thread in shared memory, 8 KiB at this size
+    constexpr uint32_t SORT_GROUP_SIZE = 128;
+    constexpr uint32_t SORT_ITEMS      = 8;
+    constexpr uint32_t SORT_TILE       = SORT_GROUP_SIZE * SORT_ITEMS;
+    constexpr uint32_t RADIX_BITS      = 4;
+    constexpr uint32_t RADIX           = 1u << RADIX_BITS;
+
+    // the TileCounts block of the shaders
+    struct TileCounts {
+        uint32_t count = 0;
+        uint32_t tiles = 0;
+        uint32_t shift = 0;
+    };
+
+    static uint32_t tilesFor(uint32_t count, uint32_t tile) {
+        return static_cast<uint32_t>((static_cast<uint64_t>(count) + tile - 1) / tile);
+    }
+
+    static std::vector<std::pair<std::string, std::string>> tileDefines(uint32_t groupSize, uint32_t items) {
+        return {{"GROUP_SIZE", std::to_string(groupSize)}, {"ITEMS", std::to_string(items)}};
+    }
+
+    ComputePrimitives::ComputePrimitives(const std::shared_ptr<GContext> &gc, ShaderCompiler &shaders) : m_GC(gc), m_Shaders(shaders) {}
+
+    ComputePrimitives::~ComputePrimitives() = default;
+
+    const ComputeKernel &ComputePrimitives::getKernel(const std::string &name, std::string_view code, uint32_t bufferCount,
+                                                      const std::vector<std::pair<std::string, std::string>> &defines) {
+        std::lock_guard lock(m_Mutex);
+
+        // compiled on first use, most programs only need a few of them
+        auto &kernel = m_Kernels[name];
+        if (!kernel) {
+            const ShaderSource source{.name = name, .code = std::string(PRIMITIVES_COMMON) + std::string(code), .stage = ShaderStage::Compute, .defines = defines};
+            kernel = std::make_unique<ComputeKernel>(
+                *m_GC, KernelDesc{.name = name, .spirv = m_Shaders.compile(source), .bufferCount = bufferCount, .pushConstantSize = sizeof(TileCounts)});
+        }
+        return *kernel;
+    }
+
+    void ComputePrimitives::dispatchTiles(ComputeBatch &batch, const ComputeKernel &kernel, std::initializer_list<ComputeBinding> buffers, uint32_t count,
+                                          uint32_t tiles, uint32_t shift) const {
+        const uint32_t maxGroups = m_GC->getProperties().limits.maxComputeWorkGroupCount[0];
+        const uint32_t groupsX   = std::min(tiles, maxGroups);
+        batch.dispatch(kernel, buffers, TileCounts{.count = count, .tiles = tiles, .shift = shift}, groupsX, tilesFor(tiles, groupsX));
+    }
+
+    void ComputePrimitives::reduceTiles(ComputeBatch &batch, const ComputeBinding &input, const ComputeBinding &result, ScalarType type, ReduceOp op, uint32_t count) {
+        static constexpr std::array<const char *, 3> TYPE_NAMES = {"uint", "int", "float"};
+        static constexpr std::array<const char *, 3> OP_NAMES   = {"add", "min", "max"};
+
+        // the identity of every operation, by type
+        static constexpr std::array<std::array<const char *, 3>, 3> IDENTITIES = {{
+            {"0u", "0xffffffffu", "0u"},
+            {"0", "0x7fffffff", "(-0x7fffffff - 1)"},
+            {"0.0", "uintBitsToFloat(0x7f800000u)", "uintBitsToFloat(0xff800000u)"},
+        }};
+
+        const auto typeIndex = static_cast<size_t>(type);
+        const auto opIndex   = static_cast<size_t>(op);
+
+        auto defines = tileDefines(PRIMITIVE_GROUP_SIZE, PRIMITIVE_ITEMS);
+        defines.emplace_back("TYPE", TYPE_NAMES[typeIndex]);
+        defines.emplace_back("IDENTITY", IDENTITIES[typeIndex][opIndex]);
+        if (op != ReduceOp::Add)
+            defines.emplace_back(op == ReduceOp::Min ? "OP_MIN" : "OP_MAX", "1");
+
+        const ComputeKernel &kernel = getKernel(std::string("reduce_") + OP_NAMES[opIndex] + "_" + TYPE_NAMES[typeIndex] + ".comp", REDUCE_SHADER, 2, defines);
+
+        // every pass leaves one partial result per tile, until there is one left. An empty input still gets a pass, which writes the identity
+        ComputeBinding source    = input;
+        uint32_t       remaining = count;
+        do {
+            const uint32_t       tiles  = std::max(tilesFor(remaining, PRIMITIVE_TILE), 1u);
+            const ComputeBinding target = tiles == 1 ? result : batch.allocateScratch(static_cast<vk::DeviceSize>(tiles) * 4);
+            dispatchTiles(batch, kernel, {source, target}, remaining, tiles);
+
+            source    = target;
+            remaining = tiles;
+        } while (remaining > 1);
+    }
+
+    void ComputePrimitives::scan(ComputeBatch &batch, const ComputeBinding &input, const ComputeBinding &output, uint32_t count, bool predicate) {
+        if (count == 0)
+            return;
+
+        auto defines = tileDefines(PRIMITIVE_GROUP_SIZE, PRIMITIVE_ITEMS);
+        if (predicate)
+            defines.emplace_back("PREDICATE", "1");
+
+        const ComputeKernel &scanKernel = getKernel(predicate ? "scan_predicate.comp" : "scan.comp", SCAN_SHADER, 3, defines);
+        const ComputeKernel &addKernel  = getKernel("scan_add.comp", ADD_OFFSETS_SHADER, 2, tileDefines(PRIMITIVE_GROUP_SIZE, PRIMITIVE_ITEMS));
+
+        // scan the tiles, then the tile sums (in place, recursively), then add those to the tiles
+        const uint32_t       tiles = tilesFor(count, PRIMITIVE_TILE);
+        const ComputeBinding sums  = batch.allocateScratch(static_cast<vk::DeviceSize>(tiles) * 4);
+        dispatchTiles(batch, scanKernel, {input, output, sums}, count, tiles);
+        if (tiles == 1)
+            return;
+
+        scan(batch, sums, sums, tiles, false);
+        dispatchTiles(batch, addKernel, {output, sums}, count, tiles);
+    }
+
+    void ComputePrimitives::exclusiveScan(ComputeBatch &batch, const DeviceBuffer<uint32_t> &input, const DeviceBuffer<uint32_t> &output, size_t count) {
+        NEURON_PROFILE_SCOPE("ComputePrimitives::exclusiveScan");
+        const uint32_t elements = checkCount(input, count);
+        if (output.size() < elements) {
+            throw std::runtime_error("Scan output is smaller than its input");
+        }
+        scan(batch, input, output, elements, false);
+    }
+
+    void ComputePrimitives::compact(ComputeBatch &batch, const DeviceBuffer<uint32_t> &values, const DeviceBuffer<uint32_t> &flags, const DeviceBuffer<uint32_t> &output,
+                                    const DeviceBuffer<uint32_t> &count) {
+        NEURON_PROFILE_SCOPE("ComputePrimitives::compact");
+        const uint32_t elements = checkCount(values, SIZE_MAX);
+        if (flags.size() < elements || output.size() < elements || count.size() < 1) {
+            throw std::runtime_error("Compaction needs a flag and an output slot per value, and a count");
+        }
+
+        if (elements == 0) {
+            batch.fill(ComputeBinding(count.getBuffer(), 0, sizeof(uint32_t)), 0);
+            return;
+        }
+
+        // the exclusive scan of the flags is where every kept value goes
+        const ComputeBinding indices = batch.allocateScratch(static_cast<vk::DeviceSize>(elements) * 4);
+        scan(batch, flags, indices, elements, true);
+
+        const ComputeKernel &kernel = getKernel("compact_scatter.comp", SCATTER_SHADER, 5, tileDefines(PRIMITIVE_GROUP_SIZE, PRIMITIVE_ITEMS));
+        dispatchTiles(batch, kernel, {values, flags, indices, output, count}, elements, tilesFor(elements, PRIMITIVE_TILE));
+    }
+
+    void ComputePrimitives::radixSort(ComputeBatch &batch, const DeviceBuffer<uint32_t> &keys, const DeviceBuffer<uint32_t> *values, uint32_t keyBits) {
+        NEURON_PROFILE_SCOPE("ComputePrimitives::radixSort");
+        const uint32_t elements = checkCount(keys, SIZE_MAX);
+        if (values != nullptr && values->size() < elements) {
+            throw std::runtime_error("Radix sort needs a value per key");
+        }
+
+        keyBits = std::min(keyBits, 32u);
+        if (elements < 2 || keyBits == 0)
+            return;
+
+        auto defines = tileDefines(SORT_GROUP_SIZE, SORT_ITEMS);
+        defines.emplace_back("RADIX", std::to_string(RADIX));
+
+        const ComputeKernel &histogram = getKernel("sort_histogram.comp", HISTOGRAM_SHADER, 2, defines);
+        if (values != nullptr)
+            defines.emplace_back("VALUES", "1");
+        const ComputeKernel &scatter = getKernel(values != nullptr ? "sort_scatter_values.comp" : "sort_scatter.comp", SORT_SCATTER_SHADER, values != nullptr ? 5 : 3, defines);
+
+        const vk::DeviceSize bytes  = static_cast<vk::DeviceSize>(elements) * sizeof(uint32_t);
+        const uint32_t       tiles  = tilesFor(elements, SORT_TILE);
+        const uint32_t       passes = (keyBits + RADIX_BITS - 1) / RADIX_BITS;
+        const ComputeBinding counts = batch.allocateScratch(static_cast<vk::DeviceSize>(tiles) * RADIX * sizeof(uint32_t));
+
+        // passes go back and forth between the buffers and a scratch copy
+        std::array<ComputeBinding, 2> keyBuffers   = {ComputeBinding(keys.getBuffer(), 0, bytes), batch.allocateScratch(bytes)};
+        std::array<ComputeBinding, 2> valueBuffers = keyBuffers;
+        if (values != nullptr)
+            valueBuffers = {ComputeBinding(values->getBuffer(), 0, bytes), batch.allocateScratch(bytes)};
+
+        for (uint32_t pass = 0; pass < passes; pass++) {
+            const ComputeBinding &keysIn  = keyBuffers[pass % 2];
+            const ComputeBinding &keysOut = keyBuffers[(pass + 1) % 2];
+            const uint32_t        shift   = pass * RADIX_BITS;
+
+            dispatchTiles(batch, histogram, {keysIn, counts}, elements, tiles, shift);
+            scan(batch, counts, counts, tiles * RADIX, false);
+            if (values != nullptr) {
+                dispatchTiles(batch, scatter, {keysIn, keysOut, counts, valueBuffers[pass % 2], valueBuffers[(pass + 1) % 2]}, elements, tiles, shift);
+            } else {
+                dispatchTiles(batch, scatter, {keysIn, keysOut, counts}, elements, tiles, shift);
+            }
+        }
+
+        if (passes % 2 == 1) {
+            batch.copy(keyBuffers[1], keyBuffers[0]);
+            if (values != nullptr)
+                batch.copy(valueBuffers[1], valueBuffers[0]);
+        }
+    }
+
+} // namespace neuron::graphics
@@ -0,0 +1,473 @@
+#pragma once
+
+#include "neuron/graphics/memory.hpp"
+#include "neuron/graphics/shaders.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace neuron::graphics {
+    class GContext;
+
+    struct ComputeSettings {
+        /**
+         * Batches recorded or running at once. begin() waits for the oldest one beyond that.
+         */
+        uint32_t maxBatchesInFlight = 16;
+
+        /**
+         * Descriptor sets in one pool of a batch, a batch with more dispatches gets another pool.
+         */
+        uint32_t setsPerPool = 256;
+    };
+
+    /**
+     * Timeline value of ComputeService::getTimeline() that is reached once a batch has finished and its writes are visible to the host.
+     */
+    struct ComputeToken {
+        uint64_t value = 0;
+    };
+
+    enum class ComputeMemory {
+        /**
+         * Device local, filled and read back with copies.
+         */
+        Device,
+
+        /**
+         * Host visible, coherent and persistently mapped. For data the CPU writes before or reads after every batch, and for devices where all memory is host memory.
+         */
+        Host,
+    };
+
+    /**
+     *
+     * A storage buffer for compute, usable on the primary and the compute queue without ownership transfers. Can also be copied from and to.
+     *
+     */
+    class ComputeBuffer {
+      public:
+        ComputeBuffer() = default;
+        ComputeBuffer(const GContext &gc, vk::DeviceSize size, ComputeMemory memory = ComputeMemory::Device);
+        ~ComputeBuffer();
+
+        ComputeBuffer(const ComputeBuffer &)            = delete;
+        ComputeBuffer &operator=(const ComputeBuffer &) = delete;
+
+        ComputeBuffer(ComputeBuffer &&other) noexcept;
+        ComputeBuffer &operator=(ComputeBuffer &&other) noexcept;
+
+        [[nodiscard]] inline vk::Buffer getBuffer() const noexcept { return m_Buffer.buffer; }
+
+        [[nodiscard]] inline vk::DeviceSize getSize() const noexcept { return m_Size; }
+
+        [[nodiscard]] inline ComputeMemory getMemory() const noexcept { return m_Memory; }
+
+        /**
+         * Null for device memory.
+         */
+        [[nodiscard]] inline void *getMapped() const noexcept { return m_Buffer.allocation.mapped; }
+
+      private:
+        const GContext *m_GC = nullptr;
+        AllocatedBuffer m_Buffer;
+        vk::DeviceSize  m_Size   = 0;
+        ComputeMemory   m_Memory = ComputeMemory::Device;
+
+        void release() noexcept;
+    };
+
+    /**
+     * A ComputeBuffer of count elements of T, laid out as a std430 array of it.
+     */
+    template<typename T> class DeviceBuffer final : public ComputeBuffer {
+        static_assert(std::is_trivially_copyable_v<T>, "Device buffers hold trivially copyable types");
+
+      public:
+        DeviceBuffer() = default;
+
+        // an empty buffer still gets one element, Vulkan has no empty buffers
+        DeviceBuffer(const GContext &gc, size_t count, ComputeMemory memory = ComputeMemory::Device)
+            : ComputeBuffer(gc, std::max<size_t>(count, 1) * sizeof(T), memory), m_Count(count) {}
+
+        DeviceBuffer(DeviceBuffer &&other) noexcept : ComputeBuffer(std::move(other)), m_Count(std::exchange(other.m_Count, 0)) {}
+
+        DeviceBuffer &operator=(DeviceBuffer &&other) noexcept {
+            ComputeBuffer::operator=(std::move(other));
+            m_Count = std::exchange(other.m_Count, 0);
+            return *this;
+        }
+
+        [[nodiscard]] inline size_t size() const noexcept { return m_Count; }
+
+        /**
+         * The mapped elements of a host buffer. Only valid to read once the batches writing it are complete.
+         *
+         * @throws std::runtime_error for device memory.
+         */
+        [[nodiscard]] std::span<T> getHostData() const {
+            if (getMapped() == nullptr)
+                throw std::runtime_error("Only host compute buffers are mapped");
+            return {static_cast<T *>(getMapped()), m_Count};
+        }
+
+      private:
+        size_t m_Count = 0;
+    };
+
+    /**
+     * A range of a buffer bound to a kernel or copied. Buffers convert to a binding of their whole size.
+     */
+    struct ComputeBinding {
+        vk::Buffer     buffer;
+        vk::DeviceSize offset = 0;
+        vk::DeviceSize range  = VK_WHOLE_SIZE;
+
+        ComputeBinding(vk::Buffer buffer, vk::DeviceSize offset = 0, vk::DeviceSize range = VK_WHOLE_SIZE) : buffer(buffer), offset(offset), range(range) {}
+
+        ComputeBinding(const ComputeBuffer &buffer) : buffer(buffer.getBuffer()), range(buffer.getSize()) {}
+    };
+
+    constexpr uint32_t MAX_KERNEL_BUFFERS = 8;
+
+    struct KernelDesc {
+        /**
+         * For errors and profiling.
+         */
+        std::string name;
+
+        Spirv       spirv;
+        std::string entryPoint = "main";
+
+        /**
+         * Storage buffers at bindings 0 to bufferCount - 1 of set 0, at most MAX_KERNEL_BUFFERS.
+         */
+        uint32_t bufferCount = 0;
+
+        /**
+         * Bytes of one push constant block at offset 0, visible to the compute stage. At most 128, the smallest maxPushConstantsSize there is.
+         */
+        uint32_t pushConstantSize = 0;
+    };
+
+    /**
+     *
+     * A compute pipeline made from SPIR-V, with its layout. Dispatched through a ComputeBatch.
+     *
+     */
+    class ComputeKernel final {
+      public:
+        /**
+         * @throws std::runtime_error if the limits of KernelDesc are exceeded or the pipeline can't be created.
+         */
+        ComputeKernel(const GContext &gc, const KernelDesc &desc);
+        ~ComputeKernel();
+
+        ComputeKernel(const ComputeKernel &)            = delete;
+        ComputeKernel &operator=(const ComputeKernel &) = delete;
+
+        [[nodiscard]] inline const std::string &getName() const noexcept { return m_Name; }
+
+        [[nodiscard]] inline vk::Pipeline getPipeline() const noexcept { return m_Pipeline; }
+
+        [[nodiscard]] inline vk::PipelineLayout getLayout() const noexcept { return m_Layout; }
+
+        [[nodiscard]] inline vk::DescriptorSetLayout getSetLayout() const noexcept { return m_SetLayout; }
+
+        [[nodiscard]] inline uint32_t getBufferCount() const noexcept { return m_BufferCount; }
+
+        [[nodiscard]] inline uint32_t getPushConstantSize() const noexcept { return m_PushConstantSize; }
+
+      private:
+        const GContext &m_GC;
+        std::string     m_Name;
+        uint32_t        m_BufferCount;
+        uint32_t        m_PushConstantSize;
+
+        vk::DescriptorSetLayout m_SetLayout;
+        vk::PipelineLayout      m_Layout;
+        vk::Pipeline            m_Pipeline;
+    };
+
+    class ComputeService;
+
+    /**
+     *
+     * Commands recorded for one submit, from ComputeService::begin(). Every command waits for the ones recorded before it (and for earlier batches), so a batch reads
+     * like a sequence of function calls. A batch is used by one thread at a time; dropping it without submitting discards it.
+     *
+     */
+    class ComputeBatch final {
+      public:
+        ~ComputeBatch();
+
+        ComputeBatch(const ComputeBatch &)            = delete;
+        ComputeBatch &operator=(const ComputeBatch &) = delete;
+
+        ComputeBatch(ComputeBatch &&other) noexcept;
+        ComputeBatch &operator=(ComputeBatch &&other) noexcept;
+
+        /**
+         * Binds buffers to bindings 0 to n - 1 and dispatches the kernel. pushConstants must be getPushConstantSize() bytes, or empty for a kernel without any.
+         *
+         * @throws std::runtime_error if the number of buffers or push constant bytes doesn't match the kernel.
+         */
+        void dispatch(const ComputeKernel &kernel, std::initializer_list<ComputeBinding> buffers, std::span<const std::byte> pushConstants, uint32_t groupsX,
+                      uint32_t groupsY = 1, uint32_t groupsZ = 1);
+
+        template<typename P>
+        void dispatch(const ComputeKernel &kernel, std::initializer_list<ComputeBinding> buffers, const P &pushConstants, uint32_t groupsX, uint32_t groupsY = 1,
+                      uint32_t groupsZ = 1) {
+            static_assert(std::is_trivially_copyable_v<P>, "Push constants are copied bytewise");
+            dispatch(kernel, buffers, std::as_bytes(std::span(&pushConstants, 1)), groupsX, groupsY, groupsZ);
+        }
+
+        /**
+         * Sets every 32 bit word of the range to value. Offset and range must be multiples of 4.
+         */
+        void fill(const ComputeBinding &buffer, uint32_t value);
+
+        /**
+         * Copies the whole range of src (which must be given) to dst.
+         */
+        void copy(const ComputeBinding &src, const ComputeBinding &dst);
+
+        /**
+         * Copies data to dst through staging memory of the batch. The data is staged right away.
+         */
+        void upload(const ComputeBinding &dst, std::span<const std::byte> data);
+
+        /**
+         * A buffer that lives until the batch is complete, for intermediate results. Scratch buffers are reused by later batches, their contents are undefined.
+         */
+        [[nodiscard]] ComputeBinding allocateScratch(vk::DeviceSize size, ComputeMemory memory = ComputeMemory::Device);
+
+        /**
+         * For commands of your own. Records a barrier first, so they see what the batch wrote so far, and the next command of the batch waits for them.
+         */
+        [[nodiscard]] vk::CommandBuffer getCommandBuffer();
+
+      private:
+        friend class ComputeService;
+
+        ComputeBatch(ComputeService &service, uint32_t slot);
+
+        ComputeService *m_Service = nullptr;
+        uint32_t        m_Slot    = 0;
+
+        void barrier();
+    };
+
+    struct ComputeStats {
+        uint64_t batchesSubmitted = 0;
+        uint64_t dispatches       = 0;
+        uint64_t batchStalls      = 0;
+    };
+
+    /**
+     *
+     * Records compute work into batches and submits them, on the dedicated compute queue when the device has one and on the primary queue otherwise. Submits return a
+     * token to wait on, or to make other submits wait on through getTimeline().
+     *
+     * Batches can be recorded on several threads at once. All methods are thread safe. Owned by GContext, requires timeline semaphores.
+     *
+     */
+    class ComputeService final {
+      public:
+        ComputeService(GContext &gc, const ComputeSettings &settings);
+        ~ComputeService();
+
+        ComputeService(const ComputeService &)            = delete;
+        ComputeService &operator=(const ComputeService &) = delete;
+
+        /**
+         * Starts recording. Blocks if maxBatchesInFlight batches are recorded or running, until the oldest one is complete.
+         */
+        [[nodiscard]] ComputeBatch begin();
+
+        ComputeToken submit(ComputeBatch &&batch);
+
+        [[nodiscard]] bool isComplete(ComputeToken token) const;
+
+        void wait(ComputeToken token) const;
+
+        /**
+         * Uploads data into a buffer and waits for it. Host buffers are written directly, so batches using them must be complete.
+         */
+        template<typename T> void write(DeviceBuffer<T> &buffer, std::span<const T> data) {
+            if (data.size() > buffer.size())
+                throw std::runtime_error("More data than the compute buffer holds");
+            if (auto mapped = buffer.getMapped(); mapped != nullptr) {
+                std::copy(data.begin(), data.end(), static_cast<T *>(mapped));
+                return;
+            }
+
+            ComputeBatch batch = begin();
+            batch.upload(buffer, std::as_bytes(data));
+            wait(submit(std::move(batch)));
+        }
+
+        /**
+         * The first count elements of a buffer (all by default), read back once everything submitted before is complete.
+         */
+        template<typename T> [[nodiscard]] std::vector<T> read(const DeviceBuffer<T> &buffer, size_t count = SIZE_MAX) {
+            count = std::min(count, buffer.size());
+            std::vector<T> data(count);
+            readBytes(buffer, std::as_writable_bytes(std::span(data)));
+            return data;
+        }
+
+        [[nodiscard]] inline vk::Semaphore getTimeline() const noexcept { return m_Timeline; }
+
+        [[nodiscard]] inline vk::Queue getQueue() const noexcept { return m_Queue; }
+
+        [[nodiscard]] inline uint32_t getQueueFamily() const noexcept { return m_Family; }
+
+        [[nodiscard]] ComputeStats getStats() const;
+
+      private:
+        friend class ComputeBatch;
+
+        struct Slot {
+            vk::CommandPool                 commandPool;
+            vk::CommandBuffer               commands;
+            std::vector<vk::DescriptorPool> descriptorPools;
+            uint32_t                        currentPool = 0;
+
+            // kept across uses, handed out again in the same order
+            std::vector<ComputeBuffer> scratch;
+            size_t                     scratchUsed = 0;
+
+            uint64_t value      = 0;
+            uint32_t dispatches = 0;
+            bool     recording  = false;
+        };
+
+        GContext       &m_GC;
+        ComputeSettings m_Settings;
+
+        vk::Queue     m_Queue;
+        uint32_t      m_Family;
+        vk::Semaphore m_Timeline;
+
+        std::vector<std::unique_ptr<Slot>> m_Slots;
+        std::vector<uint32_t>              m_Free;
+        std::deque<uint32_t>               m_InFlight;
+        uint64_t                           m_LastSubmitted = 0;
+
+        ComputeStats m_Stats;
+
+        mutable std::mutex m_Mutex;
+
+        [[nodiscard]] uint32_t           acquireSlot();
+        [[nodiscard]] Slot              &getSlot(uint32_t slot);
+        [[nodiscard]] vk::DescriptorSet  allocateSet(Slot &slot, vk::DescriptorSetLayout layout);
+        [[nodiscard]] vk::DescriptorPool createPool() const;
+        [[nodiscard]] ComputeBuffer     &allocateScratch(Slot &slot, vk::DeviceSize size, ComputeMemory memory);
+        void                             discard(uint32_t slot);
+        void                             readBytes(const ComputeBuffer &buffer, std::span<std::byte> data);
+    };
+
+    enum class ReduceOp {
+        Add,
+        Min,
+        Max,
+    };
+
+    /**
+     *
+     * Reduction, exclusive prefix sum, stream compaction and radix sort on storage buffers, recorded into a ComputeBatch. Kernels are compiled from GLSL on first use.
+     *
+     * They work on tiles held in shared memory, each workgroup of 256 threads reducing or scanning 2048 elements, so large inputs take few passes: a scan of 2^24
+     * elements is three levels. Temporaries are scratch buffers of the batch. Thread safe.
+     *
+     */
+    class ComputePrimitives final {
+      public:
+        ComputePrimitives(const std::shared_ptr<GContext> &gc, ShaderCompiler &shaders);
+        ~ComputePrimitives();
+
+        ComputePrimitives(const ComputePrimitives &)            = delete;
+        ComputePrimitives &operator=(const ComputePrimitives &) = delete;
+
+        /**
+         * Writes op over the first count elements of input (all by default) to result[0]. An empty input gives the identity of op. Sums of floats are summed in tiles,
+         * so they differ from a sequential sum by rounding.
+         */
+        template<typename T> void reduce(ComputeBatch &batch, const DeviceBuffer<T> &input, const DeviceBuffer<T> &result, ReduceOp op = ReduceOp::Add, size_t count = SIZE_MAX) {
+            static_assert(std::is_same_v<T, uint32_t> || std::is_same_v<T, int32_t> || std::is_same_v<T, float>, "Reductions are over uint32_t, int32_t or float");
+            reduceTiles(batch, input, result, getType<T>(), op, checkCount(input, count));
+        }
+
+        /**
+         * output[i] is the sum of input[0] to input[i - 1] (wrapping around), for the first count elements. output may be input.
+         */
+        void exclusiveScan(ComputeBatch &batch, const DeviceBuffer<uint32_t> &input, const DeviceBuffer<uint32_t> &output, size_t count = SIZE_MAX);
+
+        /**
+         * Copies the values with a nonzero flag to the start of output, keeping their order, and writes how many there are to count[0].
+         */
+        void compact(ComputeBatch &batch, const DeviceBuffer<uint32_t> &values, const DeviceBuffer<uint32_t> &flags, const DeviceBuffer<uint32_t> &output,
+                     const DeviceBuffer<uint32_t> &count);
+
+        /**
+         * Sorts keys in place, ascending and stable, with values (if given) moved along. Only the low keyBits bits of the keys are compared, fewer bits take fewer
+         * passes of 4 bits each.
+         */
+        void radixSort(ComputeBatch &batch, const DeviceBuffer<uint32_t> &keys, const DeviceBuffer<uint32_t> *values = nullptr, uint32_t keyBits = 32);
+
+      private:
+        enum class ScalarType {
+            Uint,
+            Int,
+            Float,
+        };
+
+        std::shared_ptr<GContext> m_GC;
+        ShaderCompiler           &m_Shaders;
+
+        std::mutex                                                      m_Mutex;
+        std::unordered_map<std::string, std::unique_ptr<ComputeKernel>> m_Kernels;
+
+        template<typename T> static constexpr ScalarType getType() {
+            if constexpr (std::is_same_v<T, float>)
+                return ScalarType::Float;
+            else if constexpr (std::is_same_v<T, int32_t>)
+                return ScalarType::Int;
+            else
+                return ScalarType::Uint;
+        }
+
+        template<typename T> static uint32_t checkCount(const DeviceBuffer<T> &buffer, size_t count) {
+            count = std::min(count, buffer.size());
+            if (count > UINT32_MAX)
+                throw std::runtime_error("Compute primitives take at most 2^32 - 1 elements");
+            return static_cast<uint32_t>(count);
+        }
+
+        const ComputeKernel &getKernel(const std::string &name, std::string_view code, uint32_t bufferCount, const std::vector<std::pair<std::string, std::string>> &defines);
+
+        void reduceTiles(ComputeBatch &batch, const ComputeBinding &input, const ComputeBinding &result, ScalarType type, ReduceOp op, uint32_t count);
+
+        // scans count elements from input to output, level by level through scratch buffers. With predicate, input != 0 is scanned instead of input
+        void scan(ComputeBatch &batch, const ComputeBinding &input, const ComputeBinding &output, uint32_t count, bool predicate);
+
+        // one workgroup per tile, spread over x and y
+        void dispatchTiles(ComputeBatch &batch, const ComputeKernel &kernel, std::initializer_list<ComputeBinding> buffers, uint32_t count, uint32_t tiles,
+                           uint32_t shift = 0) const;
+    };
+
+} // namespace neuron::graphics
@@ -0,0 +1,546 @@
+#include "culling.hpp"
+
+#include "neuron/utils/profiler.hpp"
+
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace neuron::graphics {
+
+    static constexpr std::string_view CULL_COMMON = R"(#version 450
+layout(local_size_x = 64) in;
+
+struct Instance {
+    vec4 sphere;
+    uint batch;
+    uint padding0;
+    uint padding1;
+    uint padding2;
+};
+
+struct Batch {
+    uint indexCount;
+    uint firstIndex;
+    int  vertexOffset;
+    uint firstInstance;
+};
+
+struct Command {
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int  vertexOffset;
+    uint firstInstance;
+};
+
+layout(set = 0, binding = 0) uniform View {
+    mat4  view;
+    mat4  projection;
+    vec4  planes[6];
+    uvec4 counts; // instances, batches, Hi-Z levels
+    vec4  hiZ;    // width, height, near plane
+};
+
+layout(set = 0, binding = 1, std430) readonly buffer Instances { Instance instances[]; };
+layout(set = 0, binding = 2, std430) readonly buffer Batches { Batch batches[]; };
+layout(set = 0, binding = 3, std430) buffer Counters { uint counters[]; };
+layout(set = 0, binding = 4, std430) writeonly buffer Visible { uint visible[]; };
+layout(set = 0, binding = 5, std430) writeonly buffer Commands { Command commands[]; };
+layout(set = 0, binding = 6, std430) buffer Count { uint drawCount; };
+)";
+
+    static constexpr std::string_view CULL_MAIN = R"(
+#ifdef OCCLUSION
+layout(set = 0, binding = 7) uniform sampler2D pyramid;
+
+bool isOccluded(vec3 center, float radius) {
+    vec3 c = (view * vec4(center, 1.0)).xyz;
+
+    // spheres reaching past the near plane don't project to a bounded rectangle
+    if (-c.z - radius <= hiZ.z)
+        return false;
+
+    // the screen rectangle and nearest depth of the view space box around the sphere
+    vec2  lo      = vec2(1e30);
+    vec2  hi      = vec2(-1e30);
+    float nearest = 1.0;
+    for (int i = 0; i < 8; i++) {
+        vec3 corner = c + radius * vec3((i & 1) != 0 ? 1.0 : -1.0, (i & 2) != 0 ? 1.0 : -1.0, (i & 4) != 0 ? 1.0 : -1.0);
+        vec4 clip   = projection * vec4(corner, 1.0);
+        vec3 ndc    = clip.xyz / clip.w;
+        lo          = min(lo, ndc.xy);
+        hi          = max(hi, ndc.xy);
+        nearest     = min(nearest, ndc.z);
+    }
+
+    // the level where the rectangle is at most one texel wide, so it touches at most 2x2 texels
+    vec2 uvLo  = clamp(lo * 0.5 + 0.5, 0.0, 1.0);
+    vec2 uvHi  = clamp(hi * 0.5 + 0.5, 0.0, 1.0);
+    vec2 size  = (uvHi - uvLo) * hiZ.xy;
+    int  level = clamp(int(ceil(log2(max(max(size.x, size.y), 1.0)))), 0, int(counts.z) - 1);
+
+    ivec2 levelSize = textureSize(pyramid, level);
+    ivec2 a         = min(ivec2(uvLo * vec2(levelSize)), levelSize - 1);
+    ivec2 b         = min(ivec2(uvHi * vec2(levelSize)), levelSize - 1);
+    float farthest  = max(max(texelFetch(pyramid, a, level).r, texelFetch(pyramid, ivec2(b.x, a.y), level).r),
+                          max(texelFetch(pyramid, ivec2(a.x, b.y), level).r, texelFetch(pyramid, b, level).r));
+    return nearest > farthest;
+}
+#endif
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= counts.x)
+        return;
+
+    Instance instance = instances[index];
+    vec3     center   = instance.sphere.xyz;
+    float    radius   = instance.sphere.w;
+    for (int i = 0; i < 6; i++) {
+        if (dot(planes[i].xyz, center) + planes[i].w < -radius)
+            return;
+    }
+
+#ifdef OCCLUSION
+    if (isOccluded(center, radius))
+        return;
+#endif
+
+    uint slot = atomicAdd(counters[instance.batch], 1u);
+    visible[batches[instance.batch].firstInstance + slot] = index;
+}
+)";
+
+    static constexpr std::string_view COMPACT_MAIN = R"(
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= counts.y)
+        return;
+
+    uint  instanceCount = counters[index];
+    Batch batch         = batches[index];
+#ifdef KEEP_EMPTY_BATCHES
+    commands[index] = Command(batch.indexCount, instanceCount, batch.firstIndex, batch.vertexOffset, batch.firstInstance);
+#else
+    if (instanceCount == 0)
+        return;
+
+    commands[atomicAdd(drawCount, 1u)] = Command(batch.indexCount, instanceCount, batch.firstIndex, batch.vertexOffset, batch.firstInstance);
+#endif
+}
+)";
+
+    static constexpr std::string_view HIZ_SHADER = R"(#version 450
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(set = 0, binding = 0) uniform sampler2D source;
+layout(set = 0, binding = 1, r32f) uniform writeonly image2D destination;
+
+layout(push_constant) uniform Sizes {
+    ivec2 sourceSize;
+    ivec2 destinationSize;
+};
+
+void main() {
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(texel, destinationSize)))
+        return;
+
+    // every source texel this one overlaps, up to 3x3 where the source size is odd, so each level stays conservative
+    ivec2 first = texel * sourceSize / destinationSize;
+    ivec2 last  = ((texel + 1) * sourceSize + destinationSize - 1) / destinationSize;
+    float depth = 0.0;
+    for (int y = first.y; y < last.y; y++) {
+        for (int x = first.x; x < last.x; x++)
+            depth = max(depth, texelFetch(source, ivec2(x, y), 0).r);
+    }
+    imageStore(destination, texel, vec4(depth));
+}
+)";
+
+    constexpr uint32_t CULL_GROUP_SIZE = 64;
+    constexpr uint32_t HIZ_GROUP_SIZE  = 8;
+
+    // the View block of the shaders, std140
+    struct CullUniforms {
+        glm::mat4                view;
+        glm::mat4                projection;
+        std::array<glm::vec4, 6> planes;
+        glm::uvec4               counts;
+        glm::vec4                hiZ;
+    };
+
+    std::array<glm::vec4, 6> extractFrustumPlanes(const glm::mat4 &viewProjection) {
+        const auto row = [&](int i) { return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]); };
+
+        // clip space is -w <= x, y <= w and 0 <= z <= w
+        std::array<glm::vec4, 6> planes = {row(3) + row(0), row(3) - row(0), row(3) + row(1), row(3) - row(1), row(2), row(3) - row(2)};
+        for (glm::vec4 &plane : planes)
+            plane /= glm::length(glm::vec3(plane));
+        return planes;
+    }
+
+    static ComputePipelineDesc cullShader(const char *name, std::string_view main, vk::PipelineLayout layout, std::vector<std::pair<std::string, std::string>> defines) {
+        return {.shader = {.name = name, .code = std::string(CULL_COMMON) + std::string(main), .stage = ShaderStage::Compute, .defines = std::move(defines)}, .layout = layout};
+    }
+
+    GpuCuller::GpuCuller(const std::shared_ptr<GContext> &gc, PipelineManager &pipelines, const CullerSettings &settings)
+        : m_GC(gc), m_Settings(settings),
+          m_Descriptors(gc, {.framesInFlight    = settings.framesInFlight,
+                             .setsPerPool       = 64,
+                             .descriptorsPerSet = {{vk::DescriptorType::eUniformBuffer, 1},
+                                                   {vk::DescriptorType::eStorageBuffer, 6},
+                                                   {vk::DescriptorType::eCombinedImageSampler, 1}}}),
+          m_HiZDescriptors(gc, {.framesInFlight    = settings.framesInFlight,
+                                .setsPerPool       = 16,
+                                .descriptorsPerSet = {{vk::DescriptorType::eCombinedImageSampler, 1}, {vk::DescriptorType::eStorageImage, 1}}}) {
+        const vk::Device &device = gc->getDevice();
+
+        if ((m_Settings.maxInstances + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE > gc->getProperties().limits.maxComputeWorkGroupCount[0]) {
+            throw std::runtime_error("maxInstances exceeds what one culling dispatch can cover");
+        }
+
+        m_PrimaryFamily = gc->getQueueFamily(QueueType::Primary).value();
+        m_ComputeFamily = m_PrimaryFamily;
+        m_IndirectCount = gc->getEnabledFeatures().vulkan12.drawIndirectCount == VK_TRUE;
+
+        // GContext creates a queue on the dedicated compute family when timeline semaphores are there to synchronize with it
+        if (gc->supportsTimelineSemaphores()) {
+            m_ComputeFamily = gc->getQueueFamily(QueueType::Compute).value_or(m_PrimaryFamily);
+            m_ComputeQueue  = m_ComputeFamily == m_PrimaryFamily ? gc->getPrimaryQueue() : gc->getQueue(QueueType::Compute).value();
+
+            vk::SemaphoreTypeCreateInfo timelineType(vk::SemaphoreType::eTimeline, 0);
+            m_Timeline = device.createSemaphore(vk::SemaphoreCreateInfo({}, &timelineType));
+        }
+
+        std::array<vk::DescriptorSetLayoutBinding, 8> cullBindings;
+        cullBindings[0] = vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eCompute);
+        for (uint32_t binding = 1; binding < 7; binding++)
+            cullBindings[binding] = vk::DescriptorSetLayoutBinding(binding, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute);
+        cullBindings[7] = vk::DescriptorSetLayoutBinding(7, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eCompute);
+
+        m_CullSetLayout = device.createDescriptorSetLayout(vk::DescriptorSetLayoutCreateInfo({}, cullBindings));
+        m_CullLayout    = device.createPipelineLayout(vk::PipelineLayoutCreateInfo({}, m_CullSetLayout));
+
+        const std::array hiZBindings = {vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eCompute),
+                                        vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eStorageImage, 1, vk::ShaderStageFlagBits::eCompute)};
+        const vk::PushConstantRange hiZSizes(vk::ShaderStageFlagBits::eCompute, 0, sizeof(int32_t) * 4);
+
+        m_HiZSetLayout = device.createDescriptorSetLayout(vk::DescriptorSetLayoutCreateInfo({}, hiZBindings));
+        m_HiZLayout    = device.createPipelineLayout(vk::PipelineLayoutCreateInfo({}, m_HiZSetLayout, hiZSizes));
+
+        // without drawIndirectCount every batch gets a command, so the draw count is always batchCount
+        std::vector<std::pair<std::string, std::string>> compactDefines;
+        if (!m_IndirectCount)
+            compactDefines.emplace_back("KEEP_EMPTY_BATCHES", "1");
+
+        m_Cull          = pipelines.get(cullShader("cull.comp", CULL_MAIN, m_CullLayout, {}));
+        m_CullOcclusion = pipelines.get(cullShader("cull_occlusion.comp", CULL_MAIN, m_CullLayout, {{"OCCLUSION", "1"}}));
+        m_Compact       = pipelines.get(cullShader("cull_compact.comp", COMPACT_MAIN, m_CullLayout, std::move(compactDefines)));
+        m_HiZ = pipelines.get(ComputePipelineDesc{.shader = {.name = "hiz.comp", .code = std::string(HIZ_SHADER), .stage = ShaderStage::Compute}, .layout = m_HiZLayout});
+
+        m_Sampler = device.createSampler(vk::SamplerCreateInfo({}, vk::Filter::eNearest, vk::Filter::eNearest, vk::SamplerMipmapMode::eNearest,
+                                                               vk::SamplerAddressMode::eClampToEdge, vk::SamplerAddressMode::eClampToEdge, vk::SamplerAddressMode::eClampToEdge));
+
+        // the outputs can be copied out, for debugging and tests
+        using Usage = vk::BufferUsageFlagBits;
+
+        const vk::BufferUsageFlags output      = Usage::eStorageBuffer | Usage::eTransferSrc;
+        const vk::DeviceSize       commandSize = sizeof(vk::DrawIndexedIndirectCommand);
+        const auto                 deviceLocal = vk::MemoryPropertyFlagBits::eDeviceLocal;
+        for (uint32_t i = 0; i < std::max(m_Settings.framesInFlight, 1u); i++) {
+            Frame &frame   = m_Frames.emplace_back();
+            frame.uniforms = createBuffer(sizeof(CullUniforms), Usage::eUniformBuffer, vk::MemoryPropertyFlagBits::eHostVisible);
+            frame.counters = createBuffer(m_Settings.maxBatches * sizeof(uint32_t), Usage::eStorageBuffer | Usage::eTransferDst, deviceLocal);
+            frame.visible  = createBuffer(m_Settings.maxInstances * sizeof(uint32_t), output | Usage::eVertexBuffer, deviceLocal);
+            frame.commands = createBuffer(m_Settings.maxBatches * commandSize, output | Usage::eIndirectBuffer, deviceLocal);
+            frame.count    = createBuffer(sizeof(uint32_t), output | Usage::eIndirectBuffer | Usage::eTransferDst, deviceLocal);
+
+            if (m_Timeline) {
+                frame.pool = device.createCommandPool(vk::CommandPoolCreateInfo(vk::CommandPoolCreateFlagBits::eTransient, m_ComputeFamily));
+                frame.cmd  = device.allocateCommandBuffers(vk::CommandBufferAllocateInfo(frame.pool, vk::CommandBufferLevel::ePrimary, 1)).front();
+            }
+        }
+    }
+
+    GpuCuller::~GpuCuller() {
+        const vk::Device &device = m_GC->getDevice();
+
+        // async submits may still be running
+        if (m_TimelineValue > 0) {
+            (void)device.waitSemaphores(vk::SemaphoreWaitInfo({}, m_Timeline, m_TimelineValue), std::numeric_limits<uint64_t>::max());
+        }
+
+        for (Frame &frame : m_Frames) {
+            m_GC->getAllocator().destroy(frame.uniforms);
+            m_GC->getAllocator().destroy(frame.counters);
+            m_GC->getAllocator().destroy(frame.visible);
+            m_GC->getAllocator().destroy(frame.commands);
+            m_GC->getAllocator().destroy(frame.count);
+            if (frame.pool)
+                device.destroyCommandPool(frame.pool);
+        }
+        destroyPyramids();
+
+        device.destroySampler(m_Sampler);
+        device.destroyPipelineLayout(m_HiZLayout);
+        device.destroyDescriptorSetLayout(m_HiZSetLayout);
+        device.destroyPipelineLayout(m_CullLayout);
+        device.destroyDescriptorSetLayout(m_CullSetLayout);
+        if (m_Timeline)
+            device.destroySemaphore(m_Timeline);
+    }
+
+    void GpuCuller::record(vk::CommandBuffer cmd, uint32_t frameIndex, const CullInputs &inputs, const CullView &view) {
+        recordPasses(cmd, frameIndex, inputs, view);
+
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, getWaitStages(), {},
+                            vk::MemoryBarrier(vk::AccessFlagBits::eShaderWrite,
+                                              vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eVertexAttributeRead),
+                            {}, {});
+    }
+
+    uint64_t GpuCuller::submitAsync(uint32_t frameIndex, const CullInputs &inputs, const CullView &view, std::span<const CullWait> waits) {
+        if (!m_Timeline) {
+            throw std::runtime_error("Async culling needs timeline semaphore support");
+        }
+        if (frameIndex >= m_Frames.size()) {
+            throw std::runtime_error("Frame index out of range for this culler");
+        }
+
+        const vk::Device &device = m_GC->getDevice();
+        Frame            &frame  = m_Frames[frameIndex];
+
+        // long done when the caller waited for the frame that last used this slot, as it should have
+        if (frame.submitted > 0) {
+            (void)device.waitSemaphores(vk::SemaphoreWaitInfo({}, m_Timeline, frame.submitted), std::numeric_limits<uint64_t>::max());
+        }
+
+        device.resetCommandPool(frame.pool);
+        frame.cmd.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+        recordPasses(frame.cmd, frameIndex, inputs, view);
+        frame.cmd.end();
+
+        std::vector<vk::Semaphore>          semaphores;
+        std::vector<uint64_t>               values;
+        std::vector<vk::PipelineStageFlags> stages;
+        for (const CullWait &wait : waits) {
+            semaphores.push_back(wait.semaphore);
+            values.push_back(wait.value);
+            stages.push_back(wait.stages);
+        }
+
+        // the semaphore makes the shader writes available to whatever waits on it, no release barrier needed with concurrent buffers
+        frame.submitted = ++m_TimelineValue;
+        vk::TimelineSemaphoreSubmitInfo timelineInfo(values, frame.submitted);
+        m_GC->submit(m_ComputeQueue, vk::SubmitInfo(semaphores, stages, frame.cmd, m_Timeline, &timelineInfo));
+        return frame.submitted;
+    }
+
+    void GpuCuller::recordPasses(vk::CommandBuffer cmd, uint32_t frameIndex, const CullInputs &inputs, const CullView &view) {
+        NEURON_PROFILE_SCOPE("GpuCuller::record");
+        if (frameIndex >= m_Frames.size()) {
+            throw std::runtime_error("Frame index out of range for this culler");
+        }
+        if (inputs.instanceCount > m_Settings.maxInstances || inputs.batchCount > m_Settings.maxBatches) {
+            throw std::runtime_error("More instances or batches than the culler was created for");
+        }
+
+        Frame &frame     = m_Frames[frameIndex];
+        frame.batchCount = inputs.batchCount;
+        m_Descriptors.beginFrame(frameIndex);
+
+        const bool         occlusion = view.occlusion && m_LatestHiZ.has_value();
+        const CullUniforms uniforms{
+            .view       = view.view,
+            .projection = view.projection,
+            .planes     = extractFrustumPlanes(view.projection * view.view),
+            .counts     = {inputs.instanceCount, inputs.batchCount, m_HiZLevels, 0},
+            .hiZ        = {static_cast<float>(m_HiZExtent.width), static_cast<float>(m_HiZExtent.height), view.zNear, 0.f},
+        };
+        std::memcpy(frame.uniforms.allocation.mapped, &uniforms, sizeof(uniforms));
+        m_GC->getAllocator().flush(frame.uniforms.allocation);
+
+        const vk::DescriptorSet        set = m_Descriptors.allocate(m_CullSetLayout);
+        const vk::DescriptorBufferInfo uniformInfo(frame.uniforms.buffer, 0, VK_WHOLE_SIZE);
+        const vk::DescriptorBufferInfo instanceInfo(inputs.instances, 0, VK_WHOLE_SIZE);
+        const vk::DescriptorBufferInfo batchInfo(inputs.batches, 0, VK_WHOLE_SIZE);
+        const vk::DescriptorBufferInfo counterInfo(frame.counters.buffer, 0, VK_WHOLE_SIZE);
+        const vk::DescriptorBufferInfo visibleInfo(frame.visible.buffer, 0, VK_WHOLE_SIZE);
+        const vk::DescriptorBufferInfo commandInfo(frame.commands.buffer, 0, VK_WHOLE_SIZE);
+        const vk::DescriptorBufferInfo countInfo(frame.count.buffer, 0, VK_WHOLE_SIZE);
+
+        std::vector<vk::WriteDescriptorSet> writes = {
+            vk::WriteDescriptorSet(set, 0, 0, vk::DescriptorType::eUniformBuffer, {}, uniformInfo),
+            vk::WriteDescriptorSet(set, 1, 0, vk::DescriptorType::eStorageBuffer, {}, instanceInfo),
+            vk::WriteDescriptorSet(set, 2, 0, vk::DescriptorType::eStorageBuffer, {}, batchInfo),
+            vk::WriteDescriptorSet(set, 3, 0, vk::DescriptorType::eStorageBuffer, {}, counterInfo),
+            vk::WriteDescriptorSet(set, 4, 0, vk::DescriptorType::eStorageBuffer, {}, visibleInfo),
+            vk::WriteDescriptorSet(set, 5, 0, vk::DescriptorType::eStorageBuffer, {}, commandInfo),
+            vk::WriteDescriptorSet(set, 6, 0, vk::DescriptorType::eStorageBuffer, {}, countInfo),
+        };
+
+        // the pipeline without occlusion never reads binding 7, so it may stay unwritten
+        vk::DescriptorImageInfo pyramidInfo;
+        if (occlusion) {
+            pyramidInfo = vk::DescriptorImageInfo(m_Sampler, m_Pyramids[*m_LatestHiZ].view, vk::ImageLayout::eGeneral);
+            writes.emplace_back(set, 7, 0, vk::DescriptorType::eCombinedImageSampler, pyramidInfo);
+        }
+        m_GC->getDevice().updateDescriptorSets(writes, {});
+
+        if (inputs.batchCount > 0)
+            cmd.fillBuffer(frame.counters.buffer, 0, inputs.batchCount * sizeof(uint32_t), 0);
+        cmd.fillBuffer(frame.count.buffer, 0, sizeof(uint32_t), 0);
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {},
+                            vk::MemoryBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite), {}, {});
+
+        cmd.bindDescriptorSets(vk::PipelineBindPoint::eCompute, m_CullLayout, 0, set, {});
+        cmd.bindPipeline(vk::PipelineBindPoint::eCompute, occlusion ? m_CullOcclusion : m_Cull);
+        if (inputs.instanceCount > 0)
+            cmd.dispatch((inputs.instanceCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {},
+                            vk::MemoryBarrier(vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite), {}, {});
+
+        cmd.bindPipeline(vk::PipelineBindPoint::eCompute, m_Compact);
+        if (inputs.batchCount > 0)
+            cmd.dispatch((inputs.batchCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+    }
+
+    void GpuCuller::buildHiZ(vk::CommandBuffer cmd, uint32_t frameIndex, vk::ImageView depth, vk::ImageLayout layout, vk::Extent2D extent) {
+        NEURON_PROFILE_SCOPE("GpuCuller::buildHiZ");
+        if (frameIndex >= m_Frames.size()) {
+            throw std::runtime_error("Frame index out of range for this culler");
+        }
+        if (extent != m_HiZExtent) {
+            createPyramids(extent);
+        }
+
+        const vk::Device &device  = m_GC->getDevice();
+        const Pyramid    &pyramid = m_Pyramids[frameIndex];
+
+        // its own pools, so culling the same frame doesn't reset the sets bound here
+        m_HiZDescriptors.beginFrame(frameIndex);
+
+        // every level is rewritten, the old contents can go
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {}, {}, {},
+                            vk::ImageMemoryBarrier({}, vk::AccessFlagBits::eShaderWrite, vk::ImageLayout::eUndefined, vk::ImageLayout::eGeneral, VK_QUEUE_FAMILY_IGNORED,
+                                                   VK_QUEUE_FAMILY_IGNORED, pyramid.image.image, {vk::ImageAspectFlagBits::eColor, 0, m_HiZLevels, 0, 1}));
+
+        cmd.bindPipeline(vk::PipelineBindPoint::eCompute, m_HiZ);
+        vk::Extent2D source = extent;
+        for (uint32_t level = 0; level < m_HiZLevels; level++) {
+            const vk::Extent2D destination = level == 0 ? extent : vk::Extent2D(std::max(source.width / 2, 1u), std::max(source.height / 2, 1u));
+
+            const vk::DescriptorSet       set = m_HiZDescriptors.allocate(m_HiZSetLayout);
+            const vk::DescriptorImageInfo sourceInfo(m_Sampler, level == 0 ? depth : pyramid.levels[level - 1], level == 0 ? layout : vk::ImageLayout::eGeneral);
+            const vk::DescriptorImageInfo destinationInfo({}, pyramid.levels[level], vk::ImageLayout::eGeneral);
+            device.updateDescriptorSets({vk::WriteDescriptorSet(set, 0, 0, vk::DescriptorType::eCombinedImageSampler, sourceInfo),
+                                         vk::WriteDescriptorSet(set, 1, 0, vk::DescriptorType::eStorageImage, destinationInfo)},
+                                        {});
+
+            const std::array<int32_t, 4> sizes = {static_cast<int32_t>(source.width), static_cast<int32_t>(source.height), static_cast<int32_t>(destination.width),
+                                                  static_cast<int32_t>(destination.height)};
+            cmd.bindDescriptorSets(vk::PipelineBindPoint::eCompute, m_HiZLayout, 0, set, {});
+            cmd.pushConstants(m_HiZLayout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(sizes), sizes.data());
+            cmd.dispatch((destination.width + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE, (destination.height + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE, 1);
+
+            // for the next level, and after the last one for the culling
+            cmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {},
+                                vk::MemoryBarrier(vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eShaderRead), {}, {});
+            source = destination;
+        }
+
+        m_LatestHiZ = frameIndex;
+    }
+
+    void GpuCuller::draw(vk::CommandBuffer cmd, uint32_t frameIndex) const {
+        if (frameIndex >= m_Frames.size()) {
+            throw std::runtime_error("Frame index out of range for this culler");
+        }
+
+        const Frame   &frame  = m_Frames[frameIndex];
+        const uint32_t stride = sizeof(vk::DrawIndexedIndirectCommand);
+        if (m_IndirectCount) {
+            cmd.drawIndexedIndirectCount(frame.commands.buffer, 0, frame.count.buffer, 0, frame.batchCount, stride);
+        } else if (m_GC->getEnabledFeatures().core.multiDrawIndirect) {
+            cmd.drawIndexedIndirect(frame.commands.buffer, 0, frame.batchCount, stride);
+        } else {
+            for (uint32_t batch = 0; batch < frame.batchCount; batch++)
+                cmd.drawIndexedIndirect(frame.commands.buffer, batch * stride, 1, stride);
+        }
+    }
+
+    AllocatedBuffer GpuCuller::createBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags required, vk::MemoryPropertyFlags preferred) const {
+        const std::vector<uint32_t> families = getFamilies();
+
+        vk::BufferCreateInfo createInfo({}, size, usage, vk::SharingMode::eExclusive);
+        if (families.size() > 1) {
+            createInfo.setSharingMode(vk::SharingMode::eConcurrent).setQueueFamilyIndices(families);
+        }
+        return m_GC->getAllocator().createBuffer(createInfo, required, preferred);
+    }
+
+    vk::Buffer GpuCuller::getVisibleBuffer(uint32_t frameIndex) const {
+        return m_Frames.at(frameIndex).visible.buffer;
+    }
+
+    vk::Buffer GpuCuller::getCommandBuffer(uint32_t frameIndex) const {
+        return m_Frames.at(frameIndex).commands.buffer;
+    }
+
+    vk::Buffer GpuCuller::getCountBuffer(uint32_t frameIndex) const {
+        return m_Frames.at(frameIndex).count.buffer;
+    }
+
+    void GpuCuller::createPyramids(vk::Extent2D extent) {
+        destroyPyramids();
+
+        const vk::Device           &device   = m_GC->getDevice();
+        const std::vector<uint32_t> families = getFamilies();
+
+        m_HiZExtent = extent;
+        m_HiZLevels = static_cast<uint32_t>(std::bit_width(std::max(extent.width, extent.height)));
+
+        for (size_t i = 0; i < m_Frames.size(); i++) {
+            vk::ImageCreateInfo createInfo({}, vk::ImageType::e2D, vk::Format::eR32Sfloat, vk::Extent3D(extent, 1), m_HiZLevels, 1, vk::SampleCountFlagBits::e1,
+                                           vk::ImageTiling::eOptimal, vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled, vk::SharingMode::eExclusive);
+            if (families.size() > 1) {
+                createInfo.setSharingMode(vk::SharingMode::eConcurrent).setQueueFamilyIndices(families);
+            }
+
+            Pyramid &pyramid = m_Pyramids.emplace_back();
+            pyramid.image    = m_GC->getAllocator().createImage(createInfo, vk::MemoryPropertyFlagBits::eDeviceLocal);
+            pyramid.view     = device.createImageView(vk::ImageViewCreateInfo({}, pyramid.image.image, vk::ImageViewType::e2D, vk::Format::eR32Sfloat,
+                                                                              STANDARD_COMPONENT_MAPPING, {vk::ImageAspectFlagBits::eColor, 0, m_HiZLevels, 0, 1}));
+            for (uint32_t level = 0; level < m_HiZLevels; level++) {
+                pyramid.levels.push_back(device.createImageView(vk::ImageViewCreateInfo({}, pyramid.image.image, vk::ImageViewType::e2D, vk::Format::eR32Sfloat,
+                                                                                        STANDARD_COMPONENT_MAPPING, {vk::ImageAspectFlagBits::eColor, level, 1, 0, 1})));
+            }
+        }
+    }
+
+    void GpuCuller::destroyPyramids() {
+        const vk::Device &device = m_GC->getDevice();
+        for (Pyramid &pyramid : m_Pyramids) {
+            for (const vk::ImageView level : pyramid.levels)
+                device.destroyImageView(level);
+            device.destroyImageView(pyramid.view);
+            m_GC->getAllocator().destroy(pyramid.image);
+        }
+
+        m_Pyramids.clear();
+        m_HiZExtent = vk::Extent2D();
+        m_HiZLevels = 0;
+        m_LatestHiZ.reset();
+    }
+
+    std::vector<uint32_t> GpuCuller::getFamilies() const {
+        if (m_ComputeFamily == m_PrimaryFamily)
+            return {m_PrimaryFamily};
+        return {m_PrimaryFamily, m_ComputeFamily};
+    }
+
+} // namespace neuron::graphics
@@ -0,0 +1,215 @@
+#pragma once
+
+#include "neuron/graphics/descriptors.hpp"
+#include "neuron/graphics/gcontext.hpp"
+#include "neuron/graphics/pipelines.hpp"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace neuron::graphics {
+
+    /**
+     * An instance's world space bounding sphere (xyz center, w radius) and the batch it is drawn with. Laid out as in the shader's std430 buffer.
+     */
+    struct CullInstance {
+        glm::vec4 sphere{0.f};
+        uint32_t  batch = 0;
+        uint32_t  padding[3]{};
+    };
+
+    /**
+     * A mesh drawn for the visible instances of this batch. The shader writes their instance indices to the visible buffer starting at firstInstance, so batches must
+     * reserve as many slots there as they have instances, without overlapping (as DrawBatch does).
+     */
+    struct CullBatch {
+        uint32_t indexCount    = 0;
+        uint32_t firstIndex    = 0;
+        int32_t  vertexOffset  = 0;
+        uint32_t firstInstance = 0;
+    };
+
+    /**
+     * Buffers the caller owns and keeps alive until the GPU is done with the frame. With a dedicated compute queue they are read there, see GpuCuller::createBuffer().
+     */
+    struct CullInputs {
+        vk::Buffer instances;
+        uint32_t   instanceCount = 0;
+        vk::Buffer batches;
+        uint32_t   batchCount = 0;
+    };
+
+    struct CullView {
+        glm::mat4 view{1.f};
+
+        /**
+         * A perspective projection with a [0, 1] depth range where larger is farther, as the Hi-Z pyramid is built for.
+         */
+        glm::mat4 projection{1.f};
+        float     zNear = 0.1f;
+
+        /**
+         * Also tests against the last pyramid buildHiZ() recorded, if there is one.
+         */
+        bool occlusion = false;
+    };
+
+    /**
+     * A semaphore the async submit waits for, e.g. the graphics work that built the Hi-Z pyramid or uploaded the instances. Binary semaphores ignore value.
+     */
+    struct CullWait {
+        vk::Semaphore          semaphore;
+        uint64_t               value  = 0;
+        vk::PipelineStageFlags stages = vk::PipelineStageFlagBits::eComputeShader;
+    };
+
+    struct CullerSettings {
+        uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+
+        /**
+         * Capacity of the output buffers every frame in flight has.
+         */
+        uint32_t maxInstances = 1 << 20;
+        uint32_t maxBatches   = 1 << 16;
+    };
+
+    /**
+     * The six planes (left, right, bottom, top, near, far) of a [0, 1] depth clip space frustum, normalized and pointing inwards, in the space viewProjection maps from.
+     */
+    [[nodiscard]] std::array<glm::vec4, 6> extractFrustumPlanes(const glm::mat4 &viewProjection);
+
+    /**
+     *
+     * Culls instances on the GPU and writes the indirect draws for the survivors, so the CPU never looks at per-instance visibility. A first dispatch tests every instance's
+     * bounding sphere against the frustum and, optionally, a Hi-Z pyramid of the previous frame's depth, and appends the visible ones to their batch's range of the visible
+     * buffer. A second dispatch compacts the batches with visible instances into VkDrawIndexedIndirectCommands and counts them for vkCmdDrawIndexedIndirectCount. The
+     * commands' order is unspecified, so all batches of one cull should use the same pipeline.
+     *
+     * Vertex shaders find their instance through the visible buffer: instances[visible[gl_InstanceIndex]].
+     *
+     * The passes are recorded into a graphics command buffer with record(), or submitted on their own with submitAsync(), to the dedicated compute queue where there is one
+     * so culling overlaps the previous frame's graphics work. Every frame in flight has its own outputs; the caller waits for a frame before reusing its slot as usual.
+     *
+     */
+    class GpuCuller final {
+      public:
+        GpuCuller(const std::shared_ptr<GContext> &gc, PipelineManager &pipelines, const CullerSettings &settings = {});
+        ~GpuCuller();
+
+        GpuCuller(const GpuCuller &)            = delete;
+        GpuCuller &operator=(const GpuCuller &) = delete;
+
+        /**
+         * Records the culling of the frame into cmd, which must go to the primary queue, and makes its results visible to indirect draws and vertex shaders.
+         *
+         * @throws std::runtime_error if the frame index or the counts are out of range.
+         */
+        void record(vk::CommandBuffer cmd, uint32_t frameIndex, const CullInputs &inputs, const CullView &view);
+
+        /**
+         * Submits the culling of the frame to the compute queue and returns the value getTimeline() reaches once it finished. The graphics submit that draws the frame waits
+         * for it at getWaitStages().
+         *
+         * @throws std::runtime_error without timeline semaphores, or if the frame index or the counts are out of range.
+         */
+        [[nodiscard]] uint64_t submitAsync(uint32_t frameIndex, const CullInputs &inputs, const CullView &view, std::span<const CullWait> waits = {});
+
+        /**
+         * Records the Hi-Z pyramid of a depth buffer into cmd, for the frames after this one to cull against. depth is a view of the depth aspect in layout, with the depth
+         * writes already made visible to compute shaders. Changing the extent recreates the pyramids, so the GPU must not use them anymore then (as after a swapchain resize).
+         */
+        void buildHiZ(vk::CommandBuffer cmd, uint32_t frameIndex, vk::ImageView depth, vk::ImageLayout layout, vk::Extent2D extent);
+
+        /**
+         * Draws the culled batches with the bound pipeline and index buffer. Without the drawIndirectCount feature every batch is drawn, those without visible instances
+         * with an instance count of 0.
+         */
+        void draw(vk::CommandBuffer cmd, uint32_t frameIndex) const;
+
+        /**
+         * Creates a buffer the compute queue and the primary queue can both use without ownership transfers.
+         */
+        [[nodiscard]] AllocatedBuffer createBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags required,
+                                                   vk::MemoryPropertyFlags preferred = {}) const;
+
+        [[nodiscard]] vk::Buffer getVisibleBuffer(uint32_t frameIndex) const;
+        [[nodiscard]] vk::Buffer getCommandBuffer(uint32_t frameIndex) const;
+        [[nodiscard]] vk::Buffer getCountBuffer(uint32_t frameIndex) const;
+
+        [[nodiscard]] inline vk::Semaphore getTimeline() const noexcept { return m_Timeline; }
+
+        [[nodiscard]] static constexpr vk::PipelineStageFlags getWaitStages() noexcept {
+            return vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexShader;
+        }
+
+        /**
+         * Whether submitAsync() goes to a dedicated compute queue rather than the primary one.
+         */
+        [[nodiscard]] inline bool isAsync() const noexcept { return m_ComputeFamily != m_PrimaryFamily; }
+
+        [[nodiscard]] inline bool supportsIndirectCount() const noexcept { return m_IndirectCount; }
+
+      private:
+        struct Frame {
+            AllocatedBuffer uniforms;
+            AllocatedBuffer counters;
+            AllocatedBuffer visible;
+            AllocatedBuffer commands;
+            AllocatedBuffer count;
+            uint32_t        batchCount = 0;
+
+            // submitAsync() only
+            vk::CommandPool   pool;
+            vk::CommandBuffer cmd;
+            uint64_t          submitted = 0;
+        };
+
+        struct Pyramid {
+            AllocatedImage             image;
+            vk::ImageView              view;
+            std::vector<vk::ImageView> levels;
+        };
+
+        std::shared_ptr<GContext> m_GC;
+        CullerSettings            m_Settings;
+
+        uint32_t m_PrimaryFamily = 0;
+        uint32_t m_ComputeFamily = 0;
+        bool     m_IndirectCount = false;
+
+        vk::DescriptorSetLayout m_CullSetLayout;
+        vk::PipelineLayout      m_CullLayout;
+        vk::Pipeline            m_Cull;
+        vk::Pipeline            m_CullOcclusion;
+        vk::Pipeline            m_Compact;
+
+        vk::DescriptorSetLayout m_HiZSetLayout;
+        vk::PipelineLayout      m_HiZLayout;
+        vk::Pipeline            m_HiZ;
+        vk::Sampler             m_Sampler;
+
+        FrameDescriptorAllocator m_Descriptors;
+        FrameDescriptorAllocator m_HiZDescriptors;
+        std::vector<Frame>       m_Frames;
+        std::vector<Pyramid>     m_Pyramids;
+        vk::Extent2D             m_HiZExtent;
+        uint32_t                 m_HiZLevels = 0;
+        std::optional<uint32_t>  m_LatestHiZ;
+
+        vk::Queue     m_ComputeQueue;
+        vk::Semaphore m_Timeline;
+        uint64_t      m_TimelineValue = 0;
+
+        void recordPasses(vk::CommandBuffer cmd, uint32_t frameIndex, const CullInputs &inputs, const CullView &view);
+        void createPyramids(vk::Extent2D extent);
+        void destroyPyramids();
+
+        [[nodiscard]] std::vector<uint32_t> getFamilies() const;
+    };
+
+} // namespace neuron::graphics
@@ -0,0 +1,279 @@
+#include "descriptors.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace neuron::graphics {
+
+    constexpr std::array<vk::DescriptorType, BINDLESS_TYPE_COUNT> BINDLESS_DESCRIPTOR_TYPES = {
+        vk::DescriptorType::eCombinedImageSampler,
+        vk::DescriptorType::eStorageImage,
+        vk::DescriptorType::eStorageBuffer,
+    };
+
+    constexpr std::array<const char *, BINDLESS_TYPE_COUNT> BINDLESS_TYPE_NAMES = {"sampled image", "storage image", "storage buffer"};
+
+    static uint32_t clampCapacity(uint32_t requested, uint32_t limit, BindlessType type) {
+        if (requested > limit) {
+            spdlog::warn("Bindless {} array clamped from {} to {}, the device limit", BINDLESS_TYPE_NAMES[static_cast<uint32_t>(type)], requested, limit);
+            return limit;
+        }
+        return requested;
+    }
+
+    BindlessHeap::BindlessHeap(const std::shared_ptr<GContext> &gc, const BindlessSettings &settings) : m_GC(gc), m_Settings(settings) {
+        if (!gc->getFastPaths().descriptorIndexing) {
+            throw std::runtime_error("Bindless descriptors need descriptor indexing, runtime descriptor arrays and partially bound descriptors");
+        }
+
+        const auto &features = gc->getEnabledFeatures().vulkan12;
+        std::string missing;
+        if (!features.descriptorBindingSampledImageUpdateAfterBind)
+            missing += " descriptorBindingSampledImageUpdateAfterBind";
+        if (!features.descriptorBindingStorageImageUpdateAfterBind)
+            missing += " descriptorBindingStorageImageUpdateAfterBind";
+        if (!features.descriptorBindingStorageBufferUpdateAfterBind)
+            missing += " descriptorBindingStorageBufferUpdateAfterBind";
+        if (!features.descriptorBindingUpdateUnusedWhilePending)
+            missing += " descriptorBindingUpdateUnusedWhilePending";
+        if (!missing.empty()) {
+            throw std::runtime_error("Bindless descriptors need features that aren't enabled:" + missing);
+        }
+
+        // combined image samplers count against the sampler and the sampled image limits
+        const auto properties = gc->getGpu().getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceVulkan12Properties>().get<vk::PhysicalDeviceVulkan12Properties>();
+        const std::array<uint32_t, BINDLESS_TYPE_COUNT> limits = {
+            std::min({properties.maxDescriptorSetUpdateAfterBindSampledImages, properties.maxDescriptorSetUpdateAfterBindSamplers,
+                      properties.maxPerStageDescriptorUpdateAfterBindSampledImages, properties.maxPerStageDescriptorUpdateAfterBindSamplers}),
+            std::min(properties.maxDescriptorSetUpdateAfterBindStorageImages, properties.maxPerStageDescriptorUpdateAfterBindStorageImages),
+            std::min(properties.maxDescriptorSetUpdateAfterBindStorageBuffers, properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers),
+        };
+        const std::array<uint32_t, BINDLESS_TYPE_COUNT> requested = {settings.sampledImages, settings.storageImages, settings.storageBuffers};
+        for (uint32_t type = 0; type < BINDLESS_TYPE_COUNT; type++) {
+            m_Arrays[type].capacity = std::max(clampCapacity(requested[type], limits[type], static_cast<BindlessType>(type)), 1u);
+        }
+
+        // the arrays also share one per stage budget, which is scaled down proportionally if needed
+        uint64_t total = 0;
+        for (const auto &array : m_Arrays)
+            total += array.capacity;
+        if (total > properties.maxPerStageUpdateAfterBindResources) {
+            spdlog::warn("Bindless arrays scaled down to fit {} update-after-bind resources per stage", properties.maxPerStageUpdateAfterBindResources);
+            for (auto &array : m_Arrays)
+                array.capacity = std::max<uint32_t>(static_cast<uint32_t>(static_cast<uint64_t>(array.capacity) * properties.maxPerStageUpdateAfterBindResources / total), 1u);
+        }
+
+        std::array<vk::DescriptorSetLayoutBinding, BINDLESS_TYPE_COUNT> bindings;
+        std::array<vk::DescriptorBindingFlags, BINDLESS_TYPE_COUNT>     bindingFlags;
+        std::array<vk::DescriptorPoolSize, BINDLESS_TYPE_COUNT>         poolSizes;
+        for (uint32_t type = 0; type < BINDLESS_TYPE_COUNT; type++) {
+            bindings[type]     = vk::DescriptorSetLayoutBinding(type, BINDLESS_DESCRIPTOR_TYPES[type], m_Arrays[type].capacity, vk::ShaderStageFlagBits::eAll);
+            bindingFlags[type] = vk::DescriptorBindingFlagBits::ePartiallyBound | vk::DescriptorBindingFlagBits::eUpdateAfterBind |
+                                 vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending;
+            poolSizes[type] = vk::DescriptorPoolSize(BINDLESS_DESCRIPTOR_TYPES[type], m_Arrays[type].capacity);
+        }
+
+        const vk::Device &device = gc->getDevice();
+
+        const vk::DescriptorSetLayoutBindingFlagsCreateInfo flagsInfo(bindingFlags);
+        m_SetLayout = device.createDescriptorSetLayout(vk::DescriptorSetLayoutCreateInfo(vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool, bindings, &flagsInfo));
+        m_Pool      = device.createDescriptorPool(vk::DescriptorPoolCreateInfo(vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind, 1, poolSizes));
+        m_Set       = device.allocateDescriptorSets(vk::DescriptorSetAllocateInfo(m_Pool, m_SetLayout)).front();
+
+        const uint32_t              pushConstantSize = std::min(settings.pushConstantSize, gc->getProperties().limits.maxPushConstantsSize);
+        const vk::PushConstantRange pushConstants(vk::ShaderStageFlagBits::eAll, 0, pushConstantSize);
+
+        vk::PipelineLayoutCreateInfo layoutInfo({}, m_SetLayout);
+        if (pushConstantSize > 0)
+            layoutInfo.setPushConstantRanges(pushConstants);
+        m_PipelineLayout = device.createPipelineLayout(layoutInfo);
+    }
+
+    BindlessHeap::~BindlessHeap() {
+        const vk::Device &device = m_GC->getDevice();
+        device.destroyPipelineLayout(m_PipelineLayout);
+        device.destroyDescriptorPool(m_Pool);
+        device.destroyDescriptorSetLayout(m_SetLayout);
+    }
+
+    uint32_t BindlessHeap::registerSampledImage(vk::ImageView view, vk::Sampler sampler, vk::ImageLayout layout) {
+        const vk::DescriptorImageInfo info(sampler, view, layout);
+
+        std::lock_guard lock(m_Mutex);
+        const uint32_t  index = acquire(BindlessType::SampledImage);
+        write(BindlessType::SampledImage, index, &info, nullptr);
+        return index;
+    }
+
+    uint32_t BindlessHeap::registerStorageImage(vk::ImageView view, vk::ImageLayout layout) {
+        const vk::DescriptorImageInfo info({}, view, layout);
+
+        std::lock_guard lock(m_Mutex);
+        const uint32_t  index = acquire(BindlessType::StorageImage);
+        write(BindlessType::StorageImage, index, &info, nullptr);
+        return index;
+    }
+
+    uint32_t BindlessHeap::registerStorageBuffer(vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize range) {
+        const vk::DescriptorBufferInfo info(buffer, offset, range);
+
+        std::lock_guard lock(m_Mutex);
+        const uint32_t  index = acquire(BindlessType::StorageBuffer);
+        write(BindlessType::StorageBuffer, index, nullptr, &info);
+        return index;
+    }
+
+    void BindlessHeap::updateSampledImage(uint32_t index, vk::ImageView view, vk::Sampler sampler, vk::ImageLayout layout) {
+        const vk::DescriptorImageInfo info(sampler, view, layout);
+
+        std::lock_guard lock(m_Mutex);
+        write(BindlessType::SampledImage, index, &info, nullptr);
+    }
+
+    void BindlessHeap::updateStorageImage(uint32_t index, vk::ImageView view, vk::ImageLayout layout) {
+        const vk::DescriptorImageInfo info({}, view, layout);
+
+        std::lock_guard lock(m_Mutex);
+        write(BindlessType::StorageImage, index, &info, nullptr);
+    }
+
+    void BindlessHeap::updateStorageBuffer(uint32_t index, vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize range) {
+        const vk::DescriptorBufferInfo info(buffer, offset, range);
+
+        std::lock_guard lock(m_Mutex);
+        write(BindlessType::StorageBuffer, index, nullptr, &info);
+    }
+
+    void BindlessHeap::release(BindlessType type, uint32_t index) {
+        std::lock_guard lock(m_Mutex);
+        auto           &array = m_Arrays[static_cast<uint32_t>(type)];
+        if (index >= array.next || !array.live[index]) {
+            throw std::runtime_error("Releasing bindless index " + std::to_string(index) + " which isn't handed out");
+        }
+        array.live[index] = false;
+        array.retired.emplace_back(index, m_Frame);
+    }
+
+    void BindlessHeap::beginFrame() {
+        std::lock_guard lock(m_Mutex);
+        m_Frame++;
+
+        for (auto &array : m_Arrays) {
+            // released in frame f, the index may be used by command buffers until frame f + framesInFlight begins
+            const auto recycled = std::ranges::partition(array.retired, [this](const auto &entry) { return entry.second + m_Settings.framesInFlight > m_Frame; });
+            for (const auto &[index, frame] : recycled)
+                array.free.push_back(index);
+            array.retired.erase(recycled.begin(), recycled.end());
+        }
+    }
+
+    void BindlessHeap::bind(vk::CommandBuffer cmd, vk::PipelineBindPoint bindPoint, vk::PipelineLayout layout) const {
+        cmd.bindDescriptorSets(bindPoint, layout, 0, m_Set, {});
+    }
+
+    uint32_t BindlessHeap::getCapacity(BindlessType type) const noexcept { return m_Arrays[static_cast<uint32_t>(type)].capacity; }
+
+    uint32_t BindlessHeap::getUsedCount(BindlessType type) const {
+        std::lock_guard lock(m_Mutex);
+        const auto     &array = m_Arrays[static_cast<uint32_t>(type)];
+        return array.next - static_cast<uint32_t>(array.free.size());
+    }
+
+    uint32_t BindlessHeap::acquire(BindlessType type) {
+        auto &array = m_Arrays[static_cast<uint32_t>(type)];
+        if (!array.free.empty()) {
+            const uint32_t index = array.free.back();
+            array.free.pop_back();
+            array.live[index] = true;
+            return index;
+        }
+
+        if (array.next == array.capacity) {
+            throw std::runtime_error(std::string("The bindless ") + BINDLESS_TYPE_NAMES[static_cast<uint32_t>(type)] + " array is full");
+        }
+        array.live.push_back(true);
+        return array.next++;
+    }
+
+    void BindlessHeap::write(BindlessType type, uint32_t index, const vk::DescriptorImageInfo *image, const vk::DescriptorBufferInfo *buffer) {
+        const auto binding = static_cast<uint32_t>(type);
+        if (index >= m_Arrays[binding].capacity) {
+            throw std::runtime_error("Bindless index " + std::to_string(index) + " out of range");
+        }
+
+        const vk::WriteDescriptorSet write(m_Set, binding, index, 1, BINDLESS_DESCRIPTOR_TYPES[binding], image, buffer);
+        m_GC->getDevice().updateDescriptorSets(write, {});
+    }
+
+    FrameDescriptorAllocator::FrameDescriptorAllocator(const std::shared_ptr<GContext> &gc, const FrameDescriptorSettings &settings)
+        : m_GC(gc), m_Settings(settings), m_Frames(std::max(settings.framesInFlight, 1u)) {}
+
+    FrameDescriptorAllocator::~FrameDescriptorAllocator() {
+        for (const auto &frame : m_Frames) {
+            for (const auto pool : frame.pools) {
+                m_GC->getDevice().destroyDescriptorPool(pool);
+            }
+        }
+    }
+
+    void FrameDescriptorAllocator::beginFrame(uint32_t frameIndex) {
+        if (frameIndex >= m_Frames.size()) {
+            throw std::runtime_error("Frame index out of range for this descriptor allocator");
+        }
+
+        std::lock_guard lock(m_Mutex);
+        auto           &frame = m_Frames[frameIndex];
+
+        // frees every set of the pool at once, and keeps the pool's memory
+        for (uint32_t i = 0; i < std::min<size_t>(frame.current + 1, frame.pools.size()); i++) {
+            m_GC->getDevice().resetDescriptorPool(frame.pools[i]);
+        }
+        frame.current = 0;
+        m_FrameIndex  = frameIndex;
+    }
+
+    vk::DescriptorSet FrameDescriptorAllocator::allocate(vk::DescriptorSetLayout layout) {
+        std::lock_guard lock(m_Mutex);
+        auto           &frame = m_Frames[m_FrameIndex];
+
+        while (true) {
+            const bool created = frame.current == frame.pools.size();
+            if (created)
+                frame.pools.push_back(createPool());
+
+            const vk::DescriptorSetAllocateInfo info(frame.pools[frame.current], layout);
+            vk::DescriptorSet                   set;
+            const vk::Result                    result = m_GC->getDevice().allocateDescriptorSets(&info, &set);
+            if (result == vk::Result::eSuccess)
+                return set;
+
+            if (result != vk::Result::eErrorOutOfPoolMemory && result != vk::Result::eErrorFragmentedPool) {
+                throw std::runtime_error("Failed to allocate a descriptor set: " + vk::to_string(result));
+            }
+            if (created) {
+                throw std::runtime_error("Descriptor set doesn't fit in an empty pool, raise FrameDescriptorSettings::descriptorsPerSet");
+            }
+            frame.current++;
+        }
+    }
+
+    uint32_t FrameDescriptorAllocator::getPoolCount() const {
+        std::lock_guard lock(m_Mutex);
+        uint32_t        count = 0;
+        for (const auto &frame : m_Frames) {
+            count += static_cast<uint32_t>(frame.pools.size());
+        }
+        return count;
+    }
+
+    vk::DescriptorPool FrameDescriptorAllocator::createPool() const {
+        std::vector<vk::DescriptorPoolSize> sizes = m_Settings.descriptorsPerSet;
+        for (auto &size : sizes) {
+            size.descriptorCount *= m_Settings.setsPerPool;
+        }
+        return m_GC->getDevice().createDescriptorPool(vk::DescriptorPoolCreateInfo({}, m_Settings.setsPerPool, sizes));
+    }
+
+} // namespace neuron::graphics
@@ -0,0 +1,210 @@
+#pragma once
+
+#include "neuron/graphics/gcontext.hpp"
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace neuron::graphics {
+
+    /**
+     * The arrays of the bindless set, in binding order.
+     */
+    enum class BindlessType : uint32_t {
+        SampledImage,
+        StorageImage,
+        StorageBuffer,
+    };
+
+    constexpr uint32_t BINDLESS_TYPE_COUNT = 3;
+    constexpr uint32_t INVALID_BINDLESS    = UINT32_MAX;
+
+    struct BindlessSettings {
+        /**
+         * Array sizes, clamped to what the device allows for update-after-bind sets.
+         */
+        uint32_t sampledImages  = 1 << 16;
+        uint32_t storageImages  = 1 << 14;
+        uint32_t storageBuffers = 1 << 16;
+
+        /**
+         * How many beginFrame() calls a released index waits for before it is handed out again.
+         */
+        uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+
+        /**
+         * Size of the push constant range of getPipelineLayout(), for passing indices to shaders.
+         */
+        uint32_t pushConstantSize = 128;
+    };
+
+    /**
+     *
+     * One big descriptor set with an update-after-bind array per BindlessType, bound once per command buffer instead of per draw. Shaders index into it with indices
+     * passed in push constants or buffers:
+     *
+     *   layout(set = 0, binding = 0) uniform sampler2D textures[];
+     *   layout(set = 0, binding = 1, rgba8) uniform image2D images[];
+     *   layout(set = 0, binding = 2) buffer Buffers { uint data[]; } buffers[];
+     *
+     * Registering a resource writes its descriptor and returns its index, which stays the same until the resource is released. Released indices are recycled
+     * framesInFlight frames later, once no command buffer still in flight can use them. Slots are partially bound, so shaders must only touch indices they were given.
+     *
+     * Needs the descriptor indexing fast path and its update-after-bind features. All methods are thread safe.
+     *
+     */
+    class BindlessHeap final {
+      public:
+        /**
+         * @throws std::runtime_error if the device lacks descriptor indexing or update-after-bind for one of the arrays.
+         */
+        explicit BindlessHeap(const std::shared_ptr<GContext> &gc, const BindlessSettings &settings = {});
+        ~BindlessHeap();
+
+        BindlessHeap(const BindlessHeap &)            = delete;
+        BindlessHeap &operator=(const BindlessHeap &) = delete;
+
+        /**
+         * @throws std::runtime_error if the array is full.
+         */
+        [[nodiscard]] uint32_t registerSampledImage(vk::ImageView view, vk::Sampler sampler, vk::ImageLayout layout = vk::ImageLayout::eShaderReadOnlyOptimal);
+        [[nodiscard]] uint32_t registerStorageImage(vk::ImageView view, vk::ImageLayout layout = vk::ImageLayout::eGeneral);
+        [[nodiscard]] uint32_t registerStorageBuffer(vk::Buffer buffer, vk::DeviceSize offset = 0, vk::DeviceSize range = VK_WHOLE_SIZE);
+
+        /**
+         * Point an index at another resource, e.g. after a texture finished streaming in. Command buffers already recorded see the new descriptor if they haven't executed
+         * yet.
+         */
+        void updateSampledImage(uint32_t index, vk::ImageView view, vk::Sampler sampler, vk::ImageLayout layout = vk::ImageLayout::eShaderReadOnlyOptimal);
+        void updateStorageImage(uint32_t index, vk::ImageView view, vk::ImageLayout layout = vk::ImageLayout::eGeneral);
+        void updateStorageBuffer(uint32_t index, vk::Buffer buffer, vk::DeviceSize offset = 0, vk::DeviceSize range = VK_WHOLE_SIZE);
+
+        /**
+         * The index stays reserved until framesInFlight more frames began. The resource itself may be destroyed once the GPU is done with it.
+         *
+         * @throws std::runtime_error if the index isn't handed out, e.g. because it was released already.
+         */
+        void release(BindlessType type, uint32_t index);
+
+        /**
+         * Recycles the indices released long enough ago. Call once per frame, after waiting for the frame that last used this frame's resources.
+         */
+        void beginFrame();
+
+        /**
+         * Binds the set at set 0 of layout, which must have been created with getSetLayout() there, like getPipelineLayout().
+         */
+        void bind(vk::CommandBuffer cmd, vk::PipelineBindPoint bindPoint, vk::PipelineLayout layout) const;
+
+        [[nodiscard]] inline vk::DescriptorSetLayout getSetLayout() const noexcept { return m_SetLayout; }
+
+        [[nodiscard]] inline vk::DescriptorSet getSet() const noexcept { return m_Set; }
+
+        /**
+         * The heap at set 0 and a push constant range of pushConstantSize bytes for all stages.
+         */
+        [[nodiscard]] inline vk::PipelineLayout getPipelineLayout() const noexcept { return m_PipelineLayout; }
+
+        [[nodiscard]] uint32_t getCapacity(BindlessType type) const noexcept;
+
+        /**
+         * Indices currently handed out, released ones waiting to be recycled included.
+         */
+        [[nodiscard]] uint32_t getUsedCount(BindlessType type) const;
+
+      private:
+        struct Array {
+            uint32_t              capacity = 0;
+            uint32_t              next     = 0;
+            std::vector<uint32_t> free;
+
+            // per index below next, whether it is handed out and not released
+            std::vector<bool> live;
+
+            // index and the frame it was released in
+            std::vector<std::pair<uint32_t, uint64_t>> retired;
+        };
+
+        std::shared_ptr<GContext> m_GC;
+        BindlessSettings          m_Settings;
+
+        vk::DescriptorSetLayout m_SetLayout;
+        vk::DescriptorPool      m_Pool;
+        vk::DescriptorSet       m_Set;
+        vk::PipelineLayout      m_PipelineLayout;
+
+        mutable std::mutex                     m_Mutex;
+        std::array<Array, BINDLESS_TYPE_COUNT> m_Arrays;
+        uint64_t                               m_Frame = 0;
+
+        [[nodiscard]] uint32_t acquire(BindlessType type);
+        void                   write(BindlessType type, uint32_t index, const vk::DescriptorImageInfo *image, const vk::DescriptorBufferInfo *buffer);
+    };
+
+    struct FrameDescriptorSettings {
+        uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+
+        /**
+         * Sets per pool. Frames that need more get more pools, which stay around for later frames.
+         */
+        uint32_t setsPerPool = 1024;
+
+        /**
+         * Descriptors per set of each type; a pool holds setsPerPool times as many.
+         */
+        std::vector<vk::DescriptorPoolSize> descriptorsPerSet = {
+            {vk::DescriptorType::eUniformBuffer, 2},
+            {vk::DescriptorType::eUniformBufferDynamic, 1},
+            {vk::DescriptorType::eCombinedImageSampler, 4},
+            {vk::DescriptorType::eStorageBuffer, 2},
+            {vk::DescriptorType::eStorageImage, 1},
+        };
+    };
+
+    /**
+     *
+     * Hands out descriptor sets that live for one frame. Every frame in flight has its own pools, which beginFrame() resets in bulk instead of freeing sets one by one.
+     * For classic per-draw sets; see BindlessHeap for the alternative. All methods are thread safe.
+     *
+     */
+    class FrameDescriptorAllocator final {
+      public:
+        explicit FrameDescriptorAllocator(const std::shared_ptr<GContext> &gc, const FrameDescriptorSettings &settings = {});
+        ~FrameDescriptorAllocator();
+
+        FrameDescriptorAllocator(const FrameDescriptorAllocator &)            = delete;
+        FrameDescriptorAllocator &operator=(const FrameDescriptorAllocator &) = delete;
+
+        /**
+         * Resets the pools of the frame. The GPU must be done with the frame that last used them, see CommandRecorder::beginFrame().
+         */
+        void beginFrame(uint32_t frameIndex);
+
+        /**
+         * @throws std::runtime_error if the set doesn't fit in an empty pool either.
+         */
+        [[nodiscard]] vk::DescriptorSet allocate(vk::DescriptorSetLayout layout);
+
+        [[nodiscard]] uint32_t getPoolCount() const;
+
+      private:
+        struct Frame {
+            std::vector<vk::DescriptorPool> pools;
+
+            // pools before this one are full for this frame
+            uint32_t current = 0;
+        };
+
+        std::shared_ptr<GContext> m_GC;
+        FrameDescriptorSettings   m_Settings;
+
+        mutable std::mutex m_Mutex;
+        std::vector<Frame> m_Frames;
+        uint32_t           m_FrameIndex = 0;
+
+        [[nodiscard]] vk::DescriptorPool createPool() const;
+    };
+
+} // namespace neuron::graphics
@@ -0,0 +1,487 @@
+#include "device.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdlib>
+#include <format>
+#include <unordered_set>
+
+namespace neuron::graphics {
+
+    constexpr std::array CORE_FEATURE_NAMES = {
+        "robustBufferAccess",
+        "fullDrawIndexUint32",
+        "imageCubeArray",
+        "independentBlend",
+        "geometryShader",
+        "tessellationShader",
+        "sampleRateShading",
+        "dualSrcBlend",
+        "logicOp",
+        "multiDrawIndirect",
+        "drawIndirectFirstInstance",
+        "depthClamp",
+        "depthBiasClamp",
+        "fillModeNonSolid",
+        "depthBounds",
+        "wideLines",
+        "largePoints",
+        "alphaToOne",
+        "multiViewport",
+        "samplerAnisotropy",
+        "textureCompressionETC2",
+        "textureCompressionASTC_LDR",
+        "textureCompressionBC",
+        "occlusionQueryPrecise",
+        "pipelineStatisticsQuery",
+        "vertexPipelineStoresAndAtomics",
+        "fragmentStoresAndAtomics",
+        "shaderTessellationAndGeometryPointSize",
+        "shaderImageGatherExtended",
+        "shaderStorageImageExtendedFormats",
+        "shaderStorageImageMultisample",
+        "shaderStorageImageReadWithoutFormat",
+        "shaderStorageImageWriteWithoutFormat",
+        "shaderUniformBufferArrayDynamicIndexing",
+        "shaderSampledImageArrayDynamicIndexing",
+        "shaderStorageBufferArrayDynamicIndexing",
+        "shaderStorageImageArrayDynamicIndexing",
+        "shaderClipDistance",
+        "shaderCullDistance",
+        "shaderFloat64",
+        "shaderInt64",
+        "shaderInt16",
+        "shaderResourceResidency",
+        "shaderResourceMinLod",
+        "sparseBinding",
+        "sparseResidencyBuffer",
+        "sparseResidencyImage2D",
+        "sparseResidencyImage3D",
+        "sparseResidency2Samples",
+        "sparseResidency4Samples",
+        "sparseResidency8Samples",
+        "sparseResidency16Samples",
+        "sparseResidencyAliased",
+        "variableMultisampleRate",
+        "inheritedQueries",
+    };
+
+    constexpr std::array VULKAN11_FEATURE_NAMES = {
+        "storageBuffer16BitAccess",
+        "uniformAndStorageBuffer16BitAccess",
+        "storagePushConstant16",
+        "storageInputOutput16",
+        "multiview",
+        "multiviewGeometryShader",
+        "multiviewTessellationShader",
+        "variablePointersStorageBuffer",
+        "variablePointers",
+        "protectedMemory",
+        "samplerYcbcrConversion",
+        "shaderDrawParameters",
+    };
+
+    constexpr std::array VULKAN12_FEATURE_NAMES = {
+        "samplerMirrorClampToEdge",
+        "drawIndirectCount",
+        "storageBuffer8BitAccess",
+        "uniformAndStorageBuffer8BitAccess",
+        "storagePushConstant8",
+        "shaderBufferInt64Atomics",
+        "shaderSharedInt64Atomics",
+        "shaderFloat16",
+        "shaderInt8",
+        "descriptorIndexing",
+        "shaderInputAttachmentArrayDynamicIndexing",
+        "shaderUniformTexelBufferArrayDynamicIndexing",
+        "shaderStorageTexelBufferArrayDynamicIndexing",
+        "shaderUniformBufferArrayNonUniformIndexing",
+        "shaderSampledImageArrayNonUniformIndexing",
+        "shaderStorageBufferArrayNonUniformIndexing",
+        "shaderStorageImageArrayNonUniformIndexing",
+        "shaderInputAttachmentArrayNonUniformIndexing",
+        "shaderUniformTexelBufferArrayNonUniformIndexing",
+        "shaderStorageTexelBufferArrayNonUniformIndexing",
+        "descriptorBindingUniformBufferUpdateAfterBind",
+        "descriptorBindingSampledImageUpdateAfterBind",
+        "descriptorBindingStorageImageUpdateAfterBind",
+        "descriptorBindingStorageBufferUpdateAfterBind",
+        "descriptorBindingUniformTexelBufferUpdateAfterBind",
+        "descriptorBindingStorageTexelBufferUpdateAfterBind",
+        "descriptorBindingUpdateUnusedWhilePending",
+        "descriptorBindingPartiallyBound",
+        "descriptorBindingVariableDescriptorCount",
+        "runtimeDescriptorArray",
+        "samplerFilterMinmax",
+        "scalarBlockLayout",
+        "imagelessFramebuffer",
+        "uniformBufferStandardLayout",
+        "shaderSubgroupExtendedTypes",
+        "separateDepthStencilLayouts",
+        "hostQueryReset",
+        "timelineSemaphore",
+        "bufferDeviceAddress",
+        "bufferDeviceAddressCaptureReplay",
+        "bufferDeviceAddressMultiDevice",
+        "vulkanMemoryModel",
+        "vulkanMemoryModelDeviceScope",
+        "vulkanMemoryModelAvailabilityVisibilityChains",
+        "shaderOutputViewportIndex",
+        "shaderOutputLayer",
+        "subgroupBroadcastDynamicId",
+    };
+
+    constexpr std::array VULKAN13_FEATURE_NAMES = {
+        "robustImageAccess",
+        "inlineUniformBlock",
+        "descriptorBindingInlineUniformBlockUpdateAfterBind",
+        "pipelineCreationCacheControl",
+        "privateData",
+        "shaderDemoteToHelperInvocation",
+        "shaderTerminateInvocation",
+        "subgroupSizeControl",
+        "computeFullSubgroups",
+        "synchronization2",
+        "textureCompressionASTC_HDR",
+        "shaderZeroInitializeWorkgroupMemory",
+        "dynamicRendering",
+        "shaderIntegerDotProduct",
+        "maintenance4",
+    };
+
+    // the feature structs are treated as arrays of VkBool32 between their first and last feature
+    static_assert(sizeof(VkPhysicalDeviceFeatures) == CORE_FEATURE_NAMES.size() * sizeof(VkBool32));
+    static_assert(offsetof(VkPhysicalDeviceVulkan11Features, shaderDrawParameters) - offsetof(VkPhysicalDeviceVulkan11Features, storageBuffer16BitAccess) ==
+                  (VULKAN11_FEATURE_NAMES.size() - 1) * sizeof(VkBool32));
+    static_assert(offsetof(VkPhysicalDeviceVulkan12Features, subgroupBroadcastDynamicId) - offsetof(VkPhysicalDeviceVulkan12Features, samplerMirrorClampToEdge) ==
+                  (VULKAN12_FEATURE_NAMES.size() - 1) * sizeof(VkBool32));
+    static_assert(offsetof(VkPhysicalDeviceVulkan13Features, maintenance4) - offsetof(VkPhysicalDeviceVulkan13Features, robustImageAccess) ==
+                  (VULKAN13_FEATURE_NAMES.size() - 1) * sizeof(VkBool32));
+
+    struct FeatureGroup {
+        std::span<vk::Bool32>        flags;
+        std::span<const char *const> names;
+    };
+
+    static std::array<FeatureGroup, 4> groupsOf(DeviceFeatures &features) {
+        return {{
+            {std::span(&features.core.robustBufferAccess, CORE_FEATURE_NAMES.size()), CORE_FEATURE_NAMES},
+            {std::span(&features.vulkan11.storageBuffer16BitAccess, VULKAN11_FEATURE_NAMES.size()), VULKAN11_FEATURE_NAMES},
+            {std::span(&features.vulkan12.samplerMirrorClampToEdge, VULKAN12_FEATURE_NAMES.size()), VULKAN12_FEATURE_NAMES},
+            {std::span(&features.vulkan13.robustImageAccess, VULKAN13_FEATURE_NAMES.size()), VULKAN13_FEATURE_NAMES},
+        }};
+    }
+
+    static std::array<FeatureGroup, 4> groupsOf(const DeviceFeatures &features) { return groupsOf(const_cast<DeviceFeatures &>(features)); }
+
+    static void unlink(DeviceFeatures &features) {
+        features.vulkan11.pNext = nullptr;
+        features.vulkan12.pNext = nullptr;
+        features.vulkan13.pNext = nullptr;
+    }
+
+    DeviceFeatures DeviceFeatures::engineDefaults() {
+        DeviceFeatures features;
+        features.core.tessellationShader = true;
+        features.core.geometryShader     = true;
+        features.core.wideLines          = true;
+        features.core.largePoints        = true;
+        features.core.fillModeNonSolid   = true;
+        features.core.samplerAnisotropy  = true;
+        features.core.multiDrawIndirect  = true;
+
+        features.vulkan12.drawIndirectCount                             = true;
+        features.vulkan12.timelineSemaphore                             = true;
+        features.vulkan12.hostQueryReset                                = true;
+        features.vulkan12.scalarBlockLayout                             = true;
+        features.vulkan12.bufferDeviceAddress                           = true;
+        features.vulkan12.descriptorIndexing                            = true;
+        features.vulkan12.runtimeDescriptorArray                        = true;
+        features.vulkan12.descriptorBindingPartiallyBound               = true;
+        features.vulkan12.descriptorBindingVariableDescriptorCount      = true;
+        features.vulkan12.descriptorBindingUpdateUnusedWhilePending     = true;
+        features.vulkan12.descriptorBindingSampledImageUpdateAfterBind  = true;
+        features.vulkan12.descriptorBindingStorageImageUpdateAfterBind  = true;
+        features.vulkan12.descriptorBindingStorageBufferUpdateAfterBind = true;
+        features.vulkan12.shaderSampledImageArrayNonUniformIndexing     = true;
+        features.vulkan12.shaderStorageBufferArrayNonUniformIndexing    = true;
+        features.vulkan12.shaderStorageImageArrayNonUniformIndexing     = true;
+
+        features.vulkan13.synchronization2 = true;
+        features.vulkan13.dynamicRendering = true;
+        return features;
+    }
+
+    DeviceFeatures DeviceFeatures::query(vk::PhysicalDevice gpu) {
+        DeviceFeatures supported;
+
+        vk::PhysicalDeviceFeatures2 head = supported.link(gpu.getProperties().apiVersion);
+        gpu.getFeatures2(&head);
+        supported.core = head.features;
+
+        unlink(supported);
+        return supported;
+    }
+
+    bool DeviceFeatures::contains(const DeviceFeatures &other) const {
+        const auto mine   = groupsOf(*this);
+        const auto theirs = groupsOf(other);
+        for (size_t group = 0; group < mine.size(); group++) {
+            for (size_t i = 0; i < mine[group].flags.size(); i++) {
+                if (theirs[group].flags[i] && !mine[group].flags[i])
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    DeviceFeatures DeviceFeatures::intersect(const DeviceFeatures &other) const {
+        DeviceFeatures result = *this;
+        unlink(result);
+
+        const auto mine   = groupsOf(result);
+        const auto theirs = groupsOf(other);
+        for (size_t group = 0; group < mine.size(); group++) {
+            for (size_t i = 0; i < mine[group].flags.size(); i++) {
+                mine[group].flags[i] = mine[group].flags[i] && theirs[group].flags[i];
+            }
+        }
+        return result;
+    }
+
+    std::vector<std::string> DeviceFeatures::listMissing(const DeviceFeatures &other) const {
+        std::vector<std::string> missing;
+
+        const auto mine   = groupsOf(*this);
+        const auto theirs = groupsOf(other);
+        for (size_t group = 0; group < mine.size(); group++) {
+            for (size_t i = 0; i < mine[group].flags.size(); i++) {
+                if (theirs[group].flags[i] && !mine[group].flags[i])
+                    missing.emplace_back(mine[group].names[i]);
+            }
+        }
+        return missing;
+    }
+
+    uint32_t DeviceFeatures::count() const {
+        uint32_t enabled = 0;
+        for (const auto &group : groupsOf(*this)) {
+            enabled += static_cast<uint32_t>(std::ranges::count_if(group.flags, [](vk::Bool32 flag) { return flag != VK_FALSE; }));
+        }
+        return enabled;
+    }
+
+    DeviceFeatures &DeviceFeatures::operator|=(const DeviceFeatures &other) {
+        const auto mine   = groupsOf(*this);
+        const auto theirs = groupsOf(other);
+        for (size_t group = 0; group < mine.size(); group++) {
+            for (size_t i = 0; i < mine[group].flags.size(); i++) {
+                mine[group].flags[i] = mine[group].flags[i] || theirs[group].flags[i];
+            }
+        }
+        return *this;
+    }
+
+    vk::PhysicalDeviceFeatures2 DeviceFeatures::link(uint32_t apiVersion) {
+        unlink(*this);
+
+        vk::PhysicalDeviceFeatures2 head(core);
+        if (apiVersion >= vk::ApiVersion12) {
+            head.pNext     = &vulkan11;
+            vulkan11.pNext = &vulkan12;
+        }
+        if (apiVersion >= vk::ApiVersion13) {
+            vulkan12.pNext = &vulkan13;
+        }
+        return head;
+    }
+
+    FastPaths FastPaths::from(const DeviceFeatures &features) {
+        return {
+            .timelineSemaphores  = features.vulkan12.timelineSemaphore == VK_TRUE,
+            .synchronization2    = features.vulkan13.synchronization2 == VK_TRUE,
+            .dynamicRendering    = features.vulkan13.dynamicRendering == VK_TRUE,
+            .bufferDeviceAddress = features.vulkan12.bufferDeviceAddress == VK_TRUE,
+            .descriptorIndexing  = features.vulkan12.descriptorIndexing && features.vulkan12.runtimeDescriptorArray && features.vulkan12.descriptorBindingPartiallyBound,
+        };
+    }
+
+    std::string formatUuid(std::span<const uint8_t, VK_UUID_SIZE> uuid) {
+        std::string result;
+        for (const uint8_t byte : uuid) {
+            result += std::format("{:02x}", byte);
+        }
+        return result;
+    }
+
+    std::optional<uint32_t> findPrimaryQueueFamily(std::span<const vk::QueueFamilyProperties> families) {
+        std::optional<uint32_t> graphics;
+        for (uint32_t i = 0; i < families.size(); i++) {
+            if (!(families[i].queueFlags & vk::QueueFlagBits::eGraphics))
+                continue;
+            if (families[i].queueFlags & vk::QueueFlagBits::eCompute)
+                return i;
+            if (!graphics.has_value())
+                graphics = i;
+        }
+        return graphics;
+    }
+
+    static std::string normalizeUuid(std::string_view uuid) {
+        std::string result;
+        for (const char c : uuid) {
+            if (c != '-')
+                result += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return result;
+    }
+
+    static int64_t scoreDeviceType(vk::PhysicalDeviceType type) {
+        switch (type) {
+        case vk::PhysicalDeviceType::eDiscreteGpu:
+            return 4096;
+        case vk::PhysicalDeviceType::eIntegratedGpu:
+            return 2048;
+        case vk::PhysicalDeviceType::eVirtualGpu:
+            return 1024;
+        case vk::PhysicalDeviceType::eCpu:
+            return 256;
+        default:
+            return 0;
+        }
+    }
+
+    static DeviceCandidate evaluate(vk::PhysicalDevice gpu, uint32_t index, const DeviceRequirements &requirements) {
+        const auto  properties2 = gpu.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceIDProperties>();
+        const auto &properties  = properties2.get<vk::PhysicalDeviceProperties2>().properties;
+
+        DeviceCandidate candidate;
+        candidate.gpu   = gpu;
+        candidate.index = index;
+        candidate.name  = properties.deviceName.data();
+        candidate.uuid  = formatUuid(properties2.get<vk::PhysicalDeviceIDProperties>().deviceUUID);
+
+        if (properties.apiVersion < vk::ApiVersion11) {
+            candidate.rejection = "needs Vulkan 1.1";
+            return candidate;
+        }
+
+        const auto queueFamilies = gpu.getQueueFamilyProperties();
+        if (!findPrimaryQueueFamily(queueFamilies).has_value()) {
+            candidate.rejection = "no queue family can do graphics";
+            return candidate;
+        }
+
+        const DeviceFeatures supported = DeviceFeatures::query(gpu);
+        if (const auto missing = supported.listMissing(requirements.requiredFeatures); !missing.empty()) {
+            candidate.rejection = "missing features";
+            for (const auto &name : missing)
+                candidate.rejection += " " + name;
+            return candidate;
+        }
+
+        std::unordered_set<std::string> extensions;
+        for (const auto &extension : gpu.enumerateDeviceExtensionProperties()) {
+            extensions.insert(extension.extensionName.data());
+        }
+        for (const char *extension : requirements.requiredExtensions) {
+            if (!extensions.contains(extension)) {
+                candidate.rejection = std::string("missing extension ") + extension;
+                return candidate;
+            }
+        }
+
+        int64_t score = scoreDeviceType(properties.deviceType);
+
+        // 64 per GiB of the largest device local heap, up to 16 GiB
+        const auto     memory  = gpu.getMemoryProperties();
+        vk::DeviceSize largest = 0;
+        for (uint32_t i = 0; i < memory.memoryHeapCount; i++) {
+            if (memory.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal)
+                largest = std::max(largest, memory.memoryHeaps[i].size);
+        }
+        score += static_cast<int64_t>(std::min<vk::DeviceSize>(largest >> 30, 16)) * 64;
+
+        const bool dedicatedTransfer = std::ranges::any_of(queueFamilies, [](const vk::QueueFamilyProperties &family) {
+            return (family.queueFlags & vk::QueueFlagBits::eTransfer) && !(family.queueFlags & (vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute));
+        });
+        const bool asyncCompute = std::ranges::any_of(queueFamilies, [](const vk::QueueFamilyProperties &family) {
+            return (family.queueFlags & vk::QueueFlagBits::eCompute) && !(family.queueFlags & vk::QueueFlagBits::eGraphics);
+        });
+        score += dedicatedTransfer ? 256 : 0;
+        score += asyncCompute ? 256 : 0;
+
+        score += static_cast<int64_t>(supported.intersect(requirements.optionalFeatures).count()) * 16;
+        score += std::ranges::count_if(requirements.optionalExtensions, [&](const char *extension) { return extensions.contains(extension); }) * 32;
+
+        if (properties.apiVersion >= vk::ApiVersion13)
+            score += 128;
+
+        candidate.score = score;
+        return candidate;
+    }
+
+    std::vector<DeviceCandidate> rankDevices(vk::Instance instance, const DeviceRequirements &requirements) {
+        const auto gpus = instance.enumeratePhysicalDevices();
+
+        std::vector<DeviceCandidate> candidates;
+        for (uint32_t i = 0; i < gpus.size(); i++) {
+            candidates.push_back(evaluate(gpus[i], i, requirements));
+        }
+
+        std::ranges::stable_sort(candidates, [](const DeviceCandidate &a, const DeviceCandidate &b) {
+            if (a.isSuitable() != b.isSuitable())
+                return a.isSuitable();
+            return a.score > b.score;
+        });
+        return candidates;
+    }
+
+    DeviceCandidate selectDevice(vk::Instance instance, const DeviceRequirements &requirements, const DeviceSelection &selection) {
+        const auto candidates = rankDevices(instance, requirements);
+
+        for (const auto &candidate : candidates) {
+            if (candidate.isSuitable())
+                spdlog::debug("Device {} {} ({}): score {}", candidate.index, candidate.name, candidate.uuid, candidate.score);
+            else
+                spdlog::debug("Device {} {} ({}): rejected, {}", candidate.index, candidate.name, candidate.uuid, candidate.rejection);
+        }
+
+        DeviceSelection chosen = selection;
+        if (const char *environment = std::getenv("NEURON_DEVICE"); environment != nullptr && *environment != '\0') {
+            const std::string_view value(environment);
+            if (std::ranges::all_of(value, [](char c) { return std::isdigit(static_cast<unsigned char>(c)); })) {
+                chosen = {.index = static_cast<uint32_t>(std::stoul(std::string(value)))};
+            } else {
+                chosen = {.uuid = std::string(value)};
+            }
+        }
+
+        const DeviceCandidate *picked = nullptr;
+        if (chosen.index.has_value() || chosen.uuid.has_value()) {
+            const auto it = std::ranges::find_if(candidates, [&](const DeviceCandidate &candidate) {
+                return chosen.index.has_value() ? candidate.index == *chosen.index : candidate.uuid == normalizeUuid(*chosen.uuid);
+            });
+            if (it == candidates.end())
+                throw std::runtime_error("No device " + (chosen.index.has_value() ? std::to_string(*chosen.index) : *chosen.uuid));
+            if (!it->isSuitable())
+                throw std::runtime_error("Device " + it->name + " can't be used: " + it->rejection);
+            picked = &*it;
+        } else {
+            if (candidates.empty() || !candidates.front().isSuitable()) {
+                std::string reasons;
+                for (const auto &candidate : candidates)
+                    reasons += "\n  " + candidate.name + ": " + candidate.rejection;
+                throw std::runtime_error("No suitable Vulkan device" + reasons);
+            }
+            picked = &candidates.front();
+        }
+
+        spdlog::info("Using device {} {} (score {})", picked->index, picked->name, picked->score);
+        return *picked;
+    }
+
+} // namespace neuron::graphics
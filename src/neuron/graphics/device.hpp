@@ -0,0 +1,121 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <array>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace neuron::graphics {
+
+    /**
+     * The core feature structs of Vulkan 1.0 to 1.3, without pNext chaining to worry about. Structs the device's API version doesn't have are treated as unsupported.
+     */
+    struct DeviceFeatures {
+        vk::PhysicalDeviceFeatures         core;
+        vk::PhysicalDeviceVulkan11Features vulkan11;
+        vk::PhysicalDeviceVulkan12Features vulkan12;
+        vk::PhysicalDeviceVulkan13Features vulkan13;
+
+        /**
+         * What the engine turns on when the device has it: the fast paths its subsystems check for, and the features the old hardcoded list enabled.
+         */
+        [[nodiscard]] static DeviceFeatures engineDefaults();
+
+        [[nodiscard]] static DeviceFeatures query(vk::PhysicalDevice gpu);
+
+        /**
+         * Whether every feature enabled in other is also enabled here.
+         */
+        [[nodiscard]] bool contains(const DeviceFeatures &other) const;
+
+        /**
+         * The features enabled in both.
+         */
+        [[nodiscard]] DeviceFeatures intersect(const DeviceFeatures &other) const;
+
+        /**
+         * Names of the features enabled in other but not here, for error messages.
+         */
+        [[nodiscard]] std::vector<std::string> listMissing(const DeviceFeatures &other) const;
+
+        [[nodiscard]] uint32_t count() const;
+
+        DeviceFeatures &operator|=(const DeviceFeatures &other);
+
+        /**
+         * Links the structs into a chain for vkCreateDevice, as far as apiVersion has them. Returns the head.
+         */
+        [[nodiscard]] vk::PhysicalDeviceFeatures2 link(uint32_t apiVersion);
+    };
+
+    /**
+     * Optional features which subsystems take faster paths with.
+     */
+    struct FastPaths {
+        bool timelineSemaphores  = false;
+        bool synchronization2    = false;
+        bool dynamicRendering    = false;
+        bool bufferDeviceAddress = false;
+        bool descriptorIndexing  = false;
+
+        [[nodiscard]] static FastPaths from(const DeviceFeatures &features);
+    };
+
+    struct DeviceSelection {
+        /**
+         * Position in vkEnumeratePhysicalDevices.
+         */
+        std::optional<uint32_t> index;
+
+        /**
+         * VkPhysicalDeviceIDProperties::deviceUUID as 32 hex digits, dashes ignored.
+         */
+        std::optional<std::string> uuid;
+    };
+
+    struct DeviceRequirements {
+        DeviceFeatures            requiredFeatures;
+        DeviceFeatures            optionalFeatures;
+        std::vector<const char *> requiredExtensions;
+        std::vector<const char *> optionalExtensions;
+    };
+
+    struct DeviceCandidate {
+        vk::PhysicalDevice gpu;
+        uint32_t           index = 0;
+        std::string        name;
+        std::string        uuid;
+
+        /**
+         * Empty when the device meets the requirements.
+         */
+        std::string rejection;
+        int64_t     score = 0;
+
+        [[nodiscard]] inline bool isSuitable() const noexcept { return rejection.empty(); }
+    };
+
+    [[nodiscard]] std::string formatUuid(std::span<const uint8_t, VK_UUID_SIZE> uuid);
+
+    /**
+     * The queue family the primary queue comes from: the first that can do graphics and compute, or else the first that can do graphics. Empty for compute-only devices.
+     */
+    [[nodiscard]] std::optional<uint32_t> findPrimaryQueueFamily(std::span<const vk::QueueFamilyProperties> families);
+
+    /**
+     * Scores every device of the instance, best first. Weighs the device type most, then device local memory, queue topology and how many of the optional features and
+     * extensions it has. Devices missing a required feature or extension are rejected and sorted last.
+     */
+    [[nodiscard]] std::vector<DeviceCandidate> rankDevices(vk::Instance instance, const DeviceRequirements &requirements);
+
+    /**
+     * The best device, or the one picked by selection. The NEURON_DEVICE environment variable (an index or a UUID) takes precedence over selection.
+     *
+     * @throws std::runtime_error if no device meets the requirements, or the selected device doesn't exist or doesn't meet them.
+     */
+    [[nodiscard]] DeviceCandidate selectDevice(vk::Instance instance, const DeviceRequirements &requirements, const DeviceSelection &selection);
+
+} // namespace neuron::graphics
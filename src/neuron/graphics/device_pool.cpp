@@ -0,0 +1,147 @@
+#include "device_pool.hpp"
+
+#include "neuron/utils/profiler.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+#include <spdlog/spdlog.h>
+
+namespace neuron::graphics {
+
+    bool DevicePool::lessLoaded(const std::unique_ptr<Slot> &a, const std::unique_ptr<Slot> &b) noexcept {
+        const uint32_t outstandingA = a->outstanding.load();
+        const uint32_t outstandingB = b->outstanding.load();
+        if (outstandingA != outstandingB)
+            return outstandingA < outstandingB;
+        return a->busyNanoseconds.load() < b->busyNanoseconds.load();
+    }
+
+    DevicePool::DevicePool(const DevicePoolSettings &settings) {
+        if (settings.contextsPerDevice == 0)
+            throw std::runtime_error("A device pool needs at least one context per device");
+
+        std::vector<DeviceSelection> devices = settings.devices;
+        if (devices.empty()) {
+            if (const char *environment = std::getenv("NEURON_DEVICE"); environment != nullptr && *environment != '\0') {
+                // selectDevice() resolves it
+                devices.emplace_back();
+            } else {
+                for (const auto &candidate : rankDevices(Context::get()->getInstance(), GContext::getRequirements(settings.gcSettings))) {
+                    if (candidate.isSuitable())
+                        devices.push_back({.index = candidate.index});
+                }
+            }
+        }
+        if (devices.empty())
+            throw std::runtime_error("No suitable Vulkan device for the device pool");
+
+        for (const auto &device : devices) {
+            for (uint32_t i = 0; i < settings.contextsPerDevice; i++) {
+                GCSettings gcSettings      = settings.gcSettings;
+                gcSettings.deviceSelection = device;
+
+                auto slot = std::make_unique<Slot>();
+                slot->gc  = std::make_shared<GContext>(gcSettings);
+                m_Slots.push_back(std::move(slot));
+            }
+        }
+
+        // only once every context exists, so a failed one leaves no threads behind
+        try {
+            for (uint32_t i = 0; i < m_Slots.size(); i++) {
+                m_Slots[i]->thread = std::thread([this, i] { run(*m_Slots[i], i); });
+            }
+        } catch (...) {
+            stop();
+            throw;
+        }
+
+        spdlog::info("Device pool with {} contexts on {} devices", m_Slots.size(), devices.size());
+    }
+
+    DevicePool::~DevicePool() {
+        stop();
+    }
+
+    void DevicePool::stop() noexcept {
+        for (const auto &slot : m_Slots) {
+            {
+                std::lock_guard lock(slot->mutex);
+                slot->stopping = true;
+            }
+            slot->signal.notify_one();
+        }
+
+        for (const auto &slot : m_Slots) {
+            if (slot->thread.joinable())
+                slot->thread.join();
+        }
+    }
+
+    void DevicePool::enqueue(Job job) {
+        Slot *slot;
+        {
+            std::lock_guard lock(m_ScheduleMutex);
+            slot = std::ranges::min_element(m_Slots, lessLoaded)->get();
+            slot->outstanding.fetch_add(1);
+        }
+
+        {
+            std::lock_guard lock(slot->mutex);
+            slot->jobs.push_back(std::move(job));
+        }
+        slot->signal.notify_one();
+    }
+
+    void DevicePool::run(Slot &slot, uint32_t index) {
+        NEURON_PROFILE_THREAD("Device pool " + std::to_string(index));
+        (void) index;
+
+        while (true) {
+            Job job;
+            {
+                std::unique_lock lock(slot.mutex);
+                slot.signal.wait(lock, [&] { return slot.stopping || !slot.jobs.empty(); });
+
+                // queued jobs still run when stopping, their futures are waited on
+                if (slot.jobs.empty())
+                    return;
+
+                job = std::move(slot.jobs.front());
+                slot.jobs.pop_front();
+            }
+
+            const uint64_t begin = utils::Profiler::now();
+            job(slot.gc);
+            slot.busyNanoseconds.fetch_add(utils::Profiler::now() - begin);
+            slot.completed.fetch_add(1);
+
+            {
+                std::lock_guard lock(m_IdleMutex);
+                slot.outstanding.fetch_sub(1);
+            }
+            m_IdleSignal.notify_all();
+        }
+    }
+
+    void DevicePool::waitIdle() {
+        std::unique_lock lock(m_IdleMutex);
+        m_IdleSignal.wait(lock, [&] { return std::ranges::all_of(m_Slots, [](const std::unique_ptr<Slot> &slot) { return slot->outstanding.load() == 0; }); });
+    }
+
+    std::vector<DevicePoolStats> DevicePool::getStats() const {
+        std::vector<DevicePoolStats> stats;
+        for (const auto &slot : m_Slots) {
+            stats.push_back({
+                .device          = slot->gc->getProperties().deviceName.data(),
+                .outstanding     = slot->outstanding.load(),
+                .completed       = slot->completed.load(),
+                .busyNanoseconds = slot->busyNanoseconds.load(),
+            });
+        }
+        return stats;
+    }
+
+} // namespace neuron::graphics
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "neuron/graphics/gcontext.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace neuron::graphics {
+
+    struct DevicePoolSettings {
+        /**
+         * The physical devices to create contexts on. Empty uses every device that meets gcSettings' requirements. The NEURON_DEVICE environment variable pins every
+         * context to one device, as it does for a single GContext.
+         */
+        std::vector<DeviceSelection> devices;
+
+        /**
+         * Logical devices per physical device. Several on one adapter let its queues work on independent jobs side by side, and let a single (software) device stand in
+         * for several in tests.
+         */
+        uint32_t contextsPerDevice = 1;
+
+        /**
+         * What every context is created with. The device selection is overridden.
+         */
+        GCSettings gcSettings;
+    };
+
+    struct DevicePoolStats {
+        std::string device;
+
+        /**
+         * Jobs queued on the context or running on it.
+         */
+        uint32_t outstanding = 0;
+        uint64_t completed   = 0;
+
+        /**
+         * Time spent running jobs, in nanoseconds.
+         */
+        uint64_t busyNanoseconds = 0;
+    };
+
+    /**
+     *
+     * One GContext per chosen device (or several per device), each with a thread of its own that runs the jobs given to it in order. Jobs are independent units of
+     * offscreen work, like a frame or a tile: each goes to the context with the fewest outstanding jobs, ties broken by the least busy time, and gets that context to
+     * record, submit and wait on. Resources a job uses must belong to its context.
+     *
+     * Destroying the pool finishes the queued jobs first. All methods are thread safe, but jobs must not wait on other jobs of the same pool.
+     *
+     */
+    class DevicePool final {
+      public:
+        /**
+         * @throws std::runtime_error if there is no suitable device, contextsPerDevice is 0 or a context can't be created.
+         */
+        explicit DevicePool(const DevicePoolSettings &settings = {});
+        ~DevicePool();
+
+        DevicePool(const DevicePool &)            = delete;
+        DevicePool &operator=(const DevicePool &) = delete;
+
+        [[nodiscard]] inline size_t getSize() const noexcept { return m_Slots.size(); }
+
+        [[nodiscard]] inline const std::shared_ptr<GContext> &getContext(size_t index) const { return m_Slots.at(index)->gc; }
+
+        /**
+         * Queues job(gc) on the least loaded context. Exceptions end up in the future.
+         */
+        template<typename F> [[nodiscard]] auto submit(F &&job) -> std::future<std::invoke_result_t<F &, const std::shared_ptr<GContext> &>> {
+            using Result = std::invoke_result_t<F &, const std::shared_ptr<GContext> &>;
+
+            auto task   = std::make_shared<std::packaged_task<Result(const std::shared_ptr<GContext> &)>>(std::forward<F>(job));
+            auto future = task->get_future();
+            enqueue([task](const std::shared_ptr<GContext> &gc) { (*task)(gc); });
+            return future;
+        }
+
+        /**
+         * Runs job(gc, i) for every i in [0, count), spread over the contexts, and returns the results in order of i. Waits for every job before rethrowing the first
+         * exception in that order.
+         */
+        template<typename F> [[nodiscard]] auto map(uint32_t count, F &&job) -> std::vector<std::invoke_result_t<F &, const std::shared_ptr<GContext> &, uint32_t>> {
+            using Result = std::invoke_result_t<F &, const std::shared_ptr<GContext> &, uint32_t>;
+            static_assert(!std::is_void_v<Result>, "map() gathers results, submit() jobs that have none");
+
+            std::vector<std::future<Result>> futures;
+            futures.reserve(count);
+            for (uint32_t i = 0; i < count; i++) {
+                futures.push_back(submit([&job, i](const std::shared_ptr<GContext> &gc) { return job(gc, i); }));
+            }
+
+            // the jobs reference job, so none may still run when this throws
+            for (auto &future : futures) {
+                future.wait();
+            }
+
+            std::vector<Result> results;
+            results.reserve(count);
+            for (auto &future : futures) {
+                results.push_back(future.get());
+            }
+            return results;
+        }
+
+        /**
+         * Blocks until every job submitted so far finished.
+         */
+        void waitIdle();
+
+        /**
+         * One entry per context, in the order of getContext().
+         */
+        [[nodiscard]] std::vector<DevicePoolStats> getStats() const;
+
+      private:
+        using Job = std::function<void(const std::shared_ptr<GContext> &)>;
+
+        struct Slot {
+            std::shared_ptr<GContext> gc;
+
+            std::mutex              mutex;
+            std::condition_variable signal;
+            std::deque<Job>         jobs;
+            bool                    stopping = false;
+
+            std::atomic<uint32_t> outstanding     = 0;
+            std::atomic<uint64_t> completed       = 0;
+            std::atomic<uint64_t> busyNanoseconds = 0;
+
+            std::thread thread;
+        };
+
+        std::vector<std::unique_ptr<Slot>> m_Slots;
+
+        // picking a slot and counting the job on it happen together, so a burst of submits spreads evenly
+        std::mutex m_ScheduleMutex;
+
+        std::mutex              m_IdleMutex;
+        std::condition_variable m_IdleSignal;
+
+        [[nodiscard]] static bool lessLoaded(const std::unique_ptr<Slot> &a, const std::unique_ptr<Slot> &b) noexcept;
+
+        void enqueue(Job job);
+        void run(Slot &slot, uint32_t index);
+        void stop() noexcept;
+    };
+
+} // namespace neuron::graphics
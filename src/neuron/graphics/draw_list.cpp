@@ -0,0 +1,153 @@
+#include "draw_list.hpp"
+
+#include "neuron/utils/profiler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <stdexcept>
+
+namespace neuron::graphics {
+
+    constexpr uint64_t DEPTH_STEPS = 0xffff;
+
+    static bool isBackToFront(uint64_t pass, uint16_t backToFrontPasses) { return (backToFrontPasses >> pass & 1) != 0; }
+
+    static uint64_t makeKey(const Renderable &renderable, uint64_t depth, bool backToFront) {
+        const uint64_t pass     = renderable.pass;
+        const uint64_t pipeline = renderable.pipeline;
+        const uint64_t material = renderable.material;
+        const uint64_t mesh     = renderable.mesh;
+
+        if (backToFront)
+            return pass << 60 | (DEPTH_STEPS - depth) << 44 | pipeline << 32 | material << 16 | mesh;
+        return pass << 60 | pipeline << 48 | material << 32 | mesh << 16 | depth;
+    }
+
+    // the key without its depth, equal for packets that can share an instanced draw
+    static uint64_t batchBits(uint64_t key, uint16_t backToFrontPasses) {
+        return key & ~(isBackToFront(key >> 60, backToFrontPasses) ? DEPTH_STEPS << 44 : DEPTH_STEPS);
+    }
+
+    static DrawBatch makeBatch(uint64_t key, uint16_t backToFrontPasses, uint32_t firstInstance) {
+        DrawBatch batch{.pass = static_cast<uint8_t>(key >> 60), .firstInstance = firstInstance, .instanceCount = 1};
+        if (isBackToFront(batch.pass, backToFrontPasses)) {
+            batch.pipeline = static_cast<uint16_t>(key >> 32 & 0xfff);
+            batch.material = static_cast<uint16_t>(key >> 16);
+            batch.mesh     = static_cast<uint16_t>(key);
+        } else {
+            batch.pipeline = static_cast<uint16_t>(key >> 48 & 0xfff);
+            batch.material = static_cast<uint16_t>(key >> 32);
+            batch.mesh     = static_cast<uint16_t>(key >> 16);
+        }
+        return batch;
+    }
+
+    void DrawList::extract(entt::registry &registry, const DrawExtractSettings &settings) {
+        NEURON_PROFILE_SCOPE("DrawList::extract");
+        m_Stats = {};
+
+        const uint64_t start = utils::Profiler::now();
+
+        // the entities first, so every task knows where its packets go
+        const auto view = registry.view<const WorldTransform, const Renderable>();
+        m_Entities.assign(view.begin(), view.end());
+
+        const auto count = static_cast<uint32_t>(m_Entities.size());
+        m_Transforms.resize(count);
+        m_Packets.resize(count);
+
+        const float       depthScale = static_cast<float>(DEPTH_STEPS) / settings.farPlane;
+        std::atomic<bool> invalid    = false;
+
+        const auto extractRange = [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                const auto [transform, renderable] = view.get<const WorldTransform, const Renderable>(m_Entities[i]);
+                if (renderable.pass >= MAX_DRAW_PASSES || renderable.pipeline >= MAX_DRAW_PIPELINES) {
+                    invalid.store(true, std::memory_order_relaxed);
+                    continue;
+                }
+
+                const float viewDepth = -(settings.view * transform.matrix[3]).z;
+                const auto  depth     = static_cast<uint64_t>(std::clamp(viewDepth * depthScale, 0.f, static_cast<float>(DEPTH_STEPS)));
+                m_Transforms[i]       = transform.matrix;
+                m_Packets[i]          = {makeKey(renderable, depth, isBackToFront(renderable.pass, settings.backToFrontPasses)), i, m_Entities[i]};
+            }
+        };
+
+        if (settings.jobs) {
+            settings.jobs->parallelFor(count, settings.grain, extractRange);
+        } else {
+            extractRange(0, count);
+        }
+        if (invalid) {
+            throw std::runtime_error("A Renderable's pass or pipeline is out of range");
+        }
+
+        const uint64_t extracted = utils::Profiler::now();
+        radixSortPackets(m_Packets, m_Scratch);
+        const uint64_t sorted = utils::Profiler::now();
+
+        m_Instances.resize(count);
+        m_Batches.clear();
+        uint64_t current = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            const DrawPacket &packet = m_Packets[i];
+            m_Instances[i]           = m_Transforms[packet.object];
+
+            const uint64_t bits = batchBits(packet.key, settings.backToFrontPasses);
+            if (m_Batches.empty() || bits != current) {
+                m_Batches.push_back(makeBatch(packet.key, settings.backToFrontPasses, i));
+                current = bits;
+            } else {
+                m_Batches.back().instanceCount++;
+            }
+        }
+
+        m_Stats.entities            = count;
+        m_Stats.drawsBeforeBatching = count;
+        m_Stats.drawsAfterBatching  = static_cast<uint32_t>(m_Batches.size());
+        m_Stats.extractNanoseconds  = extracted - start;
+        m_Stats.sortNanoseconds     = sorted - extracted;
+        m_Stats.batchNanoseconds    = utils::Profiler::now() - sorted;
+    }
+
+    void radixSortPackets(std::vector<DrawPacket> &packets, std::vector<DrawPacket> &scratch) {
+        const size_t count = packets.size();
+        scratch.resize(count);
+        if (count < 2)
+            return;
+
+        // the histograms of all eight bytes in one pass over the keys
+        std::array<std::array<uint32_t, 256>, 8> histograms{};
+        for (const DrawPacket &packet : packets) {
+            for (uint32_t byte = 0; byte < 8; byte++)
+                histograms[byte][packet.key >> byte * 8 & 0xff]++;
+        }
+
+        DrawPacket *source      = packets.data();
+        DrawPacket *destination = scratch.data();
+        for (uint32_t byte = 0; byte < 8; byte++) {
+            auto &histogram = histograms[byte];
+
+            // keys that all share this byte (pass and pipeline bits, mostly) would be copied without moving
+            if (histogram[source->key >> byte * 8 & 0xff] == count)
+                continue;
+
+            uint32_t offset = 0;
+            for (uint32_t &bucket : histogram) {
+                const uint32_t size = bucket;
+                bucket              = offset;
+                offset += size;
+            }
+
+            for (size_t i = 0; i < count; i++)
+                destination[histogram[source[i].key >> byte * 8 & 0xff]++] = source[i];
+            std::swap(source, destination);
+        }
+
+        if (source != packets.data())
+            packets.swap(scratch);
+    }
+
+} // namespace neuron::graphics
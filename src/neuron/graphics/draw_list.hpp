@@ -0,0 +1,151 @@
+#pragma once
+
+#include "neuron/utils/jobs.hpp"
+
+#include <entt/entt.hpp>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace neuron::graphics {
+
+    /**
+     * Where an entity is, read by DrawList::extract(). The translation gives the depth the draws are sorted by.
+     */
+    struct WorldTransform {
+        glm::mat4 matrix{1.f};
+    };
+
+    /**
+     * What an entity is drawn with. The ids are the application's, DrawList only sorts and groups by them.
+     */
+    struct Renderable {
+        uint16_t mesh     = 0;
+        uint16_t material = 0;
+
+        /**
+         * Below MAX_DRAW_PIPELINES.
+         */
+        uint16_t pipeline = 0;
+
+        /**
+         * Below MAX_DRAW_PASSES. Passes are drawn in order.
+         */
+        uint8_t pass = 0;
+    };
+
+    constexpr uint32_t MAX_DRAW_PASSES    = 16;
+    constexpr uint32_t MAX_DRAW_PIPELINES = 4096;
+
+    /**
+     * One entity to draw. object indexes the transforms in extraction order.
+     */
+    struct DrawPacket {
+        uint64_t     key    = 0;
+        uint32_t     object = 0;
+        entt::entity entity = entt::null;
+    };
+
+    /**
+     * Consecutive packets with the same pass, pipeline, material and mesh, drawn as one instanced draw. The instances' transforms are
+     * DrawList::getInstances()[firstInstance, firstInstance + instanceCount).
+     */
+    struct DrawBatch {
+        uint16_t mesh          = 0;
+        uint16_t material      = 0;
+        uint16_t pipeline      = 0;
+        uint8_t  pass          = 0;
+        uint32_t firstInstance = 0;
+        uint32_t instanceCount = 0;
+    };
+
+    struct DrawExtractSettings {
+        /**
+         * The camera the depth is measured from, and the depth that maps to the last of the 65536 depth steps.
+         */
+        glm::mat4 view{1.f};
+        float     farPlane = 1000.f;
+
+        /**
+         * Bit i set sorts pass i back to front before anything else, as blending needs; other passes sort by state and front to back within it.
+         */
+        uint16_t backToFrontPasses = 0;
+
+        /**
+         * Computes the keys on this job system. Null extracts on the calling thread.
+         */
+        utils::JobSystem *jobs = nullptr;
+
+        /**
+         * Entities per task.
+         */
+        uint32_t grain = 4096;
+    };
+
+    struct DrawListStats {
+        uint32_t entities = 0;
+
+        /**
+         * One draw per entity, and the instanced draws they were merged into.
+         */
+        uint32_t drawsBeforeBatching = 0;
+        uint32_t drawsAfterBatching  = 0;
+
+        uint64_t extractNanoseconds = 0;
+        uint64_t sortNanoseconds    = 0;
+        uint64_t batchNanoseconds   = 0;
+    };
+
+    /**
+     *
+     * Turns the renderable entities of a registry into instanced draws. extract() reads every entity with a WorldTransform and a Renderable into a packet with a 64 bit
+     * sort key, radix sorts the packets and merges runs of the same mesh and material into DrawBatches. Keys are laid out from the most to the least significant bits as
+     *
+     *   pass (4) | pipeline (12) | material (16) | mesh (16) | depth (16)           for front to back passes
+     *   pass (4) | inverted depth (16) | pipeline (12) | material (16) | mesh (16)  for back to front passes
+     *
+     * so opaque passes change state as rarely as possible and draw the nearest objects of a batch first, while transparent ones keep the blending order.
+     *
+     * The buffers are kept between calls, so extracting a scene of the same size every frame doesn't allocate.
+     *
+     */
+    class DrawList final {
+      public:
+        /**
+         * Replaces the last extraction. The registry is only read; it isn't const since entt creates the component pools of views on first use.
+         *
+         * @throws std::runtime_error if a Renderable's pass or pipeline is out of range.
+         */
+        void extract(entt::registry &registry, const DrawExtractSettings &settings = {});
+
+        /**
+         * The packets, sorted by key.
+         */
+        [[nodiscard]] inline const std::vector<DrawPacket> &getPackets() const noexcept { return m_Packets; }
+
+        [[nodiscard]] inline const std::vector<DrawBatch> &getBatches() const noexcept { return m_Batches; }
+
+        /**
+         * The transforms in packet order, for the instance buffer.
+         */
+        [[nodiscard]] inline const std::vector<glm::mat4> &getInstances() const noexcept { return m_Instances; }
+
+        [[nodiscard]] inline const DrawListStats &getStats() const noexcept { return m_Stats; }
+
+      private:
+        std::vector<entt::entity> m_Entities;
+        std::vector<glm::mat4>    m_Transforms;
+        std::vector<DrawPacket>   m_Packets;
+        std::vector<DrawPacket>   m_Scratch;
+        std::vector<glm::mat4>    m_Instances;
+        std::vector<DrawBatch>    m_Batches;
+        DrawListStats             m_Stats;
+    };
+
+    /**
+     * Sorts packets by key with an LSD radix sort over the key's bytes, skipping the bytes all keys share. Stable. scratch is resized to match and left with garbage.
+     */
+    void radixSortPackets(std::vector<DrawPacket> &packets, std::vector<DrawPacket> &scratch);
+
+} // namespace neuron::graphics
@@ -0,0 +1,414 @@
+#include "frame_capture.hpp"
+
+#include "neuron/utils/profiler.hpp"
+
+#include <array>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include <spdlog/spdlog.h>
+#include <stb_image_write.h>
+
+namespace neuron::graphics {
+
+    static bool isRgba8(vk::Format format) {
+        return format == vk::Format::eR8G8B8A8Unorm || format == vk::Format::eR8G8B8A8Srgb;
+    }
+
+    static bool isBgra8(vk::Format format) {
+        return format == vk::Format::eB8G8R8A8Unorm || format == vk::Format::eB8G8R8A8Srgb;
+    }
+
+    // only what a color attachment is likely to be; 0 for anything else
+    static vk::DeviceSize texelSize(vk::Format format) {
+        switch (format) {
+        case vk::Format::eR8G8B8A8Unorm:
+        case vk::Format::eR8G8B8A8Srgb:
+        case vk::Format::eB8G8R8A8Unorm:
+        case vk::Format::eB8G8R8A8Srgb:
+        case vk::Format::eA2B10G10R10UnormPack32:
+        case vk::Format::eB10G11R11UfloatPack32:
+        case vk::Format::eR32Sfloat:
+            return 4;
+        case vk::Format::eR16G16B16A16Sfloat:
+            return 8;
+        case vk::Format::eR32G32B32A32Sfloat:
+            return 16;
+        default:
+            return 0;
+        }
+    }
+
+    FrameCapture::FrameCapture(const std::shared_ptr<GContext> &gc, const FrameCaptureSettings &settings) : m_GC(gc), m_Settings(settings) {
+        if (m_Settings.ringSize == 0 || m_Settings.workerCount == 0) {
+            throw std::runtime_error("Frame capture needs at least one readback buffer and one worker");
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(m_Settings.directory, error);
+        if (error) {
+            throw std::runtime_error(std::format("Failed to create capture directory {}: {}", m_Settings.directory.string(), error.message()));
+        }
+
+        // buffers are sized on first use, when the target's extent is known
+        m_Slots.resize(m_Settings.ringSize);
+        for (uint32_t i = 0; i < m_Settings.ringSize; i++) {
+            m_Slots[i].fence = m_GC->getDevice().createFence(vk::FenceCreateInfo());
+            m_Free.push_back(m_Settings.ringSize - 1 - i);
+        }
+
+        try {
+            for (uint32_t i = 0; i < m_Settings.workerCount; i++) {
+                m_Workers.emplace_back([this, i] { run(i); });
+            }
+        } catch (...) {
+            stop();
+            for (const auto &slot : m_Slots)
+                m_GC->getDevice().destroyFence(slot.fence);
+            throw;
+        }
+    }
+
+    FrameCapture::~FrameCapture() {
+        stop();
+
+        const vk::Device &device = m_GC->getDevice();
+        for (auto &slot : m_Slots) {
+            device.destroyFence(slot.fence);
+            if (slot.capacity > 0)
+                m_GC->getAllocator().destroy(slot.buffer);
+        }
+    }
+
+    void FrameCapture::stop() noexcept {
+        {
+            std::lock_guard lock(m_Mutex);
+            m_Stopping = true;
+        }
+        m_Signal.notify_all();
+
+        for (auto &worker : m_Workers) {
+            if (worker.joinable())
+                worker.join();
+        }
+    }
+
+    uint64_t FrameCapture::record(const FrameContext &frame, const IRenderTarget &target) {
+        NEURON_PROFILE_SCOPE("FrameCapture::record");
+
+        if (m_Recorded.has_value()) {
+            throw std::runtime_error("record() called twice without commit()");
+        }
+
+        const RenderTargetConfiguration &configuration = target.getCurrentConfiguration();
+        const vk::DeviceSize             texel         = texelSize(configuration.format);
+        if (texel == 0 || (m_Settings.format != CaptureFormat::Raw && !isRgba8(configuration.format) && !isBgra8(configuration.format))) {
+            throw std::runtime_error(std::format("Can't capture frames of format {}", vk::to_string(configuration.format)));
+        }
+        if (!(configuration.usage & vk::ImageUsageFlagBits::eTransferSrc)) {
+            throw std::runtime_error("Can't capture frames of a target whose images weren't created with eTransferSrc");
+        }
+
+        uint32_t index;
+        {
+            std::unique_lock lock(m_Mutex);
+            if (m_Free.empty()) {
+                // backpressure: the encoders are behind, so rendering waits for them
+                const uint64_t begin = utils::Profiler::now();
+                m_Signal.wait(lock, [&] { return !m_Free.empty(); });
+                m_Stats.stalls++;
+                m_Stats.stallNanoseconds += utils::Profiler::now() - begin;
+            }
+
+            index = m_Free.back();
+            m_Free.pop_back();
+            if (m_FirstRecord == 0)
+                m_FirstRecord = utils::Profiler::now();
+        }
+
+        Slot                &slot = m_Slots[index];
+        const vk::DeviceSize size = static_cast<vk::DeviceSize>(configuration.extent.width) * configuration.extent.height * texel;
+        if (slot.capacity < size) {
+            MemoryAllocator &allocator = m_GC->getAllocator();
+            if (slot.capacity > 0)
+                allocator.destroy(slot.buffer);
+            slot.buffer   = allocator.createBuffer(vk::BufferCreateInfo({}, size, vk::BufferUsageFlagBits::eTransferDst, vk::SharingMode::eExclusive),
+                                                   vk::MemoryPropertyFlagBits::eHostVisible, vk::MemoryPropertyFlagBits::eHostCached);
+            slot.capacity = size;
+        }
+        m_GC->getDevice().resetFences(slot.fence);
+
+        slot.frameNumber = m_NextFrame++;
+        slot.extent      = configuration.extent;
+        slot.format      = configuration.format;
+
+        const vk::Image         image = target.getImageTarget(frame.imageIndex);
+        const vk::CommandBuffer cmd   = frame.commandBuffer;
+
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {}, {}, {},
+                            vk::ImageMemoryBarrier(vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eTransferRead,
+                                                   vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::eTransferSrcOptimal, VK_QUEUE_FAMILY_IGNORED,
+                                                   VK_QUEUE_FAMILY_IGNORED, image, BASIC_ISR));
+
+        const vk::BufferImageCopy region(0, 0, 0, vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1), {0, 0, 0},
+                                         {configuration.extent.width, configuration.extent.height, 1});
+        cmd.copyImageToBuffer(image, vk::ImageLayout::eTransferSrcOptimal, slot.buffer.buffer, region);
+
+        const vk::ImageMemoryBarrier  restore({}, vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite, vk::ImageLayout::eTransferSrcOptimal,
+                                              vk::ImageLayout::eColorAttachmentOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image, BASIC_ISR);
+        const vk::BufferMemoryBarrier toHost(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+                                             slot.buffer.buffer, 0, VK_WHOLE_SIZE);
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eHost, {}, {}, toHost,
+                            restore);
+
+        m_Recorded = index;
+        return slot.frameNumber;
+    }
+
+    void FrameCapture::commit() {
+        if (!m_Recorded.has_value()) {
+            throw std::runtime_error("commit() called without record()");
+        }
+
+        // an empty submission's fence signals once everything submitted before it on the queue finished, the frame included
+        m_GC->submit(m_GC->getPrimaryQueue(), nullptr, m_Slots[m_Recorded.value()].fence);
+
+        {
+            std::lock_guard lock(m_Mutex);
+            m_Committed.push_back(m_Recorded.value());
+        }
+        m_Signal.notify_all();
+        m_Recorded.reset();
+    }
+
+    void FrameCapture::flush() {
+        std::unique_lock lock(m_Mutex);
+        m_Signal.wait(lock, [&] { return m_Committed.empty() && m_Encoding == 0; });
+    }
+
+    void FrameCapture::run(uint32_t index) {
+        NEURON_PROFILE_THREAD("Frame capture " + std::to_string(index));
+        (void) index;
+
+        while (true) {
+            uint32_t slotIndex;
+            {
+                std::unique_lock lock(m_Mutex);
+                m_Signal.wait(lock, [&] { return m_Stopping || !m_Committed.empty(); });
+
+                // committed frames are still written when stopping
+                if (m_Committed.empty())
+                    return;
+
+                slotIndex = m_Committed.front();
+                m_Committed.pop_front();
+                m_Encoding++;
+            }
+
+            // the slot is this worker's until it goes back to the free list, which it does even if the frame fails, as an exception would end the process here
+            const Slot           &slot  = m_Slots[slotIndex];
+            uint64_t              begin = utils::Profiler::now();
+            std::optional<size_t> written;
+            try {
+                (void) m_GC->getDevice().waitForFences(slot.fence, true, std::numeric_limits<uint64_t>::max());
+                m_GC->getAllocator().invalidate(slot.buffer.allocation);
+
+                begin   = utils::Profiler::now();
+                written = write(slot);
+            } catch (const std::exception &e) {
+                spdlog::error("Failed to capture frame {}: {}", slot.frameNumber, e.what());
+            }
+            const uint64_t end = utils::Profiler::now();
+
+            {
+                std::lock_guard lock(m_Mutex);
+                m_Stats.encodeNanoseconds += end - begin;
+                if (written.has_value()) {
+                    m_Stats.framesCaptured++;
+                    m_Stats.bytesWritten += written.value();
+                    m_LastWritten = end;
+                } else {
+                    m_Stats.framesFailed++;
+                }
+
+                m_Free.push_back(slotIndex);
+                m_Encoding--;
+            }
+            m_Signal.notify_all();
+        }
+    }
+
+    std::optional<size_t> FrameCapture::write(const Slot &slot) const {
+        NEURON_PROFILE_SCOPE("FrameCapture::write");
+
+        const size_t               size = static_cast<size_t>(slot.extent.width) * slot.extent.height * texelSize(slot.format);
+        std::span<const std::byte> pixels(static_cast<const std::byte *>(slot.buffer.allocation.mapped), size);
+
+        std::vector<std::byte> encoded;
+        switch (m_Settings.format) {
+        case CaptureFormat::Png:
+            encoded = encodePng(pixels, slot.extent.width, slot.extent.height, isBgra8(slot.format));
+            pixels  = encoded;
+            break;
+        case CaptureFormat::Qoi:
+            encoded = encodeQoi(pixels, slot.extent.width, slot.extent.height, isBgra8(slot.format));
+            pixels  = encoded;
+            break;
+        case CaptureFormat::Raw:
+            break;
+        }
+
+        const std::filesystem::path path = getPath(slot.frameNumber);
+        std::ofstream               file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(pixels.data()), static_cast<std::streamsize>(pixels.size()));
+        file.close();
+
+        if (!file) {
+            spdlog::error("Failed to write captured frame {}", path.string());
+            return std::nullopt;
+        }
+        return pixels.size();
+    }
+
+    FrameCaptureStats FrameCapture::getStats() const {
+        std::lock_guard lock(m_Mutex);
+
+        FrameCaptureStats stats = m_Stats;
+        if (m_LastWritten > m_FirstRecord) {
+            stats.framesPerSecond = static_cast<double>(stats.framesCaptured) * 1e9 / static_cast<double>(m_LastWritten - m_FirstRecord);
+        }
+        return stats;
+    }
+
+    std::filesystem::path FrameCapture::getPath(uint64_t frameNumber) const {
+        static constexpr std::array<const char *, 3> EXTENSIONS = {"png", "qoi", "raw"};
+        return m_Settings.directory / std::format("{}{:06}.{}", m_Settings.prefix, frameNumber, EXTENSIONS[static_cast<size_t>(m_Settings.format)]);
+    }
+
+    std::vector<std::byte> FrameCapture::encodeQoi(std::span<const std::byte> pixels, uint32_t width, uint32_t height, bool bgra) {
+        using Pixel = std::array<uint8_t, 4>;
+
+        const size_t count = static_cast<size_t>(width) * height;
+        if (pixels.size() < count * 4) {
+            throw std::runtime_error("Not enough pixels to encode");
+        }
+
+        std::vector<std::byte> out;
+        // the worst case is 5 bytes per pixel, which never happens for rendered frames
+        out.reserve(14 + count * 2 + 8);
+
+        const auto put   = [&](uint32_t byte) { out.push_back(static_cast<std::byte>(byte)); };
+        const auto put32 = [&](uint32_t value) {
+            put(value >> 24);
+            put((value >> 16) & 0xff);
+            put((value >> 8) & 0xff);
+            put(value & 0xff);
+        };
+
+        put('q');
+        put('o');
+        put('i');
+        put('f');
+        put32(width);
+        put32(height);
+        put(4);
+        put(0);
+
+        std::array<Pixel, 64> seen{};
+        Pixel                 previous = {0, 0, 0, 255};
+        uint32_t              run      = 0;
+
+        const auto *data = reinterpret_cast<const uint8_t *>(pixels.data());
+        for (size_t i = 0; i < count; i++) {
+            const uint8_t *source = data + i * 4;
+            const Pixel    pixel  = bgra ? Pixel{source[2], source[1], source[0], source[3]} : Pixel{source[0], source[1], source[2], source[3]};
+
+            if (pixel == previous) {
+                run++;
+                if (run == 62 || i + 1 == count) {
+                    put(0xc0 | (run - 1));
+                    run = 0;
+                }
+                continue;
+            }
+
+            if (run > 0) {
+                put(0xc0 | (run - 1));
+                run = 0;
+            }
+
+            const uint32_t hash = (pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64;
+            if (seen[hash] == pixel) {
+                put(hash);
+            } else {
+                seen[hash] = pixel;
+
+                if (pixel[3] == previous[3]) {
+                    // differences wrap around, like the decoder's additions
+                    const int dr = static_cast<int8_t>(static_cast<uint8_t>(pixel[0] - previous[0]));
+                    const int dg = static_cast<int8_t>(static_cast<uint8_t>(pixel[1] - previous[1]));
+                    const int db = static_cast<int8_t>(static_cast<uint8_t>(pixel[2] - previous[2]));
+
+                    const int drDg = dr - dg;
+                    const int dbDg = db - dg;
+
+                    if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                        put(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+                    } else if (dg >= -32 && dg <= 31 && drDg >= -8 && drDg <= 7 && dbDg >= -8 && dbDg <= 7) {
+                        put(0x80 | (dg + 32));
+                        put((drDg + 8) << 4 | (dbDg + 8));
+                    } else {
+                        put(0xfe);
+                        put(pixel[0]);
+                        put(pixel[1]);
+                        put(pixel[2]);
+                    }
+                } else {
+                    put(0xff);
+                    put(pixel[0]);
+                    put(pixel[1]);
+                    put(pixel[2]);
+                    put(pixel[3]);
+                }
+            }
+            previous = pixel;
+        }
+
+        for (uint32_t i = 0; i < 7; i++)
+            put(0);
+        put(1);
+
+        return out;
+    }
+
+    std::vector<std::byte> FrameCapture::encodePng(std::span<const std::byte> pixels, uint32_t width, uint32_t height, bool bgra) {
+        const size_t size = static_cast<size_t>(width) * height * 4;
+        if (pixels.size() < size) {
+            throw std::runtime_error("Not enough pixels to encode");
+        }
+
+        std::vector<std::byte> swizzled;
+        if (bgra) {
+            swizzled.assign(pixels.begin(), pixels.begin() + static_cast<ptrdiff_t>(size));
+            for (size_t i = 0; i < size; i += 4)
+                std::swap(swizzled[i], swizzled[i + 2]);
+            pixels = swizzled;
+        }
+
+        std::vector<std::byte> out;
+        const auto             append = [](void *context, void *data, int length) {
+            auto       &target = *static_cast<std::vector<std::byte> *>(context);
+            const auto *bytes  = static_cast<const std::byte *>(data);
+            target.insert(target.end(), bytes, bytes + length);
+        };
+
+        if (stbi_write_png_to_func(append, &out, static_cast<int>(width), static_cast<int>(height), 4, pixels.data(), static_cast<int>(width * 4)) == 0) {
+            throw std::runtime_error("Failed to encode PNG");
+        }
+        return out;
+    }
+
+} // namespace neuron::graphics
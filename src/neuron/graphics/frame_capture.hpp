@@ -0,0 +1,175 @@
+#pragma once
+
+#include "neuron/graphics/gcontext.hpp"
+#include "neuron/graphics/memory.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace neuron::graphics {
+
+    enum class CaptureFormat {
+        /**
+         * Deflate compressed through stb_image_write. Small files, but by far the slowest to encode.
+         */
+        Png,
+
+        /**
+         * The "Quite OK Image" format: lossless, a single pass over the pixels and several times faster than PNG at a somewhat larger size.
+         */
+        Qoi,
+
+        /**
+         * The readback bytes as they are, row by row without a header and in the format of the target. Costs nothing but disk bandwidth.
+         */
+        Raw,
+    };
+
+    struct FrameCaptureSettings {
+        std::filesystem::path directory = ".";
+
+        /**
+         * Files are named <prefix><frame number, 6 digits>.<png|qoi|raw>.
+         */
+        std::string   prefix = "frame_";
+        CaptureFormat format = CaptureFormat::Qoi;
+
+        /**
+         * Readback buffers in the ring. Frames whose copy is on the GPU or whose buffer is being encoded hold one each; when none is free, record() blocks until an encoder
+         * returns one.
+         */
+        uint32_t ringSize = 4;
+
+        /**
+         * Threads that wait for the copies and encode them.
+         */
+        uint32_t workerCount = 2;
+    };
+
+    struct FrameCaptureStats {
+        /**
+         * Frames encoded and written, and frames that failed to be read back, encoded or written.
+         */
+        uint64_t framesCaptured = 0;
+        uint64_t framesFailed   = 0;
+
+        /**
+         * Frames written per second, from the first record() to the last written frame.
+         */
+        double framesPerSecond = 0.0;
+
+        /**
+         * How often, and for how long in total, record() blocked because every readback buffer was still in use.
+         */
+        uint64_t stalls           = 0;
+        uint64_t stallNanoseconds = 0;
+
+        /**
+         * Time the workers spent encoding and writing, summed over all of them.
+         */
+        uint64_t encodeNanoseconds = 0;
+        uint64_t bytesWritten      = 0;
+    };
+
+    /**
+     *
+     * Archives the frames of any render target to disk without stalling the render thread on the readback or the encoding. record() adds a copy of the frame's image into a
+     * host-visible buffer from a ring to the frame's own command buffer, and commit() puts a fence behind the frame's submission. Worker threads wait on those fences in
+     * order, encode the pixels and write the files, then hand the buffer back to the ring.
+     *
+     * The target's images need vk::ImageUsageFlagBits::eTransferSrc (ImageRenderTarget has it while readback is enabled, SurfaceRenderTarget only when it is in
+     * desiredImageUsage), an 8-bit RGBA or BGRA format for PNG and QOI, and their frames must be submitted to the primary queue, as both render targets do.
+     *
+     * Destroying the capture writes every committed frame first.
+     *
+     */
+    class FrameCapture final {
+      public:
+        /**
+         * @throws std::runtime_error if ringSize or workerCount is 0, or the directory can't be created.
+         */
+        explicit FrameCapture(const std::shared_ptr<GContext> &gc, const FrameCaptureSettings &settings = {});
+        ~FrameCapture();
+
+        FrameCapture(const FrameCapture &)            = delete;
+        FrameCapture &operator=(const FrameCapture &) = delete;
+
+        /**
+         * Records the copy of the frame's image into a free readback buffer, between beginFrame() and endFrame() of the target. Leaves the image in
+         * vk::ImageLayout::eColorAttachmentOptimal. Blocks while the ring is full.
+         *
+         * @return The number of the captured frame, which is also in its file name.
+         * @throws std::runtime_error if the previous record() wasn't committed, the format can't be encoded or the images can't be copied from.
+         */
+        uint64_t record(const FrameContext &frame, const IRenderTarget &target);
+
+        /**
+         * Call after the target's endFrame() submitted the recorded frame. Hands the frame to the encoders once the GPU finished it.
+         *
+         * @throws std::runtime_error if nothing was recorded.
+         */
+        void commit();
+
+        /**
+         * Blocks until every committed frame was written.
+         */
+        void flush();
+
+        [[nodiscard]] FrameCaptureStats getStats() const;
+
+        [[nodiscard]] inline const FrameCaptureSettings &getSettings() const noexcept { return m_Settings; }
+
+        [[nodiscard]] std::filesystem::path getPath(uint64_t frameNumber) const;
+
+        /**
+         * @param pixels width * height pixels of 4 bytes each.
+         * @param bgra Whether the pixels are in blue, green, red order, like the common swapchain formats.
+         */
+        [[nodiscard]] static std::vector<std::byte> encodeQoi(std::span<const std::byte> pixels, uint32_t width, uint32_t height, bool bgra = false);
+        [[nodiscard]] static std::vector<std::byte> encodePng(std::span<const std::byte> pixels, uint32_t width, uint32_t height, bool bgra = false);
+
+      private:
+        struct Slot {
+            AllocatedBuffer buffer;
+            vk::DeviceSize  capacity = 0;
+            vk::Fence       fence;
+
+            uint64_t     frameNumber = 0;
+            vk::Extent2D extent;
+            vk::Format   format = vk::Format::eUndefined;
+        };
+
+        std::shared_ptr<GContext> m_GC;
+        FrameCaptureSettings      m_Settings;
+
+        std::vector<Slot>       m_Slots;
+        std::optional<uint32_t> m_Recorded;
+        uint64_t                m_NextFrame = 0;
+
+        mutable std::mutex       m_Mutex;
+        std::condition_variable  m_Signal;
+        std::vector<uint32_t>    m_Free;
+        std::deque<uint32_t>     m_Committed;
+        std::vector<std::thread> m_Workers;
+        uint32_t                 m_Encoding = 0;
+        bool                     m_Stopping = false;
+
+        FrameCaptureStats m_Stats;
+        uint64_t          m_FirstRecord = 0;
+        uint64_t          m_LastWritten = 0;
+
+        void                                run(uint32_t index);
+        [[nodiscard]] std::optional<size_t> write(const Slot &slot) const;
+        void                                stop() noexcept;
+    };
+
+} // namespace neuron::graphics
@@ -2,7 +2,8 @@
 
 #include "neuron/math/utils.hpp"
 
-#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <array>
 #include <limits>
 
 #include <unordered_set>
@@ -12,16 +13,48 @@
 namespace neuron::graphics {
 
 
-    GContext::GContext(const GCSettings &settings) {
+    DeviceRequirements GContext::getRequirements(const GCSettings &settings) {
+        DeviceRequirements requirements{
+            .requiredFeatures   = settings.requiredFeatures,
+            .optionalFeatures   = settings.optionalFeatures,
+            .requiredExtensions = settings.requestedExtensions,
+            .optionalExtensions = settings.optionalExtensions,
+        };
 
-        // TODO: non-naive gpu selection, allow user to manually select gpu
-        m_Gpu = Context::get()->getInstance().enumeratePhysicalDevices().front();
+        // headless processes may run on drivers without any WSI support
+        if (!Context::get()->getSettings().offscreenRenderingOnly &&
+            std::ranges::none_of(requirements.requiredExtensions, [](const char *name) { return std::string_view(name) == VK_KHR_SWAPCHAIN_EXTENSION_NAME; })) {
+            requirements.requiredExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        }
+        return requirements;
+    }
+
+    GContext::GContext(const GCSettings &settings) : m_UploadSettings(settings.uploadSettings), m_ComputeSettings(settings.computeSettings) {
+        const DeviceRequirements requirements = getRequirements(settings);
+
+        m_Gpu = m_Startup.measure("device selection", [&] { return selectDevice(Context::get()->getInstance(), requirements, settings.deviceSelection).gpu; });
+        const uint64_t deviceBegin = utils::Profiler::now();
+
+        m_Properties       = m_Gpu.getProperties();
+        m_MemoryProperties = m_Gpu.getMemoryProperties();
+
+        // required features are known to be supported at this point, optional ones are enabled where they are
+        m_EnabledFeatures = settings.requiredFeatures;
+        m_EnabledFeatures |= DeviceFeatures::query(m_Gpu).intersect(settings.optionalFeatures);
+        m_FastPaths = FastPaths::from(m_EnabledFeatures);
+
+        spdlog::info("Fast paths: timeline semaphores {}, synchronization2 {}, dynamic rendering {}, buffer device address {}, descriptor indexing {}",
+                     m_FastPaths.timelineSemaphores, m_FastPaths.synchronization2, m_FastPaths.dynamicRendering, m_FastPaths.bufferDeviceAddress,
+                     m_FastPaths.descriptorIndexing);
 
 
         std::unordered_map<uint32_t, uint32_t> queueCounts;
 
         auto queueFamilyProperties = m_Gpu.getQueueFamilyProperties();
 
+        // selectDevice() rejects devices without one
+        m_PrimaryQueueFamily = findPrimaryQueueFamily(queueFamilyProperties).value();
+
         uint32_t index = 0;
         for (const auto &properties : queueFamilyProperties) {
             if (!m_TransferQueueFamily.has_value() && (properties.queueFlags & vk::QueueFlagBits::eTransfer) && !(properties.queueFlags & vk::QueueFlagBits::eGraphics) &&
@@ -40,9 +73,23 @@ namespace neuron::graphics {
             index++;
         }
 
-        // TODO: support nonprimary presentation families, primary queue families other than 0
+        // TODO: support nonprimary presentation families
+
+        std::vector<QueueRequest> queueRequests = settings.queueRequests;
+
+        // the upload service streams on the dedicated transfer queue whenever there is one
+        if (m_TransferQueueFamily.has_value() && m_FastPaths.timelineSemaphores &&
+            std::ranges::none_of(queueRequests, [](const QueueRequest &request) { return request.type == QueueType::Transfer; })) {
+            queueRequests.push_back({QueueType::Transfer, 1});
+        }
+
+        // GpuCuller's async culling and the compute service submit to the dedicated compute queue whenever there is one
+        if (m_ComputeQueueFamily.has_value() && m_FastPaths.timelineSemaphores &&
+            std::ranges::none_of(queueRequests, [](const QueueRequest &request) { return request.type == QueueType::Compute; })) {
+            queueRequests.push_back({QueueType::Compute, 1});
+        }
 
-        for (const auto &request : settings.queueRequests) {
+        for (const auto &request : queueRequests) {
             uint32_t qf = UINT32_MAX;
             switch (request.type) {
             case QueueType::Primary:
@@ -101,25 +148,25 @@ namespace neuron::graphics {
             queuePriorities.push_back(priorities);
         }
 
-        std::vector<const char *>       deviceExtensions;
-        std::unordered_set<std::string> extraExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+        std::unordered_set<std::string> availableExtensions;
+        for (const auto &extension : m_Gpu.enumerateDeviceExtensionProperties()) {
+            availableExtensions.insert(extension.extensionName.data());
+        }
 
-        for (const char *extensionName : settings.requestedExtensions) {
-            extraExtensions.erase(std::string(extensionName));
-            deviceExtensions.push_back(extensionName);
+        m_EnabledExtensions.assign(requirements.requiredExtensions.begin(), requirements.requiredExtensions.end());
+        for (const char *extension : settings.optionalExtensions) {
+            if (availableExtensions.contains(extension) && !isExtensionEnabled(extension)) {
+                m_EnabledExtensions.emplace_back(extension);
+            }
         }
 
-        for (const auto &string : extraExtensions) {
-            deviceExtensions.push_back(string.c_str());
+        std::vector<const char *> deviceExtensions;
+        for (const auto &extension : m_EnabledExtensions) {
+            deviceExtensions.push_back(extension.c_str());
         }
 
-        // TODO: user requested features
-        vk::PhysicalDeviceFeatures2 f2{};
-        f2.features.tessellationShader = true;
-        f2.features.geometryShader     = true;
-        f2.features.wideLines          = true;
-        f2.features.largePoints        = true;
-        f2.features.fillModeNonSolid   = true;
+        DeviceFeatures              features = m_EnabledFeatures;
+        vk::PhysicalDeviceFeatures2 f2       = features.link(m_Properties.apiVersion);
 
         m_Device = m_Gpu.createDevice(vk::DeviceCreateInfo({}, queueCreateInfos, {}, deviceExtensions, nullptr, &f2));
 
@@ -128,12 +175,31 @@ namespace neuron::graphics {
         }
 
         m_PrimaryQueue = m_Device.getQueue(m_PrimaryQueueFamily, queueCounts[m_PrimaryQueueFamily] - 1);
+
+        for (const auto &entry : queueCounts) {
+            for (uint32_t i = 0; i < entry.second; i++) {
+                m_QueueLocks.emplace(static_cast<VkQueue>(m_Device.getQueue(entry.first, i)), std::make_unique<std::mutex>());
+            }
+        }
+
+        m_Startup.add("device", deviceBegin, utils::Profiler::now());
+
+        m_Startup.measure("allocator", [&] { m_Allocator = std::make_unique<MemoryAllocator>(*this, settings.memorySettings); });
+
+        spdlog::info("Device ready in {}", m_Startup.format());
     }
 
     GContext::~GContext() {
+        m_ComputeService.reset();
+        m_UploadService.reset();
+        m_Allocator.reset();
         m_Device.destroy();
     }
 
+    bool GContext::isExtensionEnabled(std::string_view name) const {
+        return std::ranges::find(m_EnabledExtensions, name) != m_EnabledExtensions.end();
+    }
+
     std::optional<vk::Queue> GContext::getQueue(QueueType type, uint32_t index) const {
         auto family = getQueueFamily(type);
         if (family.has_value()) {
@@ -162,6 +228,56 @@ namespace neuron::graphics {
         return m_PrimaryQueue;
     }
 
+    UploadService &GContext::getUploadService() const {
+        if (!m_FastPaths.timelineSemaphores) {
+            throw std::runtime_error("The upload service needs timeline semaphore support");
+        }
+
+        // its command pools and staging memory are only worth having once something uploads
+        std::call_once(m_UploadServiceOnce, [this] {
+            m_Startup.measure("upload service", [this] { m_UploadService = std::make_unique<UploadService>(const_cast<GContext &>(*this), m_UploadSettings); });
+        });
+        return *m_UploadService;
+    }
+
+    ComputeService &GContext::getComputeService() const {
+        if (!m_FastPaths.timelineSemaphores) {
+            throw std::runtime_error("The compute service needs timeline semaphore support");
+        }
+
+        std::call_once(m_ComputeServiceOnce, [this] {
+            m_Startup.measure("compute service", [this] { m_ComputeService = std::make_unique<ComputeService>(const_cast<GContext &>(*this), m_ComputeSettings); });
+        });
+        return *m_ComputeService;
+    }
+
+    void GContext::submit(vk::Queue queue, const vk::ArrayProxy<const vk::SubmitInfo> &submits, vk::Fence fence) const {
+        std::lock_guard lock(*m_QueueLocks.at(static_cast<VkQueue>(queue)));
+        queue.submit(submits, fence);
+    }
+
+    vk::Result GContext::present(const vk::PresentInfoKHR &presentInfo) const {
+        std::lock_guard lock(*m_QueueLocks.at(static_cast<VkQueue>(m_PrimaryQueue)));
+        return m_PrimaryQueue.presentKHR(presentInfo);
+    }
+
+    uint32_t GContext::findMemoryType(uint32_t typeBits, vk::MemoryPropertyFlags required, vk::MemoryPropertyFlags preferred) const {
+        const vk::MemoryPropertyFlags wanted = required | preferred;
+        for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; i++) {
+            if ((typeBits & (1U << i)) && (m_MemoryProperties.memoryTypes[i].propertyFlags & wanted) == wanted) {
+                return i;
+            }
+        }
+
+        for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; i++) {
+            if ((typeBits & (1U << i)) && (m_MemoryProperties.memoryTypes[i].propertyFlags & required) == required) {
+                return i;
+            }
+        }
+
+        throw std::runtime_error("No suitable memory type");
+    }
+
     std::tuple<vk::Format, vk::ColorSpaceKHR> selectPreferredSurfaceFormat(const std::shared_ptr<GContext> &gc, vk::SurfaceKHR surface) {
         auto surfaceFormats  = gc->getGpu().getSurfaceFormatsKHR(surface);
         bool foundBGRA_SRGB  = false;
@@ -216,20 +332,30 @@ namespace neuron::graphics {
 
     SurfaceRenderTarget::SurfaceRenderTarget(const std::shared_ptr<GContext> &gc, vk::SurfaceKHR surface, const SurfaceRenderTargetConfiguration &configuration)
         : m_GC(gc), m_TargetConfiguration(configuration) {
-        m_Surface = surface;
+        m_Surface         = surface;
+        m_RequestedExtent = configuration.fallbackExtent;
+        m_SizeProvider    = [this] { return m_RequestedExtent; };
         initialConfigure();
         createSwapchain();
+        createFrames();
     }
 
     SurfaceRenderTarget::SurfaceRenderTarget(const std::shared_ptr<GContext> &gc, const std::shared_ptr<ISurfaceProvider> &surfaceProvider,
                                              const SurfaceRenderTargetConfiguration &configuration)
         : m_GC(gc), m_TargetConfiguration(configuration) {
-        m_Surface = surfaceProvider->getOrCreateSurface();
+        m_Surface         = surfaceProvider->getOrCreateSurface();
+        m_RequestedExtent = configuration.fallbackExtent;
+        m_SizeProvider    = [this] { return m_RequestedExtent; };
         initialConfigure();
         createSwapchain();
+        createFrames();
     }
 
-    void SurfaceRenderTarget::resizeTarget(const vk::Extent2D &newSize) {}
+    void SurfaceRenderTarget::resizeTarget(const vk::Extent2D &newSize) {
+        // recreation is deferred to the next beginFrame(), which already waited for the frame slot it is about to reuse
+        m_RequestedExtent = newSize;
+        m_SwapchainDirty  = true;
+    }
 
     vk::Image SurfaceRenderTarget::getImageTarget(uint32_t index) const {
         return m_Images[index];
@@ -255,6 +381,8 @@ namespace neuron::graphics {
             m_Configuration.extent = neuron::math::clamp(m_SizeProvider(), capabilities.minImageExtent, capabilities.maxImageExtent);
         }
 
+        m_Configuration.usage = m_TargetConfiguration.desiredImageUsage;
+
         uint32_t minImageCount = capabilities.minImageCount + 1;
         if (capabilities.maxImageCount > 0 && minImageCount > capabilities.maxImageCount) {
             minImageCount = capabilities.maxImageCount;
@@ -264,11 +392,12 @@ namespace neuron::graphics {
             vk::SwapchainCreateInfoKHR({}, m_Surface, minImageCount, m_Configuration.format, m_ColorSpace, m_Configuration.extent, 1, m_TargetConfiguration.desiredImageUsage,
                                        vk::SharingMode::eExclusive, {}, capabilities.currentTransform, vk::CompositeAlphaFlagBitsKHR::eOpaque, m_PresentMode, true, old));
 
-        m_GC->getDevice().waitIdle();
-
-        for (const auto &iv : m_ImageViews)
-            m_GC->getDevice().destroy(iv);
-        m_GC->getDevice().destroy(old);
+        // frames still in flight may present from the old swapchain, so it is retired instead of waiting for the device to go idle
+        if (old) {
+            m_Retired.push_back(RetiredSwapchain{old, std::move(m_ImageViews), std::move(m_RenderFinished), m_FramesSubmitted + 1});
+            m_ImageViews.clear();
+            m_RenderFinished.clear();
+        }
 
         m_Images = m_GC->getDevice().getSwapchainImagesKHR(m_Swapchain);
 
@@ -277,13 +406,419 @@ namespace neuron::graphics {
             m_ImageViews[i] =
                 m_GC->getDevice().createImageView(vk::ImageViewCreateInfo({}, m_Images[i], vk::ImageViewType::e2D, m_Configuration.format, STANDARD_COMPONENT_MAPPING, BASIC_ISR));
         }
+
+        // one present semaphore per image, since a frame slot can't know when the presentation engine is done with the previous one
+        m_RenderFinished.resize(m_Images.size());
+        for (auto &semaphore : m_RenderFinished) {
+            semaphore = m_GC->getDevice().createSemaphore(vk::SemaphoreCreateInfo());
+        }
+
+        m_SwapchainDirty = false;
+    }
+
+    void SurfaceRenderTarget::createFrames() {
+        const vk::Device &device = m_GC->getDevice();
+
+        if (m_TargetConfiguration.framesInFlight == 0) {
+            throw std::runtime_error("SurfaceRenderTarget needs at least one frame in flight");
+        }
+
+        if (m_GC->supportsTimelineSemaphores()) {
+            vk::SemaphoreTypeCreateInfo typeInfo(vk::SemaphoreType::eTimeline, 0);
+            m_Timeline = device.createSemaphore(vk::SemaphoreCreateInfo({}, &typeInfo));
+        }
+
+        m_Frames.resize(m_TargetConfiguration.framesInFlight);
+        for (auto &frame : m_Frames) {
+            frame.commandPool    = device.createCommandPool(vk::CommandPoolCreateInfo(vk::CommandPoolCreateFlagBits::eTransient, m_GC->getQueueFamily(QueueType::Primary).value()));
+            frame.commandBuffer  = device.allocateCommandBuffers(vk::CommandBufferAllocateInfo(frame.commandPool, vk::CommandBufferLevel::ePrimary, 1)).front();
+            frame.imageAvailable = device.createSemaphore(vk::SemaphoreCreateInfo());
+
+            if (!m_Timeline) {
+                frame.fence = device.createFence(vk::FenceCreateInfo(vk::FenceCreateFlagBits::eSignaled));
+            }
+        }
+    }
+
+    void SurfaceRenderTarget::waitForFrame(const FrameData &frame) const {
+        if (m_Timeline) {
+            if (frame.serial > 0) {
+                (void)m_GC->getDevice().waitSemaphores(vk::SemaphoreWaitInfo({}, m_Timeline, frame.serial), std::numeric_limits<uint64_t>::max());
+            }
+        } else {
+            (void)m_GC->getDevice().waitForFences(frame.fence, true, std::numeric_limits<uint64_t>::max());
+        }
+    }
+
+    uint64_t SurfaceRenderTarget::getCompletedFrames() const {
+        if (m_Timeline) {
+            return m_GC->getDevice().getSemaphoreCounterValue(m_Timeline);
+        }
+
+        uint64_t completed = m_FramesSubmitted;
+        for (const auto &frame : m_Frames) {
+            if (frame.serial > 0 && m_GC->getDevice().getFenceStatus(frame.fence) != vk::Result::eSuccess) {
+                completed = std::min(completed, frame.serial - 1);
+            }
+        }
+
+        return completed;
+    }
+
+    void SurfaceRenderTarget::collectRetired() {
+        if (m_Retired.empty())
+            return;
+
+        const vk::Device &device    = m_GC->getDevice();
+        const uint64_t    completed = getCompletedFrames();
+
+        std::erase_if(m_Retired, [&](const RetiredSwapchain &retired) {
+            if (retired.retireAfter > completed)
+                return false;
+
+            for (const auto &iv : retired.imageViews)
+                device.destroy(iv);
+            for (const auto &semaphore : retired.renderFinished)
+                device.destroy(semaphore);
+            device.destroy(retired.swapchain);
+            return true;
+        });
+    }
+
+    FrameContext SurfaceRenderTarget::beginFrame() {
+        if (m_AcquiredImage.has_value()) {
+            throw std::runtime_error("beginFrame() called twice without endFrame()");
+        }
+
+        const vk::Device &device = m_GC->getDevice();
+        FrameData        &frame  = m_Frames[m_CurrentFrame];
+
+        waitForFrame(frame);
+        collectRetired();
+
+        if (m_SwapchainDirty) {
+            createSwapchain();
+        }
+
+        uint32_t imageIndex;
+        while (true) {
+            try {
+                auto acquired = device.acquireNextImageKHR(m_Swapchain, std::numeric_limits<uint64_t>::max(), frame.imageAvailable, nullptr);
+                if (acquired.result == vk::Result::eSuboptimalKHR) {
+                    m_SwapchainDirty = true;
+                }
+                imageIndex = acquired.value;
+                break;
+            } catch (const vk::OutOfDateKHRError &) {
+                createSwapchain();
+            }
+        }
+
+        // only reset once an image was acquired, so a failed acquire can't leave the fence unsignaled forever
+        if (frame.fence) {
+            device.resetFences(frame.fence);
+        }
+        device.resetCommandPool(frame.commandPool);
+
+        frame.commandBuffer.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+        frame.commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::PipelineStageFlagBits::eColorAttachmentOutput, {}, {}, {},
+                                            vk::ImageMemoryBarrier({}, vk::AccessFlagBits::eColorAttachmentWrite, vk::ImageLayout::eUndefined,
+                                                                   vk::ImageLayout::eColorAttachmentOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+                                                                   m_Images[imageIndex], BASIC_ISR));
+
+        m_AcquiredImage = imageIndex;
+        return FrameContext{m_CurrentFrame, imageIndex, frame.commandBuffer};
+    }
+
+    void SurfaceRenderTarget::endFrame() {
+        if (!m_AcquiredImage.has_value()) {
+            throw std::runtime_error("endFrame() called without beginFrame()");
+        }
+
+        FrameData     &frame          = m_Frames[m_CurrentFrame];
+        const uint32_t imageIndex     = m_AcquiredImage.value();
+        vk::Semaphore &renderFinished = m_RenderFinished[imageIndex];
+
+        frame.commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::PipelineStageFlagBits::eBottomOfPipe, {}, {}, {},
+                                            vk::ImageMemoryBarrier(vk::AccessFlagBits::eColorAttachmentWrite, {}, vk::ImageLayout::eColorAttachmentOptimal,
+                                                                   vk::ImageLayout::ePresentSrcKHR, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, m_Images[imageIndex],
+                                                                   BASIC_ISR));
+        frame.commandBuffer.end();
+
+        vk::PipelineStageFlags waitStage = vk::PipelineStageFlagBits::eColorAttachmentOutput;
+
+        frame.serial = m_FramesSubmitted + 1;
+
+        if (m_Timeline) {
+            std::array<vk::Semaphore, 2> signalSemaphores = {renderFinished, m_Timeline};
+            std::array<uint64_t, 2>      signalValues     = {0, frame.serial};
+            uint64_t                     waitValue        = 0;
+
+            vk::TimelineSemaphoreSubmitInfo timelineInfo(waitValue, signalValues);
+            vk::SubmitInfo                  submitInfo(frame.imageAvailable, waitStage, frame.commandBuffer, signalSemaphores, &timelineInfo);
+            m_GC->submit(m_GC->getPrimaryQueue(), submitInfo);
+        } else {
+            m_GC->submit(m_GC->getPrimaryQueue(), vk::SubmitInfo(frame.imageAvailable, waitStage, frame.commandBuffer, renderFinished), frame.fence);
+        }
+
+        m_FramesSubmitted++;
+        m_AcquiredImage.reset();
+        m_CurrentFrame = (m_CurrentFrame + 1) % static_cast<uint32_t>(m_Frames.size());
+
+        try {
+            if (m_GC->present(vk::PresentInfoKHR(renderFinished, m_Swapchain, imageIndex)) == vk::Result::eSuboptimalKHR) {
+                m_SwapchainDirty = true;
+            }
+        } catch (const vk::OutOfDateKHRError &) {
+            m_SwapchainDirty = true;
+        }
     }
 
     SurfaceRenderTarget::~SurfaceRenderTarget() {
+        const vk::Device &device = m_GC->getDevice();
+
+        for (const auto &frame : m_Frames) {
+            waitForFrame(frame);
+        }
+
+        for (const auto &frame : m_Frames) {
+            device.destroy(frame.commandPool);
+            device.destroy(frame.imageAvailable);
+            device.destroy(frame.fence);
+        }
+        device.destroy(m_Timeline);
+
+        for (const auto &retired : m_Retired) {
+            for (const auto &iv : retired.imageViews)
+                device.destroy(iv);
+            for (const auto &semaphore : retired.renderFinished)
+                device.destroy(semaphore);
+            device.destroy(retired.swapchain);
+        }
+
+        for (const auto &semaphore : m_RenderFinished)
+            device.destroy(semaphore);
         for (const auto &iv : m_ImageViews)
-            m_GC->getDevice().destroy(iv);
+            device.destroy(iv);
         if (m_Swapchain)
-            m_GC->getDevice().destroy(m_Swapchain);
+            device.destroy(m_Swapchain);
+    }
+
+    static vk::DeviceSize bytesPerPixel(vk::Format format) {
+        switch (format) {
+        case vk::Format::eR8Unorm:
+        case vk::Format::eR8Srgb:
+            return 1;
+        case vk::Format::eR8G8Unorm:
+        case vk::Format::eR16Sfloat:
+            return 2;
+        case vk::Format::eR8G8B8A8Unorm:
+        case vk::Format::eR8G8B8A8Srgb:
+        case vk::Format::eB8G8R8A8Unorm:
+        case vk::Format::eB8G8R8A8Srgb:
+        case vk::Format::eA2B10G10R10UnormPack32:
+        case vk::Format::eR32Sfloat:
+        case vk::Format::eR16G16Sfloat:
+            return 4;
+        case vk::Format::eR16G16B16A16Sfloat:
+        case vk::Format::eR32G32Sfloat:
+            return 8;
+        case vk::Format::eR32G32B32A32Sfloat:
+            return 16;
+        default:
+            throw std::runtime_error("Unsupported format for image readback");
+        }
+    }
+
+    ImageRenderTarget::ImageRenderTarget(const std::shared_ptr<GContext> &gc, const ImageRenderTargetConfiguration &configuration)
+        : m_GC(gc), m_TargetConfiguration(configuration) {
+        if (m_TargetConfiguration.imageCount == 0) {
+            throw std::runtime_error("ImageRenderTarget needs at least one image");
+        }
+
+        m_Configuration.extent = configuration.extent;
+        m_Configuration.format = configuration.format;
+
+        if (m_TargetConfiguration.enableReadback) {
+            m_TargetConfiguration.desiredImageUsage |= vk::ImageUsageFlagBits::eTransferSrc;
+        }
+        m_Configuration.usage = m_TargetConfiguration.desiredImageUsage;
+
+        createImages();
+    }
+
+    ImageRenderTarget::~ImageRenderTarget() {
+        waitForSlots();
+        destroyImages();
+    }
+
+    void ImageRenderTarget::resizeTarget(const vk::Extent2D &newSize) {
+        if (m_RecordingSlot.has_value()) {
+            throw std::runtime_error("Cannot resize an ImageRenderTarget while a frame is being recorded");
+        }
+
+        if (newSize == m_Configuration.extent)
+            return;
+
+        waitForSlots();
+        destroyImages();
+
+        m_Configuration.extent = newSize;
+        createImages();
+    }
+
+    vk::Image ImageRenderTarget::getImageTarget(uint32_t index) const {
+        return m_Slots[index].image.image;
+    }
+
+    vk::ImageView ImageRenderTarget::getImageViewTarget(uint32_t index) const {
+        return m_Slots[index].imageView;
+    }
+
+    FrameContext ImageRenderTarget::beginFrame() {
+        if (m_RecordingSlot.has_value()) {
+            throw std::runtime_error("beginFrame() called twice without endFrame()");
+        }
+
+        const vk::Device &device = m_GC->getDevice();
+        const uint32_t    index  = m_NextSlot;
+        Slot             &slot   = m_Slots[index];
+
+        if (slot.submitted) {
+            (void)device.waitForFences(slot.fence, true, std::numeric_limits<uint64_t>::max());
+            slot.submitted = false;
+        }
+        device.resetFences(slot.fence);
+        device.resetCommandPool(slot.commandPool);
+
+        slot.commandBuffer.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+        slot.commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eColorAttachmentOutput, {}, {}, {},
+                                           vk::ImageMemoryBarrier({}, vk::AccessFlagBits::eColorAttachmentWrite, vk::ImageLayout::eUndefined,
+                                                                  vk::ImageLayout::eColorAttachmentOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, slot.image.image,
+                                                                  BASIC_ISR));
+
+        m_RecordingSlot = index;
+        return FrameContext{index, index, slot.commandBuffer};
+    }
+
+    void ImageRenderTarget::endFrame() {
+        if (!m_RecordingSlot.has_value()) {
+            throw std::runtime_error("endFrame() called without beginFrame()");
+        }
+
+        Slot &slot = m_Slots[m_RecordingSlot.value()];
+
+        if (m_TargetConfiguration.enableReadback) {
+            slot.commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer,
+                                               {}, {}, {},
+                                               vk::ImageMemoryBarrier(vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eTransferWrite,
+                                                                      vk::AccessFlagBits::eTransferRead, vk::ImageLayout::eColorAttachmentOptimal,
+                                                                      vk::ImageLayout::eTransferSrcOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, slot.image.image,
+                                                                      BASIC_ISR));
+
+            const vk::BufferImageCopy region(0, 0, 0, vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1), {0, 0, 0},
+                                             {m_Configuration.extent.width, m_Configuration.extent.height, 1});
+            slot.commandBuffer.copyImageToBuffer(slot.image.image, vk::ImageLayout::eTransferSrcOptimal, slot.readback.buffer, region);
+
+            slot.commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {}, {},
+                                               vk::BufferMemoryBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead, VK_QUEUE_FAMILY_IGNORED,
+                                                                       VK_QUEUE_FAMILY_IGNORED, slot.readback.buffer, 0, VK_WHOLE_SIZE),
+                                               {});
+        }
+
+        slot.commandBuffer.end();
+
+        m_GC->submit(m_GC->getPrimaryQueue(), vk::SubmitInfo({}, {}, slot.commandBuffer, {}), slot.fence);
+
+        slot.submitted = true;
+        m_FramesSubmitted++;
+        m_NextSlot = (m_RecordingSlot.value() + 1) % static_cast<uint32_t>(m_Slots.size());
+        m_RecordingSlot.reset();
+    }
+
+    bool ImageRenderTarget::isFrameComplete(uint32_t index) const {
+        const Slot &slot = m_Slots[index];
+        return !slot.submitted || m_GC->getDevice().getFenceStatus(slot.fence) == vk::Result::eSuccess;
+    }
+
+    std::span<const std::byte> ImageRenderTarget::readback(uint32_t index) {
+        if (!m_TargetConfiguration.enableReadback) {
+            throw std::runtime_error("Readback is not enabled for this ImageRenderTarget");
+        }
+
+        Slot &slot = m_Slots[index];
+        if (slot.submitted) {
+            (void)m_GC->getDevice().waitForFences(slot.fence, true, std::numeric_limits<uint64_t>::max());
+        }
+
+        m_GC->getAllocator().invalidate(slot.readback.allocation);
+
+        return {static_cast<const std::byte *>(slot.readback.allocation.mapped), static_cast<size_t>(m_ReadbackSize)};
+    }
+
+    void ImageRenderTarget::createImages() {
+        const vk::Device &device    = m_GC->getDevice();
+        MemoryAllocator  &allocator = m_GC->getAllocator();
+
+        if (m_TargetConfiguration.enableReadback) {
+            m_ReadbackSize = static_cast<vk::DeviceSize>(m_Configuration.extent.width) * m_Configuration.extent.height * bytesPerPixel(m_Configuration.format);
+        }
+
+        m_Slots.resize(m_TargetConfiguration.imageCount);
+        for (auto &slot : m_Slots) {
+            slot.image = allocator.createImage(vk::ImageCreateInfo({}, vk::ImageType::e2D, m_Configuration.format,
+                                                                   vk::Extent3D(m_Configuration.extent.width, m_Configuration.extent.height, 1), 1, 1,
+                                                                   vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal, m_TargetConfiguration.desiredImageUsage,
+                                                                   vk::SharingMode::eExclusive, {}, vk::ImageLayout::eUndefined),
+                                               vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+            slot.imageView = device.createImageView(
+                vk::ImageViewCreateInfo({}, slot.image.image, vk::ImageViewType::e2D, m_Configuration.format, STANDARD_COMPONENT_MAPPING, BASIC_ISR));
+
+            if (m_TargetConfiguration.enableReadback) {
+                slot.readback = allocator.createBuffer(vk::BufferCreateInfo({}, m_ReadbackSize, vk::BufferUsageFlagBits::eTransferDst, vk::SharingMode::eExclusive),
+                                                       vk::MemoryPropertyFlagBits::eHostVisible, vk::MemoryPropertyFlagBits::eHostCached);
+            }
+
+            slot.commandPool   = device.createCommandPool(vk::CommandPoolCreateInfo(vk::CommandPoolCreateFlagBits::eTransient, m_GC->getQueueFamily(QueueType::Primary).value()));
+            slot.commandBuffer = device.allocateCommandBuffers(vk::CommandBufferAllocateInfo(slot.commandPool, vk::CommandBufferLevel::ePrimary, 1)).front();
+            slot.fence         = device.createFence(vk::FenceCreateInfo());
+        }
+
+        m_NextSlot = 0;
+    }
+
+    void ImageRenderTarget::destroyImages() {
+        const vk::Device &device    = m_GC->getDevice();
+        MemoryAllocator  &allocator = m_GC->getAllocator();
+
+        for (auto &slot : m_Slots) {
+            device.destroy(slot.fence);
+            device.destroy(slot.commandPool);
+
+            if (slot.readback.buffer) {
+                allocator.destroy(slot.readback);
+            }
+
+            device.destroy(slot.imageView);
+            allocator.destroy(slot.image);
+        }
+
+        m_Slots.clear();
+    }
+
+    void ImageRenderTarget::waitForSlots() {
+        std::vector<vk::Fence> pending;
+        for (auto &slot : m_Slots) {
+            if (slot.submitted) {
+                pending.push_back(slot.fence);
+                slot.submitted = false;
+            }
+        }
+
+        if (!pending.empty()) {
+            (void)m_GC->getDevice().waitForFences(pending, true, std::numeric_limits<uint64_t>::max());
+        }
     }
 
 
@@ -1,11 +1,20 @@
 #pragma once
 
+#include "neuron/graphics/compute.hpp"
+#include "neuron/graphics/device.hpp"
+#include "neuron/graphics/memory.hpp"
+#include "neuron/graphics/upload.hpp"
 #include "neuron/neuron.hpp"
 #include "neuron/utils/utils.hpp"
 
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 
 namespace neuron::graphics {
 
@@ -27,19 +36,47 @@ namespace neuron::graphics {
 
     struct GCSettings {
         std::vector<QueueRequest> queueRequests;
+
+        /**
+         * Devices without these extensions are never picked. Optional ones are enabled when the device has them; calibrated timestamps line GpuProfiler scopes up with the CPU,
+         * host memory import lets PackageLoader copy from mapped packages without staging.
+         */
         std::vector<const char *> requestedExtensions;
+        std::vector<const char *> optionalExtensions = {VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME, VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME};
+
+        /**
+         * Devices missing a required feature are never picked. Optional features are enabled where supported; see GContext::getFastPaths() for what the engine got.
+         */
+        DeviceFeatures requiredFeatures;
+        DeviceFeatures optionalFeatures = DeviceFeatures::engineDefaults();
+
+        /**
+         * Picks a device explicitly instead of the best scoring one.
+         */
+        DeviceSelection deviceSelection;
+
+        MemoryAllocatorSettings memorySettings;
+        UploadSettings          uploadSettings;
+        ComputeSettings         computeSettings;
     };
 
     /**
      *
      * GContext is the actual connection to the GPU. This is required for all rendering operations you want to do.
      *
+     * Construction is timed in phases, see getStartupTimings(). The upload and compute services are created on first use and add their own phase then.
+     *
      */
     class GContext final {
       public:
         explicit GContext(const GCSettings &settings = {});
         ~GContext();
 
+        /**
+         * What a device needs for these settings, as device selection checks it.
+         */
+        [[nodiscard]] static DeviceRequirements getRequirements(const GCSettings &settings);
+
         [[nodiscard]] inline const vk::PhysicalDevice &getGpu() const { return m_Gpu; }
 
         [[nodiscard]] inline const vk::Device &getDevice() const { return m_Device; }
@@ -49,11 +86,85 @@ namespace neuron::graphics {
 
         [[nodiscard]] vk::Queue getPrimaryQueue() const;
 
+        /**
+         * Finds a memory type index compatible with typeBits that has all the required property flags. Types which also have the preferred flags are picked first.
+         *
+         * @throws std::runtime_error if no memory type has the required properties.
+         */
+        [[nodiscard]] uint32_t findMemoryType(uint32_t typeBits, vk::MemoryPropertyFlags required, vk::MemoryPropertyFlags preferred = {}) const;
+
+        [[nodiscard]] inline const vk::PhysicalDeviceMemoryProperties &getMemoryProperties() const noexcept { return m_MemoryProperties; }
+
+        [[nodiscard]] inline const vk::PhysicalDeviceProperties &getProperties() const noexcept { return m_Properties; }
+
+        /**
+         * The optional features subsystems look for, as far as they were requested and the device has them.
+         */
+        [[nodiscard]] inline const FastPaths &getFastPaths() const noexcept { return m_FastPaths; }
+
+        /**
+         * Timeline semaphores are core since Vulkan 1.2, but the feature is optional on some drivers. Subsystems fall back to fences when this is false.
+         */
+        [[nodiscard]] inline bool supportsTimelineSemaphores() const noexcept { return m_FastPaths.timelineSemaphores; }
+
+        /**
+         * Pipelines without a render pass need it.
+         */
+        [[nodiscard]] inline bool supportsDynamicRendering() const noexcept { return m_FastPaths.dynamicRendering; }
+
+        [[nodiscard]] inline const DeviceFeatures &getEnabledFeatures() const noexcept { return m_EnabledFeatures; }
+
+        [[nodiscard]] inline const std::vector<std::string> &getEnabledExtensions() const noexcept { return m_EnabledExtensions; }
+
+        [[nodiscard]] bool isExtensionEnabled(std::string_view name) const;
+
+        [[nodiscard]] inline MemoryAllocator &getAllocator() const noexcept { return *m_Allocator; }
+
+        /**
+         * Created by the first call. Thread safe.
+         *
+         * @throws std::runtime_error if the device doesn't support timeline semaphores.
+         */
+        [[nodiscard]] UploadService &getUploadService() const;
+
+        /**
+         * Created by the first call. Thread safe.
+         *
+         * @throws std::runtime_error if the device doesn't support timeline semaphores.
+         */
+        [[nodiscard]] ComputeService &getComputeService() const;
+
+        [[nodiscard]] inline const utils::StartupTimings &getStartupTimings() const noexcept { return m_Startup; }
+
+        /**
+         * Queues are externally synchronized, so every submit and present in the engine goes through these to allow several threads to share a queue.
+         */
+        void                     submit(vk::Queue queue, const vk::ArrayProxy<const vk::SubmitInfo> &submits, vk::Fence fence = {}) const;
+        [[nodiscard]] vk::Result present(const vk::PresentInfoKHR &presentInfo) const;
+
 
       private:
         vk::PhysicalDevice m_Gpu;
         vk::Device         m_Device;
 
+        vk::PhysicalDeviceProperties       m_Properties;
+        vk::PhysicalDeviceMemoryProperties m_MemoryProperties;
+        DeviceFeatures                     m_EnabledFeatures;
+        FastPaths                          m_FastPaths;
+        std::vector<std::string>           m_EnabledExtensions;
+
+        // getUploadService() and getComputeService() create the services and record their phases
+        mutable utils::StartupTimings           m_Startup;
+        UploadSettings                          m_UploadSettings;
+        ComputeSettings                         m_ComputeSettings;
+        std::unique_ptr<MemoryAllocator>        m_Allocator;
+        mutable std::once_flag                  m_UploadServiceOnce;
+        mutable std::unique_ptr<UploadService>  m_UploadService;
+        mutable std::once_flag                  m_ComputeServiceOnce;
+        mutable std::unique_ptr<ComputeService> m_ComputeService;
+
+        std::unordered_map<VkQueue, std::unique_ptr<std::mutex>> m_QueueLocks;
+
         uint32_t                m_PrimaryQueueFamily = 0;
         std::optional<uint32_t> m_TransferQueueFamily;
         std::optional<uint32_t> m_ComputeQueueFamily;
@@ -66,6 +177,21 @@ namespace neuron::graphics {
     struct RenderTargetConfiguration {
         vk::Extent2D extent;
         vk::Format   format;
+
+        /**
+         * What the target's images were created for, so users can check e.g. for vk::ImageUsageFlagBits::eTransferSrc before copying from them.
+         */
+        vk::ImageUsageFlags usage;
+    };
+
+    /**
+     * Handed out by a render target at the start of a frame. The image at imageIndex is in vk::ImageLayout::eColorAttachmentOptimal and must be left in that layout when the frame
+     * is ended.
+     */
+    struct FrameContext {
+        uint32_t          frameIndex;
+        uint32_t          imageIndex;
+        vk::CommandBuffer commandBuffer;
     };
 
     /**
@@ -109,8 +235,20 @@ namespace neuron::graphics {
         virtual vk::SurfaceKHR getSurfaceIfAvailable() = 0;
     };
 
+    constexpr uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
+
     struct SurfaceRenderTargetConfiguration {
         vk::ImageUsageFlags desiredImageUsage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferDst;
+
+        /**
+         * How many frames the CPU may record ahead of the GPU. More frames trade latency for throughput.
+         */
+        uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+
+        /**
+         * Used when the surface lets the application pick the extent (headless and some wayland surfaces). Replaced by the size passed to resizeTarget().
+         */
+        vk::Extent2D fallbackExtent = {1280, 720};
     };
 
     class SurfaceRenderTarget final : public IRenderTarget {
@@ -133,9 +271,52 @@ namespace neuron::graphics {
 
         [[nodiscard]] inline bool isMultiBuffered() const noexcept override { return m_Images.size() > 1; };
 
-        static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 2;
+        [[nodiscard]] inline uint32_t getFramesInFlight() const noexcept { return static_cast<uint32_t>(m_Frames.size()); };
+
+        [[nodiscard]] inline uint32_t getCurrentFrame() const noexcept { return m_CurrentFrame; };
+
+        [[nodiscard]] inline uint64_t getFramesSubmitted() const noexcept { return m_FramesSubmitted; };
+
+        /**
+         * @return the number of old swapchains still waiting for the GPU to finish with them.
+         */
+        [[nodiscard]] inline size_t getRetiredSwapchainCount() const noexcept { return m_Retired.size(); };
+
+        /**
+         * Waits until the current frame slot is free on the GPU, acquires the next swapchain image and starts recording the frame's command buffer.
+         *
+         * Only the frame that used this slot framesInFlight frames ago is waited on, so the CPU records while the GPU is still busy with the previous frames.
+         */
+        [[nodiscard]] FrameContext beginFrame();
+
+        /**
+         * Transitions the image for presentation, submits the frame to the primary queue and presents it. An out of date or suboptimal swapchain is recreated on the
+         * next beginFrame().
+         */
+        void endFrame();
 
       private:
+        struct FrameData {
+            vk::CommandPool   commandPool;
+            vk::CommandBuffer commandBuffer;
+            vk::Semaphore     imageAvailable;
+
+            // fence is only used without timeline semaphores, serial is the frame number signaled on the timeline
+            vk::Fence fence;
+            uint64_t  serial = 0;
+        };
+
+        /**
+         * A replaced swapchain and everything created for its images. Destroyed once the first frame rendered to its successor has completed, since by then every frame
+         * that presented from it has finished too.
+         */
+        struct RetiredSwapchain {
+            vk::SwapchainKHR           swapchain;
+            std::vector<vk::ImageView> imageViews;
+            std::vector<vk::Semaphore> renderFinished;
+            uint64_t                   retireAfter;
+        };
+
         std::shared_ptr<GContext> m_GC;
 
         vk::SurfaceKHR m_Surface;
@@ -147,7 +328,16 @@ namespace neuron::graphics {
         std::vector<vk::Image>     m_Images;
         std::vector<vk::ImageView> m_ImageViews;
 
-        uint32_t m_CurrentFrame = 0;
+        std::vector<FrameData>        m_Frames;
+        std::vector<vk::Semaphore>    m_RenderFinished;
+        vk::Semaphore                 m_Timeline;
+        std::vector<RetiredSwapchain> m_Retired;
+        vk::Extent2D                  m_RequestedExtent;
+
+        std::optional<uint32_t> m_AcquiredImage;
+        uint32_t                m_CurrentFrame    = 0;
+        uint64_t                m_FramesSubmitted = 0;
+        bool                    m_SwapchainDirty  = false;
 
         std::function<vk::Extent2D()> m_SizeProvider;
 
@@ -155,6 +345,95 @@ namespace neuron::graphics {
 
         void initialConfigure();
         void createSwapchain();
+        void createFrames();
+        void waitForFrame(const FrameData &frame) const;
+
+        [[nodiscard]] uint64_t getCompletedFrames() const;
+        void                   collectRetired();
+    };
+
+    struct ImageRenderTargetConfiguration {
+        vk::Extent2D        extent            = {1280, 720};
+        vk::Format          format            = vk::Format::eR8G8B8A8Unorm;
+        uint32_t            imageCount        = 2;
+        vk::ImageUsageFlags desiredImageUsage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferDst;
+        bool                enableReadback    = true;
+    };
+
+    /**
+     *
+     * Offscreen render target for headless rendering. Owns a ring of device-local images, each paired with a host-visible readback buffer, so the next frame can be rendered
+     * while the previous one is still being copied out.
+     *
+     */
+    class ImageRenderTarget final : public IRenderTarget {
+      public:
+        explicit ImageRenderTarget(const std::shared_ptr<GContext> &gc, const ImageRenderTargetConfiguration &configuration = {});
+
+        virtual ~ImageRenderTarget();
+
+        /**
+         * Recreates all images and readback buffers at the new size. Only waits on frames submitted to this target, never on the whole device.
+         */
+        void                        resizeTarget(const vk::Extent2D &newSize) override;
+        [[nodiscard]] vk::Image     getImageTarget(uint32_t index) const override;
+        [[nodiscard]] vk::ImageView getImageViewTarget(uint32_t index) const override;
+
+        [[nodiscard]] inline bool isMultiBuffered() const noexcept override { return m_Slots.size() > 1; };
+
+        [[nodiscard]] inline uint32_t getImageCount() const noexcept { return static_cast<uint32_t>(m_Slots.size()); };
+
+        [[nodiscard]] inline uint64_t getFramesSubmitted() const noexcept { return m_FramesSubmitted; };
+
+        /**
+         * Waits until the next image in the ring is no longer in use by the GPU and starts recording its command buffer.
+         *
+         * The readback data of the previous frame rendered to that image is overwritten by this frame, so read it before the ring wraps around.
+         */
+        [[nodiscard]] FrameContext beginFrame();
+
+        /**
+         * Records the copy into the readback buffer (if enabled) and submits the frame to the primary queue. Does not wait for the GPU.
+         */
+        void endFrame();
+
+        /**
+         * @return true if the last frame submitted for this image has finished executing on the GPU.
+         */
+        [[nodiscard]] bool isFrameComplete(uint32_t index) const;
+
+        /**
+         * Waits for the last frame submitted for this image and returns its pixels, tightly packed row by row.
+         *
+         * @throws std::runtime_error if readback was not enabled for this target.
+         */
+        [[nodiscard]] std::span<const std::byte> readback(uint32_t index);
+
+      private:
+        struct Slot {
+            AllocatedImage  image;
+            vk::ImageView   imageView;
+            AllocatedBuffer readback;
+
+            vk::CommandPool   commandPool;
+            vk::CommandBuffer commandBuffer;
+            vk::Fence         fence;
+            bool              submitted = false;
+        };
+
+        std::shared_ptr<GContext> m_GC;
+
+        std::vector<Slot>       m_Slots;
+        std::optional<uint32_t> m_RecordingSlot;
+        uint32_t                m_NextSlot         = 0;
+        uint64_t                m_FramesSubmitted  = 0;
+        vk::DeviceSize          m_ReadbackSize     = 0;
+
+        ImageRenderTargetConfiguration m_TargetConfiguration;
+
+        void createImages();
+        void destroyImages();
+        void waitForSlots();
     };
 
 } // namespace neuron::graphics
@@ -0,0 +1,185 @@
+#include "gpu_profiler.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace neuron::graphics {
+
+#if defined(_WIN32)
+    constexpr vk::TimeDomainEXT HOST_TIME_DOMAIN = vk::TimeDomainEXT::eQueryPerformanceCounter;
+#else
+    constexpr vk::TimeDomainEXT HOST_TIME_DOMAIN = vk::TimeDomainEXT::eClockMonotonic;
+#endif
+
+    // the host domain in the nanoseconds of utils::Profiler::now()
+    static uint64_t hostToNanoseconds(uint64_t value) {
+#if defined(_WIN32)
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        const auto ticksPerSecond = static_cast<uint64_t>(frequency.QuadPart);
+        return value / ticksPerSecond * 1'000'000'000 + value % ticksPerSecond * 1'000'000'000 / ticksPerSecond;
+#else
+        return value;
+#endif
+    }
+
+    GpuProfiler::GpuProfiler(const std::shared_ptr<GContext> &gc, const GpuProfilerSettings &settings) : m_GC(gc), m_Settings(settings) {
+        const uint32_t family = gc->getQueueFamily(QueueType::Primary).value();
+        m_ValidBits           = gc->getGpu().getQueueFamilyProperties()[family].timestampValidBits;
+        m_TimestampPeriod     = gc->getProperties().limits.timestampPeriod;
+        m_HostReset           = gc->getEnabledFeatures().vulkan12.hostQueryReset == VK_TRUE;
+        m_Track               = utils::Profiler::get().addTrack(settings.trackName);
+
+        if (!isSupported()) {
+            spdlog::warn("The primary queue doesn't support timestamps, GPU scopes won't be timed");
+            return;
+        }
+
+        const uint32_t queryCount = m_Settings.maxScopes * 2;
+        for (uint32_t i = 0; i < std::max(m_Settings.framesInFlight, 1u); i++) {
+            auto &frame = *m_Frames.emplace_back(std::make_unique<Frame>());
+            frame.pool  = gc->getDevice().createQueryPool(vk::QueryPoolCreateInfo({}, vk::QueryType::eTimestamp, queryCount));
+            frame.names.resize(m_Settings.maxScopes);
+        }
+
+        if (gc->isExtensionEnabled(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME)) {
+            const auto domains = gc->getGpu().getCalibrateableTimeDomainsEXT();
+            m_Calibrated       = std::ranges::find(domains, vk::TimeDomainEXT::eDevice) != domains.end() && std::ranges::find(domains, HOST_TIME_DOMAIN) != domains.end();
+        }
+
+        if (m_Calibrated) {
+            calibrate();
+        } else {
+            calibrateWithSubmit();
+        }
+    }
+
+    GpuProfiler::~GpuProfiler() {
+        for (const auto &frame : m_Frames) {
+            m_GC->getDevice().destroyQueryPool(frame->pool);
+        }
+    }
+
+    void GpuProfiler::beginFrame(uint32_t frameIndex, vk::CommandBuffer cmd) {
+        if (!isSupported())
+            return;
+        if (frameIndex >= m_Frames.size()) {
+            throw std::runtime_error("Frame index out of range for this GPU profiler");
+        }
+
+        Frame         &frame = *m_Frames[frameIndex];
+        const uint32_t used  = std::min(frame.used.load(std::memory_order_relaxed), m_Settings.maxScopes);
+
+        m_Resolved.clear();
+        if (used > 0) {
+            if (m_Calibrated)
+                calibrate();
+
+            // value and availability per query; the frame's fence signaled, so everything that was ended is available
+            std::vector<uint64_t> results(used * 4);
+            const vk::Result      result = m_GC->getDevice().getQueryPoolResults(frame.pool, 0, used * 2, results.size() * sizeof(uint64_t), results.data(),
+                                                                                 2 * sizeof(uint64_t), vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWithAvailability);
+            if (result == vk::Result::eSuccess || result == vk::Result::eNotReady) {
+                auto &profiler = utils::Profiler::get();
+                for (uint32_t scope = 0; scope < used; scope++) {
+                    const uint64_t *query = &results[scope * 4];
+                    if (query[1] == 0 || query[3] == 0)
+                        continue;
+
+                    const utils::ProfileEvent event{frame.names[scope], toCpuTime(query[0]), toCpuTime(query[2]), m_Track};
+                    profiler.record(m_Track, event.name, event.begin, event.end);
+                    m_Resolved.push_back(event);
+                }
+            }
+        }
+
+        if (m_HostReset) {
+            m_GC->getDevice().resetQueryPool(frame.pool, 0, m_Settings.maxScopes * 2);
+        } else {
+            cmd.resetQueryPool(frame.pool, 0, m_Settings.maxScopes * 2);
+        }
+        frame.used.store(0, std::memory_order_relaxed);
+        m_FrameIndex = frameIndex;
+    }
+
+    uint32_t GpuProfiler::begin(vk::CommandBuffer cmd, const char *name) {
+        if (!isSupported())
+            return UINT32_MAX;
+
+        Frame         &frame = *m_Frames[m_FrameIndex];
+        const uint32_t scope = frame.used.fetch_add(1, std::memory_order_relaxed);
+        if (scope >= m_Settings.maxScopes)
+            return UINT32_MAX;
+
+        frame.names[scope] = name;
+        cmd.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, frame.pool, scope * 2);
+        return scope;
+    }
+
+    void GpuProfiler::end(vk::CommandBuffer cmd, uint32_t scope) {
+        if (scope == UINT32_MAX)
+            return;
+
+        cmd.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, m_Frames[m_FrameIndex]->pool, scope * 2 + 1);
+    }
+
+    void GpuProfiler::calibrate() {
+        const std::array infos = {vk::CalibratedTimestampInfoEXT(vk::TimeDomainEXT::eDevice), vk::CalibratedTimestampInfoEXT(HOST_TIME_DOMAIN)};
+
+        std::array<uint64_t, 2> timestamps{};
+        uint64_t                deviation = 0;
+        if (m_GC->getDevice().getCalibratedTimestampsEXT(static_cast<uint32_t>(infos.size()), infos.data(), timestamps.data(), &deviation) != vk::Result::eSuccess) {
+            return;
+        }
+
+        m_CalibrationGpu = timestamps[0];
+        m_CalibrationCpu = hostToNanoseconds(timestamps[1]);
+    }
+
+    void GpuProfiler::calibrateWithSubmit() {
+        const vk::Device &device = m_GC->getDevice();
+
+        const auto commandPool = device.createCommandPool(vk::CommandPoolCreateInfo(vk::CommandPoolCreateFlagBits::eTransient, m_GC->getQueueFamily(QueueType::Primary).value()));
+        const auto cmd         = device.allocateCommandBuffers(vk::CommandBufferAllocateInfo(commandPool, vk::CommandBufferLevel::ePrimary, 1)).front();
+        const auto queryPool   = device.createQueryPool(vk::QueryPoolCreateInfo({}, vk::QueryType::eTimestamp, 1));
+        const auto fence       = device.createFence(vk::FenceCreateInfo());
+
+        cmd.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+        cmd.resetQueryPool(queryPool, 0, 1);
+        cmd.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, queryPool, 0);
+        cmd.end();
+
+        // the timestamp was taken somewhere between the submit and the fence signaling, the middle is the best guess
+        const uint64_t submitted = utils::Profiler::now();
+        m_GC->submit(m_GC->getPrimaryQueue(), vk::SubmitInfo({}, {}, cmd), fence);
+        (void)device.waitForFences(fence, true, UINT64_MAX);
+        const uint64_t finished = utils::Profiler::now();
+
+        uint64_t ticks = 0;
+        if (device.getQueryPoolResults(queryPool, 0, 1, sizeof(ticks), &ticks, sizeof(ticks), vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWait) ==
+            vk::Result::eSuccess) {
+            m_CalibrationGpu = ticks;
+            m_CalibrationCpu = submitted + (finished - submitted) / 2;
+        }
+
+        device.destroyFence(fence);
+        device.destroyQueryPool(queryPool);
+        device.destroyCommandPool(commandPool);
+    }
+
+    uint64_t GpuProfiler::toCpuTime(uint64_t ticks) const noexcept {
+        // ticks only have validBits bits and wrap, the sign extended difference also handles timestamps from before the calibration
+        const uint32_t shift = 64 - m_ValidBits;
+        const auto     delta = static_cast<int64_t>((ticks - m_CalibrationGpu) << shift) >> shift;
+        return m_CalibrationCpu + static_cast<int64_t>(static_cast<double>(delta) * m_TimestampPeriod);
+    }
+
+} // namespace neuron::graphics
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "neuron/graphics/gcontext.hpp"
+#include "neuron/utils/profiler.hpp"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace neuron::graphics {
+
+    struct GpuProfilerSettings {
+        uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+
+        /**
+         * Scopes per frame. Scopes beyond that aren't timed.
+         */
+        uint32_t maxScopes = 256;
+
+        /**
+         * The name of the profiler's track in the trace.
+         */
+        std::string trackName = "GPU";
+    };
+
+    /**
+     *
+     * Times command buffer scopes with timestamp queries. Every frame in flight has its own query pool, which is read back when the frame comes around again (at which
+     * point its fence has signaled), so resolving never waits for the GPU.
+     *
+     * Resolved scopes go to utils::Profiler on a track of their own, converted to the CPU clock. With VK_EXT_calibrated_timestamps the clocks are matched every frame;
+     * without it once at construction, through a submit the constructor waits for, which makes GPU scopes appear late by about the submit latency and lets them drift
+     * over time.
+     *
+     * begin() and end() may be called from several threads recording the same frame, beginFrame() must not run concurrently with them.
+     *
+     */
+    class GpuProfiler final {
+      public:
+        explicit GpuProfiler(const std::shared_ptr<GContext> &gc, const GpuProfilerSettings &settings = {});
+        ~GpuProfiler();
+
+        GpuProfiler(const GpuProfiler &)            = delete;
+        GpuProfiler &operator=(const GpuProfiler &) = delete;
+
+        /**
+         * Resolves the scopes of the last frame that used this slot and resets its queries, from cmd unless host query reset is enabled. cmd must be submitted before any
+         * command buffer with scopes of this frame. The GPU must be done with the frame that last used this slot.
+         */
+        void beginFrame(uint32_t frameIndex, vk::CommandBuffer cmd);
+
+        /**
+         * Writes the start timestamp. name must outlive the profiler, see utils::Profiler::intern(). Returns the scope to end, or UINT32_MAX if the frame is out of
+         * scopes or the queue can't do timestamps.
+         */
+        [[nodiscard]] uint32_t begin(vk::CommandBuffer cmd, const char *name);
+
+        void end(vk::CommandBuffer cmd, uint32_t scope);
+
+        /**
+         * Whether the primary queue supports timestamps. Without them begin() and end() do nothing.
+         */
+        [[nodiscard]] inline bool isSupported() const noexcept { return m_ValidBits != 0; }
+
+        [[nodiscard]] inline bool isCalibrated() const noexcept { return m_Calibrated; }
+
+        /**
+         * The scopes beginFrame() resolved last.
+         */
+        [[nodiscard]] inline const std::vector<utils::ProfileEvent> &getResolved() const noexcept { return m_Resolved; }
+
+        [[nodiscard]] inline uint32_t getTrack() const noexcept { return m_Track; }
+
+      private:
+        struct Frame {
+            vk::QueryPool             pool;
+            std::vector<const char *> names;
+            std::atomic<uint32_t>     used = 0;
+        };
+
+        std::shared_ptr<GContext> m_GC;
+        GpuProfilerSettings       m_Settings;
+
+        std::vector<std::unique_ptr<Frame>> m_Frames;
+        uint32_t                            m_FrameIndex = 0;
+
+        uint32_t m_ValidBits       = 0;
+        double   m_TimestampPeriod = 1.0;
+        uint32_t m_Track           = 0;
+
+        // a GPU tick and the CPU time it happened at
+        bool     m_Calibrated     = false;
+        bool     m_HostReset      = false;
+        uint64_t m_CalibrationGpu = 0;
+        uint64_t m_CalibrationCpu = 0;
+
+        std::vector<utils::ProfileEvent> m_Resolved;
+
+        void calibrate();
+        void calibrateWithSubmit();
+
+        [[nodiscard]] uint64_t toCpuTime(uint64_t ticks) const noexcept;
+    };
+
+    /**
+     * Times the commands recorded into cmd between its construction and its destruction.
+     */
+    class GpuScope final {
+      public:
+        GpuScope(GpuProfiler &profiler, vk::CommandBuffer cmd, const char *name) : m_Profiler(profiler), m_Cmd(cmd), m_Scope(profiler.begin(cmd, name)) {}
+
+        ~GpuScope() { m_Profiler.end(m_Cmd, m_Scope); }
+
+        GpuScope(const GpuScope &)            = delete;
+        GpuScope &operator=(const GpuScope &) = delete;
+
+      private:
+        GpuProfiler      &m_Profiler;
+        vk::CommandBuffer m_Cmd;
+        uint32_t          m_Scope;
+    };
+
+} // namespace neuron::graphics
+
+#if defined(NEURON_PROFILING)
+#define NEURON_PROFILE_GPU_SCOPE(profiler, cmd, name) const ::neuron::graphics::GpuScope NEURON_PROFILE_CONCAT(neuronGpuScope, __LINE__)(profiler, cmd, name)
+#else
+#define NEURON_PROFILE_GPU_SCOPE(profiler, cmd, name) ((void) 0)
+#endif
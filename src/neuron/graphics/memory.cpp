@@ -0,0 +1,429 @@
+#include "memory.hpp"
+
+#include "neuron/graphics/gcontext.hpp"
+
+#include <algorithm>
+#include <bit>
+
+#include <spdlog/spdlog.h>
+
+namespace neuron::graphics {
+
+    static vk::DeviceSize alignUp(vk::DeviceSize value, vk::DeviceSize alignment) {
+        return alignment <= 1 ? value : (value + alignment - 1) / alignment * alignment;
+    }
+
+    static vk::DeviceSize alignDown(vk::DeviceSize value, vk::DeviceSize alignment) {
+        return alignment <= 1 ? value : value / alignment * alignment;
+    }
+
+    MemoryStats &MemoryStats::operator+=(const MemoryStats &other) {
+        blockCount += other.blockCount;
+        dedicatedCount += other.dedicatedCount;
+        allocationCount += other.allocationCount;
+        bytesReserved += other.bytesReserved;
+        bytesUsed += other.bytesUsed;
+        largestFreeRange = std::max(largestFreeRange, other.largestFreeRange);
+        return *this;
+    }
+
+    MemoryAllocator::MemoryAllocator(const GContext &gc, const MemoryAllocatorSettings &settings) : m_GC(gc), m_Device(gc.getDevice()), m_Settings(settings) {
+        if (!std::has_single_bit(settings.blockSize) || !std::has_single_bit(settings.minAllocationSize) || settings.minAllocationSize > settings.blockSize) {
+            throw std::runtime_error("Memory block and minimum allocation sizes must be powers of two");
+        }
+
+        m_Granularity = gc.getProperties().limits.bufferImageGranularity;
+        m_AtomSize    = gc.getProperties().limits.nonCoherentAtomSize;
+        m_MaxOrder    = static_cast<uint32_t>(std::countr_zero(settings.blockSize / settings.minAllocationSize));
+    }
+
+    MemoryAllocator::~MemoryAllocator() {
+        uint32_t leaked = 0;
+        for (auto &heap : m_Heaps) {
+            leaked += heap.dedicatedCount;
+            for (auto &block : heap.blocks) {
+                leaked += block->count;
+                m_Device.free(block->memory);
+            }
+        }
+
+        if (leaked > 0) {
+            spdlog::warn("{} device memory allocations were not freed before the allocator was destroyed", leaked);
+        }
+    }
+
+    MemoryAllocator::Heap &MemoryAllocator::heapFor(uint32_t memoryType, ResourceKind kind) {
+        // with a granularity of 1 there is no conflict between linear and optimal resources, so they share blocks
+        const uint32_t kindIndex = m_Granularity > 1 && kind == ResourceKind::Optimal ? 1 : 0;
+        return m_Heaps[memoryType * 2 + kindIndex];
+    }
+
+    void *MemoryAllocator::mapIfHostVisible(vk::DeviceMemory memory, uint32_t memoryType) const {
+        if (m_GC.getMemoryProperties().memoryTypes[memoryType].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible) {
+            return m_Device.mapMemory(memory, 0, VK_WHOLE_SIZE);
+        }
+
+        return nullptr;
+    }
+
+    Allocation MemoryAllocator::allocate(const vk::MemoryRequirements &requirements, vk::MemoryPropertyFlags required, vk::MemoryPropertyFlags preferred, ResourceKind kind) {
+        const uint32_t       memoryType = m_GC.findMemoryType(requirements.memoryTypeBits, required, preferred);
+        const vk::DeviceSize needed     = std::bit_ceil(std::max({requirements.size, requirements.alignment, m_Settings.minAllocationSize}));
+
+        std::lock_guard lock(m_Mutex);
+        Heap           &heap = heapFor(memoryType, kind);
+
+        if (needed > m_Settings.blockSize) {
+            Allocation allocation = allocateDedicated(alignUp(requirements.size, m_AtomSize), memoryType);
+            allocation.m_Detail   = static_cast<uint32_t>(kind) << 16;
+            heap.dedicatedCount++;
+            heap.dedicatedBytes += allocation.size;
+            return allocation;
+        }
+
+        Allocation allocation;
+        allocation.memoryType = memoryType;
+        allocation.m_Detail   = static_cast<uint32_t>(kind) << 16;
+
+        for (auto &block : heap.blocks) {
+            if (allocateFromBlock(*block, needed, allocation)) {
+                allocation.size = requirements.size;
+                return allocation;
+            }
+        }
+
+        // small heaps (integrated gpus, the 256MiB BAR heap) shouldn't be eaten by a single block
+        const vk::DeviceSize heapSize  = m_GC.getMemoryProperties().memoryHeaps[m_GC.getMemoryProperties().memoryTypes[memoryType].heapIndex].size;
+        const vk::DeviceSize blockSize = std::max(needed, std::min(m_Settings.blockSize, std::bit_floor(heapSize / 8)));
+
+        auto block     = std::make_unique<Block>();
+        block->memory  = m_Device.allocateMemory(vk::MemoryAllocateInfo(blockSize, memoryType));
+        block->mapping = mapIfHostVisible(block->memory, memoryType);
+        block->size    = blockSize;
+        block->freeLists.resize(std::countr_zero(blockSize / m_Settings.minAllocationSize) + 1);
+        block->freeLists.back().insert(0);
+
+        allocateFromBlock(*block, needed, allocation);
+        allocation.size = requirements.size;
+
+        heap.blocks.push_back(std::move(block));
+        return allocation;
+    }
+
+    Allocation MemoryAllocator::allocateDedicated(vk::DeviceSize size, uint32_t memoryType) {
+        Allocation allocation;
+        allocation.memory     = m_Device.allocateMemory(vk::MemoryAllocateInfo(size, memoryType));
+        allocation.size       = size;
+        allocation.mapped     = mapIfHostVisible(allocation.memory, memoryType);
+        allocation.memoryType = memoryType;
+        allocation.m_Strategy = AllocationStrategy::Dedicated;
+        return allocation;
+    }
+
+    bool MemoryAllocator::allocateFromBlock(Block &block, vk::DeviceSize size, Allocation &allocation) const {
+        if (size > block.size)
+            return false;
+
+        const auto order = static_cast<uint32_t>(std::countr_zero(size / m_Settings.minAllocationSize));
+
+        uint32_t available = order;
+        while (available < block.freeLists.size() && block.freeLists[available].empty()) {
+            available++;
+        }
+
+        if (available >= block.freeLists.size())
+            return false;
+
+        const vk::DeviceSize offset = *block.freeLists[available].begin();
+        block.freeLists[available].erase(block.freeLists[available].begin());
+
+        // split down to the requested order, keeping the upper halves free
+        while (available > order) {
+            available--;
+            block.freeLists[available].insert(offset + (m_Settings.minAllocationSize << available));
+        }
+
+        block.used += size;
+        block.count++;
+
+        allocation.memory     = block.memory;
+        allocation.offset     = offset;
+        allocation.mapped     = block.mapping ? static_cast<std::byte *>(block.mapping) + offset : nullptr;
+        allocation.m_Strategy = AllocationStrategy::Buddy;
+        allocation.m_Owner    = &block;
+        allocation.m_Detail   = (allocation.m_Detail & 0xFFFF0000U) | order;
+        return true;
+    }
+
+    void MemoryAllocator::freeToBlock(Block &block, vk::DeviceSize offset, uint32_t order) const {
+        block.used -= m_Settings.minAllocationSize << order;
+        block.count--;
+
+        while (order + 1 < block.freeLists.size()) {
+            const vk::DeviceSize buddy = offset ^ (m_Settings.minAllocationSize << order);
+
+            auto it = block.freeLists[order].find(buddy);
+            if (it == block.freeLists[order].end())
+                break;
+
+            block.freeLists[order].erase(it);
+            offset = std::min(offset, buddy);
+            order++;
+        }
+
+        block.freeLists[order].insert(offset);
+    }
+
+    void MemoryAllocator::free(Allocation &allocation) {
+        if (!allocation)
+            return;
+
+        if (allocation.m_Strategy != AllocationStrategy::Buddy && allocation.m_Strategy != AllocationStrategy::Dedicated) {
+            throw std::runtime_error("Allocation belongs to a pool or linear allocator");
+        }
+
+        std::lock_guard lock(m_Mutex);
+        Heap           &heap = heapFor(allocation.memoryType, static_cast<ResourceKind>(allocation.m_Detail >> 16));
+
+        if (allocation.m_Strategy == AllocationStrategy::Dedicated) {
+            m_Device.free(allocation.memory);
+            heap.dedicatedCount--;
+            heap.dedicatedBytes -= allocation.size;
+        } else {
+            auto *block = static_cast<Block *>(allocation.m_Owner);
+            freeToBlock(*block, allocation.offset, allocation.m_Detail & 0xFFFFU);
+
+            // keep one empty block around per heap so a free/allocate pattern doesn't hit vkAllocateMemory every time
+            if (block->count == 0 && std::ranges::count_if(heap.blocks, [](const auto &b) { return b->count == 0; }) > 1) {
+                m_Device.free(block->memory);
+                std::erase_if(heap.blocks, [&](const auto &b) { return b.get() == block; });
+            }
+        }
+
+        allocation = {};
+    }
+
+    AllocatedBuffer MemoryAllocator::createBuffer(const vk::BufferCreateInfo &createInfo, vk::MemoryPropertyFlags required, vk::MemoryPropertyFlags preferred) {
+        AllocatedBuffer result;
+        result.buffer = m_Device.createBuffer(createInfo);
+
+        try {
+            result.allocation = allocate(m_Device.getBufferMemoryRequirements(result.buffer), required, preferred, ResourceKind::Linear);
+            m_Device.bindBufferMemory(result.buffer, result.allocation.memory, result.allocation.offset);
+        } catch (...) {
+            m_Device.destroy(result.buffer);
+            throw;
+        }
+
+        return result;
+    }
+
+    AllocatedImage MemoryAllocator::createImage(const vk::ImageCreateInfo &createInfo, vk::MemoryPropertyFlags required, vk::MemoryPropertyFlags preferred) {
+        AllocatedImage result;
+        result.image = m_Device.createImage(createInfo);
+
+        try {
+            const ResourceKind kind = createInfo.tiling == vk::ImageTiling::eOptimal ? ResourceKind::Optimal : ResourceKind::Linear;
+            result.allocation       = allocate(m_Device.getImageMemoryRequirements(result.image), required, preferred, kind);
+            m_Device.bindImageMemory(result.image, result.allocation.memory, result.allocation.offset);
+        } catch (...) {
+            m_Device.destroy(result.image);
+            throw;
+        }
+
+        return result;
+    }
+
+    void MemoryAllocator::destroy(AllocatedBuffer &buffer) {
+        m_Device.destroy(buffer.buffer);
+        free(buffer.allocation);
+        buffer.buffer = nullptr;
+    }
+
+    void MemoryAllocator::destroy(AllocatedImage &image) {
+        m_Device.destroy(image.image);
+        free(image.allocation);
+        image.image = nullptr;
+    }
+
+    bool MemoryAllocator::isHostCoherent(const Allocation &allocation) const {
+        return static_cast<bool>(m_GC.getMemoryProperties().memoryTypes[allocation.memoryType].propertyFlags & vk::MemoryPropertyFlagBits::eHostCoherent);
+    }
+
+    void MemoryAllocator::flush(const Allocation &allocation) const {
+        if (isHostCoherent(allocation))
+            return;
+
+        const vk::DeviceSize begin = alignDown(allocation.offset, m_AtomSize);
+        m_Device.flushMappedMemoryRanges(vk::MappedMemoryRange(allocation.memory, begin, alignUp(allocation.offset + allocation.size, m_AtomSize) - begin));
+    }
+
+    void MemoryAllocator::invalidate(const Allocation &allocation) const {
+        if (isHostCoherent(allocation))
+            return;
+
+        const vk::DeviceSize begin = alignDown(allocation.offset, m_AtomSize);
+        m_Device.invalidateMappedMemoryRanges(vk::MappedMemoryRange(allocation.memory, begin, alignUp(allocation.offset + allocation.size, m_AtomSize) - begin));
+    }
+
+    MemoryStats MemoryAllocator::collectStats(uint32_t memoryType) const {
+        MemoryStats stats;
+        for (uint32_t kind = 0; kind < 2; kind++) {
+            const Heap &heap = m_Heaps[memoryType * 2 + kind];
+
+            stats.dedicatedCount += heap.dedicatedCount;
+            stats.allocationCount += heap.dedicatedCount;
+            stats.bytesReserved += heap.dedicatedBytes;
+            stats.bytesUsed += heap.dedicatedBytes;
+
+            for (const auto &block : heap.blocks) {
+                stats.blockCount++;
+                stats.allocationCount += block->count;
+                stats.bytesReserved += block->size;
+                stats.bytesUsed += block->used;
+
+                for (size_t order = block->freeLists.size(); order-- > 0;) {
+                    if (!block->freeLists[order].empty()) {
+                        stats.largestFreeRange = std::max(stats.largestFreeRange, m_Settings.minAllocationSize << order);
+                        break;
+                    }
+                }
+            }
+        }
+
+        return stats;
+    }
+
+    MemoryStats MemoryAllocator::getStats(uint32_t memoryType) const {
+        std::lock_guard lock(m_Mutex);
+        return collectStats(memoryType);
+    }
+
+    MemoryStats MemoryAllocator::getStats() const {
+        std::lock_guard lock(m_Mutex);
+
+        MemoryStats total;
+        for (uint32_t i = 0; i < m_GC.getMemoryProperties().memoryTypeCount; i++) {
+            total += collectStats(i);
+        }
+
+        return total;
+    }
+
+    PoolAllocator::PoolAllocator(MemoryAllocator &allocator, const vk::MemoryRequirements &slotRequirements, vk::MemoryPropertyFlags required,
+                                 vk::MemoryPropertyFlags preferred, ResourceKind kind, uint32_t slotsPerChunk)
+        : m_Allocator(allocator), m_Required(required), m_Preferred(preferred), m_Kind(kind), m_SlotsPerChunk(slotsPerChunk) {
+        if (slotsPerChunk == 0) {
+            throw std::runtime_error("PoolAllocator needs at least one slot per chunk");
+        }
+
+        m_SlotStride        = alignUp(slotRequirements.size, slotRequirements.alignment);
+        m_ChunkRequirements = vk::MemoryRequirements(m_SlotStride * slotsPerChunk, std::max(slotRequirements.alignment, allocator.getBufferImageGranularity()),
+                                                     slotRequirements.memoryTypeBits);
+    }
+
+    PoolAllocator::~PoolAllocator() {
+        for (auto &chunk : m_Chunks) {
+            m_Allocator.free(chunk);
+        }
+    }
+
+    Allocation PoolAllocator::allocate() {
+        if (m_FreeSlots.empty()) {
+            const auto chunkIndex = static_cast<uint32_t>(m_Chunks.size());
+            m_Chunks.push_back(m_Allocator.allocate(m_ChunkRequirements, m_Required, m_Preferred, m_Kind));
+
+            // pushed in reverse so slots are handed out front to back
+            for (uint32_t i = m_SlotsPerChunk; i-- > 0;) {
+                m_FreeSlots.push_back(chunkIndex * m_SlotsPerChunk + i);
+            }
+        }
+
+        const uint32_t slot = m_FreeSlots.back();
+        m_FreeSlots.pop_back();
+
+        const Allocation    &chunk       = m_Chunks[slot / m_SlotsPerChunk];
+        const vk::DeviceSize localOffset = (slot % m_SlotsPerChunk) * m_SlotStride;
+
+        Allocation allocation;
+        allocation.memory     = chunk.memory;
+        allocation.offset     = chunk.offset + localOffset;
+        allocation.size       = m_SlotStride;
+        allocation.mapped     = chunk.mapped ? static_cast<std::byte *>(chunk.mapped) + localOffset : nullptr;
+        allocation.memoryType = chunk.memoryType;
+        allocation.m_Strategy = AllocationStrategy::Pool;
+        allocation.m_Owner    = this;
+        allocation.m_Detail   = slot;
+
+        m_LiveSlots++;
+        return allocation;
+    }
+
+    void PoolAllocator::free(Allocation &allocation) {
+        if (!allocation)
+            return;
+
+        if (allocation.m_Owner != this) {
+            throw std::runtime_error("Allocation does not belong to this pool");
+        }
+
+        m_FreeSlots.push_back(allocation.m_Detail);
+        m_LiveSlots--;
+        allocation = {};
+    }
+
+    MemoryStats PoolAllocator::getStats() const {
+        MemoryStats stats;
+        stats.blockCount      = static_cast<uint32_t>(m_Chunks.size());
+        stats.allocationCount = m_LiveSlots;
+        stats.bytesReserved   = m_Chunks.size() * m_SlotsPerChunk * m_SlotStride;
+        stats.bytesUsed       = m_LiveSlots * m_SlotStride;
+
+        // every free slot fits every request, so a pool never fragments
+        stats.largestFreeRange = stats.bytesReserved - stats.bytesUsed;
+        return stats;
+    }
+
+    LinearAllocator::LinearAllocator(MemoryAllocator &allocator, vk::DeviceSize capacity, uint32_t memoryTypeBits, vk::MemoryPropertyFlags required,
+                                     vk::MemoryPropertyFlags preferred)
+        : m_Allocator(allocator), m_LastKind(ResourceKind::Linear), m_Granularity(allocator.getBufferImageGranularity()) {
+        // the chunk covers whole granularity pages, so whatever the buddy allocator places next to it can't conflict with what we put inside
+        const vk::DeviceSize alignment = std::max<vk::DeviceSize>(256, m_Granularity);
+        m_Chunk = allocator.allocate(vk::MemoryRequirements(alignUp(capacity, alignment), alignment, memoryTypeBits), required, preferred, ResourceKind::Linear);
+    }
+
+    LinearAllocator::~LinearAllocator() {
+        m_Allocator.free(m_Chunk);
+    }
+
+    Allocation LinearAllocator::allocate(vk::DeviceSize size, vk::DeviceSize alignment, ResourceKind kind) {
+        vk::DeviceSize offset = alignUp(m_Chunk.offset + m_Head, alignment);
+        if (m_Head > 0 && kind != m_LastKind) {
+            offset = alignUp(offset, m_Granularity);
+        }
+        offset -= m_Chunk.offset;
+
+        if (offset + size > m_Chunk.size) {
+            throw std::runtime_error("LinearAllocator is out of memory");
+        }
+
+        m_Head     = offset + size;
+        m_LastKind = kind;
+
+        Allocation allocation;
+        allocation.memory     = m_Chunk.memory;
+        allocation.offset     = m_Chunk.offset + offset;
+        allocation.size       = size;
+        allocation.mapped     = m_Chunk.mapped ? static_cast<std::byte *>(m_Chunk.mapped) + offset : nullptr;
+        allocation.memoryType = m_Chunk.memoryType;
+        allocation.m_Strategy = AllocationStrategy::Linear;
+        allocation.m_Owner    = this;
+        return allocation;
+    }
+
+    void LinearAllocator::reset() noexcept {
+        m_Head     = 0;
+        m_LastKind = ResourceKind::Linear;
+    }
+
+} // namespace neuron::graphics
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <array>
+#include <cinttypes>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+namespace neuron::graphics {
+    class GContext;
+
+    enum class AllocationStrategy {
+        Buddy,
+        Pool,
+        Linear,
+        Dedicated,
+    };
+
+    /**
+     * Linear resources (buffers, linear images) and optimal images must be bufferImageGranularity apart when they share a memory object. Allocators either keep them in
+     * separate blocks or pad between them, depending on which one is asking.
+     */
+    enum class ResourceKind {
+        Linear,
+        Optimal,
+    };
+
+    struct MemoryAllocatorSettings {
+        /**
+         * Size of the blocks the buddy allocator carves allocations out of. Must be a power of two. Requests bigger than this get their own vkAllocateMemory.
+         */
+        vk::DeviceSize blockSize = 64ULL * 1024 * 1024;
+
+        /**
+         * Smallest buddy size. Smaller requests are rounded up to this.
+         */
+        vk::DeviceSize minAllocationSize = 256;
+    };
+
+    /**
+     * A range of device memory handed out by one of the allocators. Host visible memory is persistently mapped; mapped already points at offset.
+     */
+    struct Allocation {
+        vk::DeviceMemory memory;
+        vk::DeviceSize   offset     = 0;
+        vk::DeviceSize   size       = 0;
+        void            *mapped     = nullptr;
+        uint32_t         memoryType = 0;
+
+        [[nodiscard]] inline explicit operator bool() const noexcept { return static_cast<bool>(memory); }
+
+        [[nodiscard]] inline AllocationStrategy getStrategy() const noexcept { return m_Strategy; }
+
+      private:
+        friend class MemoryAllocator;
+        friend class PoolAllocator;
+        friend class LinearAllocator;
+
+        AllocationStrategy m_Strategy = AllocationStrategy::Dedicated;
+        void              *m_Owner    = nullptr;
+        uint32_t           m_Detail   = 0;
+    };
+
+    struct AllocatedBuffer {
+        vk::Buffer buffer;
+        Allocation allocation;
+    };
+
+    struct AllocatedImage {
+        vk::Image  image;
+        Allocation allocation;
+    };
+
+    struct MemoryStats {
+        uint32_t       blockCount       = 0;
+        uint32_t       dedicatedCount   = 0;
+        uint32_t       allocationCount  = 0;
+        vk::DeviceSize bytesReserved    = 0;
+        vk::DeviceSize bytesUsed        = 0;
+        vk::DeviceSize largestFreeRange = 0;
+
+        /**
+         * 0 when all free memory is one contiguous range, approaching 1 as free memory is split into many small ranges.
+         */
+        [[nodiscard]] inline float getFragmentation() const noexcept {
+            const vk::DeviceSize free = bytesReserved - bytesUsed;
+            return free == 0 ? 0.0f : 1.0f - static_cast<float>(largestFreeRange) / static_cast<float>(free);
+        }
+
+        MemoryStats &operator+=(const MemoryStats &other);
+    };
+
+    /**
+     *
+     * Sub-allocates device memory from large blocks per memory type, so resources don't each pay for (and count against the limit of) their own vkAllocateMemory.
+     *
+     * General purpose allocations use a buddy allocator. PoolAllocator and LinearAllocator draw their backing memory from here for same-sized resources and per-frame data.
+     * All methods are thread safe. Owned by GContext.
+     *
+     */
+    class MemoryAllocator final {
+      public:
+        MemoryAllocator(const GContext &gc, const MemoryAllocatorSettings &settings);
+        ~MemoryAllocator();
+
+        MemoryAllocator(const MemoryAllocator &)            = delete;
+        MemoryAllocator &operator=(const MemoryAllocator &) = delete;
+
+        /**
+         * @throws std::runtime_error if no memory type matches, vk::OutOfDeviceMemoryError if the heap is exhausted.
+         */
+        [[nodiscard]] Allocation allocate(const vk::MemoryRequirements &requirements, vk::MemoryPropertyFlags required, vk::MemoryPropertyFlags preferred = {},
+                                          ResourceKind kind = ResourceKind::Linear);
+        void                     free(Allocation &allocation);
+
+        [[nodiscard]] AllocatedBuffer createBuffer(const vk::BufferCreateInfo &createInfo, vk::MemoryPropertyFlags required, vk::MemoryPropertyFlags preferred = {});
+        [[nodiscard]] AllocatedImage  createImage(const vk::ImageCreateInfo &createInfo, vk::MemoryPropertyFlags required, vk::MemoryPropertyFlags preferred = {});
+
+        void destroy(AllocatedBuffer &buffer);
+        void destroy(AllocatedImage &image);
+
+        /**
+         * No-ops for host coherent memory. Ranges are widened to nonCoherentAtomSize.
+         */
+        void flush(const Allocation &allocation) const;
+        void invalidate(const Allocation &allocation) const;
+
+        [[nodiscard]] bool isHostCoherent(const Allocation &allocation) const;
+
+        [[nodiscard]] MemoryStats getStats() const;
+        [[nodiscard]] MemoryStats getStats(uint32_t memoryType) const;
+
+        [[nodiscard]] inline vk::DeviceSize getBufferImageGranularity() const noexcept { return m_Granularity; }
+
+      private:
+        struct Block {
+            vk::DeviceMemory memory;
+            void            *mapping = nullptr;
+            vk::DeviceSize   size    = 0;
+            vk::DeviceSize   used    = 0;
+            uint32_t         count   = 0;
+
+            // freeLists[order] holds the offsets of free ranges of size minAllocationSize << order
+            std::vector<std::set<vk::DeviceSize>> freeLists;
+        };
+
+        struct Heap {
+            std::vector<std::unique_ptr<Block>> blocks;
+            uint32_t                            dedicatedCount = 0;
+            vk::DeviceSize                      dedicatedBytes = 0;
+        };
+
+        const GContext         &m_GC;
+        vk::Device              m_Device;
+        MemoryAllocatorSettings m_Settings;
+        vk::DeviceSize          m_Granularity;
+        vk::DeviceSize          m_AtomSize;
+        uint32_t                m_MaxOrder;
+
+        mutable std::mutex m_Mutex;
+
+        // indexed by memory type * 2 + resource kind
+        std::array<Heap, VK_MAX_MEMORY_TYPES * 2> m_Heaps;
+
+        [[nodiscard]] Heap &heapFor(uint32_t memoryType, ResourceKind kind);
+
+        [[nodiscard]] Allocation allocateDedicated(vk::DeviceSize size, uint32_t memoryType);
+        [[nodiscard]] bool       allocateFromBlock(Block &block, vk::DeviceSize size, Allocation &allocation) const;
+        void                     freeToBlock(Block &block, vk::DeviceSize offset, uint32_t order) const;
+        [[nodiscard]] void      *mapIfHostVisible(vk::DeviceMemory memory, uint32_t memoryType) const;
+
+        [[nodiscard]] MemoryStats collectStats(uint32_t memoryType) const;
+    };
+
+    /**
+     *
+     * Hands out fixed-size slots for resources that all have the same memory requirements (per-object uniform buffers, same-sized images...). Allocation and freeing are O(1).
+     * Not thread safe.
+     *
+     */
+    class PoolAllocator final {
+      public:
+        PoolAllocator(MemoryAllocator &allocator, const vk::MemoryRequirements &slotRequirements, vk::MemoryPropertyFlags required, vk::MemoryPropertyFlags preferred = {},
+                      ResourceKind kind = ResourceKind::Linear, uint32_t slotsPerChunk = 256);
+        ~PoolAllocator();
+
+        PoolAllocator(const PoolAllocator &)            = delete;
+        PoolAllocator &operator=(const PoolAllocator &) = delete;
+
+        [[nodiscard]] Allocation allocate();
+        void                     free(Allocation &allocation);
+
+        [[nodiscard]] MemoryStats getStats() const;
+
+      private:
+        MemoryAllocator        &m_Allocator;
+        vk::MemoryRequirements  m_ChunkRequirements;
+        vk::MemoryPropertyFlags m_Required;
+        vk::MemoryPropertyFlags m_Preferred;
+        ResourceKind            m_Kind;
+        vk::DeviceSize          m_SlotStride;
+        uint32_t                m_SlotsPerChunk;
+
+        std::vector<Allocation> m_Chunks;
+        std::vector<uint32_t>   m_FreeSlots;
+        uint32_t                m_LiveSlots = 0;
+    };
+
+    /**
+     *
+     * Bump allocator over one chunk of memory, for data that lives for a single frame. Individual allocations are never freed; reset() releases everything at once, so keep
+     * one per frame in flight and reset it once that frame's fence has signaled. Not thread safe.
+     *
+     */
+    class LinearAllocator final {
+      public:
+        LinearAllocator(MemoryAllocator &allocator, vk::DeviceSize capacity, uint32_t memoryTypeBits, vk::MemoryPropertyFlags required,
+                        vk::MemoryPropertyFlags preferred = {});
+        ~LinearAllocator();
+
+        LinearAllocator(const LinearAllocator &)            = delete;
+        LinearAllocator &operator=(const LinearAllocator &) = delete;
+
+        /**
+         * @throws std::runtime_error if the chunk is full.
+         */
+        [[nodiscard]] Allocation allocate(vk::DeviceSize size, vk::DeviceSize alignment, ResourceKind kind = ResourceKind::Linear);
+
+        void reset() noexcept;
+
+        [[nodiscard]] inline vk::DeviceSize getUsed() const noexcept { return m_Head; }
+
+        [[nodiscard]] inline vk::DeviceSize getCapacity() const noexcept { return m_Chunk.size; }
+
+        [[nodiscard]] inline const Allocation &getChunk() const noexcept { return m_Chunk; }
+
+      private:
+        MemoryAllocator &m_Allocator;
+        Allocation       m_Chunk;
+        vk::DeviceSize   m_Head = 0;
+        ResourceKind     m_LastKind;
+        vk::DeviceSize   m_Granularity;
+    };
+
+} // namespace neuron::graphics
@@ -0,0 +1,91 @@
+#include "package_loader.hpp"
+
+#include "neuron/graphics/gcontext.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+namespace neuron::graphics {
+
+    PackageLoader::PackageLoader(GContext &gc, const assets::Package &package) : m_GC(gc), m_Package(package), m_Uploads(gc.getUploadService()) {
+        if (gc.isExtensionEnabled(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME)) {
+            importPackage();
+        }
+    }
+
+    PackageLoader::~PackageLoader() {
+        if (!m_Imported)
+            return;
+
+        // the imported buffer is the source of copies still in flight
+        m_Uploads.wait(m_LastTicket);
+        m_GC.getDevice().destroy(m_Imported);
+        m_GC.getDevice().free(m_ImportedMemory);
+    }
+
+    void PackageLoader::importPackage() {
+        const vk::Device &device  = m_GC.getDevice();
+        const auto        mapping = m_Package.getMapping();
+
+        const auto properties =
+            m_GC.getGpu().getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceExternalMemoryHostPropertiesEXT>().get<vk::PhysicalDeviceExternalMemoryHostPropertiesEXT>();
+        const vk::DeviceSize alignment = properties.minImportedHostPointerAlignment;
+
+        // mappings are page aligned, and packages padded to their alignment, which is usually enough
+        if (reinterpret_cast<uintptr_t>(mapping.data()) % alignment != 0 || mapping.size() % alignment != 0) {
+            spdlog::debug("Package {} doesn't meet the host import alignment of {}, staging instead", m_Package.getPath().string(), alignment);
+            return;
+        }
+
+        constexpr auto handleType = vk::ExternalMemoryHandleTypeFlagBits::eHostAllocationEXT;
+        void          *pointer    = const_cast<std::byte *>(mapping.data());
+
+        try {
+            const vk::MemoryHostPointerPropertiesEXT pointerProperties = device.getMemoryHostPointerPropertiesEXT(handleType, pointer);
+
+            vk::ExternalMemoryBufferCreateInfo external(handleType);
+            m_Imported = device.createBuffer(vk::BufferCreateInfo({}, mapping.size(), vk::BufferUsageFlagBits::eTransferSrc, vk::SharingMode::eExclusive).setPNext(&external));
+
+            const vk::MemoryRequirements requirements = device.getBufferMemoryRequirements(m_Imported);
+            const uint32_t               memoryType   = m_GC.findMemoryType(requirements.memoryTypeBits & pointerProperties.memoryTypeBits, {});
+
+            vk::ImportMemoryHostPointerInfoEXT import(handleType, pointer);
+            m_ImportedMemory = device.allocateMemory(vk::MemoryAllocateInfo(mapping.size(), memoryType, &import));
+            device.bindBufferMemory(m_Imported, m_ImportedMemory, 0);
+        } catch (const std::exception &e) {
+            // drivers may refuse read only file mappings
+            spdlog::debug("Failed to import package {}, staging instead: {}", m_Package.getPath().string(), e.what());
+            device.destroy(m_Imported);
+            device.free(m_ImportedMemory);
+            m_Imported       = nullptr;
+            m_ImportedMemory = nullptr;
+        }
+    }
+
+    void PackageLoader::track(UploadTicket ticket) {
+        std::lock_guard lock(m_Mutex);
+        m_LastTicket.value = std::max(m_LastTicket.value, ticket.value);
+    }
+
+    UploadTicket PackageLoader::uploadBuffer(std::string_view name, vk::Buffer dst, vk::DeviceSize dstOffset) {
+        const assets::PackageAsset asset = m_Package.get(name);
+        if (!m_Imported)
+            return m_Uploads.uploadBuffer(dst, dstOffset, asset.data);
+
+        const UploadTicket ticket = m_Uploads.copyBuffer(m_Imported, asset.offset, dst, dstOffset, asset.data.size());
+        track(ticket);
+        return ticket;
+    }
+
+    UploadTicket PackageLoader::uploadImage(std::string_view name, const ImageUploadInfo &info) {
+        const assets::PackageAsset asset = m_Package.get(name);
+        if (!m_Imported)
+            return m_Uploads.uploadImage(info, asset.data);
+
+        const UploadTicket ticket = m_Uploads.copyBufferToImage(m_Imported, asset.offset, asset.data.size(), info);
+        track(ticket);
+        return ticket;
+    }
+
+} // namespace neuron::graphics
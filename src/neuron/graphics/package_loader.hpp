@@ -0,0 +1,58 @@
+#pragma once
+
+#include "neuron/assets/package.hpp"
+#include "neuron/graphics/upload.hpp"
+
+#include <mutex>
+#include <string_view>
+
+namespace neuron::graphics {
+    class GContext;
+
+    /**
+     *
+     * Uploads assets of a package through the GContext's UploadService. Where VK_EXT_external_memory_host is enabled and accepts the mapping, the whole package is
+     * imported as a transfer source once and copies go from there straight to the destination, without touching the staging ring. Otherwise asset data is copied from
+     * the mapping into the staging ring, which is still the only CPU copy.
+     *
+     * The package must outlive the loader, and the loader the uploads it recorded; the destructor waits for them. Thread safe, as UploadService is.
+     *
+     */
+    class PackageLoader final {
+      public:
+        /**
+         * @throws std::runtime_error if the device doesn't support timeline semaphores, see GContext::getUploadService().
+         */
+        PackageLoader(GContext &gc, const assets::Package &package);
+        ~PackageLoader();
+
+        PackageLoader(const PackageLoader &)            = delete;
+        PackageLoader &operator=(const PackageLoader &) = delete;
+
+        /**
+         * @throws std::runtime_error if there is no asset of that name.
+         */
+        UploadTicket uploadBuffer(std::string_view name, vk::Buffer dst, vk::DeviceSize dstOffset = 0);
+        UploadTicket uploadImage(std::string_view name, const ImageUploadInfo &info);
+
+        /**
+         * Whether copies come from the imported package rather than the staging ring.
+         */
+        [[nodiscard]] inline bool isImported() const noexcept { return static_cast<bool>(m_Imported); }
+
+      private:
+        GContext              &m_GC;
+        const assets::Package &m_Package;
+        UploadService         &m_Uploads;
+
+        vk::Buffer       m_Imported;
+        vk::DeviceMemory m_ImportedMemory;
+
+        std::mutex   m_Mutex;
+        UploadTicket m_LastTicket;
+
+        void importPackage();
+        void track(UploadTicket ticket);
+    };
+
+} // namespace neuron::graphics
@@ -0,0 +1,388 @@
+#include "pipelines.hpp"
+
+#include "neuron/neuron.hpp"
+#include "neuron/utils/profiler.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <array>
+#include <chrono>
+#include <fstream>
+
+namespace neuron::graphics {
+
+    constexpr uint32_t PIPELINE_CACHE_MAGIC   = 0x4350504e; // "NPPC"
+    constexpr uint32_t PIPELINE_CACHE_VERSION = 1;
+
+    /**
+     * Written in front of the vkGetPipelineCacheData blob. Drivers validate their own header too, but some crash on foreign data instead of rejecting it.
+     */
+    struct PipelineCacheHeader {
+        uint32_t                          magic;
+        uint32_t                          version;
+        uint32_t                          vendorID;
+        uint32_t                          deviceID;
+        uint32_t                          driverVersion;
+        std::array<uint8_t, VK_UUID_SIZE> deviceUUID;
+        std::array<uint8_t, VK_UUID_SIZE> pipelineCacheUUID;
+        uint64_t                          dataSize;
+        utils::Hash128                    dataHash;
+    };
+
+    static PipelineCacheHeader makeCacheHeader(const GContext &gc) {
+        const auto properties = gc.getGpu().getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceIDProperties>();
+        const auto &device    = properties.get<vk::PhysicalDeviceProperties2>().properties;
+
+        PipelineCacheHeader header{};
+        header.magic             = PIPELINE_CACHE_MAGIC;
+        header.version           = PIPELINE_CACHE_VERSION;
+        header.vendorID          = device.vendorID;
+        header.deviceID          = device.deviceID;
+        header.driverVersion     = device.driverVersion;
+        header.deviceUUID        = properties.get<vk::PhysicalDeviceIDProperties>().deviceUUID;
+        header.pipelineCacheUUID = device.pipelineCacheUUID;
+        return header;
+    }
+
+    template<typename T> static void hashRange(utils::Hasher &hasher, const std::vector<T> &values) {
+        hasher.updateValue(static_cast<uint64_t>(values.size()));
+        for (const T &value : values) {
+            hasher.updateValue(value);
+        }
+    }
+
+    PipelineManager::PipelineManager(const std::shared_ptr<GContext> &gc, ShaderCompiler &shaders, const PipelineManagerSettings &settings)
+        : m_GC(gc), m_Shaders(shaders), m_Settings(settings), m_Tasks(settings.jobs ? *settings.jobs : getJobSystem()) {
+        // reading and validating a large cache takes a while, the first pipeline waits for it
+        m_CacheLoad = m_Tasks.submit([this] { createCache(); });
+    }
+
+    void PipelineManager::createCache() {
+        const vk::Device &device = m_GC->getDevice();
+
+        const std::vector<std::byte> data = loadCacheData();
+        try {
+            m_Cache = device.createPipelineCache(vk::PipelineCacheCreateInfo({}, data.size(), data.data()));
+
+            std::lock_guard lock(m_Mutex);
+            m_Stats.cacheLoaded = !data.empty();
+        } catch (const vk::SystemError &e) {
+            spdlog::warn("Driver rejected the pipeline cache, starting cold: {}", e.what());
+            m_Cache = device.createPipelineCache(vk::PipelineCacheCreateInfo());
+        }
+    }
+
+    vk::PipelineCache PipelineManager::getPipelineCache() const {
+        if (!m_CacheLoad.isDone())
+            m_Tasks.getJobSystem().wait(m_CacheLoad);
+        return m_Cache;
+    }
+
+    PipelineManager::~PipelineManager() {
+        waitIdle();
+        saveCache();
+
+        const vk::Device &device = m_GC->getDevice();
+        for (const auto &[key, build] : m_Builds) {
+            if (build->future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+                continue;
+
+            try {
+                device.destroy(build->future.get());
+            } catch (...) {
+                // failed builds have nothing to destroy
+            }
+        }
+        device.destroy(m_Cache);
+    }
+
+    void PipelineManager::enqueueBuild(const std::shared_ptr<Build> &build) {
+        m_Tasks.submit([this, build] {
+            // get() may have claimed it in the meantime
+            if (!build->claimed.test_and_set()) {
+                run(*build);
+            }
+        });
+    }
+
+    void PipelineManager::waitIdle() { m_Tasks.wait(); }
+
+    template<typename T> std::pair<std::shared_ptr<PipelineManager::Build>, bool> PipelineManager::findOrAdd(const T &desc) {
+        const utils::Hash128 key = getKey(desc);
+
+        std::lock_guard lock(m_Mutex);
+        if (auto it = m_Builds.find(key); it != m_Builds.end()) {
+            m_Stats.reused++;
+            return {it->second, false};
+        }
+
+        auto build    = std::make_shared<Build>();
+        build->desc   = desc;
+        build->future = build->promise.get_future().share();
+        m_Builds.emplace(key, build);
+        return {build, true};
+    }
+
+    template<typename T> vk::Pipeline PipelineManager::getImpl(const T &desc) {
+        auto [build, added] = findOrAdd(desc);
+
+        // whoever claims the build first runs it; if a worker got there first this waits for it
+        if (!build->claimed.test_and_set()) {
+            run(*build);
+        }
+        m_Tasks.getJobSystem().wait(build->future);
+        return build->future.get();
+    }
+
+    template<typename T> void PipelineManager::prefetchImpl(const T &desc) {
+        auto [build, added] = findOrAdd(desc);
+        if (added) {
+            enqueueBuild(build);
+        }
+    }
+
+    template<typename T> std::optional<vk::Pipeline> PipelineManager::tryGetImpl(const T &desc) {
+        auto [build, added] = findOrAdd(desc);
+        if (added) {
+            enqueueBuild(build);
+            return std::nullopt;
+        }
+
+        if (build->future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return std::nullopt;
+
+        try {
+            return build->future.get();
+        } catch (...) {
+            // already logged when the build failed
+            return std::nullopt;
+        }
+    }
+
+    vk::Pipeline PipelineManager::get(const GraphicsPipelineDesc &desc) { return getImpl(desc); }
+
+    vk::Pipeline PipelineManager::get(const ComputePipelineDesc &desc) { return getImpl(desc); }
+
+    void PipelineManager::prefetch(const GraphicsPipelineDesc &desc) { prefetchImpl(desc); }
+
+    void PipelineManager::prefetch(const ComputePipelineDesc &desc) { prefetchImpl(desc); }
+
+    std::optional<vk::Pipeline> PipelineManager::tryGet(const GraphicsPipelineDesc &desc) { return tryGetImpl(desc); }
+
+    std::optional<vk::Pipeline> PipelineManager::tryGet(const ComputePipelineDesc &desc) { return tryGetImpl(desc); }
+
+    void PipelineManager::run(Build &build) {
+        NEURON_PROFILE_SCOPE("PipelineManager::run");
+        const auto start = std::chrono::steady_clock::now();
+
+        try {
+            const vk::Pipeline pipeline = std::visit([this](const auto &desc) { return create(desc); }, build.desc);
+            const double       elapsed  = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            {
+                std::lock_guard lock(m_Mutex);
+                m_Stats.created++;
+                m_Stats.createMs += elapsed;
+            }
+            build.promise.set_value(pipeline);
+        } catch (const std::exception &e) {
+            spdlog::error("Failed to build pipeline: {}", e.what());
+            {
+                std::lock_guard lock(m_Mutex);
+                m_Stats.failures++;
+            }
+            build.promise.set_exception(std::current_exception());
+        }
+
+        // the shader sources aren't needed anymore
+        build.desc = Desc{};
+    }
+
+    utils::Hash128 PipelineManager::getKey(const GraphicsPipelineDesc &desc) const {
+        utils::Hasher hasher;
+        hasher.update("graphics");
+
+        hasher.updateValue(static_cast<uint64_t>(desc.shaders.size()));
+        for (const auto &shader : desc.shaders) {
+            hasher.updateValue(m_Shaders.getKey(shader));
+        }
+        hasher.updateValue(static_cast<VkPipelineLayout>(desc.layout));
+
+        hashRange(hasher, desc.vertexBindings);
+        hashRange(hasher, desc.vertexAttributes);
+        hasher.updateValue(desc.topology).updateValue(desc.patchControlPoints);
+
+        hasher.updateValue(desc.polygonMode).updateValue(desc.cullMode).updateValue(desc.frontFace).updateValue(desc.samples);
+        hasher.updateValue(desc.depthTest).updateValue(desc.depthWrite).updateValue(desc.depthCompare);
+        hashRange(hasher, desc.blendAttachments);
+
+        hasher.updateValue(static_cast<VkRenderPass>(desc.renderPass)).updateValue(desc.subpass);
+        hashRange(hasher, desc.colorFormats);
+        hasher.updateValue(desc.depthFormat);
+
+        return hasher.finish();
+    }
+
+    utils::Hash128 PipelineManager::getKey(const ComputePipelineDesc &desc) const {
+        utils::Hasher hasher;
+        hasher.update("compute");
+        hasher.updateValue(m_Shaders.getKey(desc.shader));
+        hasher.updateValue(static_cast<VkPipelineLayout>(desc.layout));
+        return hasher.finish();
+    }
+
+    vk::Pipeline PipelineManager::create(const GraphicsPipelineDesc &desc) const {
+        const vk::Device &device = m_GC->getDevice();
+
+        if (!desc.renderPass && !m_GC->supportsDynamicRendering())
+            throw std::runtime_error("Pipelines without a render pass need dynamic rendering");
+
+        const std::vector<Spirv> spirv = m_Shaders.compileAll(desc.shaders);
+
+        std::vector<vk::ShaderModule>                  modules;
+        std::vector<vk::PipelineShaderStageCreateInfo> stages;
+        bool                                           tessellation = false;
+
+        try {
+            for (size_t i = 0; i < desc.shaders.size(); i++) {
+                modules.push_back(device.createShaderModule(vk::ShaderModuleCreateInfo({}, spirv[i])));
+                stages.emplace_back(vk::PipelineShaderStageCreateFlags{}, toVkStage(desc.shaders[i].stage), modules.back(), desc.shaders[i].entryPoint.c_str());
+
+                tessellation |= desc.shaders[i].stage == ShaderStage::TessellationControl;
+            }
+
+            const vk::PipelineVertexInputStateCreateInfo   vertexInput({}, desc.vertexBindings, desc.vertexAttributes);
+            const vk::PipelineInputAssemblyStateCreateInfo inputAssembly({}, desc.topology, false);
+            const vk::PipelineTessellationStateCreateInfo  tessellationState({}, desc.patchControlPoints);
+            const vk::PipelineViewportStateCreateInfo      viewport({}, 1, nullptr, 1, nullptr);
+            const vk::PipelineRasterizationStateCreateInfo rasterization({}, false, false, desc.polygonMode, desc.cullMode, desc.frontFace, false, 0.0f, 0.0f, 0.0f, 1.0f);
+            const vk::PipelineMultisampleStateCreateInfo   multisample({}, desc.samples);
+            const vk::PipelineDepthStencilStateCreateInfo  depthStencil({}, desc.depthTest, desc.depthWrite, desc.depthCompare);
+
+            std::vector<vk::PipelineColorBlendAttachmentState> blendAttachments = desc.blendAttachments;
+            blendAttachments.resize(std::max(desc.blendAttachments.size(), desc.colorFormats.size()),
+                                    vk::PipelineColorBlendAttachmentState(false, vk::BlendFactor::eOne, vk::BlendFactor::eZero, vk::BlendOp::eAdd, vk::BlendFactor::eOne,
+                                                                          vk::BlendFactor::eZero, vk::BlendOp::eAdd,
+                                                                          vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB |
+                                                                              vk::ColorComponentFlagBits::eA));
+            const vk::PipelineColorBlendStateCreateInfo colorBlend({}, false, vk::LogicOp::eCopy, blendAttachments);
+
+            const std::array<vk::DynamicState, 2>    dynamicStates = {vk::DynamicState::eViewport, vk::DynamicState::eScissor};
+            const vk::PipelineDynamicStateCreateInfo dynamicState({}, dynamicStates);
+
+            const vk::PipelineRenderingCreateInfo rendering(0, desc.colorFormats, desc.depthFormat, vk::Format::eUndefined);
+
+            vk::GraphicsPipelineCreateInfo createInfo({}, stages, &vertexInput, &inputAssembly, tessellation ? &tessellationState : nullptr, &viewport, &rasterization,
+                                                      &multisample, &depthStencil, &colorBlend, &dynamicState, desc.layout, desc.renderPass, desc.subpass);
+            if (!desc.renderPass) {
+                createInfo.pNext = &rendering;
+            }
+
+            const vk::Pipeline pipeline = device.createGraphicsPipeline(getPipelineCache(), createInfo).value;
+
+            for (const auto &module : modules)
+                device.destroy(module);
+            return pipeline;
+        } catch (...) {
+            for (const auto &module : modules)
+                device.destroy(module);
+            throw;
+        }
+    }
+
+    vk::Pipeline PipelineManager::create(const ComputePipelineDesc &desc) const {
+        const vk::Device &device = m_GC->getDevice();
+
+        const Spirv            spirv  = m_Shaders.compile(desc.shader);
+        const vk::ShaderModule module = device.createShaderModule(vk::ShaderModuleCreateInfo({}, spirv));
+
+        try {
+            const vk::Pipeline pipeline =
+                device
+                    .createComputePipeline(getPipelineCache(), vk::ComputePipelineCreateInfo(
+                                                        {}, vk::PipelineShaderStageCreateInfo({}, vk::ShaderStageFlagBits::eCompute, module, desc.shader.entryPoint.c_str()),
+                                                        desc.layout))
+                    .value;
+            device.destroy(module);
+            return pipeline;
+        } catch (...) {
+            device.destroy(module);
+            throw;
+        }
+    }
+
+    PipelineStats PipelineManager::getStats() const {
+        // cacheLoaded is only known once the cache is
+        (void) getPipelineCache();
+
+        std::lock_guard lock(m_Mutex);
+        return m_Stats;
+    }
+
+    std::vector<std::byte> PipelineManager::loadCacheData() const {
+        if (m_Settings.cachePath.empty())
+            return {};
+
+        std::ifstream stream(m_Settings.cachePath, std::ios::binary);
+        if (!stream)
+            return {};
+
+        PipelineCacheHeader header{};
+        stream.read(reinterpret_cast<char *>(&header), sizeof(header));
+
+        const PipelineCacheHeader expected = makeCacheHeader(*m_GC);
+        if (!stream || header.magic != expected.magic || header.version != expected.version) {
+            spdlog::warn("Ignoring invalid pipeline cache {}", m_Settings.cachePath.string());
+            return {};
+        }
+
+        if (header.vendorID != expected.vendorID || header.deviceID != expected.deviceID || header.driverVersion != expected.driverVersion ||
+            header.deviceUUID != expected.deviceUUID || header.pipelineCacheUUID != expected.pipelineCacheUUID) {
+            spdlog::info("Pipeline cache {} was written by another device or driver, starting cold", m_Settings.cachePath.string());
+            return {};
+        }
+
+        std::vector<std::byte> data(header.dataSize);
+        stream.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!stream || utils::Hasher().update(data).finish() != header.dataHash) {
+            spdlog::warn("Ignoring corrupted pipeline cache {}", m_Settings.cachePath.string());
+            return {};
+        }
+
+        return data;
+    }
+
+    void PipelineManager::saveCache() const {
+        if (m_Settings.cachePath.empty())
+            return;
+
+        try {
+            const std::vector<uint8_t> data = m_GC->getDevice().getPipelineCacheData(getPipelineCache());
+
+            PipelineCacheHeader header = makeCacheHeader(*m_GC);
+            header.dataSize            = data.size();
+            header.dataHash            = utils::Hasher().update(std::as_bytes(std::span(data))).finish();
+
+            if (m_Settings.cachePath.has_parent_path()) {
+                std::filesystem::create_directories(m_Settings.cachePath.parent_path());
+            }
+
+            // written next to the cache and renamed over it, so a crash never leaves half a file behind
+            std::filesystem::path temp = m_Settings.cachePath;
+            temp += ".tmp";
+            {
+                std::ofstream stream(temp, std::ios::binary | std::ios::trunc);
+                stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+                stream.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+                if (!stream)
+                    throw std::runtime_error("write failed");
+            }
+            std::filesystem::rename(temp, m_Settings.cachePath);
+
+            spdlog::debug("Saved {} bytes of pipeline cache to {}", data.size(), m_Settings.cachePath.string());
+        } catch (const std::exception &e) {
+            spdlog::warn("Failed to save the pipeline cache: {}", e.what());
+        }
+    }
+
+} // namespace neuron::graphics
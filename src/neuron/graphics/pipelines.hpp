@@ -0,0 +1,193 @@
+#pragma once
+
+#include "neuron/graphics/gcontext.hpp"
+#include "neuron/graphics/shaders.hpp"
+
+#include <atomic>
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <variant>
+
+namespace neuron::graphics {
+
+    /**
+     * Everything a graphics pipeline is built from. Viewport and scissor are always dynamic.
+     */
+    struct GraphicsPipelineDesc {
+        std::vector<ShaderSource> shaders;
+        vk::PipelineLayout        layout;
+
+        std::vector<vk::VertexInputBindingDescription>   vertexBindings;
+        std::vector<vk::VertexInputAttributeDescription> vertexAttributes;
+        vk::PrimitiveTopology                            topology = vk::PrimitiveTopology::eTriangleList;
+
+        /**
+         * Only used when there are tessellation shaders.
+         */
+        uint32_t patchControlPoints = 3;
+
+        vk::PolygonMode         polygonMode = vk::PolygonMode::eFill;
+        vk::CullModeFlags       cullMode    = vk::CullModeFlagBits::eBack;
+        vk::FrontFace           frontFace   = vk::FrontFace::eCounterClockwise;
+        vk::SampleCountFlagBits samples     = vk::SampleCountFlagBits::e1;
+
+        bool          depthTest    = true;
+        bool          depthWrite   = true;
+        vk::CompareOp depthCompare = vk::CompareOp::eLess;
+
+        /**
+         * One per color attachment. Attachments without an entry are written opaquely; with a render pass, either give every attachment an entry or fill colorFormats.
+         */
+        std::vector<vk::PipelineColorBlendAttachmentState> blendAttachments;
+
+        /**
+         * With a render pass the pipeline targets that subpass, without one it uses dynamic rendering with these formats.
+         */
+        vk::RenderPass          renderPass;
+        uint32_t                subpass = 0;
+        std::vector<vk::Format> colorFormats;
+        vk::Format              depthFormat = vk::Format::eUndefined;
+    };
+
+    struct ComputePipelineDesc {
+        ShaderSource       shader;
+        vk::PipelineLayout layout;
+    };
+
+    struct PipelineManagerSettings {
+        /**
+         * Where the VkPipelineCache is loaded from and saved to. Empty keeps the cache in memory only.
+         */
+        std::filesystem::path cachePath;
+
+        /**
+         * Where background builds run. Null uses the engine's job system.
+         */
+        utils::JobSystem *jobs = nullptr;
+    };
+
+    struct PipelineStats {
+        uint64_t created = 0;
+
+        /**
+         * Requests answered by a pipeline that was already built or being built.
+         */
+        uint64_t reused   = 0;
+        uint64_t failures = 0;
+
+        /**
+         * Summed over all threads, shader compilation included.
+         */
+        double createMs = 0.0;
+
+        /**
+         * Whether a VkPipelineCache written by this device and driver was found.
+         */
+        bool cacheLoaded = false;
+    };
+
+    /**
+     *
+     * Builds pipelines from descriptions, keyed by a hash of their full state, so identical pipelines are only created once. Pipelines which aren't needed yet can be
+     * prefetched as background tasks; get() builds on the calling thread unless a background build already started.
+     *
+     * All pipelines go through one VkPipelineCache, which is saved to cachePath on destruction and only reused when it was written by the same device and driver. It is
+     * loaded as a background task, so construction doesn't block on reading it.
+     * Owns the pipelines it returns. All methods are thread safe.
+     *
+     */
+    class PipelineManager final {
+      public:
+        PipelineManager(const std::shared_ptr<GContext> &gc, ShaderCompiler &shaders, const PipelineManagerSettings &settings = {});
+        ~PipelineManager();
+
+        PipelineManager(const PipelineManager &)            = delete;
+        PipelineManager &operator=(const PipelineManager &) = delete;
+
+        /**
+         * @throws std::runtime_error if a shader doesn't compile, vk::SystemError if pipeline creation fails.
+         */
+        [[nodiscard]] vk::Pipeline get(const GraphicsPipelineDesc &desc);
+        [[nodiscard]] vk::Pipeline get(const ComputePipelineDesc &desc);
+
+        /**
+         * Starts building the pipeline as a background task, if it isn't built or being built already.
+         */
+        void prefetch(const GraphicsPipelineDesc &desc);
+        void prefetch(const ComputePipelineDesc &desc);
+
+        /**
+         * Returns the pipeline if it is ready and queues a background build otherwise, for callers that can skip a draw instead of hitching.
+         */
+        [[nodiscard]] std::optional<vk::Pipeline> tryGet(const GraphicsPipelineDesc &desc);
+        [[nodiscard]] std::optional<vk::Pipeline> tryGet(const ComputePipelineDesc &desc);
+
+        /**
+         * Covers the shaders' includes, which are read from disk on every call, so editing an include changes the key.
+         */
+        [[nodiscard]] utils::Hash128 getKey(const GraphicsPipelineDesc &desc) const;
+        [[nodiscard]] utils::Hash128 getKey(const ComputePipelineDesc &desc) const;
+
+        /**
+         * Blocks until all background builds are done.
+         */
+        void waitIdle();
+
+        /**
+         * Writes the pipeline cache to cachePath now instead of on destruction.
+         */
+        void saveCache() const;
+
+        /**
+         * Waits for the cache to be loaded.
+         */
+        [[nodiscard]] vk::PipelineCache getPipelineCache() const;
+
+        [[nodiscard]] PipelineStats getStats() const;
+
+      private:
+        using Desc = std::variant<GraphicsPipelineDesc, ComputePipelineDesc>;
+
+        struct Build {
+            Desc                             desc;
+            std::promise<vk::Pipeline>       promise;
+            std::shared_future<vk::Pipeline> future;
+            std::atomic_flag                 claimed;
+        };
+
+        std::shared_ptr<GContext> m_GC;
+        ShaderCompiler           &m_Shaders;
+        PipelineManagerSettings   m_Settings;
+        vk::PipelineCache         m_Cache;
+        utils::Task               m_CacheLoad;
+
+        mutable std::mutex                                         m_Mutex;
+        std::unordered_map<utils::Hash128, std::shared_ptr<Build>> m_Builds;
+        PipelineStats                                              m_Stats;
+
+        utils::TaskGroup m_Tasks;
+
+        void createCache();
+        void enqueueBuild(const std::shared_ptr<Build> &build);
+
+        /**
+         * The desc is only copied when the pipeline is new. The bool is true in that case.
+         */
+        template<typename T> [[nodiscard]] std::pair<std::shared_ptr<Build>, bool> findOrAdd(const T &desc);
+
+        template<typename T> [[nodiscard]] vk::Pipeline                getImpl(const T &desc);
+        template<typename T> void                                      prefetchImpl(const T &desc);
+        template<typename T> [[nodiscard]] std::optional<vk::Pipeline> tryGetImpl(const T &desc);
+
+        void run(Build &build);
+
+        [[nodiscard]] vk::Pipeline create(const GraphicsPipelineDesc &desc) const;
+        [[nodiscard]] vk::Pipeline create(const ComputePipelineDesc &desc) const;
+
+        [[nodiscard]] std::vector<std::byte> loadCacheData() const;
+    };
+
+} // namespace neuron::graphics
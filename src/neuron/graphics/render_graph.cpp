@@ -0,0 +1,663 @@
+#include "render_graph.hpp"
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
+namespace neuron::graphics {
+
+    struct AccessInfo {
+        vk::PipelineStageFlags2 stages;
+        vk::AccessFlags2        access;
+        vk::ImageLayout         layout;
+        bool                    write;
+        vk::ImageUsageFlags     imageUsage;
+        vk::BufferUsageFlags    bufferUsage;
+    };
+
+    using Stage  = vk::PipelineStageFlagBits2;
+    using Access = vk::AccessFlagBits2;
+
+    // only stage and access bits that exist in Vulkan 1.0 too, so the legacy barrier fallback can pass them on unchanged
+    static AccessInfo getAccessInfo(RGAccess access) {
+        switch (access) {
+        case RGAccess::ColorAttachment:
+            return {Stage::eColorAttachmentOutput, Access::eColorAttachmentRead | Access::eColorAttachmentWrite, vk::ImageLayout::eColorAttachmentOptimal, true,
+                    vk::ImageUsageFlagBits::eColorAttachment, {}};
+        case RGAccess::DepthAttachment:
+            return {Stage::eEarlyFragmentTests | Stage::eLateFragmentTests, Access::eDepthStencilAttachmentRead | Access::eDepthStencilAttachmentWrite,
+                    vk::ImageLayout::eDepthStencilAttachmentOptimal, true, vk::ImageUsageFlagBits::eDepthStencilAttachment, {}};
+        case RGAccess::DepthRead:
+            return {Stage::eEarlyFragmentTests | Stage::eLateFragmentTests | Stage::eFragmentShader, Access::eDepthStencilAttachmentRead | Access::eShaderRead,
+                    vk::ImageLayout::eDepthStencilReadOnlyOptimal, false, vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eSampled, {}};
+        case RGAccess::SampledGraphics:
+            return {Stage::eVertexShader | Stage::eFragmentShader, Access::eShaderRead, vk::ImageLayout::eShaderReadOnlyOptimal, false, vk::ImageUsageFlagBits::eSampled, {}};
+        case RGAccess::SampledCompute:
+            return {Stage::eComputeShader, Access::eShaderRead, vk::ImageLayout::eShaderReadOnlyOptimal, false, vk::ImageUsageFlagBits::eSampled, {}};
+        case RGAccess::StorageReadCompute:
+            return {Stage::eComputeShader, Access::eShaderRead, vk::ImageLayout::eGeneral, false, vk::ImageUsageFlagBits::eStorage, vk::BufferUsageFlagBits::eStorageBuffer};
+        case RGAccess::StorageWriteCompute:
+            return {Stage::eComputeShader, Access::eShaderWrite, vk::ImageLayout::eGeneral, true, vk::ImageUsageFlagBits::eStorage, vk::BufferUsageFlagBits::eStorageBuffer};
+        case RGAccess::StorageReadWriteCompute:
+            return {Stage::eComputeShader, Access::eShaderRead | Access::eShaderWrite, vk::ImageLayout::eGeneral, true, vk::ImageUsageFlagBits::eStorage,
+                    vk::BufferUsageFlagBits::eStorageBuffer};
+        case RGAccess::TransferSrc:
+            return {Stage::eTransfer, Access::eTransferRead, vk::ImageLayout::eTransferSrcOptimal, false, vk::ImageUsageFlagBits::eTransferSrc,
+                    vk::BufferUsageFlagBits::eTransferSrc};
+        case RGAccess::TransferDst:
+            return {Stage::eTransfer, Access::eTransferWrite, vk::ImageLayout::eTransferDstOptimal, true, vk::ImageUsageFlagBits::eTransferDst,
+                    vk::BufferUsageFlagBits::eTransferDst};
+        case RGAccess::VertexBuffer:
+            return {Stage::eVertexInput, Access::eVertexAttributeRead, vk::ImageLayout::eUndefined, false, {}, vk::BufferUsageFlagBits::eVertexBuffer};
+        case RGAccess::IndexBuffer:
+            return {Stage::eVertexInput, Access::eIndexRead, vk::ImageLayout::eUndefined, false, {}, vk::BufferUsageFlagBits::eIndexBuffer};
+        case RGAccess::IndirectBuffer:
+            return {Stage::eDrawIndirect, Access::eIndirectCommandRead, vk::ImageLayout::eUndefined, false, {}, vk::BufferUsageFlagBits::eIndirectBuffer};
+        case RGAccess::UniformGraphics:
+            return {Stage::eVertexShader | Stage::eFragmentShader, Access::eUniformRead, vk::ImageLayout::eUndefined, false, {}, vk::BufferUsageFlagBits::eUniformBuffer};
+        case RGAccess::UniformCompute:
+            return {Stage::eComputeShader, Access::eUniformRead, vk::ImageLayout::eUndefined, false, {}, vk::BufferUsageFlagBits::eUniformBuffer};
+        }
+        throw std::runtime_error("Unknown render graph access");
+    }
+
+    static constexpr vk::AccessFlags2 WRITE_ACCESS = Access::eShaderWrite | Access::eColorAttachmentWrite | Access::eDepthStencilAttachmentWrite | Access::eTransferWrite |
+                                                     Access::eHostWrite | Access::eMemoryWrite;
+
+    static vk::ImageAspectFlags getAspect(vk::Format format) {
+        switch (format) {
+        case vk::Format::eD16Unorm:
+        case vk::Format::eX8D24UnormPack32:
+        case vk::Format::eD32Sfloat:
+            return vk::ImageAspectFlagBits::eDepth;
+        case vk::Format::eD16UnormS8Uint:
+        case vk::Format::eD24UnormS8Uint:
+        case vk::Format::eD32SfloatS8Uint:
+            return vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil;
+        case vk::Format::eS8Uint:
+            return vk::ImageAspectFlagBits::eStencil;
+        default:
+            return vk::ImageAspectFlagBits::eColor;
+        }
+    }
+
+    static bool rangesOverlap(vk::DeviceSize aOffset, vk::DeviceSize aSize, vk::DeviceSize bOffset, vk::DeviceSize bSize) {
+        return aOffset < bOffset + bSize && bOffset < aOffset + aSize;
+    }
+
+    vk::Image RGResources::getImage(RGImage image) const { return m_Graph.m_Images.at(image.index).image; }
+
+    vk::ImageView RGResources::getImageView(RGImage image) const { return m_Graph.m_Images.at(image.index).view; }
+
+    vk::Extent2D RGResources::getExtent(RGImage image) const { return m_Graph.m_Images.at(image.index).desc.extent; }
+
+    vk::Buffer RGResources::getBuffer(RGBuffer buffer) const { return m_Graph.m_Buffers.at(buffer.index).buffer; }
+
+    RGImage RGPassBuilder::createImage(std::string name, const RGImageDesc &desc) {
+        auto &image  = m_Graph.m_Images.emplace_back();
+        image.name   = std::move(name);
+        image.desc   = desc;
+        image.aspect = getAspect(desc.format);
+        return RGImage{static_cast<uint32_t>(m_Graph.m_Images.size() - 1)};
+    }
+
+    RGBuffer RGPassBuilder::createBuffer(std::string name, const RGBufferDesc &desc) {
+        auto &buffer = m_Graph.m_Buffers.emplace_back();
+        buffer.name  = std::move(name);
+        buffer.desc  = desc;
+        return RGBuffer{static_cast<uint32_t>(m_Graph.m_Buffers.size() - 1)};
+    }
+
+    void RGPassBuilder::use(RGImage image, RGAccess access) {
+        auto &pass = m_Graph.m_Passes[m_Pass];
+        if (image.index >= m_Graph.m_Images.size())
+            throw std::runtime_error("Pass " + pass.name + " uses an image that doesn't belong to this frame");
+
+        const AccessInfo info = getAccessInfo(access);
+        if (!info.imageUsage)
+            throw std::runtime_error("Pass " + pass.name + " uses image " + m_Graph.m_Images[image.index].name + " with a buffer-only access");
+
+        m_Graph.m_Images[image.index].usage |= info.imageUsage;
+
+        // several accesses to one image in a pass become one, which needs a single layout
+        for (auto &use : pass.images) {
+            if (use.resource != image.index)
+                continue;
+            if (use.layout != info.layout)
+                throw std::runtime_error("Pass " + pass.name + " uses image " + m_Graph.m_Images[image.index].name + " in two layouts");
+
+            use.stages |= info.stages;
+            use.access |= info.access;
+            use.write = use.write || info.write;
+            return;
+        }
+        pass.images.push_back({image.index, info.stages, info.access, info.layout, info.write});
+    }
+
+    void RGPassBuilder::use(RGBuffer buffer, RGAccess access) {
+        auto &pass = m_Graph.m_Passes[m_Pass];
+        if (buffer.index >= m_Graph.m_Buffers.size())
+            throw std::runtime_error("Pass " + pass.name + " uses a buffer that doesn't belong to this frame");
+
+        const AccessInfo info = getAccessInfo(access);
+        if (!info.bufferUsage)
+            throw std::runtime_error("Pass " + pass.name + " uses buffer " + m_Graph.m_Buffers[buffer.index].name + " with an image-only access");
+
+        m_Graph.m_Buffers[buffer.index].usage |= info.bufferUsage;
+
+        for (auto &use : pass.buffers) {
+            if (use.resource != buffer.index)
+                continue;
+
+            use.stages |= info.stages;
+            use.access |= info.access;
+            use.write = use.write || info.write;
+            return;
+        }
+        pass.buffers.push_back({buffer.index, info.stages, info.access, vk::ImageLayout::eUndefined, info.write});
+    }
+
+    void RGPassBuilder::setSideEffects() { m_Graph.m_Passes[m_Pass].sideEffects = true; }
+
+    RenderGraph::RenderGraph(const std::shared_ptr<GContext> &gc, uint32_t framesInFlight) : m_GC(gc), m_Slots(std::max(framesInFlight, 1u)) {}
+
+    RenderGraph::~RenderGraph() {
+        for (auto &slot : m_Slots) {
+            destroySlot(slot);
+        }
+    }
+
+    void RenderGraph::beginFrame(uint32_t frameIndex) {
+        if (frameIndex >= m_Slots.size()) {
+            throw std::runtime_error("Frame index out of range for this render graph");
+        }
+
+        m_FrameIndex = frameIndex;
+        m_Passes.clear();
+        m_Images.clear();
+        m_Buffers.clear();
+        m_FinalBarriers.clear();
+        m_Compiled = false;
+    }
+
+    RGImage RenderGraph::importImage(std::string name, const RGImageImport &image) {
+        auto &resource             = m_Images.emplace_back();
+        resource.name              = std::move(name);
+        resource.desc              = image.desc;
+        resource.imported          = true;
+        resource.import            = image;
+        resource.aspect            = getAspect(image.desc.format);
+        resource.image             = image.image;
+        resource.view              = image.view;
+        resource.state.touched     = true;
+        resource.state.layout      = image.initialLayout;
+        resource.state.writeStages = image.initialStages;
+        resource.state.writeAccess = image.initialAccess & WRITE_ACCESS;
+        return RGImage{static_cast<uint32_t>(m_Images.size() - 1)};
+    }
+
+    RGBuffer RenderGraph::importBuffer(std::string name, const RGBufferImport &buffer) {
+        auto &resource             = m_Buffers.emplace_back();
+        resource.name              = std::move(name);
+        resource.desc              = {buffer.size};
+        resource.imported          = true;
+        resource.import            = buffer;
+        resource.buffer            = buffer.buffer;
+        resource.state.touched     = true;
+        resource.state.writeStages = buffer.initialStages;
+        resource.state.writeAccess = buffer.initialAccess & WRITE_ACCESS;
+        return RGBuffer{static_cast<uint32_t>(m_Buffers.size() - 1)};
+    }
+
+    RGImage RenderGraph::importTarget(std::string name, const IRenderTarget &target, uint32_t imageIndex) {
+        const auto &configuration = target.getCurrentConfiguration();
+
+        RGImageImport image;
+        image.image         = target.getImageTarget(imageIndex);
+        image.view          = target.getImageViewTarget(imageIndex);
+        image.desc          = {.format = configuration.format, .extent = configuration.extent};
+        image.initialLayout = vk::ImageLayout::eColorAttachmentOptimal;
+        image.initialStages = Stage::eColorAttachmentOutput;
+        image.initialAccess = Access::eColorAttachmentWrite;
+        image.finalLayout   = vk::ImageLayout::eColorAttachmentOptimal;
+        image.finalStages   = Stage::eColorAttachmentOutput;
+        image.finalAccess   = Access::eColorAttachmentRead | Access::eColorAttachmentWrite;
+        return importImage(std::move(name), image);
+    }
+
+    void RenderGraph::addPass(std::string name, const std::function<void(RGPassBuilder &)> &setup, RGExecuteFn execute) {
+        auto &pass   = m_Passes.emplace_back();
+        pass.name    = std::move(name);
+        pass.execute = std::move(execute);
+        m_Compiled   = false;
+
+        if (m_GpuProfiler != nullptr)
+            pass.profileName = utils::Profiler::get().intern(pass.name);
+
+        RGPassBuilder builder(*this, static_cast<uint32_t>(m_Passes.size() - 1));
+        setup(builder);
+    }
+
+    bool RenderGraph::isCulled(std::string_view pass) const {
+        return std::ranges::any_of(m_Passes, [&](const Pass &candidate) { return candidate.name == pass && candidate.culled; });
+    }
+
+    void RenderGraph::compile() {
+        if (m_Compiled)
+            return;
+
+        NEURON_PROFILE_SCOPE("RenderGraph::compile");
+        m_Stats = {};
+        cull();
+        computeLifetimes();
+        realize();
+        buildBarriers();
+        m_Compiled = true;
+    }
+
+    void RenderGraph::execute(vk::CommandBuffer cmd) {
+        compile();
+
+        NEURON_PROFILE_SCOPE("RenderGraph::execute");
+        const RGResources resources(*this);
+        for (const auto &pass : m_Passes) {
+            if (pass.culled)
+                continue;
+
+            const uint32_t scope = m_GpuProfiler != nullptr && pass.profileName != nullptr ? m_GpuProfiler->begin(cmd, pass.profileName) : UINT32_MAX;
+            recordBarriers(cmd, pass.imageBarriers, pass.bufferBarriers);
+            if (pass.execute)
+                pass.execute(cmd, resources);
+            if (m_GpuProfiler != nullptr)
+                m_GpuProfiler->end(cmd, scope);
+        }
+        recordBarriers(cmd, m_FinalBarriers, {});
+    }
+
+    void RenderGraph::cull() {
+        // walking backwards, a pass is needed if it writes something a later needed pass reads; a write after the last read of a resource is dead
+        std::vector<bool> neededImages(m_Images.size()), neededBuffers(m_Buffers.size());
+        for (size_t i = 0; i < m_Images.size(); i++)
+            neededImages[i] = m_Images[i].imported;
+        for (size_t i = 0; i < m_Buffers.size(); i++)
+            neededBuffers[i] = m_Buffers[i].imported;
+
+        for (auto pass = m_Passes.rbegin(); pass != m_Passes.rend(); ++pass) {
+            bool needed = pass->sideEffects;
+            for (const auto &use : pass->images)
+                needed = needed || (use.write && neededImages[use.resource]);
+            for (const auto &use : pass->buffers)
+                needed = needed || (use.write && neededBuffers[use.resource]);
+
+            pass->culled = !needed;
+            if (!needed) {
+                m_Stats.culledPasses++;
+                continue;
+            }
+
+            for (const auto &use : pass->images)
+                neededImages[use.resource] = true;
+            for (const auto &use : pass->buffers)
+                neededBuffers[use.resource] = true;
+        }
+
+        m_Stats.passes = static_cast<uint32_t>(m_Passes.size()) - m_Stats.culledPasses;
+    }
+
+    void RenderGraph::computeLifetimes() {
+        for (uint32_t i = 0; i < m_Passes.size(); i++) {
+            if (m_Passes[i].culled)
+                continue;
+
+            for (const auto &use : m_Passes[i].images) {
+                auto &image     = m_Images[use.resource];
+                image.firstPass = std::min(image.firstPass, i);
+                image.lastPass  = std::max(image.lastPass, i);
+            }
+            for (const auto &use : m_Passes[i].buffers) {
+                auto &buffer     = m_Buffers[use.resource];
+                buffer.firstPass = std::min(buffer.firstPass, i);
+                buffer.lastPass  = std::max(buffer.lastPass, i);
+            }
+        }
+    }
+
+    utils::Hash128 RenderGraph::getPlanKey() const {
+        utils::Hasher hasher;
+        // the alias lists refer to resources by index, so the indices are part of the plan
+        for (uint32_t i = 0; i < m_Images.size(); i++) {
+            const auto &image = m_Images[i];
+            if (image.imported || image.firstPass == UINT32_MAX)
+                continue;
+            hasher.updateValue(i).updateValue(image.desc.format).updateValue(image.desc.extent).updateValue(image.desc.mipLevels).updateValue(image.desc.samples);
+            hasher.updateValue(image.usage).updateValue(image.firstPass).updateValue(image.lastPass);
+        }
+        hasher.update("buffers");
+        for (uint32_t i = 0; i < m_Buffers.size(); i++) {
+            const auto &buffer = m_Buffers[i];
+            if (buffer.imported || buffer.firstPass == UINT32_MAX)
+                continue;
+            hasher.updateValue(i).updateValue(buffer.desc.size).updateValue(buffer.usage).updateValue(buffer.firstPass).updateValue(buffer.lastPass);
+        }
+        return hasher.finish();
+    }
+
+    void RenderGraph::realize() {
+        Slot                &slot = m_Slots[m_FrameIndex];
+        const utils::Hash128 key  = getPlanKey();
+
+        if (slot.key != key) {
+            destroySlot(slot);
+            createTransients(slot);
+            slot.key                 = key;
+            m_Stats.resourcesCreated = true;
+        }
+
+        uint32_t transient = 0;
+        for (auto &image : m_Images) {
+            if (image.imported || image.firstPass == UINT32_MAX)
+                continue;
+            image.image   = slot.images[transient];
+            image.view    = slot.views[transient];
+            image.aliases = slot.imageAliases[transient];
+            transient++;
+        }
+        m_Stats.transientImages = transient;
+
+        transient = 0;
+        for (auto &buffer : m_Buffers) {
+            if (buffer.imported || buffer.firstPass == UINT32_MAX)
+                continue;
+            buffer.buffer  = slot.buffers[transient];
+            buffer.aliases = slot.bufferAliases[transient];
+            transient++;
+        }
+        m_Stats.transientBuffers = transient;
+
+        m_Stats.transientBytes = slot.transientBytes;
+        m_Stats.allocatedBytes = slot.allocatedBytes;
+    }
+
+    void RenderGraph::createTransients(Slot &slot) {
+        const vk::Device &device = m_GC->getDevice();
+
+        struct Placement {
+            uint32_t               resource;
+            bool                   image;
+            vk::MemoryRequirements requirements;
+            uint32_t               firstPass;
+            uint32_t               lastPass;
+            vk::DeviceSize         offset = 0;
+        };
+
+        // images and buffers are kept apart, so neither has to care about bufferImageGranularity
+        std::map<std::pair<uint32_t, ResourceKind>, std::vector<Placement>> groups;
+        std::vector<uint32_t>                                               imageSlots(m_Images.size(), UINT32_MAX), bufferSlots(m_Buffers.size(), UINT32_MAX);
+
+        for (uint32_t i = 0; i < m_Images.size(); i++) {
+            const auto &image = m_Images[i];
+            if (image.imported || image.firstPass == UINT32_MAX)
+                continue;
+
+            const vk::ImageCreateInfo createInfo({}, vk::ImageType::e2D, image.desc.format, vk::Extent3D(image.desc.extent, 1), image.desc.mipLevels, 1, image.desc.samples,
+                                                 vk::ImageTiling::eOptimal, image.usage, vk::SharingMode::eExclusive, {}, vk::ImageLayout::eUndefined);
+            imageSlots[i] = static_cast<uint32_t>(slot.images.size());
+            slot.images.push_back(device.createImage(createInfo));
+
+            const auto requirements = device.getImageMemoryRequirements(slot.images.back());
+            const auto memoryType   = m_GC->findMemoryType(requirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal);
+            groups[{memoryType, ResourceKind::Optimal}].push_back({i, true, requirements, image.firstPass, image.lastPass});
+        }
+
+        for (uint32_t i = 0; i < m_Buffers.size(); i++) {
+            const auto &buffer = m_Buffers[i];
+            if (buffer.imported || buffer.firstPass == UINT32_MAX)
+                continue;
+
+            bufferSlots[i] = static_cast<uint32_t>(slot.buffers.size());
+            slot.buffers.push_back(device.createBuffer(vk::BufferCreateInfo({}, buffer.desc.size, buffer.usage, vk::SharingMode::eExclusive)));
+
+            const auto requirements = device.getBufferMemoryRequirements(slot.buffers.back());
+            const auto memoryType   = m_GC->findMemoryType(requirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal);
+            groups[{memoryType, ResourceKind::Linear}].push_back({i, false, requirements, buffer.firstPass, buffer.lastPass});
+        }
+
+        slot.imageAliases.assign(slot.images.size(), {});
+        slot.bufferAliases.assign(slot.buffers.size(), {});
+
+        for (auto &[group, placements] : groups) {
+            // biggest first, each at the lowest offset that doesn't collide with a placed resource whose lifetime overlaps its own
+            std::ranges::sort(placements, [](const Placement &a, const Placement &b) { return a.requirements.size > b.requirements.size; });
+
+            vk::DeviceSize heapSize = 0, alignment = 1;
+            for (size_t i = 0; i < placements.size(); i++) {
+                auto &placement = placements[i];
+
+                std::vector<const Placement *> live;
+                for (size_t j = 0; j < i; j++) {
+                    if (placements[j].firstPass <= placement.lastPass && placement.firstPass <= placements[j].lastPass)
+                        live.push_back(&placements[j]);
+                }
+                std::ranges::sort(live, [](const Placement *a, const Placement *b) { return a->offset < b->offset; });
+
+                const vk::DeviceSize align  = placement.requirements.alignment;
+                vk::DeviceSize       offset = 0;
+                for (const Placement *other : live) {
+                    const vk::DeviceSize aligned = (offset + align - 1) / align * align;
+                    if (aligned + placement.requirements.size <= other->offset)
+                        break;
+                    offset = std::max(offset, other->offset + other->requirements.size);
+                }
+                placement.offset = (offset + align - 1) / align * align;
+
+                heapSize  = std::max(heapSize, placement.offset + placement.requirements.size);
+                alignment = std::max(alignment, align);
+                slot.transientBytes += placement.requirements.size;
+            }
+
+            const vk::MemoryRequirements heapRequirements(heapSize, alignment, 1u << group.first);
+            Allocation                   memory = m_GC->getAllocator().allocate(heapRequirements, vk::MemoryPropertyFlagBits::eDeviceLocal, {}, group.second);
+            slot.allocatedBytes += heapSize;
+
+            for (const auto &placement : placements) {
+                if (placement.image) {
+                    device.bindImageMemory(slot.images[imageSlots[placement.resource]], memory.memory, memory.offset + placement.offset);
+                } else {
+                    device.bindBufferMemory(slot.buffers[bufferSlots[placement.resource]], memory.memory, memory.offset + placement.offset);
+                }
+
+                // resources that used this memory before, which the first use of this one has to wait for
+                for (const auto &other : placements) {
+                    if (other.lastPass >= placement.firstPass ||
+                        !rangesOverlap(placement.offset, placement.requirements.size, other.offset, other.requirements.size))
+                        continue;
+
+                    if (placement.image) {
+                        slot.imageAliases[imageSlots[placement.resource]].push_back(other.resource);
+                    } else {
+                        slot.bufferAliases[bufferSlots[placement.resource]].push_back(other.resource);
+                    }
+                }
+            }
+            slot.memory.push_back(memory);
+        }
+
+        for (uint32_t i = 0; i < m_Images.size(); i++) {
+            if (imageSlots[i] == UINT32_MAX)
+                continue;
+
+            const auto &image = m_Images[i];
+            slot.views.push_back(device.createImageView(vk::ImageViewCreateInfo({}, slot.images[imageSlots[i]], vk::ImageViewType::e2D, image.desc.format,
+                                                                                 STANDARD_COMPONENT_MAPPING,
+                                                                                 vk::ImageSubresourceRange(image.aspect, 0, image.desc.mipLevels, 0, 1))));
+        }
+    }
+
+    void RenderGraph::destroySlot(Slot &slot) {
+        const vk::Device &device = m_GC->getDevice();
+        for (auto view : slot.views)
+            device.destroy(view);
+        for (auto image : slot.images)
+            device.destroy(image);
+        for (auto buffer : slot.buffers)
+            device.destroy(buffer);
+        for (auto &memory : slot.memory)
+            m_GC->getAllocator().free(memory);
+
+        slot = Slot{};
+    }
+
+    void RenderGraph::buildBarriers() {
+        for (auto &pass : m_Passes) {
+            pass.imageBarriers.clear();
+            pass.bufferBarriers.clear();
+            if (pass.culled)
+                continue;
+
+            for (const auto &use : pass.images)
+                syncImage(m_Images[use.resource], use, pass.imageBarriers);
+            for (const auto &use : pass.buffers)
+                syncBuffer(m_Buffers[use.resource], use, pass.bufferBarriers);
+
+            m_Stats.imageBarriers += static_cast<uint32_t>(pass.imageBarriers.size());
+            m_Stats.bufferBarriers += static_cast<uint32_t>(pass.bufferBarriers.size());
+            if (!pass.imageBarriers.empty() || !pass.bufferBarriers.empty())
+                m_Stats.barrierBatches++;
+        }
+
+        // hand imported images over in the state whatever comes after the graph expects
+        for (const auto &image : m_Images) {
+            if (!image.imported || image.import.finalLayout == vk::ImageLayout::eUndefined)
+                continue;
+
+            const SyncState &state = image.state;
+            if (state.layout == image.import.finalLayout && !(state.writeStages & ~image.import.finalStages))
+                continue;
+
+            m_FinalBarriers.emplace_back(state.writeStages | state.readStages, state.writeAccess, image.import.finalStages, image.import.finalAccess, state.layout,
+                                         image.import.finalLayout, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image.image,
+                                         vk::ImageSubresourceRange(image.aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS));
+        }
+        m_Stats.imageBarriers += static_cast<uint32_t>(m_FinalBarriers.size());
+        if (!m_FinalBarriers.empty())
+            m_Stats.barrierBatches++;
+    }
+
+    void RenderGraph::syncImage(Image &image, const Use &use, std::vector<vk::ImageMemoryBarrier2> &barriers) {
+        SyncState &state = image.state;
+        if (!state.touched) {
+            // the memory may still be in use by the transients placed there before, which the first use has to wait for; the contents are discarded anyway
+            for (uint32_t alias : image.aliases) {
+                state.writeStages |= m_Images[alias].state.writeStages | m_Images[alias].state.readStages;
+                state.writeAccess |= m_Images[alias].state.writeAccess;
+            }
+            state.touched = true;
+        }
+
+        auto barrier = [&](vk::PipelineStageFlags2 srcStages, vk::AccessFlags2 srcAccess) {
+            barriers.emplace_back(srcStages, srcAccess, use.stages, use.access, state.layout, use.layout, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image.image,
+                                  vk::ImageSubresourceRange(image.aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS));
+        };
+
+        const bool transition = state.layout != use.layout;
+        if (use.write || transition) {
+            // waits for the last write and every read since, so neither is overwritten early
+            const vk::PipelineStageFlags2 srcStages = state.writeStages | state.readStages;
+            if (srcStages || transition)
+                barrier(srcStages, state.writeAccess);
+
+            state.layout = use.layout;
+            if (use.write) {
+                state.writeStages = use.stages;
+                state.writeAccess = use.access & WRITE_ACCESS;
+                state.readStages  = {};
+                state.readAccess  = {};
+            } else {
+                // a transition is a write too, which only these stages have waited for
+                state.writeStages = use.stages;
+                state.writeAccess = {};
+                state.readStages  = use.stages;
+                state.readAccess  = use.access;
+            }
+            return;
+        }
+
+        // reads only need a barrier if they come from stages or accesses that haven't waited for the last write yet
+        if ((use.stages & ~state.readStages) || (use.access & ~state.readAccess)) {
+            if (state.writeStages)
+                barrier(state.writeStages, state.writeAccess);
+            state.readStages |= use.stages;
+            state.readAccess |= use.access;
+        }
+    }
+
+    void RenderGraph::syncBuffer(Buffer &buffer, const Use &use, std::vector<vk::BufferMemoryBarrier2> &barriers) {
+        SyncState &state = buffer.state;
+        if (!state.touched) {
+            for (uint32_t alias : buffer.aliases) {
+                state.writeStages |= m_Buffers[alias].state.writeStages | m_Buffers[alias].state.readStages;
+                state.writeAccess |= m_Buffers[alias].state.writeAccess;
+            }
+            state.touched = true;
+        }
+
+        auto barrier = [&](vk::PipelineStageFlags2 srcStages, vk::AccessFlags2 srcAccess) {
+            barriers.emplace_back(srcStages, srcAccess, use.stages, use.access, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, buffer.buffer, 0, VK_WHOLE_SIZE);
+        };
+
+        if (use.write) {
+            const vk::PipelineStageFlags2 srcStages = state.writeStages | state.readStages;
+            if (srcStages)
+                barrier(srcStages, state.writeAccess);
+
+            state.writeStages = use.stages;
+            state.writeAccess = use.access & WRITE_ACCESS;
+            state.readStages  = {};
+            state.readAccess  = {};
+            return;
+        }
+
+        if ((use.stages & ~state.readStages) || (use.access & ~state.readAccess)) {
+            if (state.writeStages)
+                barrier(state.writeStages, state.writeAccess);
+            state.readStages |= use.stages;
+            state.readAccess |= use.access;
+        }
+    }
+
+    void RenderGraph::recordBarriers(vk::CommandBuffer cmd, const std::vector<vk::ImageMemoryBarrier2> &images, const std::vector<vk::BufferMemoryBarrier2> &buffers) const {
+        if (images.empty() && buffers.empty())
+            return;
+
+        if (m_GC->getFastPaths().synchronization2) {
+            cmd.pipelineBarrier2(vk::DependencyInfo({}, {}, buffers, images));
+            return;
+        }
+
+        // every bit the graph uses exists in the legacy flags with the same value
+        vk::PipelineStageFlags              srcStages, dstStages;
+        std::vector<vk::ImageMemoryBarrier>  imageBarriers;
+        std::vector<vk::BufferMemoryBarrier> bufferBarriers;
+        for (const auto &barrier : images) {
+            srcStages |= vk::PipelineStageFlags(static_cast<VkPipelineStageFlags>(static_cast<VkPipelineStageFlags2>(barrier.srcStageMask)));
+            dstStages |= vk::PipelineStageFlags(static_cast<VkPipelineStageFlags>(static_cast<VkPipelineStageFlags2>(barrier.dstStageMask)));
+            imageBarriers.emplace_back(vk::AccessFlags(static_cast<VkAccessFlags>(static_cast<VkAccessFlags2>(barrier.srcAccessMask))),
+                                       vk::AccessFlags(static_cast<VkAccessFlags>(static_cast<VkAccessFlags2>(barrier.dstAccessMask))), barrier.oldLayout, barrier.newLayout,
+                                       VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, barrier.image, barrier.subresourceRange);
+        }
+        for (const auto &barrier : buffers) {
+            srcStages |= vk::PipelineStageFlags(static_cast<VkPipelineStageFlags>(static_cast<VkPipelineStageFlags2>(barrier.srcStageMask)));
+            dstStages |= vk::PipelineStageFlags(static_cast<VkPipelineStageFlags>(static_cast<VkPipelineStageFlags2>(barrier.dstStageMask)));
+            bufferBarriers.emplace_back(vk::AccessFlags(static_cast<VkAccessFlags>(static_cast<VkAccessFlags2>(barrier.srcAccessMask))),
+                                        vk::AccessFlags(static_cast<VkAccessFlags>(static_cast<VkAccessFlags2>(barrier.dstAccessMask))), VK_QUEUE_FAMILY_IGNORED,
+                                        VK_QUEUE_FAMILY_IGNORED, barrier.buffer, barrier.offset, barrier.size);
+        }
+
+        if (!srcStages)
+            srcStages = vk::PipelineStageFlagBits::eTopOfPipe;
+        if (!dstStages)
+            dstStages = vk::PipelineStageFlagBits::eBottomOfPipe;
+        cmd.pipelineBarrier(srcStages, dstStages, {}, {}, bufferBarriers, imageBarriers);
+    }
+
+} // namespace neuron::graphics
@@ -0,0 +1,346 @@
+#pragma once
+
+#include "neuron/graphics/gcontext.hpp"
+#include "neuron/graphics/gpu_profiler.hpp"
+#include "neuron/utils/utils.hpp"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace neuron::graphics {
+
+    /**
+     * How a pass uses a resource. Decides the stages and access flags the graph synchronizes, and for images the layout.
+     */
+    enum class RGAccess {
+        ColorAttachment,
+        DepthAttachment,
+        DepthRead,
+        SampledGraphics,
+        SampledCompute,
+        StorageReadCompute,
+        StorageWriteCompute,
+        StorageReadWriteCompute,
+        TransferSrc,
+        TransferDst,
+
+        // buffers only
+        VertexBuffer,
+        IndexBuffer,
+        IndirectBuffer,
+        UniformGraphics,
+        UniformCompute,
+    };
+
+    struct RGImage {
+        uint32_t index = UINT32_MAX;
+
+        [[nodiscard]] inline explicit operator bool() const noexcept { return index != UINT32_MAX; }
+    };
+
+    struct RGBuffer {
+        uint32_t index = UINT32_MAX;
+
+        [[nodiscard]] inline explicit operator bool() const noexcept { return index != UINT32_MAX; }
+    };
+
+    /**
+     * A 2D image. Its usage flags are collected from how the passes access it.
+     */
+    struct RGImageDesc {
+        vk::Format              format = vk::Format::eR8G8B8A8Unorm;
+        vk::Extent2D            extent;
+        uint32_t                mipLevels = 1;
+        vk::SampleCountFlagBits samples   = vk::SampleCountFlagBits::e1;
+    };
+
+    struct RGBufferDesc {
+        vk::DeviceSize size = 0;
+    };
+
+    struct RGImageImport {
+        vk::Image     image;
+        vk::ImageView view;
+        RGImageDesc   desc;
+
+        /**
+         * The image's layout when the graph starts, and the stages and accesses of whatever wrote it last.
+         */
+        vk::ImageLayout         initialLayout = vk::ImageLayout::eUndefined;
+        vk::PipelineStageFlags2 initialStages;
+        vk::AccessFlags2        initialAccess;
+
+        /**
+         * The layout whatever comes after the graph expects, and the stages and accesses it uses the image with. Undefined leaves the image as the last pass did.
+         */
+        vk::ImageLayout         finalLayout = vk::ImageLayout::eUndefined;
+        vk::PipelineStageFlags2 finalStages;
+        vk::AccessFlags2        finalAccess;
+    };
+
+    struct RGBufferImport {
+        vk::Buffer     buffer;
+        vk::DeviceSize size = 0;
+
+        vk::PipelineStageFlags2 initialStages;
+        vk::AccessFlags2        initialAccess;
+    };
+
+    struct RenderGraphStats {
+        uint32_t passes       = 0;
+        uint32_t culledPasses = 0;
+
+        uint32_t imageBarriers  = 0;
+        uint32_t bufferBarriers = 0;
+
+        /**
+         * vkCmdPipelineBarrier2 calls, at most one per pass plus one for the final transitions.
+         */
+        uint32_t barrierBatches = 0;
+
+        uint32_t transientImages  = 0;
+        uint32_t transientBuffers = 0;
+
+        /**
+         * What the transient resources would take on their own, and what their aliased memory actually takes.
+         */
+        vk::DeviceSize transientBytes = 0;
+        vk::DeviceSize allocatedBytes = 0;
+
+        /**
+         * False when this frame reused the transient resources of the last frame that ran in the same slot.
+         */
+        bool resourcesCreated = false;
+
+        [[nodiscard]] inline uint32_t getBarrierCount() const noexcept { return imageBarriers + bufferBarriers; }
+
+        [[nodiscard]] inline vk::DeviceSize getAliasingSavings() const noexcept { return transientBytes - allocatedBytes; }
+    };
+
+    class RenderGraph;
+
+    /**
+     * The physical resources behind the handles, for pass callbacks.
+     */
+    class RGResources {
+      public:
+        [[nodiscard]] vk::Image     getImage(RGImage image) const;
+        [[nodiscard]] vk::ImageView getImageView(RGImage image) const;
+        [[nodiscard]] vk::Extent2D  getExtent(RGImage image) const;
+        [[nodiscard]] vk::Buffer    getBuffer(RGBuffer buffer) const;
+
+      private:
+        friend class RenderGraph;
+
+        explicit RGResources(const RenderGraph &graph) : m_Graph(graph) {}
+
+        const RenderGraph &m_Graph;
+    };
+
+    /**
+     * Declares what a pass creates and accesses. Only valid inside the setup callback.
+     */
+    class RGPassBuilder {
+      public:
+        /**
+         * A transient image, which only lives while passes use it and may share memory with other transients.
+         */
+        [[nodiscard]] RGImage  createImage(std::string name, const RGImageDesc &desc);
+        [[nodiscard]] RGBuffer createBuffer(std::string name, const RGBufferDesc &desc);
+
+        void use(RGImage image, RGAccess access);
+        void use(RGBuffer buffer, RGAccess access);
+
+        /**
+         * Keeps the pass even if nothing reads what it writes, for passes that do something outside the graph.
+         */
+        void setSideEffects();
+
+      private:
+        friend class RenderGraph;
+
+        RGPassBuilder(RenderGraph &graph, uint32_t pass) : m_Graph(graph), m_Pass(pass) {}
+
+        RenderGraph &m_Graph;
+        uint32_t     m_Pass;
+    };
+
+    using RGExecuteFn = std::function<void(vk::CommandBuffer, const RGResources &)>;
+
+    /**
+     *
+     * Frame render graph. Passes declare which images and buffers they access and how, the graph orders nothing itself (passes run in the order they were added) but
+     * works out everything in between:
+     *
+     * - passes whose results nothing reads are culled; writing an imported resource (like an IRenderTarget image) or having side effects keeps a pass
+     * - synchronization2 barriers and layout transitions, only where a hazard exists, batched into one vkCmdPipelineBarrier2 per pass
+     * - transient images and buffers whose lifetimes don't overlap are placed in the same memory
+     *
+     * Rebuilt every frame: beginFrame(), import and add passes, execute(). Transient resources are kept per frame slot and reused as long as the frame declares the same
+     * ones. Devices without synchronization2 get the equivalent legacy barriers. Not thread safe.
+     *
+     */
+    class RenderGraph final {
+      public:
+        explicit RenderGraph(const std::shared_ptr<GContext> &gc, uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT);
+        ~RenderGraph();
+
+        RenderGraph(const RenderGraph &)            = delete;
+        RenderGraph &operator=(const RenderGraph &) = delete;
+
+        /**
+         * Clears the passes and resources of the previous frame. The GPU must be done with the frame that last used this slot, see CommandRecorder::beginFrame().
+         */
+        void beginFrame(uint32_t frameIndex);
+
+        [[nodiscard]] RGImage  importImage(std::string name, const RGImageImport &image);
+        [[nodiscard]] RGBuffer importBuffer(std::string name, const RGBufferImport &buffer);
+
+        /**
+         * Imports an image of a render target, which is in (and is left in) vk::ImageLayout::eColorAttachmentOptimal as FrameContext requires.
+         */
+        [[nodiscard]] RGImage importTarget(std::string name, const IRenderTarget &target, uint32_t imageIndex);
+
+        void addPass(std::string name, const std::function<void(RGPassBuilder &)> &setup, RGExecuteFn execute);
+
+        /**
+         * Culls passes, creates or reuses the transient resources and computes the barriers. Called by execute() if needed.
+         *
+         * @throws std::runtime_error if a pass uses a resource of another frame or one image in two layouts.
+         */
+        void compile();
+
+        /**
+         * Records the passes that survived culling, with their barriers, into cmd.
+         */
+        void execute(vk::CommandBuffer cmd);
+
+        [[nodiscard]] bool isCulled(std::string_view pass) const;
+
+        /**
+         * Times every pass on the GPU from now on. The profiler's beginFrame() is up to the caller. Null turns it off again.
+         */
+        inline void setGpuProfiler(GpuProfiler *profiler) noexcept { m_GpuProfiler = profiler; }
+
+        /**
+         * Of the last compiled frame.
+         */
+        [[nodiscard]] inline const RenderGraphStats &getStats() const noexcept { return m_Stats; }
+
+      private:
+        friend class RGPassBuilder;
+        friend class RGResources;
+
+        struct Use {
+            uint32_t                resource;
+            vk::PipelineStageFlags2 stages;
+            vk::AccessFlags2        access;
+            vk::ImageLayout         layout;
+            bool                    write;
+        };
+
+        struct Pass {
+            std::string      name;
+            RGExecuteFn      execute;
+            std::vector<Use> images;
+            std::vector<Use> buffers;
+            bool             sideEffects = false;
+            bool             culled      = false;
+            const char      *profileName = nullptr;
+
+            std::vector<vk::ImageMemoryBarrier2>  imageBarriers;
+            std::vector<vk::BufferMemoryBarrier2> bufferBarriers;
+        };
+
+        /**
+         * Where a resource stands between passes: the layout, the last write, and the reads since then which are already synchronized with it.
+         */
+        struct SyncState {
+            bool                    touched = false;
+            vk::ImageLayout         layout  = vk::ImageLayout::eUndefined;
+            vk::PipelineStageFlags2 writeStages;
+            vk::AccessFlags2        writeAccess;
+            vk::PipelineStageFlags2 readStages;
+            vk::AccessFlags2        readAccess;
+        };
+
+        struct Image {
+            std::string          name;
+            RGImageDesc          desc;
+            bool                 imported = false;
+            RGImageImport        import;
+            vk::ImageUsageFlags  usage;
+            vk::ImageAspectFlags aspect;
+
+            uint32_t      firstPass = UINT32_MAX;
+            uint32_t      lastPass  = 0;
+            vk::Image     image;
+            vk::ImageView view;
+            SyncState     state;
+
+            // transients placed in the same memory earlier in the frame
+            std::vector<uint32_t> aliases;
+        };
+
+        struct Buffer {
+            std::string          name;
+            RGBufferDesc         desc;
+            bool                 imported = false;
+            RGBufferImport       import;
+            vk::BufferUsageFlags usage;
+
+            uint32_t   firstPass = UINT32_MAX;
+            uint32_t   lastPass  = 0;
+            vk::Buffer buffer;
+            SyncState  state;
+
+            std::vector<uint32_t> aliases;
+        };
+
+        /**
+         * The transient resources of one frame in flight.
+         */
+        struct Slot {
+            utils::Hash128                     key;
+            std::vector<vk::Image>             images;
+            std::vector<vk::ImageView>         views;
+            std::vector<vk::Buffer>            buffers;
+            std::vector<Allocation>            memory;
+            std::vector<std::vector<uint32_t>> imageAliases;
+            std::vector<std::vector<uint32_t>> bufferAliases;
+            vk::DeviceSize                     transientBytes = 0;
+            vk::DeviceSize                     allocatedBytes = 0;
+        };
+
+        std::shared_ptr<GContext> m_GC;
+        std::vector<Slot>         m_Slots;
+        uint32_t                  m_FrameIndex = 0;
+
+        std::vector<Pass>   m_Passes;
+        std::vector<Image>  m_Images;
+        std::vector<Buffer> m_Buffers;
+        bool                m_Compiled = false;
+
+        std::vector<vk::ImageMemoryBarrier2> m_FinalBarriers;
+        RenderGraphStats                     m_Stats;
+        GpuProfiler                         *m_GpuProfiler = nullptr;
+
+        void cull();
+        void computeLifetimes();
+        void realize();
+        void buildBarriers();
+
+        [[nodiscard]] utils::Hash128 getPlanKey() const;
+        void                         createTransients(Slot &slot);
+        void                         destroySlot(Slot &slot);
+
+        void syncImage(Image &image, const Use &use, std::vector<vk::ImageMemoryBarrier2> &barriers);
+        void syncBuffer(Buffer &buffer, const Use &use, std::vector<vk::BufferMemoryBarrier2> &barriers);
+
+        void recordBarriers(vk::CommandBuffer cmd, const std::vector<vk::ImageMemoryBarrier2> &images, const std::vector<vk::BufferMemoryBarrier2> &buffers) const;
+    };
+
+} // namespace neuron::graphics
@@ -0,0 +1,133 @@
+#include "resources.hpp"
+
+#include <stdexcept>
+
+namespace neuron::graphics {
+
+    static vk::ImageViewType viewTypeFor(const vk::ImageCreateInfo &createInfo) {
+        switch (createInfo.imageType) {
+        case vk::ImageType::e1D:
+            return createInfo.arrayLayers > 1 ? vk::ImageViewType::e1DArray : vk::ImageViewType::e1D;
+        case vk::ImageType::e3D:
+            return vk::ImageViewType::e3D;
+        default:
+            if (createInfo.flags & vk::ImageCreateFlagBits::eCubeCompatible)
+                return createInfo.arrayLayers > 6 ? vk::ImageViewType::eCubeArray : vk::ImageViewType::eCube;
+            return createInfo.arrayLayers > 1 ? vk::ImageViewType::e2DArray : vk::ImageViewType::e2D;
+        }
+    }
+
+    ResourceRegistry::ResourceRegistry(const std::shared_ptr<GContext> &gc, const ResourceRegistrySettings &settings) : m_GC(gc), m_Settings(settings) {
+        if (m_Settings.framesInFlight == 0) {
+            throw std::runtime_error("A resource registry needs at least one frame in flight");
+        }
+    }
+
+    ResourceRegistry::~ResourceRegistry() {
+        collectAll();
+
+        const vk::Device &device    = m_GC->getDevice();
+        MemoryAllocator  &allocator = m_GC->getAllocator();
+
+        while (!m_Buffers.empty()) {
+            auto [buffer, allocation, size] = m_Buffers.remove(m_Buffers.getHandle(0));
+            AllocatedBuffer allocated{buffer, allocation};
+            allocator.destroy(allocated);
+        }
+        while (!m_Images.empty()) {
+            auto [image, view, allocation, extent, format] = m_Images.remove(m_Images.getHandle(0));
+            device.destroyImageView(view);
+            AllocatedImage allocated{image, allocation};
+            allocator.destroy(allocated);
+        }
+    }
+
+    BufferHandle ResourceRegistry::createBuffer(const vk::BufferCreateInfo &createInfo, vk::MemoryPropertyFlags required, vk::MemoryPropertyFlags preferred) {
+        AllocatedBuffer buffer = m_GC->getAllocator().createBuffer(createInfo, required, preferred);
+        try {
+            return m_Buffers.create(buffer.buffer, buffer.allocation, createInfo.size);
+        } catch (...) {
+            m_GC->getAllocator().destroy(buffer);
+            throw;
+        }
+    }
+
+    ImageHandle ResourceRegistry::createImage(const vk::ImageCreateInfo &createInfo, vk::MemoryPropertyFlags required, vk::ImageAspectFlags aspect) {
+        MemoryAllocator &allocator = m_GC->getAllocator();
+        AllocatedImage   image     = allocator.createImage(createInfo, required);
+
+        vk::ImageView view;
+        try {
+            view = m_GC->getDevice().createImageView(vk::ImageViewCreateInfo({}, image.image, viewTypeFor(createInfo), createInfo.format, STANDARD_COMPONENT_MAPPING,
+                                                                             vk::ImageSubresourceRange(aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS)));
+            return m_Images.create(image.image, view, image.allocation, createInfo.extent, createInfo.format);
+        } catch (...) {
+            if (view)
+                m_GC->getDevice().destroyImageView(view);
+            allocator.destroy(image);
+            throw;
+        }
+    }
+
+    void ResourceRegistry::destroy(BufferHandle buffer) {
+        auto [vkBuffer, allocation, size] = m_Buffers.remove(buffer);
+        currentBatch().buffers.push_back({vkBuffer, allocation});
+    }
+
+    void ResourceRegistry::destroy(ImageHandle image) {
+        auto [vkImage, view, allocation, extent, format] = m_Images.remove(image);
+
+        RetiredBatch &batch = currentBatch();
+        batch.images.push_back({vkImage, allocation});
+        batch.views.push_back(view);
+    }
+
+    ResourceRegistry::RetiredBatch &ResourceRegistry::currentBatch() {
+        if (m_Retired.empty() || m_Retired.back().frame != m_Frame) {
+            m_Retired.push_back({.frame = m_Frame});
+        }
+        return m_Retired.back();
+    }
+
+    void ResourceRegistry::nextFrame() {
+        m_Frame++;
+
+        // a batch from frame f was last used by frame f, whose slot the target waited on before frame f + framesInFlight
+        while (!m_Retired.empty() && m_Retired.front().frame + m_Settings.framesInFlight <= m_Frame) {
+            destroyBatch(m_Retired.front());
+            m_Retired.pop_front();
+        }
+    }
+
+    void ResourceRegistry::collectAll() {
+        for (auto &batch : m_Retired)
+            destroyBatch(batch);
+        m_Retired.clear();
+    }
+
+    void ResourceRegistry::destroyBatch(RetiredBatch &batch) {
+        const vk::Device &device    = m_GC->getDevice();
+        MemoryAllocator  &allocator = m_GC->getAllocator();
+
+        for (const auto &view : batch.views)
+            device.destroyImageView(view);
+        for (auto &image : batch.images)
+            allocator.destroy(image);
+        for (auto &buffer : batch.buffers)
+            allocator.destroy(buffer);
+
+        m_Destroyed += batch.buffers.size() + batch.images.size();
+    }
+
+    ResourceStats ResourceRegistry::getStats() const {
+        ResourceStats stats{
+            .buffers   = static_cast<uint32_t>(m_Buffers.size()),
+            .images    = static_cast<uint32_t>(m_Images.size()),
+            .destroyed = m_Destroyed,
+        };
+        for (const auto &batch : m_Retired)
+            stats.pendingDestruction += static_cast<uint32_t>(batch.buffers.size() + batch.images.size());
+        return stats;
+    }
+
+} // namespace neuron::graphics
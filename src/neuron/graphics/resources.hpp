@@ -0,0 +1,125 @@
+#pragma once
+
+#include "neuron/graphics/gcontext.hpp"
+#include "neuron/graphics/memory.hpp"
+#include "neuron/utils/handle_pool.hpp"
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace neuron::graphics {
+
+    using BufferHandle = utils::Handle<struct BufferTag>;
+    using ImageHandle  = utils::Handle<struct ImageTag>;
+
+    struct ResourceRegistrySettings {
+        /**
+         * Frames between destroy() and the Vulkan objects really being destroyed. At least as many as the render target keeps in flight.
+         */
+        uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+    };
+
+    struct ResourceStats {
+        uint32_t buffers = 0;
+        uint32_t images  = 0;
+
+        /**
+         * Resources destroyed through their handle whose Vulkan objects still wait for the GPU to be done with them, and resources really destroyed so far.
+         */
+        uint32_t pendingDestruction = 0;
+        uint64_t destroyed          = 0;
+    };
+
+    /**
+     *
+     * Owns buffers and images and hands out 32-bit generational handles to them instead of shared pointers, so passing a resource around costs no atomic reference
+     * counting and looking one up reads a dense array instead of chasing a pointer. See utils::HandlePool; lookups through stale handles throw when handles are validated
+     * (in debug builds).
+     *
+     * destroy() invalidates the handle right away, but only queues the Vulkan objects in a batch for the current frame. nextFrame() destroys the batches of frames the GPU
+     * has finished with, so frames still in flight can keep using a resource destroyed by the CPU.
+     *
+     * Not thread safe, meant for the render thread. Pipelines stay with PipelineManager, which already hands out plain vk::Pipelines it owns.
+     *
+     */
+    class ResourceRegistry final {
+      public:
+        /**
+         * @throws std::runtime_error if framesInFlight is 0.
+         */
+        explicit ResourceRegistry(const std::shared_ptr<GContext> &gc, const ResourceRegistrySettings &settings = {});
+
+        /**
+         * Destroys everything right away, live or not. The GPU must be done with all of it.
+         */
+        ~ResourceRegistry();
+
+        ResourceRegistry(const ResourceRegistry &)            = delete;
+        ResourceRegistry &operator=(const ResourceRegistry &) = delete;
+
+        [[nodiscard]] BufferHandle createBuffer(const vk::BufferCreateInfo &createInfo, vk::MemoryPropertyFlags required, vk::MemoryPropertyFlags preferred = {});
+
+        /**
+         * Creates the image with a view of all its mips and layers.
+         */
+        [[nodiscard]] ImageHandle createImage(const vk::ImageCreateInfo &createInfo, vk::MemoryPropertyFlags required,
+                                              vk::ImageAspectFlags aspect = vk::ImageAspectFlagBits::eColor);
+
+        /**
+         * @throws std::runtime_error if the handle is stale.
+         */
+        void destroy(BufferHandle buffer);
+        void destroy(ImageHandle image);
+
+        [[nodiscard]] inline bool isValid(BufferHandle buffer) const noexcept { return m_Buffers.isValid(buffer); }
+        [[nodiscard]] inline bool isValid(ImageHandle image) const noexcept { return m_Images.isValid(image); }
+
+        [[nodiscard]] inline vk::Buffer        getBuffer(BufferHandle buffer) const { return m_Buffers.get<0>(buffer); }
+        [[nodiscard]] inline const Allocation &getAllocation(BufferHandle buffer) const { return m_Buffers.get<1>(buffer); }
+        [[nodiscard]] inline vk::DeviceSize    getSize(BufferHandle buffer) const { return m_Buffers.get<2>(buffer); }
+
+        [[nodiscard]] inline vk::Image         getImage(ImageHandle image) const { return m_Images.get<0>(image); }
+        [[nodiscard]] inline vk::ImageView     getImageView(ImageHandle image) const { return m_Images.get<1>(image); }
+        [[nodiscard]] inline const Allocation &getAllocation(ImageHandle image) const { return m_Images.get<2>(image); }
+        [[nodiscard]] inline vk::Extent3D      getExtent(ImageHandle image) const { return m_Images.get<3>(image); }
+        [[nodiscard]] inline vk::Format        getFormat(ImageHandle image) const { return m_Images.get<4>(image); }
+
+        /**
+         * Call once per frame, after the render target's beginFrame() waited for the frame that used its slot before. Destroys what was destroyed framesInFlight frames
+         * ago.
+         */
+        void nextFrame();
+
+        /**
+         * Destroys every queued batch now, for when the device is known to be idle.
+         */
+        void collectAll();
+
+        [[nodiscard]] inline uint64_t getFrame() const noexcept { return m_Frame; }
+
+        [[nodiscard]] ResourceStats getStats() const;
+
+      private:
+        struct RetiredBatch {
+            uint64_t                     frame = 0;
+            std::vector<AllocatedBuffer> buffers;
+            std::vector<AllocatedImage>  images;
+            std::vector<vk::ImageView>   views;
+        };
+
+        std::shared_ptr<GContext> m_GC;
+        ResourceRegistrySettings  m_Settings;
+
+        utils::HandlePool<BufferTag, vk::Buffer, Allocation, vk::DeviceSize>                        m_Buffers;
+        utils::HandlePool<ImageTag, vk::Image, vk::ImageView, Allocation, vk::Extent3D, vk::Format> m_Images;
+
+        std::deque<RetiredBatch> m_Retired;
+        uint64_t                 m_Frame     = 0;
+        uint64_t                 m_Destroyed = 0;
+
+        RetiredBatch &currentBatch();
+        void          destroyBatch(RetiredBatch &batch);
+    };
+
+} // namespace neuron::graphics
@@ -0,0 +1,399 @@
+#include "shaders.hpp"
+
+#include "neuron/neuron.hpp"
+#include "neuron/utils/profiler.hpp"
+
+#include <shaderc/shaderc.hpp>
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+namespace neuron::graphics {
+
+    // bump whenever the key or the file layout changes, so old cache entries are ignored
+    constexpr uint32_t SHADER_CACHE_VERSION = 1;
+    constexpr uint32_t SHADER_CACHE_MAGIC   = 0x5650534e; // "NSPV"
+
+    constexpr uint32_t MAX_INCLUDE_DEPTH = 32;
+
+    struct ShaderCacheHeader {
+        uint32_t       magic;
+        uint32_t       version;
+        utils::Hash128 key;
+        uint64_t       wordCount;
+    };
+
+    vk::ShaderStageFlagBits toVkStage(ShaderStage stage) noexcept {
+        switch (stage) {
+        case ShaderStage::Vertex:
+            return vk::ShaderStageFlagBits::eVertex;
+        case ShaderStage::Fragment:
+            return vk::ShaderStageFlagBits::eFragment;
+        case ShaderStage::Compute:
+            return vk::ShaderStageFlagBits::eCompute;
+        case ShaderStage::Geometry:
+            return vk::ShaderStageFlagBits::eGeometry;
+        case ShaderStage::TessellationControl:
+            return vk::ShaderStageFlagBits::eTessellationControl;
+        case ShaderStage::TessellationEvaluation:
+            return vk::ShaderStageFlagBits::eTessellationEvaluation;
+        }
+        return vk::ShaderStageFlagBits::eAll;
+    }
+
+    static shaderc_shader_kind toShadercKind(ShaderStage stage) {
+        switch (stage) {
+        case ShaderStage::Vertex:
+            return shaderc_vertex_shader;
+        case ShaderStage::Fragment:
+            return shaderc_fragment_shader;
+        case ShaderStage::Compute:
+            return shaderc_compute_shader;
+        case ShaderStage::Geometry:
+            return shaderc_geometry_shader;
+        case ShaderStage::TessellationControl:
+            return shaderc_tess_control_shader;
+        case ShaderStage::TessellationEvaluation:
+            return shaderc_tess_evaluation_shader;
+        }
+        return shaderc_glsl_infer_from_source;
+    }
+
+    static std::optional<std::string> readText(const std::filesystem::path &path) {
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream)
+            return std::nullopt;
+
+        std::stringstream contents;
+        contents << stream.rdbuf();
+        return contents.str();
+    }
+
+    /**
+     * Same lookup order for hashing and compiling: "quoted" includes next to the including file first, then the include directories.
+     */
+    static std::optional<std::filesystem::path> resolveInclude(const std::string &requested, bool relative, const std::string &requesting,
+                                                               const std::vector<std::filesystem::path> &includeDirectories) {
+        if (relative && !requesting.empty()) {
+            std::filesystem::path candidate = std::filesystem::path(requesting).parent_path() / requested;
+            if (std::filesystem::is_regular_file(candidate))
+                return candidate.lexically_normal();
+        }
+
+        for (const auto &directory : includeDirectories) {
+            std::filesystem::path candidate = directory / requested;
+            if (std::filesystem::is_regular_file(candidate))
+                return candidate.lexically_normal();
+        }
+
+        return std::nullopt;
+    }
+
+    class ShaderIncluder final : public shaderc::CompileOptions::IncluderInterface {
+      public:
+        explicit ShaderIncluder(const std::vector<std::filesystem::path> &includeDirectories) : m_IncludeDirectories(includeDirectories) {}
+
+        shaderc_include_result *GetInclude(const char *requested, shaderc_include_type type, const char *requesting, size_t) override {
+            auto *include = new Include;
+
+            const auto path = resolveInclude(requested, type == shaderc_include_type_relative, requesting, m_IncludeDirectories);
+            if (auto contents = path ? readText(*path) : std::nullopt) {
+                include->name    = path->string();
+                include->content = std::move(*contents);
+            } else {
+                // an empty name tells shaderc the include failed, the content is the error message
+                include->content = std::string("Cannot find include ") + requested;
+            }
+
+            include->result = {include->name.data(), include->name.size(), include->content.data(), include->content.size(), include};
+            return &include->result;
+        }
+
+        void ReleaseInclude(shaderc_include_result *result) override { delete static_cast<Include *>(result->user_data); }
+
+      private:
+        struct Include {
+            std::string            name;
+            std::string            content;
+            shaderc_include_result result;
+        };
+
+        const std::vector<std::filesystem::path> &m_IncludeDirectories;
+    };
+
+    /**
+     * Hashes every file the source includes, recursively. Includes in disabled preprocessor branches are hashed too, which only ever causes a spurious miss.
+     */
+    static void hashIncludes(utils::Hasher &hasher, const std::string &code, const std::string &name, const std::vector<std::filesystem::path> &includeDirectories,
+                             std::set<std::filesystem::path> &visited, uint32_t depth) {
+        static const std::regex includePattern(R"(^[ \t]*#[ \t]*include[ \t]*([<"])([^>"]+)[>"])", std::regex::multiline);
+
+        if (depth > MAX_INCLUDE_DEPTH)
+            return;
+
+        for (auto it = std::sregex_iterator(code.begin(), code.end(), includePattern); it != std::sregex_iterator(); ++it) {
+            const std::string requested = (*it)[2].str();
+            const auto        path      = resolveInclude(requested, (*it)[1].str() == "\"", name, includeDirectories);
+
+            if (!path) {
+                hasher.update("missing");
+                hasher.update(requested);
+                continue;
+            }
+
+            hasher.update(path->string());
+            if (!visited.insert(*path).second)
+                continue;
+
+            const auto contents = readText(*path);
+            hasher.update(contents.value_or(""));
+            if (contents) {
+                hashIncludes(hasher, *contents, path->string(), includeDirectories, visited, depth + 1);
+            }
+        }
+    }
+
+    ShaderSource ShaderSource::fromFile(const std::filesystem::path &path, std::optional<ShaderStage> stage) {
+        if (!stage) {
+            static const std::unordered_map<std::string, ShaderStage> stages = {
+                {".vert", ShaderStage::Vertex},   {".frag", ShaderStage::Fragment}, {".comp", ShaderStage::Compute},
+                {".geom", ShaderStage::Geometry}, {".tesc", ShaderStage::TessellationControl}, {".tese", ShaderStage::TessellationEvaluation},
+            };
+
+            const auto it = stages.find(path.extension().string());
+            if (it == stages.end())
+                throw std::runtime_error("Cannot determine the shader stage of " + path.string());
+            stage = it->second;
+        }
+
+        auto code = readText(path);
+        if (!code)
+            throw std::runtime_error("Failed to read shader " + path.string());
+
+        return ShaderSource{.name = path.string(), .code = std::move(*code), .stage = *stage};
+    }
+
+    ShaderCompiler::ShaderCompiler(const ShaderCompilerSettings &settings) : m_Settings(settings), m_Tasks(settings.jobs ? *settings.jobs : getJobSystem()) {}
+
+    ShaderCompiler::~ShaderCompiler() {
+        m_Tasks.wait();
+    }
+
+    utils::Hash128 ShaderCompiler::getKey(const ShaderSource &source) const {
+        utils::Hasher hasher;
+        hasher.updateValue(SHADER_CACHE_VERSION);
+
+        uint32_t spirvVersion, spirvRevision;
+        shaderc_get_spv_version(&spirvVersion, &spirvRevision);
+        hasher.updateValue(spirvVersion).updateValue(spirvRevision);
+
+        hasher.updateValue(source.stage).update(source.entryPoint);
+        hasher.updateValue(m_Settings.optimize).updateValue(m_Settings.debugInfo);
+
+        hasher.updateValue(static_cast<uint64_t>(source.defines.size()));
+        for (const auto &[name, value] : source.defines) {
+            hasher.update(name).update(value);
+        }
+
+        hasher.update(source.code);
+
+        std::set<std::filesystem::path> visited;
+        hashIncludes(hasher, source.code, source.name, m_Settings.includeDirectories, visited, 0);
+
+        return hasher.finish();
+    }
+
+    std::shared_future<Spirv> ShaderCompiler::compileAsync(const ShaderSource &source) {
+        const utils::Hash128 key = getKey(source);
+
+        auto                      promise = std::make_shared<std::promise<Spirv>>();
+        std::shared_future<Spirv> result  = promise->get_future().share();
+        {
+            std::lock_guard lock(m_Mutex);
+
+            auto [it, inserted] = m_Results.try_emplace(key, result);
+            if (!inserted) {
+                m_Stats.memoryHits++;
+                return it->second;
+            }
+        }
+
+        m_Tasks.submit([this, promise, source, key] {
+            try {
+                promise->set_value(compileOrLoad(source, key));
+            } catch (...) {
+                {
+                    // so the next request tries again instead of getting the error
+                    std::lock_guard lock(m_Mutex);
+                    m_Stats.failures++;
+                    m_Results.erase(key);
+                }
+                promise->set_exception(std::current_exception());
+            }
+        });
+
+        return result;
+    }
+
+    Spirv ShaderCompiler::compile(const ShaderSource &source) {
+        // helps with queued tasks instead of blocking, so compiling from inside a task can't starve the workers
+        const std::shared_future<Spirv> result = compileAsync(source);
+        m_Tasks.getJobSystem().wait(result);
+        return result.get();
+    }
+
+    std::vector<Spirv> ShaderCompiler::compileAll(std::span<const ShaderSource> sources) {
+        std::vector<std::shared_future<Spirv>> futures;
+        futures.reserve(sources.size());
+        for (const auto &source : sources) {
+            futures.push_back(compileAsync(source));
+        }
+
+        std::vector<Spirv> results;
+        results.reserve(sources.size());
+        for (auto &future : futures) {
+            m_Tasks.getJobSystem().wait(future);
+            results.push_back(future.get());
+        }
+        return results;
+    }
+
+    vk::ShaderModule ShaderCompiler::createModule(const vk::Device &device, const ShaderSource &source) {
+        const Spirv spirv = compile(source);
+        return device.createShaderModule(vk::ShaderModuleCreateInfo({}, spirv));
+    }
+
+    ShaderCacheStats ShaderCompiler::getStats() const {
+        std::lock_guard lock(m_Mutex);
+        return m_Stats;
+    }
+
+    void ShaderCompiler::clearMemoryCache() {
+        std::lock_guard lock(m_Mutex);
+        m_Results.clear();
+    }
+
+    Spirv ShaderCompiler::compileOrLoad(const ShaderSource &source, const utils::Hash128 &key) {
+        auto start = std::chrono::steady_clock::now();
+
+        if (auto cached = readCache(key)) {
+            const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            std::lock_guard lock(m_Mutex);
+            m_Stats.diskHits++;
+            m_Stats.diskReadMs += elapsed;
+            return std::move(*cached);
+        }
+
+        start                = std::chrono::steady_clock::now();
+        Spirv        spirv   = runShaderc(source);
+        const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        spdlog::debug("Compiled shader {} in {:.2f}ms", source.name, elapsed);
+
+        {
+            std::lock_guard lock(m_Mutex);
+            m_Stats.misses++;
+            m_Stats.compileMs += elapsed;
+            if (elapsed > m_Stats.slowestMs) {
+                m_Stats.slowestMs     = elapsed;
+                m_Stats.slowestShader = source.name;
+            }
+        }
+
+        writeCache(key, spirv);
+        return spirv;
+    }
+
+    Spirv ShaderCompiler::runShaderc(const ShaderSource &source) {
+        NEURON_PROFILE_SCOPE("ShaderCompiler::runShaderc");
+        const std::string name = source.name.empty() ? "<inline>" : source.name;
+
+        shaderc::CompileOptions options;
+        options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_3);
+        options.SetOptimizationLevel(m_Settings.optimize ? shaderc_optimization_level_performance : shaderc_optimization_level_zero);
+        if (m_Settings.debugInfo) {
+            options.SetGenerateDebugInfo();
+        }
+        for (const auto &[define, value] : source.defines) {
+            options.AddMacroDefinition(define, value);
+        }
+        options.SetIncluder(std::make_unique<ShaderIncluder>(m_Settings.includeDirectories));
+
+        // shaderc::Compiler is cheap to create, one per compile keeps the workers independent
+        shaderc::Compiler                   compiler;
+        const shaderc::SpvCompilationResult result =
+            compiler.CompileGlslToSpv(source.code, toShadercKind(source.stage), name.c_str(), source.entryPoint.c_str(), options);
+
+        if (result.GetCompilationStatus() != shaderc_compilation_status_success)
+            throw std::runtime_error("Failed to compile " + name + ":\n" + result.GetErrorMessage());
+
+        if (result.GetNumWarnings() > 0) {
+            spdlog::warn("Shader {}: {}", name, result.GetErrorMessage());
+        }
+
+        return {result.cbegin(), result.cend()};
+    }
+
+    std::filesystem::path ShaderCompiler::getCachePath(const utils::Hash128 &key) const { return m_Settings.cacheDirectory / (key.toString() + ".spv"); }
+
+    std::optional<Spirv> ShaderCompiler::readCache(const utils::Hash128 &key) const {
+        if (m_Settings.cacheDirectory.empty())
+            return std::nullopt;
+
+        std::ifstream stream(getCachePath(key), std::ios::binary);
+        if (!stream)
+            return std::nullopt;
+
+        ShaderCacheHeader header{};
+        stream.read(reinterpret_cast<char *>(&header), sizeof(header));
+        if (!stream || header.magic != SHADER_CACHE_MAGIC || header.version != SHADER_CACHE_VERSION || header.key != key || header.wordCount == 0) {
+            spdlog::debug("Ignoring invalid shader cache entry {}", getCachePath(key).string());
+            return std::nullopt;
+        }
+
+        Spirv spirv(header.wordCount);
+        stream.read(reinterpret_cast<char *>(spirv.data()), static_cast<std::streamsize>(spirv.size() * sizeof(uint32_t)));
+        if (!stream) {
+            spdlog::debug("Ignoring truncated shader cache entry {}", getCachePath(key).string());
+            return std::nullopt;
+        }
+
+        return spirv;
+    }
+
+    void ShaderCompiler::writeCache(const utils::Hash128 &key, const Spirv &spirv) const {
+        if (m_Settings.cacheDirectory.empty())
+            return;
+
+        try {
+            std::filesystem::create_directories(m_Settings.cacheDirectory);
+
+            // written next to the entry and renamed over it, so other processes never read half a file
+            const std::filesystem::path path = getCachePath(key);
+            std::filesystem::path       temp = path;
+            temp += std::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+            {
+                std::ofstream stream(temp, std::ios::binary | std::ios::trunc);
+
+                const ShaderCacheHeader header{SHADER_CACHE_MAGIC, SHADER_CACHE_VERSION, key, spirv.size()};
+                stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+                stream.write(reinterpret_cast<const char *>(spirv.data()), static_cast<std::streamsize>(spirv.size() * sizeof(uint32_t)));
+                if (!stream)
+                    throw std::runtime_error("write failed");
+            }
+
+            std::filesystem::rename(temp, path);
+        } catch (const std::exception &e) {
+            spdlog::warn("Failed to write shader cache entry: {}", e.what());
+        }
+    }
+
+} // namespace neuron::graphics
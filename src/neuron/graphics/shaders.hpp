@@ -0,0 +1,144 @@
+#pragma once
+
+#include "neuron/utils/jobs.hpp"
+#include "neuron/utils/utils.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace neuron::graphics {
+
+    enum class ShaderStage {
+        Vertex,
+        Fragment,
+        Compute,
+        Geometry,
+        TessellationControl,
+        TessellationEvaluation,
+    };
+
+    [[nodiscard]] vk::ShaderStageFlagBits toVkStage(ShaderStage stage) noexcept;
+
+    using Spirv = std::vector<uint32_t>;
+
+    struct ShaderSource {
+        /**
+         * The file path for shaders loaded from disk. Relative includes are resolved next to it and errors are reported with it.
+         */
+        std::string name;
+        std::string code;
+        ShaderStage stage;
+        std::string entryPoint = "main";
+
+        std::vector<std::pair<std::string, std::string>> defines;
+
+        /**
+         * Reads a GLSL file. Without an explicit stage it is picked from the extension (.vert, .frag, .comp, .geom, .tesc, .tese).
+         *
+         * @throws std::runtime_error if the file can't be read or the stage can't be determined.
+         */
+        [[nodiscard]] static ShaderSource fromFile(const std::filesystem::path &path, std::optional<ShaderStage> stage = {});
+    };
+
+    struct ShaderCompilerSettings {
+        /**
+         * Compiled SPIR-V is stored here, one file per cache key. Empty disables the disk cache.
+         */
+        std::filesystem::path cacheDirectory;
+
+        std::vector<std::filesystem::path> includeDirectories;
+
+        bool optimize  = true;
+        bool debugInfo = false;
+
+        /**
+         * Where compiles run. Null uses the engine's job system.
+         */
+        utils::JobSystem *jobs = nullptr;
+    };
+
+    struct ShaderCacheStats {
+        uint64_t memoryHits = 0;
+        uint64_t diskHits   = 0;
+        uint64_t misses     = 0;
+        uint64_t failures   = 0;
+
+        /**
+         * Summed over all threads, so with parallel compiles this is more than the time actually waited for.
+         */
+        double      compileMs  = 0.0;
+        double      diskReadMs = 0.0;
+        double      slowestMs  = 0.0;
+        std::string slowestShader;
+    };
+
+    /**
+     *
+     * Compiles GLSL to SPIR-V with shaderc as tasks on the job system. Results are keyed by a hash of the source, everything it includes, the defines, the stage and the compiler
+     * options, kept in memory and (if a cache directory is set) written to disk, so a warm start doesn't run shaderc at all.
+     *
+     * Requests for the same key share one compile. All methods are thread safe.
+     *
+     */
+    class ShaderCompiler final {
+      public:
+        explicit ShaderCompiler(const ShaderCompilerSettings &settings = {});
+        ~ShaderCompiler();
+
+        ShaderCompiler(const ShaderCompiler &)            = delete;
+        ShaderCompiler &operator=(const ShaderCompiler &) = delete;
+
+        /**
+         * The future throws std::runtime_error with the compiler output if the shader doesn't compile.
+         */
+        [[nodiscard]] std::shared_future<Spirv> compileAsync(const ShaderSource &source);
+
+        [[nodiscard]] Spirv compile(const ShaderSource &source);
+
+        /**
+         * Compiles all sources in parallel and returns the results in the same order.
+         */
+        [[nodiscard]] std::vector<Spirv> compileAll(std::span<const ShaderSource> sources);
+
+        /**
+         * Compiles (or fetches) the shader and creates a module from it. The caller owns the module.
+         */
+        [[nodiscard]] vk::ShaderModule createModule(const vk::Device &device, const ShaderSource &source);
+
+        /**
+         * The cache key of a source, computed without compiling it.
+         */
+        [[nodiscard]] utils::Hash128 getKey(const ShaderSource &source) const;
+
+        [[nodiscard]] ShaderCacheStats getStats() const;
+
+        /**
+         * Drops the in-memory results. The disk cache is kept.
+         */
+        void clearMemoryCache();
+
+      private:
+        ShaderCompilerSettings m_Settings;
+
+        mutable std::mutex                                            m_Mutex;
+        std::unordered_map<utils::Hash128, std::shared_future<Spirv>> m_Results;
+        ShaderCacheStats                                              m_Stats;
+
+        utils::TaskGroup m_Tasks;
+
+        [[nodiscard]] Spirv                 compileOrLoad(const ShaderSource &source, const utils::Hash128 &key);
+        [[nodiscard]] Spirv                 runShaderc(const ShaderSource &source);
+        [[nodiscard]] std::optional<Spirv>  readCache(const utils::Hash128 &key) const;
+        void                                writeCache(const utils::Hash128 &key, const Spirv &spirv) const;
+        [[nodiscard]] std::filesystem::path getCachePath(const utils::Hash128 &key) const;
+    };
+
+} // namespace neuron::graphics
@@ -0,0 +1,350 @@
+#include "texture.hpp"
+
+#include "neuron/neuron.hpp"
+#include "neuron/utils/profiler.hpp"
+
+#include <spdlog/spdlog.h>
+#include <stb_image.h>
+
+#include <bit>
+#include <fstream>
+#include <limits>
+#include <thread>
+
+namespace neuron::graphics {
+
+    constexpr uint32_t TEXTURE_MIP_BATCH_SLOTS = 4;
+
+    enum class TextureStatus : uint8_t {
+        Decoding,
+        Uploading,
+        Ready,
+        Failed,
+    };
+
+    struct TextureState {
+        std::shared_ptr<GContext>  gc;
+        std::string                name;
+        std::atomic<TextureStatus> status = TextureStatus::Decoding;
+        std::string                error;
+
+        AllocatedImage image;
+        vk::ImageView  view;
+        vk::Extent2D   extent;
+        uint32_t       mipLevels = 1;
+
+        UploadTicket ticket;
+        uint64_t     completionValue = 0;
+
+        TextureTimings                        timings;
+        std::chrono::steady_clock::time_point requested;
+        std::chrono::steady_clock::time_point uploadQueued;
+
+        TextureState(std::shared_ptr<GContext> gc, std::string name) : gc(std::move(gc)), name(std::move(name)), requested(std::chrono::steady_clock::now()) {}
+
+        ~TextureState() {
+            if (view)
+                gc->getDevice().destroy(view);
+            if (image.image)
+                gc->getAllocator().destroy(image);
+        }
+    };
+
+    static double millisecondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    static std::vector<std::byte> readFile(const std::filesystem::path &path) {
+        std::ifstream stream(path, std::ios::binary | std::ios::ate);
+        if (!stream)
+            throw std::runtime_error("Failed to open " + path.string());
+
+        std::vector<std::byte> contents(static_cast<size_t>(stream.tellg()));
+        stream.seekg(0);
+        stream.read(reinterpret_cast<char *>(contents.data()), static_cast<std::streamsize>(contents.size()));
+        return contents;
+    }
+
+    bool TextureHandle::isReady() const noexcept { return m_State && m_State->status.load(std::memory_order_acquire) == TextureStatus::Ready; }
+
+    bool TextureHandle::hasFailed() const noexcept { return m_State && m_State->status.load(std::memory_order_acquire) == TextureStatus::Failed; }
+
+    const std::string &TextureHandle::getName() const { return m_State->name; }
+
+    const std::string &TextureHandle::getError() const { return m_State->error; }
+
+    vk::Image TextureHandle::getImage() const { return isReady() ? m_State->image.image : vk::Image{}; }
+
+    vk::ImageView TextureHandle::getImageView() const { return isReady() ? m_State->view : vk::ImageView{}; }
+
+    vk::Extent2D TextureHandle::getExtent() const { return isReady() ? m_State->extent : vk::Extent2D{}; }
+
+    uint32_t TextureHandle::getMipLevels() const { return isReady() ? m_State->mipLevels : 0; }
+
+    TextureTimings TextureHandle::getTimings() const { return isReady() ? m_State->timings : TextureTimings{}; }
+
+    TextureLoader::TextureLoader(const std::shared_ptr<GContext> &gc, const TextureLoaderSettings &settings)
+        : m_GC(gc), m_Settings(settings), m_Tasks(settings.jobs ? *settings.jobs : getJobSystem()) {
+        if (!gc->supportsTimelineSemaphores())
+            throw std::runtime_error("TextureLoader requires timeline semaphores");
+
+        const vk::Device &device = gc->getDevice();
+
+        m_Format = settings.srgb ? vk::Format::eR8G8B8A8Srgb : vk::Format::eR8G8B8A8Unorm;
+
+        const vk::FormatFeatureFlags blitFeatures =
+            vk::FormatFeatureFlagBits::eBlitSrc | vk::FormatFeatureFlagBits::eBlitDst | vk::FormatFeatureFlagBits::eSampledImageFilterLinear;
+        m_CanBlit = (gc->getGpu().getFormatProperties(m_Format).optimalTilingFeatures & blitFeatures) == blitFeatures;
+        if (settings.generateMips && !m_CanBlit) {
+            spdlog::warn("{} does not support linear blits, textures will be loaded without mips", vk::to_string(m_Format));
+        }
+
+        vk::SemaphoreTypeCreateInfo timelineType(vk::SemaphoreType::eTimeline, 0);
+        m_Timeline = device.createSemaphore(vk::SemaphoreCreateInfo({}, &timelineType));
+
+        const uint32_t primaryFamily = gc->getQueueFamily(QueueType::Primary).value();
+
+        m_MipBatches.resize(TEXTURE_MIP_BATCH_SLOTS);
+        for (auto &batch : m_MipBatches) {
+            batch.commandPool   = device.createCommandPool(vk::CommandPoolCreateInfo(vk::CommandPoolCreateFlagBits::eTransient, primaryFamily));
+            batch.commandBuffer = device.allocateCommandBuffers(vk::CommandBufferAllocateInfo(batch.commandPool, vk::CommandBufferLevel::ePrimary, 1)).front();
+        }
+    }
+
+    TextureLoader::~TextureLoader() {
+        waitAll();
+        m_Tasks.wait();
+
+        const vk::Device &device = m_GC->getDevice();
+        for (auto &batch : m_MipBatches) {
+            device.destroy(batch.commandPool);
+        }
+        device.destroy(m_Timeline);
+    }
+
+    TextureHandle TextureLoader::load(const std::filesystem::path &path) {
+        auto state = std::make_shared<TextureState>(m_GC, path.string());
+
+        m_Decoding++;
+        m_Tasks.submit([this, state, path] { decodeAndUpload(state, [&path] { return readFile(path); }); });
+        return TextureHandle(state);
+    }
+
+    TextureHandle TextureLoader::loadFromMemory(std::vector<std::byte> encoded, std::string name) {
+        auto state = std::make_shared<TextureState>(m_GC, std::move(name));
+
+        m_Decoding++;
+        m_Tasks.submit([this, state, encoded = std::move(encoded)]() mutable { decodeAndUpload(state, [&encoded] { return std::move(encoded); }); });
+        return TextureHandle(state);
+    }
+
+    void TextureLoader::decodeAndUpload(const std::shared_ptr<TextureState> &state, const std::function<std::vector<std::byte>()> &source) {
+        NEURON_PROFILE_SCOPE("TextureLoader::decodeAndUpload");
+        bool submitNow = false;
+
+        try {
+            const auto decodeStart = std::chrono::steady_clock::now();
+
+            const std::vector<std::byte> encoded = source();
+
+            int width, height, channels;
+            std::unique_ptr<stbi_uc, decltype(&stbi_image_free)> pixels(
+                stbi_load_from_memory(reinterpret_cast<const stbi_uc *>(encoded.data()), static_cast<int>(encoded.size()), &width, &height, &channels, STBI_rgb_alpha),
+                stbi_image_free);
+            if (!pixels)
+                throw std::runtime_error(std::string("Failed to decode: ") + stbi_failure_reason());
+
+            state->timings.decodeMs = millisecondsSince(decodeStart);
+            state->extent           = vk::Extent2D(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+            state->mipLevels        = m_Settings.generateMips && m_CanBlit ? std::bit_width(std::max(state->extent.width, state->extent.height)) : 1;
+
+            state->image = m_GC->getAllocator().createImage(vk::ImageCreateInfo({}, vk::ImageType::e2D, m_Format, vk::Extent3D(state->extent, 1), state->mipLevels, 1,
+                                                                                 vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal,
+                                                                                 vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst |
+                                                                                     vk::ImageUsageFlagBits::eSampled,
+                                                                                 vk::SharingMode::eExclusive, {}, vk::ImageLayout::eUndefined),
+                                                            vk::MemoryPropertyFlagBits::eDeviceLocal);
+            state->view  = m_GC->getDevice().createImageView(vk::ImageViewCreateInfo({}, state->image.image, vk::ImageViewType::e2D, m_Format, STANDARD_COMPONENT_MAPPING,
+                                                                                     vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, state->mipLevels, 0, 1)));
+
+            // level 0 is left as a blit source, recordMips() takes it from there
+            ImageUploadInfo uploadInfo;
+            uploadInfo.image       = state->image.image;
+            uploadInfo.extent      = vk::Extent3D(state->extent, 1);
+            uploadInfo.finalLayout = vk::ImageLayout::eTransferSrcOptimal;
+            uploadInfo.dstStage    = vk::PipelineStageFlagBits::eTransfer;
+            uploadInfo.dstAccess   = vk::AccessFlagBits::eTransferRead;
+
+            state->uploadQueued = std::chrono::steady_clock::now();
+            state->ticket       = m_GC->getUploadService().uploadImage(uploadInfo, std::span(reinterpret_cast<const std::byte *>(pixels.get()), static_cast<size_t>(width) * height * 4));
+
+            state->status = TextureStatus::Uploading;
+
+            // the decrement shares the critical section with the check, so exactly one of the last decodes to finish sees zero
+            std::lock_guard lock(m_Mutex);
+            m_Pending.push_back(state);
+            const bool last = --m_Decoding == 0;
+            submitNow       = m_Pending.size() >= m_Settings.mipBatchSize || last;
+        } catch (const std::exception &e) {
+            state->error = e.what();
+            state->status.store(TextureStatus::Failed, std::memory_order_release);
+            spdlog::error("Failed to load texture {}: {}", state->name, e.what());
+
+            std::lock_guard lock(m_Mutex);
+            const bool      last = --m_Decoding == 0;
+            submitNow            = !m_Pending.empty() && last;
+        }
+
+        if (submitNow) {
+            poll();
+        }
+    }
+
+    void TextureLoader::poll() {
+        std::lock_guard lock(m_Mutex);
+
+        const uint64_t completed = m_GC->getDevice().getSemaphoreCounterValue(m_Timeline);
+        std::erase_if(m_Submitted, [&](const std::shared_ptr<TextureState> &state) {
+            if (state->completionValue > completed)
+                return false;
+
+            state->timings.uploadMs = millisecondsSince(state->uploadQueued);
+            state->timings.totalMs  = millisecondsSince(state->requested);
+            state->status.store(TextureStatus::Ready, std::memory_order_release);
+
+            spdlog::debug("Loaded texture {} ({}x{}, {} mips): decode {:.2f}ms, upload {:.2f}ms, total {:.2f}ms", state->name, state->extent.width, state->extent.height,
+                          state->mipLevels, state->timings.decodeMs, state->timings.uploadMs, state->timings.totalMs);
+            return true;
+        });
+
+        if (!m_Pending.empty()) {
+            submitMips();
+        }
+    }
+
+    void TextureLoader::submitMips() {
+        const vk::Device &device = m_GC->getDevice();
+
+        MipBatch &batch = m_MipBatches[m_NextMipBatch];
+        m_NextMipBatch  = (m_NextMipBatch + 1) % static_cast<uint32_t>(m_MipBatches.size());
+
+        if (batch.value > 0) {
+            (void)device.waitSemaphores(vk::SemaphoreWaitInfo({}, m_Timeline, batch.value), std::numeric_limits<uint64_t>::max());
+        }
+
+        device.resetCommandPool(batch.commandPool);
+        batch.commandBuffer.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+
+        batch.value            = m_NextValue++;
+        uint64_t uploadedValue = 0;
+        for (const auto &state : m_Pending) {
+            recordMips(batch.commandBuffer, *state);
+
+            uploadedValue          = std::max(uploadedValue, state->ticket.value);
+            state->completionValue = batch.value;
+            m_Submitted.push_back(state);
+        }
+        m_Pending.clear();
+
+        batch.commandBuffer.end();
+
+        // the uploads may still sit in the open batch, which would never signal otherwise
+        UploadService &uploads         = m_GC->getUploadService();
+        vk::Semaphore  uploadsTimeline = uploads.getTimeline();
+        (void)uploads.flush();
+
+        vk::PipelineStageFlags          waitStage = vk::PipelineStageFlagBits::eTransfer;
+        vk::TimelineSemaphoreSubmitInfo values(uploadedValue, batch.value);
+        m_GC->submit(m_GC->getPrimaryQueue(), vk::SubmitInfo(uploadsTimeline, waitStage, batch.commandBuffer, m_Timeline, &values));
+    }
+
+    void TextureLoader::recordMips(vk::CommandBuffer cmd, const TextureState &state) const {
+        const vk::Image image = state.image.image;
+
+        if (state.mipLevels > 1) {
+            cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, {}, {},
+                                vk::ImageMemoryBarrier({}, vk::AccessFlagBits::eTransferWrite, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
+                                                       VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image,
+                                                       vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 1, state.mipLevels - 1, 0, 1)));
+        }
+
+        auto width  = static_cast<int32_t>(state.extent.width);
+        auto height = static_cast<int32_t>(state.extent.height);
+        for (uint32_t level = 1; level < state.mipLevels; level++) {
+            const int32_t nextWidth  = std::max(width / 2, 1);
+            const int32_t nextHeight = std::max(height / 2, 1);
+
+            cmd.blitImage(image, vk::ImageLayout::eTransferSrcOptimal, image, vk::ImageLayout::eTransferDstOptimal,
+                          vk::ImageBlit(vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, level - 1, 0, 1), {vk::Offset3D(0, 0, 0), vk::Offset3D(width, height, 1)},
+                                        vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, level, 0, 1),
+                                        {vk::Offset3D(0, 0, 0), vk::Offset3D(nextWidth, nextHeight, 1)}),
+                          vk::Filter::eLinear);
+
+            // becomes the source of the next level
+            cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {}, {}, {},
+                                vk::ImageMemoryBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eTransferRead, vk::ImageLayout::eTransferDstOptimal,
+                                                       vk::ImageLayout::eTransferSrcOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image,
+                                                       vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, level, 1, 0, 1)));
+
+            width  = nextWidth;
+            height = nextHeight;
+        }
+
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands, {}, {}, {},
+                            vk::ImageMemoryBarrier(vk::AccessFlagBits::eTransferWrite | vk::AccessFlagBits::eTransferRead, vk::AccessFlagBits::eShaderRead,
+                                                   vk::ImageLayout::eTransferSrcOptimal, vk::ImageLayout::eShaderReadOnlyOptimal, VK_QUEUE_FAMILY_IGNORED,
+                                                   VK_QUEUE_FAMILY_IGNORED, image,
+                                                   vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, state.mipLevels, 0, 1)));
+    }
+
+    void TextureLoader::wait(const TextureHandle &texture) {
+        const std::shared_ptr<TextureState> &state = texture.m_State;
+        if (!state)
+            return;
+
+        while (true) {
+            poll();
+
+            const TextureStatus status = state->status.load(std::memory_order_acquire);
+            if (status == TextureStatus::Ready || status == TextureStatus::Failed)
+                return;
+
+            uint64_t waitValue;
+            {
+                std::lock_guard lock(m_Mutex);
+                waitValue = state->completionValue;
+            }
+
+            if (waitValue > 0) {
+                (void)m_GC->getDevice().waitSemaphores(vk::SemaphoreWaitInfo({}, m_Timeline, waitValue), std::numeric_limits<uint64_t>::max());
+            } else if (!m_Tasks.getJobSystem().runOne()) {
+                // still decoding; helps with queued tasks if there are any
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+
+    void TextureLoader::waitAll() {
+        while (true) {
+            poll();
+
+            uint64_t waitValue = 0;
+            {
+                std::lock_guard lock(m_Mutex);
+                if (m_Decoding == 0 && m_Pending.empty() && m_Submitted.empty())
+                    return;
+
+                for (const auto &state : m_Submitted)
+                    waitValue = std::max(waitValue, state->completionValue);
+            }
+
+            if (waitValue > 0) {
+                (void)m_GC->getDevice().waitSemaphores(vk::SemaphoreWaitInfo({}, m_Timeline, waitValue), std::numeric_limits<uint64_t>::max());
+            } else if (!m_Tasks.getJobSystem().runOne()) {
+                // still decoding; helps with queued tasks if there are any
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+
+} // namespace neuron::graphics
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "neuron/graphics/gcontext.hpp"
+#include "neuron/utils/jobs.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace neuron::graphics {
+
+    struct TextureTimings {
+        double decodeMs = 0.0;
+
+        /**
+         * From the upload being queued until the loader saw the texture finished on the GPU, mip generation included.
+         */
+        double uploadMs = 0.0;
+        double totalMs  = 0.0;
+    };
+
+    struct TextureState;
+
+    /**
+     * Shared handle to a texture being loaded. The image and view can be used once isReady() returns true, and are destroyed with the last handle (so keep one around for as long
+     * as the GPU may read the texture).
+     */
+    class TextureHandle {
+      public:
+        TextureHandle() = default;
+
+        [[nodiscard]] bool isReady() const noexcept;
+        [[nodiscard]] bool hasFailed() const noexcept;
+
+        [[nodiscard]] const std::string &getName() const;
+        [[nodiscard]] const std::string &getError() const;
+
+        [[nodiscard]] vk::Image      getImage() const;
+        [[nodiscard]] vk::ImageView  getImageView() const;
+        [[nodiscard]] vk::Extent2D   getExtent() const;
+        [[nodiscard]] uint32_t       getMipLevels() const;
+        [[nodiscard]] TextureTimings getTimings() const;
+
+        [[nodiscard]] inline explicit operator bool() const noexcept { return static_cast<bool>(m_State); }
+
+      private:
+        friend class TextureLoader;
+
+        explicit TextureHandle(std::shared_ptr<TextureState> state) : m_State(std::move(state)) {}
+
+        std::shared_ptr<TextureState> m_State;
+    };
+
+    struct TextureLoaderSettings {
+        /**
+         * Where decodes run. Null uses the engine's job system.
+         */
+        utils::JobSystem *jobs = nullptr;
+
+        bool srgb         = true;
+        bool generateMips = true;
+
+        /**
+         * Mip generation is submitted once this many textures finished uploading, or as soon as there is nothing left to decode.
+         */
+        uint32_t mipBatchSize = 32;
+    };
+
+    /**
+     *
+     * Loads textures asynchronously. Images are decoded with stb_image as tasks on the job system, uploaded through the GContext's UploadService (which batches the copies of many
+     * textures together) and get their mip chain generated on the GPU with blits.
+     *
+     * Call poll() once per frame: it submits pending mip generation and publishes textures which finished.
+     *
+     */
+    class TextureLoader final {
+      public:
+        explicit TextureLoader(const std::shared_ptr<GContext> &gc, const TextureLoaderSettings &settings = {});
+        ~TextureLoader();
+
+        TextureLoader(const TextureLoader &)            = delete;
+        TextureLoader &operator=(const TextureLoader &) = delete;
+
+        [[nodiscard]] TextureHandle load(const std::filesystem::path &path);
+        [[nodiscard]] TextureHandle loadFromMemory(std::vector<std::byte> encoded, std::string name);
+
+        void poll();
+
+        /**
+         * Blocks until the texture is ready or failed.
+         */
+        void wait(const TextureHandle &texture);
+        void waitAll();
+
+      private:
+        struct MipBatch {
+            vk::CommandPool   commandPool;
+            vk::CommandBuffer commandBuffer;
+            uint64_t          value = 0;
+        };
+
+        std::shared_ptr<GContext> m_GC;
+        TextureLoaderSettings     m_Settings;
+        vk::Format                m_Format;
+        bool                      m_CanBlit;
+
+        vk::Semaphore         m_Timeline;
+        uint64_t              m_NextValue = 1;
+        std::vector<MipBatch> m_MipBatches;
+        uint32_t              m_NextMipBatch = 0;
+
+        std::mutex                                 m_Mutex;
+        std::deque<std::shared_ptr<TextureState>>  m_Pending;
+        std::vector<std::shared_ptr<TextureState>> m_Submitted;
+        std::atomic<uint32_t>                      m_Decoding = 0;
+
+        utils::TaskGroup m_Tasks;
+
+        void decodeAndUpload(const std::shared_ptr<TextureState> &state, const std::function<std::vector<std::byte>()> &source);
+        void submitMips();
+        void recordMips(vk::CommandBuffer cmd, const TextureState &state) const;
+    };
+
+} // namespace neuron::graphics
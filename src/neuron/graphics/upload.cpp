@@ -0,0 +1,416 @@
+#include "upload.hpp"
+
+#include "neuron/graphics/gcontext.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+
+namespace neuron::graphics {
+
+    constexpr uint32_t UPLOAD_BATCH_SLOTS = 8;
+
+    static vk::DeviceSize alignUp(vk::DeviceSize value, vk::DeviceSize alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    UploadService::UploadService(GContext &gc, const UploadSettings &settings) : m_GC(gc), m_Settings(settings) {
+        const vk::Device &device = gc.getDevice();
+
+        auto transferQueue = gc.getQueue(QueueType::Transfer);
+
+        m_PrimaryFamily  = gc.getQueueFamily(QueueType::Primary).value();
+        m_Dedicated      = transferQueue.has_value();
+        m_TransferQueue  = transferQueue.value_or(gc.getPrimaryQueue());
+        m_TransferFamily = m_Dedicated ? gc.getQueueFamily(QueueType::Transfer).value() : m_PrimaryFamily;
+
+        vk::SemaphoreTypeCreateInfo timelineType(vk::SemaphoreType::eTimeline, 0);
+        m_Timeline = device.createSemaphore(vk::SemaphoreCreateInfo({}, &timelineType));
+        if (m_Dedicated) {
+            m_TransferTimeline = device.createSemaphore(vk::SemaphoreCreateInfo({}, &timelineType));
+            m_ReleaseTimeline  = device.createSemaphore(vk::SemaphoreCreateInfo({}, &timelineType));
+        }
+
+        m_Staging = gc.getAllocator().createBuffer(vk::BufferCreateInfo({}, settings.stagingSize, vk::BufferUsageFlagBits::eTransferSrc, vk::SharingMode::eExclusive),
+                                                   vk::MemoryPropertyFlagBits::eHostVisible, vk::MemoryPropertyFlagBits::eHostCoherent);
+
+        m_Batches.resize(UPLOAD_BATCH_SLOTS);
+        for (auto &batch : m_Batches) {
+            batch.transferPool     = device.createCommandPool(vk::CommandPoolCreateInfo(vk::CommandPoolCreateFlagBits::eTransient, m_TransferFamily));
+            batch.transferCommands = device.allocateCommandBuffers(vk::CommandBufferAllocateInfo(batch.transferPool, vk::CommandBufferLevel::ePrimary, 1)).front();
+
+            if (m_Dedicated) {
+                batch.takeCommands = device.allocateCommandBuffers(vk::CommandBufferAllocateInfo(batch.transferPool, vk::CommandBufferLevel::ePrimary, 1)).front();
+
+                batch.acquirePool     = device.createCommandPool(vk::CommandPoolCreateInfo(vk::CommandPoolCreateFlagBits::eTransient, m_PrimaryFamily));
+                const auto primary    = device.allocateCommandBuffers(vk::CommandBufferAllocateInfo(batch.acquirePool, vk::CommandBufferLevel::ePrimary, 2));
+                batch.acquireCommands = primary[0];
+                batch.releaseCommands = primary[1];
+            }
+        }
+    }
+
+    UploadService::~UploadService() {
+        wait(flush());
+
+        const vk::Device &device = m_GC.getDevice();
+        for (auto &batch : m_Batches) {
+            for (auto &buffer : batch.oversized)
+                m_GC.getAllocator().destroy(buffer);
+
+            device.destroy(batch.transferPool);
+            device.destroy(batch.acquirePool);
+        }
+
+        m_GC.getAllocator().destroy(m_Staging);
+        device.destroy(m_Timeline);
+        device.destroy(m_TransferTimeline);
+        device.destroy(m_ReleaseTimeline);
+    }
+
+    UploadService::Batch &UploadService::openBatch() {
+        Batch &batch = m_Batches[m_Current];
+        if (batch.recording)
+            return batch;
+
+        // every slot is in flight, so this one is the oldest
+        while (batch.submitted) {
+            retireCompleted(true);
+        }
+
+        const vk::Device &device = m_GC.getDevice();
+        device.resetCommandPool(batch.transferPool);
+        batch.transferCommands.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+
+        if (m_Dedicated) {
+            device.resetCommandPool(batch.acquirePool);
+            batch.acquireCommands.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+        }
+
+        batch.buffers.clear();
+        batch.images.clear();
+        batch.ticket       = m_NextTicket++;
+        batch.stagingBytes = 0;
+        batch.stagingEnd   = m_Head;
+        batch.bytes        = 0;
+        batch.recording    = true;
+        return batch;
+    }
+
+    void UploadService::submitBatch() {
+        Batch &batch = m_Batches[m_Current];
+        if (!batch.recording)
+            return;
+
+        vk::PipelineStageFlags waitStage = vk::PipelineStageFlagBits::eAllCommands;
+
+        if (m_Dedicated) {
+            recordOwnershipTransfers(batch);
+            batch.transferCommands.end();
+            batch.acquireCommands.end();
+
+            vk::TimelineSemaphoreSubmitInfo transferValues({}, batch.ticket);
+            if (batch.buffers.empty()) {
+                m_GC.submit(m_TransferQueue, vk::SubmitInfo({}, {}, batch.transferCommands, m_TransferTimeline, &transferValues));
+            } else {
+                // the primary family may own the buffers already, and gives them up before the transfer family writes to them
+                vk::TimelineSemaphoreSubmitInfo releaseValues({}, batch.ticket);
+                m_GC.submit(m_GC.getPrimaryQueue(), vk::SubmitInfo({}, {}, batch.releaseCommands, m_ReleaseTimeline, &releaseValues));
+
+                const std::array<vk::CommandBuffer, 2> commands = {batch.takeCommands, batch.transferCommands};
+                vk::PipelineStageFlags                 takeStage = vk::PipelineStageFlagBits::eTransfer;
+                transferValues.setWaitSemaphoreValues(batch.ticket);
+                m_GC.submit(m_TransferQueue, vk::SubmitInfo(m_ReleaseTimeline, takeStage, commands, m_TransferTimeline, &transferValues));
+            }
+
+            // the acquire half of the ownership transfer, after which the resources are usable on the primary queue
+            vk::TimelineSemaphoreSubmitInfo acquireValues(batch.ticket, batch.ticket);
+            m_GC.submit(m_GC.getPrimaryQueue(), vk::SubmitInfo(m_TransferTimeline, waitStage, batch.acquireCommands, m_Timeline, &acquireValues));
+        } else {
+            std::vector<vk::ImageMemoryBarrier> images;
+            for (const ImageTarget &target : batch.images)
+                images.emplace_back(vk::AccessFlagBits::eTransferWrite, target.dstAccess, vk::ImageLayout::eTransferDstOptimal, target.finalLayout, VK_QUEUE_FAMILY_IGNORED,
+                                    VK_QUEUE_FAMILY_IGNORED, target.image, target.range);
+
+            batch.transferCommands.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands, {},
+                                                   vk::MemoryBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite),
+                                                   {}, images);
+            batch.transferCommands.end();
+
+            vk::TimelineSemaphoreSubmitInfo values({}, batch.ticket);
+            m_GC.submit(m_TransferQueue, vk::SubmitInfo({}, {}, batch.transferCommands, m_Timeline, &values));
+        }
+
+        batch.recording = false;
+        batch.submitted = true;
+        m_InFlight.push_back(m_Current);
+        m_LastSubmitted = batch.ticket;
+        m_Current       = (m_Current + 1) % static_cast<uint32_t>(m_Batches.size());
+        m_Stats.batchesSubmitted++;
+    }
+
+    void UploadService::recordOwnershipTransfers(Batch &batch) {
+        using Access = vk::AccessFlagBits;
+        using Stage  = vk::PipelineStageFlagBits;
+
+        // ownership of an exclusive buffer belongs to all of it, so whole buffers move even when only parts of them were written
+        std::vector<vk::BufferMemoryBarrier> released, taken, handedBack, acquired;
+        for (const vk::Buffer buffer : batch.buffers) {
+            released.emplace_back(Access::eMemoryWrite, vk::AccessFlags{}, m_PrimaryFamily, m_TransferFamily, buffer, 0, VK_WHOLE_SIZE);
+            taken.emplace_back(vk::AccessFlags{}, Access::eTransferWrite, m_PrimaryFamily, m_TransferFamily, buffer, 0, VK_WHOLE_SIZE);
+            handedBack.emplace_back(Access::eTransferWrite, vk::AccessFlags{}, m_TransferFamily, m_PrimaryFamily, buffer, 0, VK_WHOLE_SIZE);
+            acquired.emplace_back(vk::AccessFlags{}, Access::eMemoryRead | Access::eMemoryWrite, m_TransferFamily, m_PrimaryFamily, buffer, 0, VK_WHOLE_SIZE);
+        }
+
+        // images start from undefined, which discards their contents, so they don't need to be released by the primary family first
+        std::vector<vk::ImageMemoryBarrier> imagesHandedBack, imagesAcquired;
+        for (const ImageTarget &target : batch.images) {
+            imagesHandedBack.emplace_back(Access::eTransferWrite, vk::AccessFlags{}, vk::ImageLayout::eTransferDstOptimal, target.finalLayout, m_TransferFamily,
+                                          m_PrimaryFamily, target.image, target.range);
+            imagesAcquired.emplace_back(vk::AccessFlags{}, target.dstAccess, vk::ImageLayout::eTransferDstOptimal, target.finalLayout, m_TransferFamily, m_PrimaryFamily,
+                                        target.image, target.range);
+        }
+
+        if (!batch.buffers.empty()) {
+            batch.releaseCommands.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+            batch.releaseCommands.pipelineBarrier(Stage::eAllCommands, Stage::eBottomOfPipe, {}, {}, released, {});
+            batch.releaseCommands.end();
+
+            batch.takeCommands.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+            batch.takeCommands.pipelineBarrier(Stage::eTopOfPipe, Stage::eTransfer, {}, {}, taken, {});
+            batch.takeCommands.end();
+        }
+
+        // after every copy of the batch
+        if (!handedBack.empty() || !imagesHandedBack.empty()) {
+            batch.transferCommands.pipelineBarrier(Stage::eTransfer, Stage::eBottomOfPipe, {}, {}, handedBack, imagesHandedBack);
+            batch.acquireCommands.pipelineBarrier(Stage::eTopOfPipe, Stage::eAllCommands, {}, {}, acquired, imagesAcquired);
+        }
+    }
+
+    void UploadService::retireCompleted(bool waitForOldest) {
+        const vk::Device &device    = m_GC.getDevice();
+        uint64_t          completed = device.getSemaphoreCounterValue(m_Timeline);
+
+        while (!m_InFlight.empty()) {
+            Batch &batch = m_Batches[m_InFlight.front()];
+
+            if (batch.ticket > completed) {
+                if (!waitForOldest)
+                    break;
+
+                (void)device.waitSemaphores(vk::SemaphoreWaitInfo({}, m_Timeline, batch.ticket), std::numeric_limits<uint64_t>::max());
+                completed     = batch.ticket;
+                waitForOldest = false;
+            }
+
+            // batches that only used oversized buffers never touched the ring
+            if (batch.stagingBytes > 0) {
+                m_Tail = batch.stagingEnd;
+                m_Used -= batch.stagingBytes;
+            }
+
+            for (auto &buffer : batch.oversized)
+                m_GC.getAllocator().destroy(buffer);
+            batch.oversized.clear();
+
+            batch.submitted = false;
+            m_InFlight.pop_front();
+        }
+    }
+
+    UploadService::StagingRange UploadService::stage(std::span<const std::byte> data, vk::DeviceSize alignment) {
+        const vk::DeviceSize size     = data.size();
+        const vk::DeviceSize capacity = m_Settings.stagingSize;
+
+        if (size > capacity / 2) {
+            Batch &batch = openBatch();
+
+            AllocatedBuffer buffer = m_GC.getAllocator().createBuffer(vk::BufferCreateInfo({}, size, vk::BufferUsageFlagBits::eTransferSrc, vk::SharingMode::eExclusive),
+                                                                      vk::MemoryPropertyFlagBits::eHostVisible, vk::MemoryPropertyFlagBits::eHostCoherent);
+            std::memcpy(buffer.allocation.mapped, data.data(), size);
+            m_GC.getAllocator().flush(buffer.allocation);
+
+            batch.oversized.push_back(buffer);
+            return {buffer.buffer, 0};
+        }
+
+        while (true) {
+            Batch &batch = openBatch();
+
+            retireCompleted(false);
+            if (m_Used == 0) {
+                m_Head = 0;
+                m_Tail = 0;
+            }
+
+            vk::DeviceSize offset   = alignUp(m_Head, alignment);
+            vk::DeviceSize consumed = 0;
+            bool           fits     = false;
+
+            // free space is [head, capacity) + [0, tail) when head is ahead of tail, and [head, tail) once it wrapped around
+            if (m_Head > m_Tail || m_Used == 0) {
+                if (offset + size <= capacity) {
+                    consumed = offset + size - m_Head;
+                    fits     = true;
+                } else if (size <= m_Tail) {
+                    offset   = 0;
+                    consumed = capacity - m_Head + size;
+                    fits     = true;
+                }
+            } else if (m_Head < m_Tail && offset + size <= m_Tail) {
+                consumed = offset + size - m_Head;
+                fits     = true;
+            }
+
+            if (fits) {
+                std::memcpy(static_cast<std::byte *>(m_Staging.allocation.mapped) + offset, data.data(), size);
+
+                Allocation range = m_Staging.allocation;
+                range.offset += offset;
+                range.size = size;
+                m_GC.getAllocator().flush(range);
+
+                m_Head = offset + size;
+                m_Used += consumed;
+                batch.stagingBytes += consumed;
+                batch.stagingEnd = m_Head;
+                return {m_Staging.buffer, offset};
+            }
+
+            // the open batch holds part of the ring, which can only come back once it is submitted
+            m_Stats.stagingStalls++;
+            if (batch.stagingBytes > 0) {
+                submitBatch();
+            }
+            retireCompleted(true);
+        }
+    }
+
+    UploadTicket UploadService::uploadBuffer(vk::Buffer dst, vk::DeviceSize dstOffset, std::span<const std::byte> data) {
+        std::lock_guard lock(m_Mutex);
+
+        if (data.empty())
+            return {m_LastSubmitted};
+
+        return recordBufferCopy(stage(data, 16), dst, dstOffset, data.size());
+    }
+
+    UploadTicket UploadService::uploadImage(const ImageUploadInfo &info, std::span<const std::byte> data) {
+        std::lock_guard lock(m_Mutex);
+
+        if (data.empty())
+            return {m_LastSubmitted};
+
+        return recordImageCopy(stage(data, 16), info, data.size());
+    }
+
+    UploadTicket UploadService::copyBuffer(vk::Buffer src, vk::DeviceSize srcOffset, vk::Buffer dst, vk::DeviceSize dstOffset, vk::DeviceSize size) {
+        std::lock_guard lock(m_Mutex);
+
+        if (size == 0)
+            return {m_LastSubmitted};
+
+        (void)openBatch();
+        return recordBufferCopy({src, srcOffset}, dst, dstOffset, size);
+    }
+
+    UploadTicket UploadService::copyBufferToImage(vk::Buffer src, vk::DeviceSize srcOffset, vk::DeviceSize size, const ImageUploadInfo &info) {
+        std::lock_guard lock(m_Mutex);
+
+        if (size == 0)
+            return {m_LastSubmitted};
+
+        (void)openBatch();
+        return recordImageCopy({src, srcOffset}, info, size);
+    }
+
+    UploadTicket UploadService::recordBufferCopy(const StagingRange &range, vk::Buffer dst, vk::DeviceSize dstOffset, vk::DeviceSize size) {
+        Batch &batch = m_Batches[m_Current];
+
+        batch.transferCommands.copyBuffer(range.buffer, dst, vk::BufferCopy(range.offset, dstOffset, size));
+        if (std::ranges::find(batch.buffers, dst) == batch.buffers.end())
+            batch.buffers.push_back(dst);
+
+        return finishCopy(size);
+    }
+
+    UploadTicket UploadService::recordImageCopy(const StagingRange &range, const ImageUploadInfo &info, vk::DeviceSize size) {
+        Batch &batch = m_Batches[m_Current];
+
+        const vk::ImageSubresourceRange subresourceRange(info.subresource.aspectMask, info.subresource.mipLevel, 1, info.subresource.baseArrayLayer,
+                                                         info.subresource.layerCount);
+
+        // only the first copy into a subresource discards it, later ones in the same batch keep what the earlier ones wrote
+        const auto target = std::ranges::find_if(batch.images, [&](const ImageTarget &t) { return t.image == info.image && t.range == subresourceRange; });
+        if (target == batch.images.end()) {
+            batch.transferCommands.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, {}, {},
+                                                   vk::ImageMemoryBarrier({}, vk::AccessFlagBits::eTransferWrite, vk::ImageLayout::eUndefined,
+                                                                          vk::ImageLayout::eTransferDstOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, info.image,
+                                                                          subresourceRange));
+            batch.images.push_back(ImageTarget{info.image, subresourceRange, info.finalLayout, info.dstAccess});
+        } else {
+            batch.transferCommands.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {},
+                                                   vk::MemoryBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eTransferWrite), {}, {});
+            target->finalLayout = info.finalLayout;
+            target->dstAccess   = info.dstAccess;
+        }
+
+        batch.transferCommands.copyBufferToImage(range.buffer, info.image, vk::ImageLayout::eTransferDstOptimal,
+                                                 vk::BufferImageCopy(range.offset, 0, 0, info.subresource, info.offset, info.extent));
+
+        return finishCopy(size);
+    }
+
+    UploadTicket UploadService::finishCopy(vk::DeviceSize size) {
+        Batch &batch = m_Batches[m_Current];
+
+        batch.bytes += size;
+        m_Stats.bytesUploaded += size;
+        m_Stats.copiesRecorded++;
+
+        const UploadTicket ticket{batch.ticket};
+        if (batch.bytes >= m_Settings.batchSize) {
+            submitBatch();
+        }
+
+        return ticket;
+    }
+
+    UploadTicket UploadService::flush() {
+        std::lock_guard lock(m_Mutex);
+
+        if (m_Batches[m_Current].recording && m_Batches[m_Current].bytes > 0) {
+            submitBatch();
+        }
+
+        return {m_LastSubmitted};
+    }
+
+    bool UploadService::isComplete(UploadTicket ticket) const {
+        return m_GC.getDevice().getSemaphoreCounterValue(m_Timeline) >= ticket.value;
+    }
+
+    void UploadService::wait(UploadTicket ticket) {
+        {
+            std::lock_guard lock(m_Mutex);
+            if (m_Batches[m_Current].recording && m_Batches[m_Current].ticket <= ticket.value) {
+                submitBatch();
+            }
+        }
+
+        if (ticket.value > 0) {
+            (void)m_GC.getDevice().waitSemaphores(vk::SemaphoreWaitInfo({}, m_Timeline, ticket.value), std::numeric_limits<uint64_t>::max());
+        }
+
+        std::lock_guard lock(m_Mutex);
+        retireCompleted(false);
+    }
+
+    UploadStats UploadService::getStats() const {
+        std::lock_guard lock(m_Mutex);
+        return m_Stats;
+    }
+
+} // namespace neuron::graphics
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "neuron/graphics/memory.hpp"
+
+#include <deque>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace neuron::graphics {
+    class GContext;
+
+    struct UploadSettings {
+        /**
+         * Size of the persistently mapped staging ring. Uploads bigger than half of it get a temporary staging buffer of their own.
+         */
+        vk::DeviceSize stagingSize = 64ULL * 1024 * 1024;
+
+        /**
+         * A batch is submitted on its own once it holds this many bytes, so big streams don't wait for an explicit flush().
+         */
+        vk::DeviceSize batchSize = 8ULL * 1024 * 1024;
+    };
+
+    /**
+     * Timeline value of UploadService::getTimeline() that is reached once an upload is complete and its resource is owned by the primary queue family.
+     */
+    struct UploadTicket {
+        uint64_t value = 0;
+    };
+
+    /**
+     * Where the uploaded image data ends up. The subresource is transitioned from undefined (discarding its previous contents) to finalLayout and made visible to dstStage.
+     */
+    struct ImageUploadInfo {
+        vk::Image                  image;
+        vk::Extent3D               extent;
+        vk::ImageSubresourceLayers subresource = {vk::ImageAspectFlagBits::eColor, 0, 0, 1};
+        vk::Offset3D               offset      = {0, 0, 0};
+        vk::ImageLayout            finalLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+        vk::PipelineStageFlags     dstStage    = vk::PipelineStageFlagBits::eAllCommands;
+        vk::AccessFlags            dstAccess   = vk::AccessFlagBits::eMemoryRead;
+    };
+
+    struct UploadStats {
+        uint64_t bytesUploaded    = 0;
+        uint64_t copiesRecorded   = 0;
+        uint64_t batchesSubmitted = 0;
+        uint64_t stagingStalls    = 0;
+    };
+
+    /**
+     *
+     * Streams data to device memory through a staging ring, on the dedicated transfer queue when the device has one and on the primary queue otherwise.
+     *
+     * Copies are batched into few submits. With a dedicated queue, resources are released by the transfer family and acquired by the primary family before the ticket is
+     * signaled, so users never deal with ownership. All methods are thread safe. Owned by GContext, requires timeline semaphores.
+     *
+     */
+    class UploadService final {
+      public:
+        UploadService(GContext &gc, const UploadSettings &settings);
+        ~UploadService();
+
+        UploadService(const UploadService &)            = delete;
+        UploadService &operator=(const UploadService &) = delete;
+
+        /**
+         * Copies data into the staging ring right away and records the transfer into the open batch. Only blocks if the ring is full of in-flight batches.
+         *
+         * With a dedicated queue the whole destination buffer goes from the primary family to the transfer family and back, so the bytes outside the written range keep
+         * their contents, and the primary queue must not use any of it between this call and the ticket.
+         */
+        UploadTicket uploadBuffer(vk::Buffer dst, vk::DeviceSize dstOffset, std::span<const std::byte> data);
+        UploadTicket uploadImage(const ImageUploadInfo &info, std::span<const std::byte> data);
+
+        /**
+         * Records a transfer from a buffer the caller already filled, skipping the staging ring (memory imported from the host, for one). src must be usable on the
+         * transfer queue and stay alive until the ticket is reached.
+         */
+        UploadTicket copyBuffer(vk::Buffer src, vk::DeviceSize srcOffset, vk::Buffer dst, vk::DeviceSize dstOffset, vk::DeviceSize size);
+        UploadTicket copyBufferToImage(vk::Buffer src, vk::DeviceSize srcOffset, vk::DeviceSize size, const ImageUploadInfo &info);
+
+        /**
+         * Submits the open batch, if any.
+         *
+         * @return the ticket of the last batch submitted.
+         */
+        UploadTicket flush();
+
+        [[nodiscard]] bool isComplete(UploadTicket ticket) const;
+
+        /**
+         * Blocks until the ticket is reached, submitting its batch first if it is still open.
+         */
+        void wait(UploadTicket ticket);
+
+        /**
+         * Other submits can wait on this (as a timeline semaphore) instead of blocking the CPU on wait().
+         */
+        [[nodiscard]] inline vk::Semaphore getTimeline() const noexcept { return m_Timeline; }
+
+        [[nodiscard]] inline bool usesDedicatedQueue() const noexcept { return m_Dedicated; }
+
+        [[nodiscard]] UploadStats getStats() const;
+
+      private:
+        // an image subresource written by the batch, and the layout it ends in; the batch's closing barrier waits for all stages, so dstStage needs no tracking
+        struct ImageTarget {
+            vk::Image                 image;
+            vk::ImageSubresourceRange range;
+            vk::ImageLayout           finalLayout;
+            vk::AccessFlags           dstAccess;
+        };
+
+        struct Batch {
+            vk::CommandPool   transferPool;
+            vk::CommandBuffer transferCommands;
+            vk::CommandPool   acquirePool;
+            vk::CommandBuffer acquireCommands;
+
+            // with a dedicated queue: the primary family releasing the batch's buffers, and the transfer family taking them, before the copies
+            vk::CommandBuffer releaseCommands;
+            vk::CommandBuffer takeCommands;
+
+            // every resource gets one ownership transfer per batch, however many copies went into it
+            std::vector<vk::Buffer>  buffers;
+            std::vector<ImageTarget> images;
+
+            uint64_t       ticket       = 0;
+            vk::DeviceSize stagingEnd   = 0;
+            vk::DeviceSize stagingBytes = 0;
+            vk::DeviceSize bytes        = 0;
+            bool           recording    = false;
+            bool           submitted    = false;
+
+            std::vector<AllocatedBuffer> oversized;
+        };
+
+        GContext      &m_GC;
+        UploadSettings m_Settings;
+
+        vk::Queue m_TransferQueue;
+        uint32_t  m_TransferFamily;
+        uint32_t  m_PrimaryFamily;
+        bool      m_Dedicated;
+
+        vk::Semaphore m_Timeline;
+        vk::Semaphore m_TransferTimeline;
+        vk::Semaphore m_ReleaseTimeline;
+
+        AllocatedBuffer m_Staging;
+        vk::DeviceSize  m_Head = 0;
+        vk::DeviceSize  m_Tail = 0;
+        vk::DeviceSize  m_Used = 0;
+
+        std::vector<Batch>   m_Batches;
+        std::deque<uint32_t> m_InFlight;
+        uint32_t             m_Current       = 0;
+        uint64_t             m_NextTicket    = 1;
+        uint64_t             m_LastSubmitted = 0;
+
+        UploadStats m_Stats;
+
+        mutable std::mutex m_Mutex;
+
+        Batch &openBatch();
+        void   submitBatch();
+        void   recordOwnershipTransfers(Batch &batch);
+        void   retireCompleted(bool waitForOldest);
+
+        struct StagingRange {
+            vk::Buffer     buffer;
+            vk::DeviceSize offset;
+        };
+
+        [[nodiscard]] StagingRange stage(std::span<const std::byte> data, vk::DeviceSize alignment);
+
+        // record into the open batch, which the caller opened
+        UploadTicket recordBufferCopy(const StagingRange &range, vk::Buffer dst, vk::DeviceSize dstOffset, vk::DeviceSize size);
+        UploadTicket recordImageCopy(const StagingRange &range, const ImageUploadInfo &info, vk::DeviceSize size);
+        UploadTicket finishCopy(vk::DeviceSize size);
+    };
+
+} // namespace neuron::graphics
@@ -0,0 +1,139 @@
+#include "batch.hpp"
+
+#include "batch_kernels.hpp"
+
+#include <array>
+#include <atomic>
+#include <stdexcept>
+
+#if NEURON_MATH_X86 && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace neuron::math {
+
+    static_assert(NO_PARENT == detail::ROOT_INDEX);
+
+    static SimdLevel detectSimdLevel() noexcept {
+#if NEURON_MATH_X86 && defined(_MSC_VER)
+        std::array<int, 4> info{};
+        __cpuid(info.data(), 1);
+        const bool osSavesAvx = (info[2] & 1 << 27) != 0 && (_xgetbv(0) & 6) == 6;
+        const bool avx        = (info[2] & 1 << 28) != 0;
+        const bool fma        = (info[2] & 1 << 12) != 0;
+        const bool sse2       = (info[3] & 1 << 26) != 0;
+
+        __cpuidex(info.data(), 7, 0);
+        const bool avx2 = (info[1] & 1 << 5) != 0;
+
+        if (osSavesAvx && avx && avx2 && fma)
+            return SimdLevel::AVX2;
+        return sse2 ? SimdLevel::SSE : SimdLevel::Scalar;
+#elif NEURON_MATH_X86
+        // also checks that the OS saves the AVX registers
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            return SimdLevel::AVX2;
+        return __builtin_cpu_supports("sse2") ? SimdLevel::SSE : SimdLevel::Scalar;
+#else
+        return SimdLevel::Scalar;
+#endif
+    }
+
+    static std::atomic<SimdLevel> &selectedLevel() noexcept {
+        static std::atomic<SimdLevel> level = getSupportedSimdLevel();
+        return level;
+    }
+
+    static const detail::BatchKernels &kernels() noexcept {
+        switch (selectedLevel().load(std::memory_order_relaxed)) {
+#if NEURON_MATH_X86
+        case SimdLevel::AVX2:
+            return detail::getAvx2Kernels();
+        case SimdLevel::SSE:
+            return detail::getSseKernels();
+#endif
+        default:
+            return detail::getScalarKernels();
+        }
+    }
+
+    SimdLevel getSupportedSimdLevel() noexcept {
+        static const SimdLevel supported = detectSimdLevel();
+        return supported;
+    }
+
+    SimdLevel getSimdLevel() noexcept {
+        return selectedLevel().load(std::memory_order_relaxed);
+    }
+
+    void setSimdLevel(SimdLevel level) noexcept {
+        selectedLevel().store(std::min(level, getSupportedSimdLevel()), std::memory_order_relaxed);
+    }
+
+    template<typename T> static std::array<const float *, T::STREAMS> streams(const T &soa) {
+        std::array<const float *, T::STREAMS> result;
+        for (size_t i = 0; i < T::STREAMS; i++)
+            result[i] = soa.stream(i);
+        return result;
+    }
+
+    template<typename T> static std::array<float *, T::STREAMS> streams(T &soa) {
+        std::array<float *, T::STREAMS> result;
+        for (size_t i = 0; i < T::STREAMS; i++)
+            result[i] = soa.stream(i);
+        return result;
+    }
+
+    void multiplyTransforms(const TransformSoA &a, const TransformSoA &b, TransformSoA &result) {
+        if (a.size() != b.size())
+            throw std::runtime_error("Transform batches differ in size");
+        if (&result == &a || &result == &b)
+            throw std::runtime_error("The product can't be written over a factor");
+
+        result.resize(a.size());
+        if (a.size() > 0)
+            kernels().multiply(streams(a).data(), streams(b).data(), streams(result).data(), a.getCapacity());
+    }
+
+    void propagateHierarchy(const TransformSoA &local, std::span<const uint32_t> parents, TransformSoA &world) {
+        if (local.size() != parents.size())
+            throw std::runtime_error("Transform batch and parents differ in size");
+        if (&world == &local)
+            throw std::runtime_error("World transforms can't be written over the local ones");
+        for (size_t i = 0; i < parents.size(); i++) {
+            if (parents[i] != NO_PARENT && parents[i] >= i)
+                throw std::runtime_error("A parent doesn't come before its child");
+        }
+
+        world.resize(local.size());
+        if (local.size() > 0)
+            kernels().propagate(streams(local).data(), parents.data(), streams(world).data(), local.size());
+    }
+
+    void transformAabbs(const TransformSoA &transforms, const AabbSoA &bounds, AabbSoA &result) {
+        if (transforms.size() != bounds.size())
+            throw std::runtime_error("Transform and bounds batches differ in size");
+
+        result.resize(bounds.size());
+        if (bounds.size() > 0)
+            kernels().transformAabbs(streams(transforms).data(), streams(bounds).data(), streams(result).data(), bounds.getCapacity());
+    }
+
+    size_t cullSpheres(std::span<const glm::vec4, 6> planes, const SphereSoA &spheres, std::span<uint8_t> visible) {
+        if (visible.size() < spheres.size())
+            throw std::runtime_error("Visibility output is smaller than the batch");
+        if (spheres.size() == 0)
+            return 0;
+        return kernels().cullSpheres(&planes[0].x, streams(spheres).data(), visible.data(), spheres.size());
+    }
+
+    size_t cullAabbs(std::span<const glm::vec4, 6> planes, const AabbSoA &bounds, std::span<uint8_t> visible) {
+        if (visible.size() < bounds.size())
+            throw std::runtime_error("Visibility output is smaller than the batch");
+        if (bounds.size() == 0)
+            return 0;
+        return kernels().cullAabbs(&planes[0].x, streams(bounds).data(), visible.data(), bounds.size());
+    }
+
+} // namespace neuron::math
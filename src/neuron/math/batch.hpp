@@ -0,0 +1,206 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <span>
+#include <utility>
+
+namespace neuron::math {
+
+    enum class SimdLevel {
+        Scalar,
+        SSE,
+        AVX2,
+    };
+
+    /**
+     * The widest instruction set this CPU (and OS) supports, as far as the kernels have an implementation for it. Always Scalar outside of x86.
+     */
+    [[nodiscard]] SimdLevel getSupportedSimdLevel() noexcept;
+
+    /**
+     * The instruction set the batch functions run with, the supported one unless setSimdLevel() lowered it.
+     */
+    [[nodiscard]] SimdLevel getSimdLevel() noexcept;
+
+    /**
+     * Selects the kernels for every thread, for tests and benchmarks. Levels above the supported one are clamped to it.
+     */
+    void setSimdLevel(SimdLevel level) noexcept;
+
+    /**
+     * Containers are padded to a multiple of this many elements, so kernels never need a scalar tail.
+     */
+    constexpr size_t SIMD_WIDTH = 8;
+
+    /**
+     *
+     * Streams floats in a structure of arrays layout: one 32 byte aligned array per component, each as long as the element count rounded up to SIMD_WIDTH. Padding
+     * elements are zero. Resizing keeps the elements that stay.
+     *
+     */
+    template<size_t Streams> class SoA {
+      public:
+        SoA() = default;
+
+        explicit SoA(size_t count) { resize(count); }
+
+        SoA(const SoA &other) { *this = other; }
+
+        SoA &operator=(const SoA &other) {
+            if (this != &other) {
+                resize(0);
+                resize(other.m_Count);
+                if (m_Data)
+                    std::memcpy(m_Data.get(), other.m_Data.get(), Streams * m_Capacity * sizeof(float));
+            }
+            return *this;
+        }
+
+        SoA(SoA &&other) noexcept { *this = std::move(other); }
+
+        SoA &operator=(SoA &&other) noexcept {
+            m_Data     = std::move(other.m_Data);
+            m_Count    = std::exchange(other.m_Count, 0);
+            m_Capacity = std::exchange(other.m_Capacity, 0);
+            return *this;
+        }
+
+        void resize(size_t count) {
+            const size_t capacity = (count + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+            if (capacity != m_Capacity) {
+                Data data(capacity > 0 ? static_cast<float *>(::operator new[](Streams * capacity * sizeof(float), std::align_val_t{32})) : nullptr);
+                if (data)
+                    std::memset(data.get(), 0, Streams * capacity * sizeof(float));
+                for (size_t stream = 0; stream < Streams && m_Data && data; stream++)
+                    std::memcpy(data.get() + stream * capacity, m_Data.get() + stream * m_Capacity, std::min(m_Count, count) * sizeof(float));
+
+                m_Data     = std::move(data);
+                m_Capacity = capacity;
+            } else {
+                for (size_t stream = 0; stream < Streams && count < m_Count; stream++)
+                    std::memset(m_Data.get() + stream * m_Capacity + count, 0, (m_Count - count) * sizeof(float));
+            }
+            m_Count = count;
+        }
+
+        [[nodiscard]] inline size_t size() const noexcept { return m_Count; }
+
+        [[nodiscard]] inline size_t getCapacity() const noexcept { return m_Capacity; }
+
+        [[nodiscard]] inline float *stream(size_t index) noexcept { return m_Data.get() + index * m_Capacity; }
+
+        [[nodiscard]] inline const float *stream(size_t index) const noexcept { return m_Data.get() + index * m_Capacity; }
+
+        static constexpr size_t STREAMS = Streams;
+
+      private:
+        struct Free {
+            void operator()(float *data) const noexcept { ::operator delete[](data, std::align_val_t{32}); }
+        };
+
+        using Data = std::unique_ptr<float[], Free>;
+
+        Data   m_Data;
+        size_t m_Count    = 0;
+        size_t m_Capacity = 0;
+    };
+
+    /**
+     * 4x4 matrices, stream c * 4 + r holding column c, row r (glm's m[c][r]).
+     */
+    class TransformSoA : public SoA<16> {
+      public:
+        using SoA::SoA;
+
+        void set(size_t index, const glm::mat4 &matrix) noexcept {
+            for (int c = 0; c < 4; c++)
+                for (int r = 0; r < 4; r++)
+                    stream(c * 4 + r)[index] = matrix[c][r];
+        }
+
+        [[nodiscard]] glm::mat4 get(size_t index) const noexcept {
+            glm::mat4 matrix;
+            for (int c = 0; c < 4; c++)
+                for (int r = 0; r < 4; r++)
+                    matrix[c][r] = stream(c * 4 + r)[index];
+            return matrix;
+        }
+    };
+
+    /**
+     * Bounding spheres, streams x, y, z and radius.
+     */
+    class SphereSoA : public SoA<4> {
+      public:
+        using SoA::SoA;
+
+        void set(size_t index, const glm::vec4 &sphere) noexcept {
+            for (int i = 0; i < 4; i++)
+                stream(i)[index] = sphere[i];
+        }
+
+        [[nodiscard]] glm::vec4 get(size_t index) const noexcept { return {stream(0)[index], stream(1)[index], stream(2)[index], stream(3)[index]}; }
+    };
+
+    /**
+     * Axis aligned boxes, streams min x, y, z and max x, y, z.
+     */
+    class AabbSoA : public SoA<6> {
+      public:
+        using SoA::SoA;
+
+        void set(size_t index, const glm::vec3 &min, const glm::vec3 &max) noexcept {
+            for (int i = 0; i < 3; i++) {
+                stream(i)[index]     = min[i];
+                stream(i + 3)[index] = max[i];
+            }
+        }
+
+        [[nodiscard]] glm::vec3 getMin(size_t index) const noexcept { return {stream(0)[index], stream(1)[index], stream(2)[index]}; }
+
+        [[nodiscard]] glm::vec3 getMax(size_t index) const noexcept { return {stream(3)[index], stream(4)[index], stream(5)[index]}; }
+    };
+
+    constexpr uint32_t NO_PARENT = ~0U;
+
+    /**
+     * result[i] = a[i] * b[i]. result is resized to match and must not be a or b.
+     *
+     * @throws std::runtime_error if a and b differ in size, or result is one of them.
+     */
+    void multiplyTransforms(const TransformSoA &a, const TransformSoA &b, TransformSoA &result);
+
+    /**
+     * world[i] = world[parents[i]] * local[i], or local[i] for roots (NO_PARENT). Parents must come before their children, as in a depth first or level order. Blocks
+     * of SIMD width gather their parents' matrices; blocks that contain the parent of one of their own elements fall back to scalar code, so level order is fastest.
+     * world is resized to match and must not be local.
+     *
+     * @throws std::runtime_error if the sizes differ, world is local or a parent doesn't come before its child.
+     */
+    void propagateHierarchy(const TransformSoA &local, std::span<const uint32_t> parents, TransformSoA &world);
+
+    /**
+     * The world space boxes of local space boxes under affine transforms, enclosing the transformed corners. result is resized to match and may be bounds.
+     *
+     * @throws std::runtime_error if the sizes differ.
+     */
+    void transformAabbs(const TransformSoA &transforms, const AabbSoA &bounds, AabbSoA &result);
+
+    /**
+     * Tests against six normalized planes pointing inwards (as graphics::extractFrustumPlanes() returns them). visible[i] is set to 1 for spheres or boxes that are at
+     * least partly inside, 0 otherwise.
+     *
+     * @return the number of visible elements.
+     * @throws std::runtime_error if visible is smaller than the container.
+     */
+    size_t cullSpheres(std::span<const glm::vec4, 6> planes, const SphereSoA &spheres, std::span<uint8_t> visible);
+    size_t cullAabbs(std::span<const glm::vec4, 6> planes, const AabbSoA &bounds, std::span<uint8_t> visible);
+
+} // namespace neuron::math
@@ -0,0 +1,45 @@
+// compiled with AVX2 and FMA enabled, only called once getSupportedSimdLevel() found them
+#include "batch_impl.hpp"
+
+#if NEURON_MATH_X86
+
+#include <immintrin.h>
+
+namespace neuron::math::detail {
+    namespace {
+        struct Avx2Vec {
+            using type = __m256;
+            using mask = __m256;
+
+            static constexpr size_t WIDTH = 8;
+
+            static type load(const float *data) { return _mm256_load_ps(data); }
+            static void store(float *data, type value) { _mm256_store_ps(data, value); }
+            static type set(float value) { return _mm256_set1_ps(value); }
+            static type add(type a, type b) { return _mm256_add_ps(a, b); }
+            static type sub(type a, type b) { return _mm256_sub_ps(a, b); }
+            static type mul(type a, type b) { return _mm256_mul_ps(a, b); }
+            static type fma(type a, type b, type c) { return _mm256_fmadd_ps(a, b, c); }
+            static type abs(type value) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), value); }
+            static mask ge(type a, type b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+            static mask both(mask a, mask b) { return _mm256_and_ps(a, b); }
+            static mask all() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+            static uint32_t bits(mask value) { return static_cast<uint32_t>(_mm256_movemask_ps(value)); }
+
+            // roots are masked off and keep the fallback
+            static type gather(const float *base, const uint32_t *indices, float fallback) {
+                const __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(indices));
+                const __m256i roots = _mm256_cmpeq_epi32(index, _mm256_set1_epi32(-1));
+                return _mm256_mask_i32gather_ps(_mm256_set1_ps(fallback), base, index, _mm256_castsi256_ps(_mm256_xor_si256(roots, _mm256_set1_epi32(-1))), 4);
+            }
+        };
+    } // namespace
+
+    const BatchKernels &getAvx2Kernels() noexcept {
+        static constexpr BatchKernels kernels = makeKernels<Avx2Vec>();
+        return kernels;
+    }
+
+} // namespace neuron::math::detail
+
+#endif
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "batch_kernels.hpp"
+
+// The kernel bodies, written once against a vector type V and included by the scalar, SSE and AVX2 units. Everything has internal linkage, so every unit keeps the code
+// compiled for its own instruction set. V provides WIDTH, type and mask, and load, store, set, add, sub, mul, fma (a * b + c), abs, ge, both, all, bits and gather.
+namespace neuron::math::detail {
+    namespace {
+
+        // a * b for one block of matrices, a already loaded
+        template<typename V> void multiplyBlock(const typename V::type *a, const float *const *b, size_t i, float *const *result) {
+            for (int c = 0; c < 4; c++) {
+                const auto b0 = V::load(b[c * 4 + 0] + i);
+                const auto b1 = V::load(b[c * 4 + 1] + i);
+                const auto b2 = V::load(b[c * 4 + 2] + i);
+                const auto b3 = V::load(b[c * 4 + 3] + i);
+                for (int r = 0; r < 4; r++) {
+                    auto sum = V::mul(a[r], b0);
+                    sum      = V::fma(a[4 + r], b1, sum);
+                    sum      = V::fma(a[8 + r], b2, sum);
+                    sum      = V::fma(a[12 + r], b3, sum);
+                    V::store(result[c * 4 + r] + i, sum);
+                }
+            }
+        }
+
+        template<typename V> void multiplyKernel(const float *const *a, const float *const *b, float *const *result, size_t count) {
+            for (size_t i = 0; i < count; i += V::WIDTH) {
+                typename V::type columns[16];
+                for (int k = 0; k < 16; k++)
+                    columns[k] = V::load(a[k] + i);
+                multiplyBlock<V>(columns, b, i, result);
+            }
+        }
+
+        inline void propagateOne(const float *const *local, const uint32_t *parents, float *const *world, size_t i) {
+            const uint32_t parent = parents[i];
+            if (parent == ROOT_INDEX) {
+                for (int k = 0; k < 16; k++)
+                    world[k][i] = local[k][i];
+                return;
+            }
+
+            for (int c = 0; c < 4; c++) {
+                for (int r = 0; r < 4; r++) {
+                    float sum = 0.f;
+                    for (int k = 0; k < 4; k++)
+                        sum += world[k * 4 + r][parent] * local[c * 4 + k][i];
+                    world[c * 4 + r][i] = sum;
+                }
+            }
+        }
+
+        template<typename V> void propagateKernel(const float *const *local, const uint32_t *parents, float *const *world, size_t count) {
+            constexpr float IDENTITY[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+
+            size_t i = 0;
+            for (; i + V::WIDTH <= count; i += V::WIDTH) {
+                // a parent in the same block isn't computed yet
+                bool dependent = false;
+                for (size_t lane = 0; lane < V::WIDTH; lane++)
+                    dependent |= parents[i + lane] != ROOT_INDEX && parents[i + lane] >= i;
+
+                if (dependent) {
+                    for (size_t lane = 0; lane < V::WIDTH; lane++)
+                        propagateOne(local, parents, world, i + lane);
+                    continue;
+                }
+
+                // roots multiply with the identity
+                typename V::type parent[16];
+                for (int k = 0; k < 16; k++)
+                    parent[k] = V::gather(world[k], parents + i, IDENTITY[k]);
+                multiplyBlock<V>(parent, local, i, world);
+            }
+
+            for (; i < count; i++)
+                propagateOne(local, parents, world, i);
+        }
+
+        template<typename V> void transformAabbsKernel(const float *const *transforms, const float *const *bounds, float *const *result, size_t count) {
+            const auto half = V::set(0.5f);
+
+            for (size_t i = 0; i < count; i += V::WIDTH) {
+                typename V::type center[3], extent[3];
+                for (int axis = 0; axis < 3; axis++) {
+                    const auto min = V::load(bounds[axis] + i);
+                    const auto max = V::load(bounds[axis + 3] + i);
+                    center[axis]   = V::mul(V::add(min, max), half);
+                    extent[axis]   = V::mul(V::sub(max, min), half);
+                }
+
+                // the center is transformed as a point, the extent by the absolute linear part
+                for (int r = 0; r < 3; r++) {
+                    auto newCenter = V::load(transforms[12 + r] + i);
+                    auto newExtent = V::set(0.f);
+                    for (int k = 0; k < 3; k++) {
+                        const auto m = V::load(transforms[k * 4 + r] + i);
+                        newCenter    = V::fma(m, center[k], newCenter);
+                        newExtent    = V::fma(V::abs(m), extent[k], newExtent);
+                    }
+                    V::store(result[r] + i, V::sub(newCenter, newExtent));
+                    V::store(result[r + 3] + i, V::add(newCenter, newExtent));
+                }
+            }
+        }
+
+        // writes the lanes of a block that are within count
+        inline size_t storeVisible(uint32_t bits, size_t width, uint8_t *visible, size_t i, size_t count) {
+            size_t found = 0;
+            for (size_t lane = 0; lane < width && i + lane < count; lane++) {
+                const auto inside = static_cast<uint8_t>(bits >> lane & 1);
+                visible[i + lane] = inside;
+                found += inside;
+            }
+            return found;
+        }
+
+        template<typename V> size_t cullSpheresKernel(const float *planes, const float *const *spheres, uint8_t *visible, size_t count) {
+            size_t found = 0;
+            for (size_t i = 0; i < count; i += V::WIDTH) {
+                const auto x      = V::load(spheres[0] + i);
+                const auto y      = V::load(spheres[1] + i);
+                const auto z      = V::load(spheres[2] + i);
+                const auto radius = V::load(spheres[3] + i);
+
+                auto inside = V::all();
+                for (int p = 0; p < 6; p++) {
+                    const float *plane    = planes + p * 4;
+                    auto         distance = V::fma(V::set(plane[0]), x, V::set(plane[3]));
+                    distance              = V::fma(V::set(plane[1]), y, distance);
+                    distance              = V::fma(V::set(plane[2]), z, distance);
+                    inside                = V::both(inside, V::ge(V::add(distance, radius), V::set(0.f)));
+                }
+
+                found += storeVisible(V::bits(inside), V::WIDTH, visible, i, count);
+            }
+            return found;
+        }
+
+        template<typename V> size_t cullAabbsKernel(const float *planes, const float *const *bounds, uint8_t *visible, size_t count) {
+            const auto half = V::set(0.5f);
+
+            size_t found = 0;
+            for (size_t i = 0; i < count; i += V::WIDTH) {
+                typename V::type center[3], extent[3];
+                for (int axis = 0; axis < 3; axis++) {
+                    const auto min = V::load(bounds[axis] + i);
+                    const auto max = V::load(bounds[axis + 3] + i);
+                    center[axis]   = V::mul(V::add(min, max), half);
+                    extent[axis]   = V::mul(V::sub(max, min), half);
+                }
+
+                // the corner furthest along the plane normal decides
+                auto inside = V::all();
+                for (int p = 0; p < 6; p++) {
+                    const float *plane    = planes + p * 4;
+                    auto         distance = V::set(plane[3]);
+                    for (int axis = 0; axis < 3; axis++) {
+                        distance = V::fma(V::set(plane[axis]), center[axis], distance);
+                        distance = V::fma(V::set(plane[axis] < 0.f ? -plane[axis] : plane[axis]), extent[axis], distance);
+                    }
+                    inside = V::both(inside, V::ge(distance, V::set(0.f)));
+                }
+
+                found += storeVisible(V::bits(inside), V::WIDTH, visible, i, count);
+            }
+            return found;
+        }
+
+        template<typename V> constexpr BatchKernels makeKernels() {
+            return {
+                .multiply       = &multiplyKernel<V>,
+                .propagate      = &propagateKernel<V>,
+                .transformAabbs = &transformAabbsKernel<V>,
+                .cullSpheres    = &cullSpheresKernel<V>,
+                .cullAabbs      = &cullAabbsKernel<V>,
+            };
+        }
+
+    } // namespace
+} // namespace neuron::math::detail
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NEURON_MATH_X86 1
+#else
+#define NEURON_MATH_X86 0
+#endif
+
+// Internal to the batch math. Kernels take raw stream pointers and padded counts, so the units compiled for AVX2 include nothing with inline functions the linker could
+// pick over the baseline copies.
+namespace neuron::math::detail {
+
+    constexpr uint32_t ROOT_INDEX = 0xffffffffU;
+
+    struct BatchKernels {
+        void (*multiply)(const float *const *a, const float *const *b, float *const *result, size_t count);
+        void (*propagate)(const float *const *local, const uint32_t *parents, float *const *world, size_t count);
+        void (*transformAabbs)(const float *const *transforms, const float *const *bounds, float *const *result, size_t count);
+
+        // planes are 6 xyzw planes, visible has count entries
+        size_t (*cullSpheres)(const float *planes, const float *const *spheres, uint8_t *visible, size_t count);
+        size_t (*cullAabbs)(const float *planes, const float *const *bounds, uint8_t *visible, size_t count);
+    };
+
+    const BatchKernels &getScalarKernels() noexcept;
+
+#if NEURON_MATH_X86
+    const BatchKernels &getSseKernels() noexcept;
+    const BatchKernels &getAvx2Kernels() noexcept;
+#endif
+
+} // namespace neuron::math::detail
@@ -0,0 +1,33 @@
+#include "batch_impl.hpp"
+
+namespace neuron::math::detail {
+    namespace {
+        struct ScalarVec {
+            using type = float;
+            using mask = bool;
+
+            static constexpr size_t WIDTH = 1;
+
+            static type load(const float *data) { return *data; }
+            static void store(float *data, type value) { *data = value; }
+            static type set(float value) { return value; }
+            static type add(type a, type b) { return a + b; }
+            static type sub(type a, type b) { return a - b; }
+            static type mul(type a, type b) { return a * b; }
+            static type fma(type a, type b, type c) { return a * b + c; }
+            static type abs(type value) { return value < 0.f ? -value : value; }
+            static mask ge(type a, type b) { return a >= b; }
+            static mask both(mask a, mask b) { return a && b; }
+            static mask all() { return true; }
+            static uint32_t bits(mask value) { return value ? 1 : 0; }
+
+            static type gather(const float *base, const uint32_t *indices, float fallback) { return *indices == ROOT_INDEX ? fallback : base[*indices]; }
+        };
+    } // namespace
+
+    const BatchKernels &getScalarKernels() noexcept {
+        static constexpr BatchKernels kernels = makeKernels<ScalarVec>();
+        return kernels;
+    }
+
+} // namespace neuron::math::detail
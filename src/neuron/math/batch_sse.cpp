@@ -0,0 +1,45 @@
+#include "batch_impl.hpp"
+
+#if NEURON_MATH_X86
+
+#include <emmintrin.h>
+
+namespace neuron::math::detail {
+    namespace {
+        struct SseVec {
+            using type = __m128;
+            using mask = __m128;
+
+            static constexpr size_t WIDTH = 4;
+
+            static type load(const float *data) { return _mm_load_ps(data); }
+            static void store(float *data, type value) { _mm_store_ps(data, value); }
+            static type set(float value) { return _mm_set1_ps(value); }
+            static type add(type a, type b) { return _mm_add_ps(a, b); }
+            static type sub(type a, type b) { return _mm_sub_ps(a, b); }
+            static type mul(type a, type b) { return _mm_mul_ps(a, b); }
+            static type fma(type a, type b, type c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+            static type abs(type value) { return _mm_andnot_ps(_mm_set1_ps(-0.f), value); }
+            static mask ge(type a, type b) { return _mm_cmpge_ps(a, b); }
+            static mask both(mask a, mask b) { return _mm_and_ps(a, b); }
+            static mask all() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+            static uint32_t bits(mask value) { return static_cast<uint32_t>(_mm_movemask_ps(value)); }
+
+            // no gather instruction before AVX2
+            static type gather(const float *base, const uint32_t *indices, float fallback) {
+                alignas(16) float values[4];
+                for (int lane = 0; lane < 4; lane++)
+                    values[lane] = indices[lane] == ROOT_INDEX ? fallback : base[indices[lane]];
+                return _mm_load_ps(values);
+            }
+        };
+    } // namespace
+
+    const BatchKernels &getSseKernels() noexcept {
+        static constexpr BatchKernels kernels = makeKernels<SseVec>();
+        return kernels;
+    }
+
+} // namespace neuron::math::detail
+
+#endif
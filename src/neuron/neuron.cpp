@@ -2,70 +2,139 @@
 
 #include <GLFW/glfw3.h>
 
+#include "neuron/os/window.hpp"
+#include "neuron/utils/profiler.hpp"
+
+#include <spdlog/async.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+
 VULKAN_HPP_DEFAULT_DISPATCH_LOADER_DYNAMIC_STORAGE;
 
 namespace neuron {
     static Context *context;
 
+    static void logValidationSummary(spdlog::logger &logger, const utils::ValidationSummary &summary) {
+        logger.warn("Suppressed {} repeated messages and {} denied ones since the last summary, logged {}", summary.suppressed, summary.denied, summary.logged);
+
+        // the worst offenders are enough to find the culprit
+        for (size_t i = 0; i < std::min<size_t>(summary.ids.size(), 8); i++) {
+            const utils::ValidationIdCount &count = summary.ids[i];
+            logger.warn("  {} ({:#010x}): {} suppressed", count.name, static_cast<uint32_t>(count.id), count.suppressed);
+        }
+    }
+
     static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType,
                                                         const VkDebugUtilsMessengerCallbackDataEXT *pCallbackData, void *pUserData) {
+        auto           &ctx    = *static_cast<Context *>(pUserData);
+        spdlog::logger &logger = *ctx.getValidationLogger();
 
-        // TODO: debug output
-
+        spdlog::level::level_enum level;
         switch (messageSeverity) {
         case VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT:
-            spdlog::debug("[validation] {}", pCallbackData->pMessage);
+            level = spdlog::level::debug;
             break;
         case VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT:
-            spdlog::info("[validation] {}", pCallbackData->pMessage);
+            level = spdlog::level::info;
             break;
         case VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT:
-            spdlog::warn("[validation] {}", pCallbackData->pMessage);
+            level = spdlog::level::warn;
             break;
         case VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT:
         default:
-            spdlog::error("[validation] {}", pCallbackData->pMessage);
+            level = spdlog::level::err;
             break;
         }
 
+        if (!logger.should_log(level))
+            return VK_FALSE;
+
+        const uint64_t now = utils::Profiler::now();
+        switch (ctx.getValidationFilter().filter(pCallbackData->messageIdNumber, pCallbackData->pMessageIdName, now)) {
+        case utils::ValidationVerdict::Log:
+            logger.log(level, "{}", pCallbackData->pMessage);
+            break;
+        case utils::ValidationVerdict::LogLast:
+            logger.log(level, "{} (repeats suppressed for now)", pCallbackData->pMessage);
+            break;
+        case utils::ValidationVerdict::Drop:
+            break;
+        }
+
+        utils::ValidationSummary summary;
+        if (ctx.getValidationFilter().takeSummary(now, summary))
+            logValidationSummary(logger, summary);
+
         return VK_FALSE;
     }
 
     void init(const Settings &settings) {
-        glfwInit();
-        VULKAN_HPP_DEFAULT_DISPATCHER.init();
-
         context = new Context(settings);
     }
 
     void cleanup() {
         delete context;
-        glfwTerminate();
         context = nullptr;
+        os::terminateWindowSystem();
     }
 
-    Context::Context(const Settings &settings) {
-        if (settings.debugMode)
-            spdlog::set_level(spdlog::level::debug);
+    utils::JobSystem &getJobSystem() {
+        if (context)
+            return context->getJobSystem();
+
+        static utils::JobSystem fallback;
+        return fallback;
+    }
+
+    Context::Context(const Settings &settings) : m_Settings(settings), m_ValidationFilter(settings.logging.validation) {
+        m_Startup.measure("loggers", [this] { createLoggers(); });
+
+        try {
+            m_Startup.measure("job system", [&] { m_Jobs = std::make_unique<utils::JobSystem>(settings.jobs); });
+
+            // GLFW has to be initialized on the main thread, opening the loader doesn't
+            const utils::Task loader = m_Jobs->submit([this] { m_Startup.measure("vulkan loader", [] { VULKAN_HPP_DEFAULT_DISPATCHER.init(); }); });
+            if (!settings.offscreenRenderingOnly)
+                m_Startup.measure("window system", [] { os::initWindowSystem(); });
+            m_Jobs->wait(loader);
+
+            vk::DebugUtilsMessengerCreateInfoEXT debuggerCreateInfo{};
+            m_Startup.measure("instance", [&] { createInstance(debuggerCreateInfo); });
+
+            if (settings.debugMode)
+                m_Startup.measure("debug messenger", [&] { m_DebugMessenger = m_Instance.createDebugUtilsMessengerEXT(debuggerCreateInfo); });
+        } catch (...) {
+            // the destructor doesn't run, and a failed init() may be retried with other settings
+            if (m_Instance)
+                m_Instance.destroy();
+            m_Jobs.reset();
+            restoreLoggers();
+            throw;
+        }
 
+        m_Logger->info("Started in {}", m_Startup.format());
+    }
+
+    void Context::createInstance(vk::DebugUtilsMessengerCreateInfoEXT &debuggerCreateInfo) {
         vk::ApplicationInfo appInfo{};
         appInfo.setApiVersion(vk::ApiVersion13);
         appInfo.setEngineVersion(neuron::VERSION.toUintVk()).setPEngineName(neuron::NAME.data());
-        appInfo.setApplicationVersion(settings.version.toUintVk()).setPApplicationName(settings.name.c_str());
+        appInfo.setApplicationVersion(m_Settings.version.toUintVk()).setPApplicationName(m_Settings.name.c_str());
 
         std::vector<const char *> instanceExtensions;
         std::vector<const char *> instanceLayers;
 
-        vk::DebugUtilsMessengerCreateInfoEXT debuggerCreateInfo{};
-        vk::InstanceCreateInfo               instanceCreateInfo{};
+        vk::InstanceCreateInfo instanceCreateInfo{};
 
-        if (settings.debugMode) {
+        if (m_Settings.debugMode) {
             instanceExtensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
             instanceLayers.push_back("VK_LAYER_KHRONOS_validation");
             debuggerCreateInfo.messageSeverity = vk::DebugUtilsMessageSeverityFlagBitsEXT::eError | vk::DebugUtilsMessageSeverityFlagBitsEXT::eInfo |
-                vk::DebugUtilsMessageSeverityFlagBitsEXT::eVerbose | vk::DebugUtilsMessageSeverityFlagBitsEXT::eWarning;
+                vk::DebugUtilsMessageSeverityFlagBitsEXT::eWarning;
+            if (m_Settings.logging.validation.verbose)
+                debuggerCreateInfo.messageSeverity |= vk::DebugUtilsMessageSeverityFlagBitsEXT::eVerbose;
             debuggerCreateInfo.messageType = vk::DebugUtilsMessageTypeFlagBitsEXT::eDeviceAddressBinding | vk::DebugUtilsMessageTypeFlagBitsEXT::eGeneral |
                 vk::DebugUtilsMessageTypeFlagBitsEXT::ePerformance | vk::DebugUtilsMessageTypeFlagBitsEXT::eValidation;
             debuggerCreateInfo.pUserData       = this;
@@ -74,11 +143,11 @@ namespace neuron {
             instanceCreateInfo.pNext = &debuggerCreateInfo;
         }
 
-        if (settings.vulkanApiDump) {
+        if (m_Settings.vulkanApiDump) {
             instanceLayers.push_back("VK_LAYER_LUNARG_api_dump");
         }
 
-        if (!settings.offscreenRenderingOnly) {
+        if (!m_Settings.offscreenRenderingOnly) {
             uint32_t     count;
             const char **requiredExtensions = glfwGetRequiredInstanceExtensions(&count);
             for (uint32_t i = 0; i < count; i++) {
@@ -86,22 +155,59 @@ namespace neuron {
             }
         }
 
+        for (const char *extensionName : m_Settings.requestedInstanceExtensions) {
+            if (std::ranges::none_of(instanceExtensions, [&](const char *enabled) { return std::string_view(enabled) == extensionName; })) {
+                instanceExtensions.push_back(extensionName);
+            }
+        }
+
         instanceCreateInfo.setPApplicationInfo(&appInfo).setPEnabledExtensionNames(instanceExtensions).setPEnabledLayerNames(instanceLayers);
 
         m_Instance = vk::createInstance(instanceCreateInfo);
         VULKAN_HPP_DEFAULT_DISPATCHER.init(m_Instance);
-
-        if (settings.debugMode) {
-            m_DebugMessenger = m_Instance.createDebugUtilsMessengerEXT(debuggerCreateInfo);
-        }
     }
 
     Context::~Context() {
+        // tasks still queued may use the instance
+        m_Jobs.reset();
+
         if (m_DebugMessenger.has_value()) {
             m_Instance.destroy(m_DebugMessenger.value());
         }
 
         m_Instance.destroy();
+
+        utils::ValidationSummary summary;
+        if (m_ValidationFilter.takeSummary(utils::Profiler::now(), summary, true))
+            logValidationSummary(*m_ValidationLogger, summary);
+
+        restoreLoggers();
+    }
+
+    void Context::createLoggers() {
+        m_LogPool = std::make_shared<spdlog::details::thread_pool>(m_Settings.logging.queueSize, 1);
+
+        const auto sink    = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+        m_Logger           = std::make_shared<spdlog::async_logger>(std::string(NAME), sink, m_LogPool, spdlog::async_overflow_policy::overrun_oldest);
+        m_ValidationLogger = std::make_shared<spdlog::async_logger>("validation", sink, m_LogPool, spdlog::async_overflow_policy::overrun_oldest);
+
+        const auto level = m_Settings.debugMode ? spdlog::level::debug : spdlog::level::info;
+        for (const auto &logger : {m_Logger, m_ValidationLogger}) {
+            logger->set_level(level);
+            logger->flush_on(spdlog::level::err);
+        }
+
+        m_PreviousLogger = spdlog::default_logger();
+        spdlog::set_default_logger(m_Logger);
+    }
+
+    void Context::restoreLoggers() {
+        // the pool drains its queue before its thread exits
+        spdlog::set_default_logger(m_PreviousLogger);
+        spdlog::drop(m_Logger->name());
+        m_Logger.reset();
+        m_ValidationLogger.reset();
+        m_LogPool.reset();
     }
 
     Context *Context::get() noexcept {
@@ -3,9 +3,20 @@
 
 #include <vulkan/vulkan.hpp>
 
+#include "neuron/utils/jobs.hpp"
+#include "neuron/utils/logging.hpp"
+#include "neuron/utils/startup.hpp"
 #include "neuron/utils/utils.hpp"
 
+#include <spdlog/logger.h>
+
+#include <memory>
 #include <optional>
+#include <vector>
+
+namespace spdlog::details {
+    class thread_pool;
+}
 
 namespace neuron {
 
@@ -19,18 +30,32 @@ namespace neuron {
         bool offscreenRenderingOnly = false;
         bool debugMode              = false;
         bool vulkanApiDump          = false;
+
+        std::vector<const char *> requestedInstanceExtensions;
+
+        utils::JobSettings jobs;
+        utils::LogSettings logging;
     };
 
     void init(const Settings &settings = {});
 
     void cleanup();
 
+    /**
+     * The engine's job system. Without init() (tools, or code that never touches the GPU) a process wide one with default settings is started on first use.
+     */
+    [[nodiscard]] utils::JobSystem &getJobSystem();
+
     /**
      *
      * Context is the container for all things that should only exist once
      *
-     * For example, this will initialize the vulkan instance & debug messenger.
-     * This will also contain references to the main engine loggers.
+     * For example, this will initialize the vulkan instance & debug messenger, and start the job system.
+     * This will also contain references to the main engine loggers. They log through a ring buffer to a background thread, and the engine logger replaces spdlog's default
+     * one while the context lives. Validation messages are rate limited by utils::ValidationFilter.
+     *
+     * Startup is split into timed phases, logged once the context is up. The Vulkan loader is opened on a worker while the main thread initializes GLFW, and GLFW is
+     * skipped entirely for offscreenRenderingOnly processes.
      *
      * see neuron::graphics::GContext for an actual rendering context.
      *
@@ -41,6 +66,18 @@ namespace neuron {
 
         [[nodiscard]] inline const std::optional<vk::DebugUtilsMessengerEXT> &getDebugMessenger() const { return m_DebugMessenger; }
 
+        [[nodiscard]] inline const Settings &getSettings() const noexcept { return m_Settings; }
+
+        [[nodiscard]] inline utils::JobSystem &getJobSystem() const noexcept { return *m_Jobs; }
+
+        [[nodiscard]] inline const std::shared_ptr<spdlog::logger> &getLogger() const noexcept { return m_Logger; }
+
+        [[nodiscard]] inline const std::shared_ptr<spdlog::logger> &getValidationLogger() const noexcept { return m_ValidationLogger; }
+
+        [[nodiscard]] inline utils::ValidationFilter &getValidationFilter() noexcept { return m_ValidationFilter; }
+
+        [[nodiscard]] inline const utils::StartupTimings &getStartupTimings() const noexcept { return m_Startup; }
+
         ~Context();
 
         static Context* get() noexcept;
@@ -50,7 +87,19 @@ namespace neuron {
 
         friend void init(const Settings &settings);
 
-        vk::Instance                              m_Instance;
-        std::optional<vk::DebugUtilsMessengerEXT> m_DebugMessenger;
+        Settings                                      m_Settings;
+        utils::StartupTimings                         m_Startup;
+        std::shared_ptr<spdlog::details::thread_pool> m_LogPool;
+        std::shared_ptr<spdlog::logger>               m_Logger;
+        std::shared_ptr<spdlog::logger>               m_ValidationLogger;
+        std::shared_ptr<spdlog::logger>               m_PreviousLogger;
+        utils::ValidationFilter                       m_ValidationFilter;
+        vk::Instance                                  m_Instance;
+        std::optional<vk::DebugUtilsMessengerEXT>     m_DebugMessenger;
+        std::unique_ptr<utils::JobSystem>             m_Jobs;
+
+        void createLoggers();
+        void createInstance(vk::DebugUtilsMessengerCreateInfoEXT &debuggerCreateInfo);
+        void restoreLoggers();
     };
 } // namespace neuron
@@ -0,0 +1,20 @@
+#include "headless_surface.hpp"
+
+namespace neuron::os {
+    vk::SurfaceKHR HeadlessSurface::getOrCreateSurface() {
+        if (!m_Surface) {
+            m_Surface = Context::get()->getInstance().createHeadlessSurfaceEXT(vk::HeadlessSurfaceCreateInfoEXT());
+        }
+
+        return m_Surface;
+    }
+
+    vk::SurfaceKHR HeadlessSurface::getSurfaceIfAvailable() {
+        return m_Surface;
+    }
+
+    HeadlessSurface::~HeadlessSurface() {
+        if (m_Surface)
+            Context::get()->getInstance().destroy(m_Surface);
+    }
+} // namespace neuron::os
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "neuron/graphics/gcontext.hpp"
+
+namespace neuron::os {
+
+    /**
+     *
+     * Surface without a window, backed by VK_EXT_headless_surface. Presenting to it goes through the whole swapchain path without a display, which is useful for tests and
+     * render nodes. The instance must be created with VK_KHR_surface and VK_EXT_headless_surface in Settings::requestedInstanceExtensions.
+     *
+     */
+    class HeadlessSurface : public neuron::graphics::ISurfaceProvider {
+      public:
+        HeadlessSurface() = default;
+        virtual ~HeadlessSurface();
+
+        vk::SurfaceKHR getOrCreateSurface() override;
+        vk::SurfaceKHR getSurfaceIfAvailable() override;
+
+      private:
+        vk::SurfaceKHR m_Surface;
+    };
+
+} // namespace neuron::os
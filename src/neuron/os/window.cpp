@@ -1,7 +1,32 @@
 #include "window.hpp"
 
+#include <atomic>
+#include <stdexcept>
+
 namespace neuron::os {
+    static std::atomic_bool windowSystemInitialized = false;
+
+    void initWindowSystem() {
+        if (windowSystemInitialized.load())
+            return;
+
+        if (glfwInit() != GLFW_TRUE)
+            throw std::runtime_error("Failed to initialize GLFW");
+        windowSystemInitialized.store(true);
+    }
+
+    void terminateWindowSystem() noexcept {
+        if (windowSystemInitialized.exchange(false))
+            glfwTerminate();
+    }
+
+    bool isWindowSystemInitialized() noexcept {
+        return windowSystemInitialized.load();
+    }
+
     Window::Window(const WindowSettings &settings) {
+        initWindowSystem();
+
         glfwDefaultWindowHints();
         glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
         glfwWindowHint(GLFW_RESIZABLE, settings.resizable);
@@ -34,6 +59,7 @@ namespace neuron::os {
     }
 
     void pollEvents() {
-        glfwPollEvents();
+        if (windowSystemInitialized.load())
+            glfwPollEvents();
     }
 } // namespace neuron::os
@@ -9,12 +9,30 @@
 
 namespace neuron::os {
 
+    /**
+     * Initializes GLFW unless it is already. Windows do this themselves, and init() does it up front unless the process is offscreenRenderingOnly, since the instance
+     * needs GLFW's surface extensions. Main thread only.
+     *
+     * @throws std::runtime_error if GLFW can't be initialized.
+     */
+    void initWindowSystem();
+
+    /**
+     * Terminates GLFW if it was initialized. Called by cleanup().
+     */
+    void terminateWindowSystem() noexcept;
+
+    [[nodiscard]] bool isWindowSystemInitialized() noexcept;
+
     struct WindowSettings {
         std::string title;
         glm::uvec2  size;
         bool        resizable = false;
     };
 
+    /**
+     * The window system is initialized on first use, but the instance only has the surface extensions when the process isn't offscreenRenderingOnly.
+     */
     class Window : public neuron::graphics::ISurfaceProvider {
       public:
         explicit Window(const WindowSettings &settings);
@@ -30,6 +48,9 @@ namespace neuron::os {
         vk::SurfaceKHR m_Surface;
     };
 
+    /**
+     * Does nothing until the window system is initialized.
+     */
     void pollEvents();
 
 } // namespace neuron::os
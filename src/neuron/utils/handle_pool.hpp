@@ -0,0 +1,201 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <format>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// debug builds check every lookup; NEURON_VALIDATE_HANDLES turns the checks on in release builds too
+#if !defined(NEURON_VALIDATE_HANDLES) && !defined(NDEBUG)
+#define NEURON_VALIDATE_HANDLES 1
+#endif
+
+namespace neuron::utils {
+
+#if defined(NEURON_VALIDATE_HANDLES)
+    constexpr bool VALIDATE_HANDLES = true;
+#else
+    constexpr bool VALIDATE_HANDLES = false;
+#endif
+
+    /**
+     * A 32-bit reference into a HandlePool. The low INDEX_BITS pick a slot, the rest are the slot's generation, which changes every time the slot is reused, so a handle
+     * to something destroyed is told apart from one to whatever took its place. Generations start at 1, so a default constructed handle is never valid.
+     *
+     * Tag only makes handles of different pools different types.
+     */
+    template<typename Tag> class Handle {
+      public:
+        static constexpr uint32_t INDEX_BITS      = 20;
+        static constexpr uint32_t GENERATION_BITS = 32 - INDEX_BITS;
+        static constexpr uint32_t INDEX_MASK      = (1u << INDEX_BITS) - 1;
+        static constexpr uint32_t MAX_GENERATION  = (1u << GENERATION_BITS) - 1;
+
+        constexpr Handle() noexcept = default;
+
+        [[nodiscard]] inline constexpr uint32_t getIndex() const noexcept { return m_Value & INDEX_MASK; }
+        [[nodiscard]] inline constexpr uint32_t getGeneration() const noexcept { return m_Value >> INDEX_BITS; }
+
+        /**
+         * The handle as one integer, for storing it in GPU-visible data or hashing it. fromValue() turns it back.
+         */
+        [[nodiscard]] inline constexpr uint32_t getValue() const noexcept { return m_Value; }
+
+        [[nodiscard]] static inline constexpr Handle fromValue(uint32_t value) noexcept { return Handle(value); }
+
+        [[nodiscard]] inline constexpr explicit operator bool() const noexcept { return m_Value != 0; }
+
+        [[nodiscard]] constexpr bool operator==(const Handle &) const noexcept = default;
+
+      private:
+        template<typename, typename...> friend class HandlePool;
+
+        constexpr explicit Handle(uint32_t value) noexcept : m_Value(value) {}
+        constexpr Handle(uint32_t index, uint32_t generation) noexcept : m_Value(generation << INDEX_BITS | index) {}
+
+        uint32_t m_Value = 0;
+    };
+
+    /**
+     *
+     * Owns objects addressed by generational handles instead of pointers. Every column of the objects lives in its own dense array (structure of arrays), so looking up
+     * one field touches one array and iterating over all objects of a pool is a linear walk. A lookup is two array reads and, with validation, one compare. Nothing is
+     * reference counted: the owner decides when an object goes away, and handles to it go stale instead of dangling.
+     *
+     * Destroying moves the last object into the hole. Freed slots are only reused once MIN_FREE_SLOTS of them piled up, oldest first, so a slot's generation runs out
+     * (and wraps around) as late as possible.
+     *
+     * Not thread safe.
+     *
+     */
+    template<typename Tag, typename... Columns> class HandlePool {
+      public:
+        using HandleType = Handle<Tag>;
+
+        static constexpr uint32_t MAX_SLOTS      = HandleType::INDEX_MASK + 1;
+        static constexpr size_t   MIN_FREE_SLOTS = 1024;
+
+        // the dense index of free slots, so a stale handle whose generation came around again doesn't pass for one to a live object
+        static constexpr uint32_t FREE_SLOT = UINT32_MAX;
+
+        void reserve(size_t count) {
+            m_Generations.reserve(count);
+            m_DenseIndices.reserve(count);
+            m_Owners.reserve(count);
+            std::apply([&](auto &...column) { (column.reserve(count), ...); }, m_Columns);
+        }
+
+        /**
+         * @throws std::runtime_error if the pool holds MAX_SLOTS objects already.
+         */
+        [[nodiscard]] HandleType create(Columns... values) {
+            uint32_t index;
+            if (m_FreeSlots.size() > MIN_FREE_SLOTS || (!m_FreeSlots.empty() && m_Generations.size() == MAX_SLOTS)) {
+                index = m_FreeSlots.front();
+                m_FreeSlots.pop_front();
+            } else {
+                if (m_Generations.size() == MAX_SLOTS) {
+                    throw std::runtime_error(std::format("A handle pool can't hold more than {} objects", MAX_SLOTS));
+                }
+                index = static_cast<uint32_t>(m_Generations.size());
+                m_Generations.push_back(1);
+                m_DenseIndices.push_back(0);
+            }
+
+            m_DenseIndices[index] = static_cast<uint32_t>(m_Owners.size());
+            m_Owners.push_back(index);
+            std::apply([&](auto &...column) { (column.push_back(std::move(values)), ...); }, m_Columns);
+
+            return HandleType(index, m_Generations[index]);
+        }
+
+        /**
+         * Takes the object out of the pool and returns its columns. The handle and every copy of it are stale from now on.
+         *
+         * @throws std::runtime_error if the handle is stale or null.
+         */
+        std::tuple<Columns...> remove(HandleType handle) {
+            if (!isValid(handle)) {
+                throw std::runtime_error(std::format("Removing through a stale handle {:#x}", handle.getValue()));
+            }
+
+            const uint32_t index = handle.getIndex();
+            const uint32_t dense = m_DenseIndices[index];
+            const uint32_t last  = static_cast<uint32_t>(m_Owners.size()) - 1;
+
+            std::tuple<Columns...> removed = std::apply([&](auto &...column) { return std::tuple<Columns...>(std::move(column[dense])...); }, m_Columns);
+
+            if (dense != last) {
+                std::apply([&](auto &...column) { ((column[dense] = std::move(column[last])), ...); }, m_Columns);
+                m_Owners[dense]                 = m_Owners[last];
+                m_DenseIndices[m_Owners[dense]] = dense;
+            }
+            std::apply([](auto &...column) { (column.pop_back(), ...); }, m_Columns);
+            m_Owners.pop_back();
+
+            // 0 is never a valid generation
+            m_Generations[index]  = m_Generations[index] == HandleType::MAX_GENERATION ? 1 : m_Generations[index] + 1;
+            m_DenseIndices[index] = FREE_SLOT;
+            m_FreeSlots.push_back(index);
+
+            return removed;
+        }
+
+        void destroy(HandleType handle) { (void) remove(handle); }
+
+        [[nodiscard]] inline bool isValid(HandleType handle) const noexcept {
+            const uint32_t index = handle.getIndex();
+            return index < m_Generations.size() && m_Generations[index] == handle.getGeneration() && m_DenseIndices[index] != FREE_SLOT;
+        }
+
+        /**
+         * Where the object is in the columns. Changes when other objects are destroyed.
+         *
+         * @throws std::runtime_error if the handle is stale or null and handles are validated; undefined otherwise.
+         */
+        [[nodiscard]] inline uint32_t getDenseIndex(HandleType handle) const {
+#if defined(NEURON_VALIDATE_HANDLES)
+            if (!isValid(handle)) {
+                throw std::runtime_error(std::format("Stale or null handle {:#x}", handle.getValue()));
+            }
+#endif
+            return m_DenseIndices[handle.getIndex()];
+        }
+
+        template<size_t Column> [[nodiscard]] inline auto &get(HandleType handle) { return std::get<Column>(m_Columns)[getDenseIndex(handle)]; }
+
+        template<size_t Column> [[nodiscard]] inline const auto &get(HandleType handle) const { return std::get<Column>(m_Columns)[getDenseIndex(handle)]; }
+
+        /**
+         * Every object's value of one column, in dense order. getHandle() maps a position back to its handle.
+         */
+        template<size_t Column> [[nodiscard]] inline auto getColumn() { return std::span(std::get<Column>(m_Columns)); }
+
+        template<size_t Column> [[nodiscard]] inline auto getColumn() const { return std::span(std::get<Column>(m_Columns)); }
+
+        [[nodiscard]] inline HandleType getHandle(uint32_t denseIndex) const {
+            const uint32_t index = m_Owners.at(denseIndex);
+            return HandleType(index, m_Generations[index]);
+        }
+
+        [[nodiscard]] inline size_t size() const noexcept { return m_Owners.size(); }
+
+        [[nodiscard]] inline bool empty() const noexcept { return m_Owners.empty(); }
+
+      private:
+        // per slot
+        std::vector<uint32_t> m_Generations;
+        std::vector<uint32_t> m_DenseIndices;
+        std::deque<uint32_t>  m_FreeSlots;
+
+        // per object, dense
+        std::vector<uint32_t>               m_Owners;
+        std::tuple<std::vector<Columns>...> m_Columns;
+    };
+
+} // namespace neuron::utils
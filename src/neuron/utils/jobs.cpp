@@ -0,0 +1,286 @@
+#include "jobs.hpp"
+
+#include "neuron/utils/profiler.hpp"
+
+#include <spdlog/spdlog.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace neuron::utils {
+
+    struct TaskNode {
+        std::function<void()> fn;
+
+        // unfinished dependencies, plus one while submit() is still adding them
+        std::atomic<uint32_t> waiting = 1;
+        std::atomic<uint32_t> done    = 0;
+
+        std::mutex                             mutex;
+        std::vector<std::shared_ptr<TaskNode>> continuations;
+        std::exception_ptr                     error;
+
+        // pending counter of the TaskGroup the task was submitted through
+        std::shared_ptr<std::atomic<uint64_t>> group;
+    };
+
+    static thread_local const JobSystem *t_System = nullptr;
+    static thread_local uint32_t         t_Worker = 0;
+
+    static void pinCurrentThread(uint32_t core) {
+#if defined(_WIN32)
+        if (SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << (core % (sizeof(DWORD_PTR) * 8))) == 0)
+            spdlog::warn("Failed to pin job worker to core {}", core);
+#elif defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core % CPU_SETSIZE, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+            spdlog::warn("Failed to pin job worker to core {}", core);
+#else
+        (void)core;
+#endif
+    }
+
+    bool Task::isDone() const noexcept { return !m_Node || m_Node->done.load(std::memory_order_acquire) != 0; }
+
+    JobSystem::JobSystem(const JobSettings &settings) : m_Settings(settings) {
+        const uint32_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        const uint32_t workerCount     = settings.workerCount > 0 ? settings.workerCount : std::max(1u, hardwareThreads - 1);
+
+        for (uint32_t i = 0; i < workerCount; i++) {
+            m_Queues.push_back(std::make_unique<WorkerQueue>());
+        }
+
+        // the queues must all exist before the first worker starts stealing
+        for (uint32_t i = 0; i < workerCount; i++) {
+            m_Workers.emplace_back([this, i, hardwareThreads] {
+                if (m_Settings.pinWorkers)
+                    pinCurrentThread((i + 1) % hardwareThreads);
+                workerLoop(i);
+            });
+        }
+    }
+
+    JobSystem::~JobSystem() {
+        waitIdle();
+        {
+            std::lock_guard lock(m_SleepMutex);
+            m_Stopping = true;
+        }
+        m_SleepSignal.notify_all();
+        m_Workers.clear();
+    }
+
+    Task JobSystem::submit(std::function<void()> fn) { return submit(std::move(fn), {}, nullptr); }
+
+    Task JobSystem::submit(std::function<void()> fn, std::span<const Task> dependencies) { return submit(std::move(fn), dependencies, nullptr); }
+
+    Task JobSystem::submit(std::function<void()> fn, std::span<const Task> dependencies, std::shared_ptr<std::atomic<uint64_t>> group) {
+        auto node   = std::make_shared<TaskNode>();
+        node->fn    = std::move(fn);
+        node->group = std::move(group);
+        m_Unfinished.fetch_add(1);
+
+        for (const Task &dependency : dependencies) {
+            if (!dependency.m_Node)
+                continue;
+
+            std::lock_guard lock(dependency.m_Node->mutex);
+            if (dependency.m_Node->done.load(std::memory_order_relaxed) == 0) {
+                dependency.m_Node->continuations.push_back(node);
+                node->waiting.fetch_add(1);
+            }
+        }
+
+        if (node->waiting.fetch_sub(1) == 1) {
+            schedule(node);
+        }
+        return Task(node);
+    }
+
+    void JobSystem::wait(const Task &task) {
+        if (!task.m_Node)
+            return;
+
+        TaskNode &node = *task.m_Node;
+        while (node.done.load(std::memory_order_acquire) == 0) {
+            // nothing queued means the task or one of its dependencies is running on another thread, which notifies once it is done
+            if (!runOne())
+                node.done.wait(0, std::memory_order_acquire);
+        }
+
+        if (node.error)
+            std::rethrow_exception(node.error);
+    }
+
+    void JobSystem::waitIdle() {
+        while (true) {
+            const uint64_t unfinished = m_Unfinished.load();
+            if (unfinished == 0)
+                return;
+            if (!runOne())
+                m_Unfinished.wait(unfinished);
+        }
+    }
+
+    bool JobSystem::runOne() {
+        auto node = findTask(getCurrentWorker());
+        if (!node)
+            return false;
+
+        execute(node);
+        return true;
+    }
+
+    std::optional<uint32_t> JobSystem::getCurrentWorker() const noexcept {
+        if (t_System == this)
+            return t_Worker;
+        return std::nullopt;
+    }
+
+    JobStats JobSystem::getStats() const { return {.executed = m_Executed.load(std::memory_order_relaxed), .stolen = m_Stolen.load(std::memory_order_relaxed)}; }
+
+    void JobSystem::workerLoop(uint32_t index) {
+        t_System = this;
+        t_Worker = index;
+        NEURON_PROFILE_THREAD("job worker " + std::to_string(index));
+
+        while (true) {
+            auto node = findTask(index);
+
+            // fine grained tasks tend to arrive in bursts, so spin briefly before going to sleep
+            for (int spin = 0; !node && spin < 64; spin++) {
+                std::this_thread::yield();
+                node = findTask(index);
+            }
+
+            if (node) {
+                execute(node);
+                continue;
+            }
+
+            std::unique_lock lock(m_SleepMutex);
+            m_Sleeping.fetch_add(1);
+            m_SleepSignal.wait(lock, [this] { return m_Queued.load() > 0 || m_Stopping; });
+            m_Sleeping.fetch_sub(1);
+
+            if (m_Stopping && m_Queued.load() == 0)
+                return;
+        }
+    }
+
+    void JobSystem::schedule(std::shared_ptr<TaskNode> node) {
+        WorkerQueue &queue = t_System == this ? *m_Queues[t_Worker] : m_Injected;
+        {
+            std::lock_guard lock(queue.mutex);
+            queue.tasks.push_back(std::move(node));
+        }
+
+        // pairs with a worker registering as sleeping before it checks m_Queued, so either the worker sees the task or this sees the worker
+        m_Queued.fetch_add(1);
+        if (m_Sleeping.load() > 0) {
+            { std::lock_guard lock(m_SleepMutex); }
+            m_SleepSignal.notify_one();
+        }
+    }
+
+    void JobSystem::execute(const std::shared_ptr<TaskNode> &node) {
+        try {
+            if (node->fn)
+                node->fn();
+        } catch (...) {
+            node->error = std::current_exception();
+        }
+        // releases whatever the task captured
+        node->fn = nullptr;
+
+        std::vector<std::shared_ptr<TaskNode>> continuations;
+        {
+            std::lock_guard lock(node->mutex);
+            node->done.store(1, std::memory_order_release);
+            continuations.swap(node->continuations);
+        }
+        node->done.notify_all();
+
+        for (auto &continuation : continuations) {
+            if (continuation->waiting.fetch_sub(1) == 1)
+                schedule(std::move(continuation));
+        }
+
+        if (node->group && node->group->fetch_sub(1) == 1)
+            node->group->notify_all();
+
+        m_Executed.fetch_add(1, std::memory_order_relaxed);
+        if (m_Unfinished.fetch_sub(1) == 1)
+            m_Unfinished.notify_all();
+    }
+
+    std::shared_ptr<TaskNode> JobSystem::findTask(std::optional<uint32_t> self) {
+        auto pop = [this](WorkerQueue &queue, bool back) -> std::shared_ptr<TaskNode> {
+            std::lock_guard lock(queue.mutex);
+            if (queue.tasks.empty())
+                return nullptr;
+
+            std::shared_ptr<TaskNode> node;
+            if (back) {
+                node = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            } else {
+                node = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            m_Queued.fetch_sub(1);
+            return node;
+        };
+
+        if (self) {
+            if (auto node = pop(*m_Queues[*self], true))
+                return node;
+        }
+
+        if (auto node = pop(m_Injected, false))
+            return node;
+
+        // start at a different victim per thread so thieves don't all pile onto the same deque
+        const auto count = static_cast<uint32_t>(m_Queues.size());
+        const auto start = self ? *self + 1 : static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        for (uint32_t i = 0; i < count; i++) {
+            const uint32_t victim = (start + i) % count;
+            if (victim == self)
+                continue;
+
+            if (auto node = pop(*m_Queues[victim], false)) {
+                m_Stolen.fetch_add(1, std::memory_order_relaxed);
+                return node;
+            }
+        }
+        return nullptr;
+    }
+
+    TaskGroup::TaskGroup(JobSystem &jobs) : m_Jobs(jobs), m_Pending(std::make_shared<std::atomic<uint64_t>>(0)) {}
+
+    TaskGroup::~TaskGroup() { wait(); }
+
+    Task TaskGroup::submit(std::function<void()> fn) {
+        m_Pending->fetch_add(1);
+        return m_Jobs.submit(std::move(fn), {}, m_Pending);
+    }
+
+    void TaskGroup::wait() {
+        while (true) {
+            const uint64_t pending = m_Pending->load();
+            if (pending == 0)
+                return;
+            if (!m_Jobs.runOne())
+                m_Pending->wait(pending);
+        }
+    }
+
+    bool TaskGroup::isIdle() const noexcept { return m_Pending->load() == 0; }
+
+} // namespace neuron::utils
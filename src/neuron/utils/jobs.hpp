@@ -0,0 +1,250 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace neuron::utils {
+
+    struct JobSettings {
+        /**
+         * Worker threads. 0 uses one per hardware thread minus one, since the main thread runs tasks too while it waits. At least one worker is always started.
+         */
+        uint32_t workerCount = 0;
+
+        /**
+         * Pins worker i to core i + 1, leaving core 0 to the main thread. Only supported on Linux and Windows.
+         */
+        bool pinWorkers = false;
+    };
+
+    struct JobStats {
+        uint64_t executed = 0;
+
+        /**
+         * Tasks a thread took from another worker's deque.
+         */
+        uint64_t stolen = 0;
+    };
+
+    struct TaskNode;
+
+    /**
+     * Handle to a submitted task. Empty handles count as done.
+     */
+    class Task {
+      public:
+        Task() = default;
+
+        [[nodiscard]] bool isDone() const noexcept;
+
+        [[nodiscard]] inline explicit operator bool() const noexcept { return static_cast<bool>(m_Node); }
+
+      private:
+        friend class JobSystem;
+
+        explicit Task(std::shared_ptr<TaskNode> node) : m_Node(std::move(node)) {}
+
+        std::shared_ptr<TaskNode> m_Node;
+    };
+
+    /**
+     *
+     * Runs tasks on a fixed set of worker threads. Every worker has its own deque: tasks submitted from a worker go to the back of its deque and are taken from there again
+     * (newest first, while their data is still in cache), idle workers steal from the front of the others. Tasks submitted from other threads go through a shared queue.
+     *
+     * Tasks can depend on other tasks and only start once all of them finished, which builds task graphs. Threads that wait on a task run queued tasks in the meantime
+     * instead of blocking, so waiting inside a task doesn't starve the workers.
+     *
+     * A task that throws still releases the tasks depending on it; wait() on it rethrows. All methods are thread safe.
+     *
+     */
+    class JobSystem final {
+      public:
+        explicit JobSystem(const JobSettings &settings = {});
+
+        /**
+         * Finishes all queued tasks, then joins the workers.
+         */
+        ~JobSystem();
+
+        JobSystem(const JobSystem &)            = delete;
+        JobSystem &operator=(const JobSystem &) = delete;
+
+        Task submit(std::function<void()> fn);
+
+        /**
+         * Starts fn once all dependencies finished.
+         */
+        Task submit(std::function<void()> fn, std::span<const Task> dependencies);
+
+        inline Task then(const Task &before, std::function<void()> fn) { return submit(std::move(fn), std::span(&before, 1)); }
+
+        /**
+         * A task without work which finishes once all dependencies did.
+         */
+        inline Task whenAll(std::span<const Task> dependencies) { return submit({}, dependencies); }
+
+        /**
+         * Runs queued tasks on the calling thread until the task finished.
+         *
+         * @throws whatever the task threw.
+         */
+        void wait(const Task &task);
+
+        /**
+         * Runs queued tasks on the calling thread until the future is ready, for results produced by tasks of this system. Doesn't call get().
+         */
+        template<typename T> void wait(const std::shared_future<T> &future) {
+            while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                // with nothing left to help with, the future's task is running on another thread
+                if (!runOne()) {
+                    future.wait();
+                    return;
+                }
+            }
+        }
+
+        /**
+         * Waits until every task submitted so far finished. Must not be called from a task.
+         */
+        void waitIdle();
+
+        /**
+         * Runs one queued task on the calling thread. Returns false if there was none.
+         */
+        bool runOne();
+
+        /**
+         * Calls fn(begin, end) for consecutive ranges of at most grain indices covering [0, count), in parallel, and waits for all of them. The calling thread runs the
+         * first range itself. Waits for every range before rethrowing the first exception, the calling thread's before the tasks' in order.
+         */
+        template<typename F> void parallelFor(uint32_t count, uint32_t grain, F &&fn) {
+            grain = std::max(grain, 1u);
+            if (count <= grain) {
+                if (count > 0)
+                    fn(0u, count);
+                return;
+            }
+
+            std::vector<Task>  tasks;
+            std::exception_ptr error;
+            try {
+                tasks.reserve((count - 1) / grain);
+                for (uint32_t begin = grain; begin < count; begin += grain) {
+                    const uint32_t end = std::min(count, begin + grain);
+                    tasks.push_back(submit([&fn, begin, end] { fn(begin, end); }));
+                }
+                fn(0u, grain);
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            // the tasks reference fn, so none may still run when this throws
+            for (const Task &task : tasks) {
+                try {
+                    wait(task);
+                } catch (...) {
+                    if (!error)
+                        error = std::current_exception();
+                }
+            }
+            if (error)
+                std::rethrow_exception(error);
+        }
+
+        [[nodiscard]] inline uint32_t getWorkerCount() const noexcept { return static_cast<uint32_t>(m_Queues.size()); }
+
+        /**
+         * Index of the worker the calling thread is, if it is one of this system's.
+         */
+        [[nodiscard]] std::optional<uint32_t> getCurrentWorker() const noexcept;
+
+        [[nodiscard]] JobStats getStats() const;
+
+      private:
+        friend class TaskGroup;
+
+        struct WorkerQueue {
+            std::mutex                            mutex;
+            std::deque<std::shared_ptr<TaskNode>> tasks;
+        };
+
+        JobSettings m_Settings;
+
+        std::vector<std::unique_ptr<WorkerQueue>> m_Queues;
+        WorkerQueue                               m_Injected;
+
+        // tasks sitting in any queue, and tasks submitted but not finished
+        std::atomic<uint64_t> m_Queued     = 0;
+        std::atomic<uint64_t> m_Unfinished = 0;
+
+        std::mutex              m_SleepMutex;
+        std::condition_variable m_SleepSignal;
+        std::atomic<uint32_t>   m_Sleeping = 0;
+        bool                    m_Stopping = false;
+
+        std::atomic<uint64_t> m_Executed = 0;
+        std::atomic<uint64_t> m_Stolen   = 0;
+
+        std::vector<std::jthread> m_Workers;
+
+        Task submit(std::function<void()> fn, std::span<const Task> dependencies, std::shared_ptr<std::atomic<uint64_t>> group);
+
+        void workerLoop(uint32_t index);
+        void schedule(std::shared_ptr<TaskNode> node);
+        void execute(const std::shared_ptr<TaskNode> &node);
+
+        [[nodiscard]] std::shared_ptr<TaskNode> findTask(std::optional<uint32_t> self);
+    };
+
+    /**
+     *
+     * Tracks the tasks a subsystem submitted, so it can wait for its own work (and only that) before it is destroyed.
+     *
+     * Declare it as the owner's last member: members are destroyed in reverse order, so the destructor then waits for running tasks before anything they use goes away.
+     *
+     */
+    class TaskGroup final {
+      public:
+        explicit TaskGroup(JobSystem &jobs);
+
+        /**
+         * Waits for the group's tasks.
+         */
+        ~TaskGroup();
+
+        TaskGroup(const TaskGroup &)            = delete;
+        TaskGroup &operator=(const TaskGroup &) = delete;
+
+        Task submit(std::function<void()> fn);
+
+        /**
+         * Runs queued tasks on the calling thread until all of the group's tasks finished.
+         */
+        void wait();
+
+        [[nodiscard]] bool isIdle() const noexcept;
+
+        [[nodiscard]] inline JobSystem &getJobSystem() const noexcept { return m_Jobs; }
+
+      private:
+        JobSystem &m_Jobs;
+
+        // shared with the tasks, which may still touch it after wait() returned
+        std::shared_ptr<std::atomic<uint64_t>> m_Pending;
+    };
+
+} // namespace neuron::utils
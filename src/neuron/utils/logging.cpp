@@ -0,0 +1,71 @@
+#include "logging.hpp"
+
+#include <algorithm>
+
+namespace neuron::utils {
+
+    ValidationFilter::ValidationFilter(const ValidationLogSettings &settings) : m_Settings(settings) {}
+
+    ValidationVerdict ValidationFilter::filter(int32_t id, const char *name, uint64_t now) {
+        std::lock_guard lock(m_Mutex);
+
+        if (std::ranges::find(m_Settings.deniedIds, id) != m_Settings.deniedIds.end()) {
+            m_Denied++;
+            return ValidationVerdict::Drop;
+        }
+
+        if (m_LastSummary == 0)
+            m_LastSummary = now;
+
+        auto [it, inserted] = m_Entries.try_emplace(id);
+        Entry &entry        = it->second;
+        if (inserted) {
+            entry.name        = name ? name : "";
+            entry.windowStart = now;
+        }
+
+        if (std::ranges::find(m_Settings.allowedIds, id) != m_Settings.allowedIds.end()) {
+            entry.logged++;
+            return ValidationVerdict::Log;
+        }
+
+        if (now - entry.windowStart >= m_Settings.windowNanoseconds) {
+            entry.windowStart = now;
+            entry.inWindow    = 0;
+        }
+
+        if (entry.inWindow >= m_Settings.messagesPerWindow) {
+            entry.suppressed++;
+            return ValidationVerdict::Drop;
+        }
+
+        entry.inWindow++;
+        entry.logged++;
+        return entry.inWindow == m_Settings.messagesPerWindow ? ValidationVerdict::LogLast : ValidationVerdict::Log;
+    }
+
+    bool ValidationFilter::takeSummary(uint64_t now, ValidationSummary &summary, bool force) {
+        std::lock_guard lock(m_Mutex);
+
+        if (!force && (m_Settings.summaryNanoseconds == 0 || now - m_LastSummary < m_Settings.summaryNanoseconds))
+            return false;
+        m_LastSummary = now;
+
+        summary        = {};
+        summary.denied = m_Denied;
+        for (auto &[id, entry] : m_Entries) {
+            summary.logged += entry.logged;
+            summary.suppressed += entry.suppressed;
+            if (entry.suppressed > 0)
+                summary.ids.push_back({id, entry.name, entry.logged, entry.suppressed});
+
+            entry.logged     = 0;
+            entry.suppressed = 0;
+        }
+        m_Denied = 0;
+
+        std::ranges::sort(summary.ids, [](const ValidationIdCount &a, const ValidationIdCount &b) { return a.suppressed > b.suppressed; });
+        return summary.suppressed > 0 || summary.denied > 0;
+    }
+
+} // namespace neuron::utils
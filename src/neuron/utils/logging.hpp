@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace neuron::utils {
+
+    struct ValidationLogSettings {
+        /**
+         * Also requests the layers' verbose messages, which are mostly object lifetime chatter.
+         */
+        bool verbose = false;
+
+        /**
+         * Messages of one id logged per window. Repeats beyond that are only counted, until the next window.
+         */
+        uint32_t messagesPerWindow = 5;
+        uint64_t windowNanoseconds = 1'000'000'000;
+
+        /**
+         * How often the counts of suppressed messages are logged. 0 only logs them when the context is destroyed.
+         */
+        uint64_t summaryNanoseconds = 10'000'000'000;
+
+        /**
+         * Message ids (VkDebugUtilsMessengerCallbackDataEXT::messageIdNumber) that are always logged, and ones that never are.
+         */
+        std::vector<int32_t> allowedIds;
+        std::vector<int32_t> deniedIds;
+    };
+
+    struct LogSettings {
+        /**
+         * Messages the async loggers buffer. Once full the oldest are dropped, so logging never blocks the thread that logs.
+         */
+        uint32_t queueSize = 8192;
+
+        ValidationLogSettings validation;
+    };
+
+    enum class ValidationVerdict {
+        Log,
+
+        /**
+         * Log, and say that further repeats are suppressed for the rest of the window.
+         */
+        LogLast,
+        Drop,
+    };
+
+    struct ValidationIdCount {
+        int32_t     id = 0;
+        std::string name;
+        uint64_t    logged     = 0;
+        uint64_t    suppressed = 0;
+    };
+
+    struct ValidationSummary {
+        uint64_t                       logged     = 0;
+        uint64_t                       suppressed = 0;
+        uint64_t                       denied     = 0;
+        std::vector<ValidationIdCount> ids;
+    };
+
+    /**
+     *
+     * Deduplicates and rate limits validation messages by their message id. Every id gets messagesPerWindow messages per window, the rest are counted and reported by
+     * takeSummary(). Times are nanoseconds on the steady clock (see Profiler::now()), passed in so the filter stays deterministic. Thread safe, as the layers call back
+     * from whatever thread made the Vulkan call.
+     *
+     */
+    class ValidationFilter final {
+      public:
+        explicit ValidationFilter(const ValidationLogSettings &settings = {});
+
+        [[nodiscard]] ValidationVerdict filter(int32_t id, const char *name, uint64_t now);
+
+        /**
+         * The counts since the last summary, sorted by suppressed messages, if the summary interval passed (or force is set) and anything was suppressed or denied.
+         * Resets the counts.
+         */
+        [[nodiscard]] bool takeSummary(uint64_t now, ValidationSummary &summary, bool force = false);
+
+        [[nodiscard]] inline const ValidationLogSettings &getSettings() const noexcept { return m_Settings; }
+
+      private:
+        struct Entry {
+            std::string name;
+            uint64_t    windowStart = 0;
+            uint32_t    inWindow    = 0;
+            uint64_t    logged      = 0;
+            uint64_t    suppressed  = 0;
+        };
+
+        ValidationLogSettings m_Settings;
+
+        std::mutex                         m_Mutex;
+        std::unordered_map<int32_t, Entry> m_Entries;
+        uint64_t                           m_Denied      = 0;
+        uint64_t                           m_LastSummary = 0;
+    };
+
+} // namespace neuron::utils
@@ -0,0 +1,189 @@
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+namespace neuron::utils {
+
+    static void appendJsonString(std::string &out, std::string_view text) {
+        out += '"';
+        for (const char c : text) {
+            switch (c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                    out += std::format("\\u{:04x}", static_cast<unsigned>(c));
+                else
+                    out += c;
+            }
+        }
+        out += '"';
+    }
+
+    Profiler &Profiler::get() {
+        // never destroyed, threads may still record while static destructors run
+        static Profiler *profiler = new Profiler();
+        return *profiler;
+    }
+
+    void Profiler::record(const char *name, uint64_t begin, uint64_t end) noexcept {
+        if (!isEnabled())
+            return;
+
+        ThreadBuffer &buffer = getThreadBuffer();
+        record(buffer.track, name, begin, end);
+    }
+
+    void Profiler::record(uint32_t track, const char *name, uint64_t begin, uint64_t end) noexcept {
+        if (!isEnabled())
+            return;
+
+        ThreadBuffer  &buffer = getThreadBuffer();
+        const uint64_t head   = buffer.head.load(std::memory_order_relaxed);
+        if (head - buffer.tail.load(std::memory_order_acquire) >= EVENTS_PER_THREAD) {
+            buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        buffer.events[head % EVENTS_PER_THREAD] = {name, begin, end, track};
+        buffer.head.store(head + 1, std::memory_order_release);
+    }
+
+    void Profiler::setThreadName(std::string name) {
+        const uint32_t  track = getThreadBuffer().track;
+        std::lock_guard lock(m_Mutex);
+        m_TrackNames[track] = std::move(name);
+    }
+
+    uint32_t Profiler::addTrack(std::string name) {
+        std::lock_guard lock(m_Mutex);
+        m_TrackNames.push_back(std::move(name));
+        return static_cast<uint32_t>(m_TrackNames.size() - 1);
+    }
+
+    const char *Profiler::intern(std::string_view name) {
+        std::lock_guard lock(m_Mutex);
+        // node based, so the strings never move
+        return m_Names.emplace(name).first->c_str();
+    }
+
+    void Profiler::collect() {
+        std::lock_guard lock(m_Mutex);
+        collectLocked();
+    }
+
+    std::vector<ProfileEvent> Profiler::takeEvents() {
+        std::lock_guard lock(m_Mutex);
+        collectLocked();
+        return std::exchange(m_Events, {});
+    }
+
+    std::string Profiler::toChromeTrace() {
+        std::lock_guard lock(m_Mutex);
+        collectLocked();
+
+        std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        for (uint32_t track = 0; track < m_TrackNames.size(); track++) {
+            out += std::format("{{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":", track);
+            appendJsonString(out, m_TrackNames[track]);
+            out += "}},";
+        }
+
+        // trace viewers want microseconds, the fraction keeps the nanoseconds
+        for (const auto &event : m_Events) {
+            out += "{\"ph\":\"X\",\"name\":";
+            appendJsonString(out, event.name);
+            out += std::format(",\"pid\":1,\"tid\":{},\"ts\":{}.{:03},\"dur\":{}.{:03}}},", event.track, event.begin / 1000, event.begin % 1000,
+                               (event.end - event.begin) / 1000, (event.end - event.begin) % 1000);
+        }
+
+        if (out.back() == ',')
+            out.pop_back();
+        out += "]}";
+        return out;
+    }
+
+    void Profiler::writeChromeTrace(const std::filesystem::path &path) {
+        const std::string trace = toChromeTrace();
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+            throw std::runtime_error("Failed to open " + path.string() + " for writing");
+        file.write(trace.data(), static_cast<std::streamsize>(trace.size()));
+        if (!file)
+            throw std::runtime_error("Failed to write " + path.string());
+    }
+
+    void Profiler::clear() {
+        std::lock_guard lock(m_Mutex);
+        collectLocked();
+        m_Events.clear();
+    }
+
+    ProfilerStats Profiler::getStats() const {
+        std::lock_guard lock(m_Mutex);
+        ProfilerStats   stats{.recorded = m_Recorded};
+        for (const auto &buffer : m_Buffers) {
+            stats.dropped += buffer->dropped.load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+
+    Profiler::ThreadBuffer &Profiler::getThreadBuffer() {
+        struct Owner {
+            ThreadBuffer *buffer = nullptr;
+
+            ~Owner() {
+                if (buffer != nullptr)
+                    buffer->owned.store(false, std::memory_order_release);
+            }
+        };
+
+        // the profiler is never destroyed, so neither are the buffers; they are reused instead, so short lived threads don't pile them up
+        thread_local Owner t_Owner;
+        if (t_Owner.buffer != nullptr)
+            return *t_Owner.buffer;
+
+        std::lock_guard lock(m_Mutex);
+        for (const auto &buffer : m_Buffers) {
+            if (!buffer->owned.load(std::memory_order_acquire)) {
+                buffer->owned.store(true, std::memory_order_relaxed);
+                t_Owner.buffer = buffer.get();
+                return *t_Owner.buffer;
+            }
+        }
+
+        auto buffer   = std::make_unique<ThreadBuffer>();
+        buffer->track = static_cast<uint32_t>(m_TrackNames.size());
+        m_TrackNames.push_back(std::format("thread {}", m_Buffers.size()));
+        t_Owner.buffer = m_Buffers.emplace_back(std::move(buffer)).get();
+        return *t_Owner.buffer;
+    }
+
+    void Profiler::collectLocked() {
+        for (const auto &buffer : m_Buffers) {
+            const uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+            const uint64_t head = buffer->head.load(std::memory_order_acquire);
+            for (uint64_t i = tail; i < head; i++) {
+                m_Events.push_back(buffer->events[i % EVENTS_PER_THREAD]);
+            }
+            buffer->tail.store(head, std::memory_order_release);
+            m_Recorded += head - tail;
+        }
+    }
+
+} // namespace neuron::utils
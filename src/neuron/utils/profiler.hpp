@@ -0,0 +1,185 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace neuron::utils {
+
+    /**
+     * A finished scope. Times are nanoseconds on the steady clock, see Profiler::now().
+     */
+    struct ProfileEvent {
+        const char *name;
+        uint64_t    begin;
+        uint64_t    end;
+        uint32_t    track;
+    };
+
+    struct ProfilerStats {
+        uint64_t recorded = 0;
+
+        /**
+         * Events lost because a thread's buffer was full when it recorded them, i.e. collect() wasn't called often enough.
+         */
+        uint64_t dropped = 0;
+    };
+
+    /**
+     *
+     * Collects timed scopes from any thread. Every thread records into its own fixed size ring buffer, which only that thread writes and only collect() reads, so recording
+     * takes no locks and costs two clock reads. collect() moves what the threads recorded into one list, which is exported as a Chrome trace (chrome://tracing, Perfetto).
+     *
+     * Every thread is a track of the trace; threads that exited hand their track to the next new thread. Other timelines, like the GPU's, add tracks of their own and record onto them.
+     *
+     * Names are stored as pointers and must outlive the profiler: string literals, or intern() for anything else. There is one profiler per process. Use the
+     * NEURON_PROFILE_* macros in engine code, which compile to nothing unless NEURON_PROFILING is defined.
+     *
+     */
+    class Profiler final {
+      public:
+        static constexpr uint32_t EVENTS_PER_THREAD = 1 << 14;
+
+        static Profiler &get();
+
+        /**
+         * Nanoseconds on std::chrono::steady_clock, which is CLOCK_MONOTONIC on Linux and the performance counter on Windows.
+         */
+        [[nodiscard]] static inline uint64_t now() noexcept {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        Profiler(const Profiler &)            = delete;
+        Profiler &operator=(const Profiler &) = delete;
+
+        /**
+         * Disabled profilers drop everything recorded. Enabled by default.
+         */
+        inline void setEnabled(bool enabled) noexcept { m_Enabled.store(enabled, std::memory_order_relaxed); }
+
+        [[nodiscard]] inline bool isEnabled() const noexcept { return m_Enabled.load(std::memory_order_relaxed); }
+
+        /**
+         * Records onto the calling thread's track.
+         */
+        void record(const char *name, uint64_t begin, uint64_t end) noexcept;
+
+        /**
+         * Records onto another track, from the calling thread's buffer.
+         */
+        void record(uint32_t track, const char *name, uint64_t begin, uint64_t end) noexcept;
+
+        /**
+         * Names the calling thread's track in the trace.
+         */
+        void setThreadName(std::string name);
+
+        /**
+         * A track for a timeline that isn't a thread.
+         */
+        [[nodiscard]] uint32_t addTrack(std::string name);
+
+        /**
+         * A copy of name which lives as long as the profiler. Takes a lock, so better done once than per scope.
+         */
+        [[nodiscard]] const char *intern(std::string_view name);
+
+        /**
+         * Moves the events recorded since the last call out of the thread buffers. Call it regularly (once a frame) while profiling, threads drop events once their buffer
+         * is full.
+         */
+        void collect();
+
+        /**
+         * Collects, then returns and forgets every collected event.
+         */
+        [[nodiscard]] std::vector<ProfileEvent> takeEvents();
+
+        /**
+         * Collects, then writes the collected events as Chrome trace event JSON. The events stay collected.
+         */
+        [[nodiscard]] std::string toChromeTrace();
+
+        /**
+         * @throws std::runtime_error if the file can't be written.
+         */
+        void writeChromeTrace(const std::filesystem::path &path);
+
+        /**
+         * Forgets every collected event and everything still in the thread buffers.
+         */
+        void clear();
+
+        [[nodiscard]] ProfilerStats getStats() const;
+
+      private:
+        struct ThreadBuffer {
+            std::unique_ptr<ProfileEvent[]> events = std::make_unique<ProfileEvent[]>(EVENTS_PER_THREAD);
+            uint32_t                        track  = 0;
+
+            // released when the thread exits, the next new thread takes the buffer over along with its track
+            std::atomic<bool> owned = true;
+
+            // the owning thread advances head, collect() advances tail
+            alignas(64) std::atomic<uint64_t> head    = 0;
+            std::atomic<uint64_t>             dropped = 0;
+            alignas(64) std::atomic<uint64_t> tail    = 0;
+        };
+
+        Profiler() = default;
+
+        std::atomic<bool> m_Enabled = true;
+
+        mutable std::mutex                         m_Mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> m_Buffers;
+        std::vector<std::string>                   m_TrackNames;
+        std::vector<ProfileEvent>                  m_Events;
+        std::unordered_set<std::string>            m_Names;
+        uint64_t                                   m_Recorded = 0;
+
+        ThreadBuffer &getThreadBuffer();
+        void          collectLocked();
+    };
+
+    /**
+     * Records the time from its construction to its destruction.
+     */
+    class ProfileScope final {
+      public:
+        // a disabled profiler skips the clock reads too
+        explicit ProfileScope(const char *name) noexcept : m_Name(name), m_Begin(Profiler::get().isEnabled() ? Profiler::now() : 0) {}
+
+        ~ProfileScope() {
+            if (m_Begin != 0)
+                Profiler::get().record(m_Name, m_Begin, Profiler::now());
+        }
+
+        ProfileScope(const ProfileScope &)            = delete;
+        ProfileScope &operator=(const ProfileScope &) = delete;
+
+      private:
+        const char *m_Name;
+        uint64_t    m_Begin;
+    };
+
+} // namespace neuron::utils
+
+#define NEURON_PROFILE_CONCAT_IMPL(a, b) a##b
+#define NEURON_PROFILE_CONCAT(a, b)      NEURON_PROFILE_CONCAT_IMPL(a, b)
+
+#if defined(NEURON_PROFILING)
+#define NEURON_PROFILE_SCOPE(name)   const ::neuron::utils::ProfileScope NEURON_PROFILE_CONCAT(neuronProfileScope, __LINE__)(name)
+#define NEURON_PROFILE_FUNCTION()    NEURON_PROFILE_SCOPE(__func__)
+#define NEURON_PROFILE_THREAD(name)  ::neuron::utils::Profiler::get().setThreadName(name)
+#else
+#define NEURON_PROFILE_SCOPE(name)   ((void) 0)
+#define NEURON_PROFILE_FUNCTION()    ((void) 0)
+#define NEURON_PROFILE_THREAD(name)  ((void) 0)
+#endif
@@ -0,0 +1,50 @@
+#include "startup.hpp"
+
+#include <algorithm>
+#include <format>
+
+namespace neuron::utils {
+
+    void StartupTimings::add(const char *name, uint64_t begin, uint64_t end) {
+        {
+            std::lock_guard lock(m_Mutex);
+            m_Phases.push_back({name, begin, end});
+        }
+
+#if defined(NEURON_PROFILING)
+        Profiler::get().record(name, begin, end);
+#endif
+    }
+
+    std::vector<StartupPhase> StartupTimings::getPhases() const {
+        std::vector<StartupPhase> phases;
+        {
+            std::lock_guard lock(m_Mutex);
+            phases = m_Phases;
+        }
+
+        std::ranges::stable_sort(phases, {}, &StartupPhase::begin);
+        return phases;
+    }
+
+    uint64_t StartupTimings::getWallNanoseconds() const {
+        std::lock_guard lock(m_Mutex);
+        if (m_Phases.empty())
+            return 0;
+
+        const auto begin = std::ranges::min(m_Phases, {}, &StartupPhase::begin).begin;
+        const auto end   = std::ranges::max(m_Phases, {}, &StartupPhase::end).end;
+        return end - begin;
+    }
+
+    std::string StartupTimings::format() const {
+        std::string result = std::format("{:.2f} ms (", static_cast<double>(getWallNanoseconds()) / 1e6);
+
+        const auto phases = getPhases();
+        for (size_t i = 0; i < phases.size(); i++) {
+            result += std::format("{}{} {:.2f} ms", i > 0 ? ", " : "", phases[i].name, phases[i].getMilliseconds());
+        }
+        return result + ")";
+    }
+
+} // namespace neuron::utils
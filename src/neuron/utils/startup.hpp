@@ -0,0 +1,73 @@
+#pragma once
+
+#include "neuron/utils/profiler.hpp"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace neuron::utils {
+
+    /**
+     * A named step of bringing a subsystem up. Times are nanoseconds on the steady clock, see Profiler::now().
+     */
+    struct StartupPhase {
+        const char *name;
+        uint64_t    begin;
+        uint64_t    end;
+
+        [[nodiscard]] inline double getMilliseconds() const noexcept { return static_cast<double>(end - begin) / 1e6; }
+    };
+
+    /**
+     *
+     * Times the phases of a subsystem's startup. Phases may run concurrently on different threads, so the wall time is measured from the first begin to the last end
+     * instead of summed. Subsystems created on first use add their phase when that happens. With NEURON_PROFILING the phases also go to the profiler. Names must
+     * outlive the timings, like string literals. Thread safe.
+     *
+     */
+    class StartupTimings final {
+      public:
+        /**
+         * Runs fn as a phase and returns what it returns. Phases that throw are recorded up to the throw.
+         */
+        template<typename F> decltype(auto) measure(const char *name, F &&fn) {
+            const Scope scope(*this, name);
+            return std::forward<F>(fn)();
+        }
+
+        void add(const char *name, uint64_t begin, uint64_t end);
+
+        /**
+         * In the order they started.
+         */
+        [[nodiscard]] std::vector<StartupPhase> getPhases() const;
+
+        /**
+         * From the start of the first phase to the end of the last one.
+         */
+        [[nodiscard]] uint64_t getWallNanoseconds() const;
+
+        /**
+         * "4.21 ms (loggers 0.05 ms, instance 3.80 ms, ...)", for the log.
+         */
+        [[nodiscard]] std::string format() const;
+
+      private:
+        struct Scope {
+            StartupTimings &timings;
+            const char     *name;
+            uint64_t        begin = Profiler::now();
+
+            Scope(StartupTimings &timings, const char *name) : timings(timings), name(name) {}
+
+            ~Scope() { timings.add(name, begin, Profiler::now()); }
+        };
+
+        mutable std::mutex        m_Mutex;
+        std::vector<StartupPhase> m_Phases;
+    };
+
+} // namespace neuron::utils
@@ -0,0 +1,7 @@
+// the one translation unit that compiles the stb implementations
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
@@ -1 +1,29 @@
 #include "utils.hpp"
+
+#include <bit>
+#include <format>
+
+namespace neuron::utils {
+    std::string Hash128::toString() const { return std::format("{:016x}{:016x}", high, low); }
+
+    Hasher &Hasher::update(std::span<const std::byte> data) noexcept {
+        for (const std::byte b : data) {
+            m_Fnv = (m_Fnv ^ static_cast<uint64_t>(b)) * 0x100000001b3ULL;
+            m_Mix = std::rotl((m_Mix ^ static_cast<uint64_t>(b)) * 0xff51afd7ed558ccdULL, 29);
+        }
+        return *this;
+    }
+
+    Hasher &Hasher::update(std::string_view text) noexcept {
+        updateValue(static_cast<uint64_t>(text.size()));
+        return update(std::as_bytes(std::span(text.data(), text.size())));
+    }
+
+    Hash128 Hasher::finish() const noexcept {
+        // final avalanche so similar inputs don't produce similar keys
+        uint64_t mix = m_Mix ^ (m_Mix >> 33);
+        mix *= 0xc4ceb9fe1a85ec53ULL;
+        mix ^= mix >> 33;
+        return {m_Fnv, mix};
+    }
+} // namespace neuron::utils
@@ -1,6 +1,10 @@
 #pragma once
 
 #include <cinttypes>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
 
 #include <vulkan/vulkan.hpp>
 
@@ -19,4 +23,42 @@ namespace neuron::utils {
         return arr;
     };
 
-}
+    struct Hash128 {
+        uint64_t low = 0, high = 0;
+
+        [[nodiscard]] std::string toString() const;
+
+        [[nodiscard]] constexpr bool operator==(const Hash128 &) const = default;
+    };
+
+    /**
+     * Incremental content hash for cache keys. FNV-1a and a multiply-rotate mix run side by side so the 128 bit result stays usable as a file name without collisions.
+     * Not cryptographic.
+     */
+    class Hasher {
+      public:
+        Hasher &update(std::span<const std::byte> data) noexcept;
+
+        /**
+         * Length prefixed, so "ab" + "c" and "a" + "bc" differ.
+         */
+        Hasher &update(std::string_view text) noexcept;
+
+        template<typename T>
+            requires std::is_trivially_copyable_v<T>
+        Hasher &updateValue(const T &value) noexcept {
+            return update(std::as_bytes(std::span(&value, 1)));
+        }
+
+        [[nodiscard]] Hash128 finish() const noexcept;
+
+      private:
+        uint64_t m_Fnv = 0xcbf29ce484222325ULL;
+        uint64_t m_Mix = 0x9e3779b97f4a7c15ULL;
+    };
+
+} // namespace neuron::utils
+
+template<> struct std::hash<neuron::utils::Hash128> {
+    size_t operator()(const neuron::utils::Hash128 &hash) const noexcept { return static_cast<size_t>(hash.low ^ (hash.high * 0x9e3779b97f4a7c15ULL)); }
+};
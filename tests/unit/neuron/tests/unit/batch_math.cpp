@@ -0,0 +1,204 @@
+#include "gtest/gtest.h"
+
+#include "neuron/math/batch.hpp"
+
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace neuron::math;
+
+namespace {
+    std::vector<SimdLevel> levels() {
+        std::vector<SimdLevel> result;
+        for (const SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE, SimdLevel::AVX2}) {
+            if (level <= getSupportedSimdLevel())
+                result.push_back(level);
+        }
+        return result;
+    }
+
+    glm::mat4 randomAffine(std::mt19937 &random) {
+        std::uniform_real_distribution<float> value(-2.f, 2.f);
+        glm::mat4                             matrix(1.f);
+        for (int c = 0; c < 4; c++)
+            for (int r = 0; r < 3; r++)
+                matrix[c][r] = value(random);
+        return matrix;
+    }
+
+    void expectNear(const glm::mat4 &actual, const glm::mat4 &expected) {
+        for (int c = 0; c < 4; c++)
+            for (int r = 0; r < 4; r++)
+                EXPECT_NEAR(actual[c][r], expected[c][r], 1e-3f * (1.f + std::abs(expected[c][r])));
+    }
+
+    // a cube of half size 10 with one face replaced by a tilted plane, so not every normal is axis aligned
+    std::array<glm::vec4, 6> cubePlanes() {
+        const float tilt = 1.f / std::sqrt(2.f);
+        return {glm::vec4(1, 0, 0, 10), glm::vec4(-1, 0, 0, 10), glm::vec4(0, 1, 0, 10), glm::vec4(0, -1, 0, 10), glm::vec4(0, tilt, tilt, 8), glm::vec4(0, 0, -1, 10)};
+    }
+
+    class SimdLevelScope {
+      public:
+        explicit SimdLevelScope(SimdLevel level) : m_Previous(getSimdLevel()) { setSimdLevel(level); }
+        ~SimdLevelScope() { setSimdLevel(m_Previous); }
+
+      private:
+        SimdLevel m_Previous;
+    };
+} // namespace
+
+TEST(BatchMath, ContainersPadAndKeepElements) {
+    TransformSoA transforms(5);
+    EXPECT_EQ(transforms.getCapacity(), SIMD_WIDTH);
+
+    std::mt19937    random(1);
+    const glm::mat4 matrix = randomAffine(random);
+    transforms.set(4, matrix);
+    transforms.resize(100);
+    EXPECT_EQ(transforms.get(4), matrix);
+    EXPECT_EQ(transforms.stream(0)[99], 0.f);
+
+    transforms.resize(3);
+    transforms.resize(5);
+    EXPECT_EQ(transforms.get(4), glm::mat4(0.f));
+}
+
+TEST(BatchMath, MultiplyMatchesGlm) {
+    constexpr size_t count = 1003;
+    std::mt19937     random(7);
+
+    TransformSoA a(count), b(count), result;
+    for (size_t i = 0; i < count; i++) {
+        a.set(i, randomAffine(random));
+        b.set(i, randomAffine(random));
+    }
+
+    for (const SimdLevel level : levels()) {
+        SimdLevelScope scope(level);
+        multiplyTransforms(a, b, result);
+        ASSERT_EQ(result.size(), count);
+        for (size_t i = 0; i < count; i++)
+            expectNear(result.get(i), a.get(i) * b.get(i));
+    }
+}
+
+TEST(BatchMath, HierarchyMatchesGlm) {
+    constexpr size_t      count = 1000;
+    std::mt19937          random(11);
+    TransformSoA          local(count), world;
+    std::vector<uint32_t> parents(count);
+
+    // mostly far away parents, with runs of siblings that share a block with their parent
+    for (size_t i = 0; i < count; i++) {
+        local.set(i, randomAffine(random));
+        if (i == 0 || random() % 10 == 0)
+            parents[i] = NO_PARENT;
+        else if (random() % 4 == 0)
+            parents[i] = static_cast<uint32_t>(i - 1);
+        else
+            parents[i] = static_cast<uint32_t>(random() % i);
+    }
+
+    std::vector<glm::mat4> expected(count);
+    for (size_t i = 0; i < count; i++)
+        expected[i] = parents[i] == NO_PARENT ? local.get(i) : expected[parents[i]] * local.get(i);
+
+    for (const SimdLevel level : levels()) {
+        SimdLevelScope scope(level);
+        propagateHierarchy(local, parents, world);
+        for (size_t i = 0; i < count; i++)
+            expectNear(world.get(i), expected[i]);
+    }
+
+    parents[5] = 5;
+    EXPECT_THROW(propagateHierarchy(local, parents, world), std::runtime_error);
+}
+
+TEST(BatchMath, TransformedAabbsEncloseTheCorners) {
+    constexpr size_t                      count = 517;
+    std::mt19937                          random(3);
+    std::uniform_real_distribution<float> value(-5.f, 5.f);
+
+    TransformSoA transforms(count);
+    AabbSoA      bounds(count), result;
+    for (size_t i = 0; i < count; i++) {
+        transforms.set(i, randomAffine(random));
+        const glm::vec3 a(value(random), value(random), value(random));
+        const glm::vec3 b(value(random), value(random), value(random));
+        bounds.set(i, glm::min(a, b), glm::max(a, b));
+    }
+
+    for (const SimdLevel level : levels()) {
+        SimdLevelScope scope(level);
+        transformAabbs(transforms, bounds, result);
+
+        for (size_t i = 0; i < count; i++) {
+            glm::vec3 min(INFINITY), max(-INFINITY);
+            for (int corner = 0; corner < 8; corner++) {
+                const glm::vec3 local(corner & 1 ? bounds.getMax(i).x : bounds.getMin(i).x, corner & 2 ? bounds.getMax(i).y : bounds.getMin(i).y,
+                                      corner & 4 ? bounds.getMax(i).z : bounds.getMin(i).z);
+                const glm::vec3 point = glm::vec3(transforms.get(i) * glm::vec4(local, 1.f));
+                min                   = glm::min(min, point);
+                max                   = glm::max(max, point);
+            }
+
+            for (int axis = 0; axis < 3; axis++) {
+                EXPECT_NEAR(result.getMin(i)[axis], min[axis], 1e-3f);
+                EXPECT_NEAR(result.getMax(i)[axis], max[axis], 1e-3f);
+            }
+        }
+    }
+}
+
+TEST(BatchMath, CullingMatchesTheReference) {
+    constexpr size_t                      count = 2029;
+    std::mt19937                          random(5);
+    std::uniform_real_distribution<float> position(-20.f, 20.f);
+    std::uniform_real_distribution<float> size(0.f, 4.f);
+
+    SphereSoA spheres(count);
+    AabbSoA   boxes(count);
+    for (size_t i = 0; i < count; i++) {
+        const glm::vec3 center(position(random), position(random), position(random));
+        const glm::vec3 extent(size(random), size(random), size(random));
+        spheres.set(i, glm::vec4(center, size(random)));
+        boxes.set(i, center - extent, center + extent);
+    }
+
+    const auto planes = cubePlanes();
+
+    std::vector<uint8_t> expectedSpheres(count), expectedBoxes(count);
+    size_t               sphereCount = 0, boxCount = 0;
+    for (size_t i = 0; i < count; i++) {
+        bool sphereInside = true, boxInside = true;
+        for (const glm::vec4 &plane : planes) {
+            const glm::vec4 sphere = spheres.get(i);
+            sphereInside &= glm::dot(glm::vec3(plane), glm::vec3(sphere)) + plane.w >= -sphere.w;
+
+            // the most positive corner along the normal
+            const glm::vec3 corner(plane.x >= 0 ? boxes.getMax(i).x : boxes.getMin(i).x, plane.y >= 0 ? boxes.getMax(i).y : boxes.getMin(i).y,
+                                   plane.z >= 0 ? boxes.getMax(i).z : boxes.getMin(i).z);
+            boxInside &= glm::dot(glm::vec3(plane), corner) + plane.w >= 0.f;
+        }
+        expectedSpheres[i] = sphereInside;
+        expectedBoxes[i]   = boxInside;
+        sphereCount += sphereInside;
+        boxCount += boxInside;
+    }
+    ASSERT_GT(sphereCount, 0);
+    ASSERT_LT(sphereCount, count);
+
+    for (const SimdLevel level : levels()) {
+        SimdLevelScope       scope(level);
+        std::vector<uint8_t> visible(count, 0xff);
+
+        EXPECT_EQ(cullSpheres(planes, spheres, visible), sphereCount);
+        EXPECT_EQ(visible, expectedSpheres);
+
+        EXPECT_EQ(cullAabbs(planes, boxes, visible), boxCount);
+        EXPECT_EQ(visible, expectedBoxes);
+    }
+}
@@ -0,0 +1,117 @@
+#include "gtest/gtest.h"
+
+#include "neuron/graphics/commands.hpp"
+#include "neuron/tests/unit/vulkan_fixture.hpp"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <random>
+#include <set>
+#include <thread>
+
+using namespace neuron::graphics;
+
+class Commands : public neuron::tests::VulkanTest {
+  protected:
+    void SetUp() override {
+        VulkanTest::SetUp();
+        if (IsSkipped())
+            return;
+
+        const auto &device = s_GC->getDevice();
+        m_Pool             = device.createCommandPool(vk::CommandPoolCreateInfo({}, s_GC->getQueueFamily(QueueType::Primary).value()));
+        m_Primary          = device.allocateCommandBuffers(vk::CommandBufferAllocateInfo(m_Pool, vk::CommandBufferLevel::ePrimary, 1)).front();
+        m_Target           = s_GC->getAllocator().createBuffer(vk::BufferCreateInfo({}, sizeof(uint32_t), vk::BufferUsageFlagBits::eTransferDst, vk::SharingMode::eExclusive),
+                                                               vk::MemoryPropertyFlagBits::eHostVisible);
+    }
+
+    void TearDown() override {
+        if (m_Pool) {
+            s_GC->getDevice().destroyCommandPool(m_Pool);
+            s_GC->getAllocator().destroy(m_Target);
+        }
+    }
+
+    /**
+     * Every secondary overwrites the same word after a barrier, so the word ends up holding the key of whichever buffer was executed last.
+     */
+    void recordOnThreads(CommandRecorder &recorder, std::span<const uint32_t> keys, uint32_t threadCount) const {
+        const vk::CommandBufferInheritanceInfo inheritance;
+        std::vector<std::jthread>              threads;
+        for (uint32_t t = 0; t < threadCount; t++) {
+            threads.emplace_back([&, t] {
+                for (size_t i = t; i < keys.size(); i += threadCount) {
+                    recorder.record(keys[i], inheritance, [&](vk::CommandBuffer cmd) {
+                        const vk::MemoryBarrier barrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eTransferWrite);
+                        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {}, barrier, {}, {});
+                        cmd.fillBuffer(m_Target.buffer, 0, sizeof(uint32_t), keys[i]);
+                    });
+                }
+            });
+        }
+    }
+
+    uint32_t submit(CommandRecorder &recorder) const {
+        m_Primary.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+        recorder.execute(m_Primary);
+        m_Primary.end();
+
+        const vk::Fence fence = s_GC->getDevice().createFence(vk::FenceCreateInfo());
+        s_GC->submit(s_GC->getPrimaryQueue(), vk::SubmitInfo({}, {}, m_Primary), fence);
+        (void)s_GC->getDevice().waitForFences(fence, true, UINT64_MAX);
+        s_GC->getDevice().destroyFence(fence);
+
+        s_GC->getAllocator().invalidate(m_Target.allocation);
+        return *static_cast<const uint32_t *>(m_Target.allocation.mapped);
+    }
+
+    vk::CommandPool   m_Pool;
+    vk::CommandBuffer m_Primary;
+    AllocatedBuffer   m_Target;
+};
+
+TEST_F(Commands, ExecutesInKeyOrder) {
+    CommandRecorder recorder(s_GC);
+
+    std::vector<uint32_t> keys(256);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+
+    recorder.beginFrame(0);
+    recordOnThreads(recorder, keys, 4);
+
+    EXPECT_EQ(recorder.getRecordedCount(), keys.size());
+    EXPECT_EQ(submit(recorder), 255);
+}
+
+TEST_F(Commands, PoolsAreRecycledPerFrame) {
+    CommandRecorder recorder(s_GC, 2);
+
+    const std::vector<uint32_t>                   keys = {5, 3, 9, 1};
+    std::array<std::vector<vk::CommandBuffer>, 2> firstUse;
+    for (uint32_t frame = 0; frame < 6; frame++) {
+        recorder.beginFrame(frame % 2);
+        EXPECT_EQ(recorder.getRecordedCount(), 0);
+
+        // the same thread records every frame, so its pools are reset and their buffers handed out again instead of new ones being allocated
+        std::vector<vk::CommandBuffer> used;
+        for (uint32_t key : keys)
+            recorder.record(key, {}, [&](vk::CommandBuffer cmd) { used.push_back(cmd); });
+        EXPECT_EQ(recorder.getRecordedCount(), keys.size());
+        (void)submit(recorder);
+
+        if (frame < 2)
+            firstUse[frame] = used;
+        else
+            EXPECT_EQ(used, firstUse[frame % 2]);
+    }
+
+    // each frame slot has its own pool
+    std::set<vk::CommandBuffer> distinct(firstUse[0].begin(), firstUse[0].end());
+    distinct.insert(firstUse[1].begin(), firstUse[1].end());
+    EXPECT_EQ(distinct.size(), 2 * keys.size());
+
+    EXPECT_EQ(recorder.getThreadCount(), 1);
+    EXPECT_THROW(recorder.beginFrame(2), std::runtime_error);
+}
@@ -0,0 +1,269 @@
+#include "gtest/gtest.h"
+
+#include "neuron/graphics/compute.hpp"
+#include "neuron/tests/unit/vulkan_fixture.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+using namespace neuron::graphics;
+
+class Compute : public neuron::tests::VulkanTest {
+  protected:
+    void SetUp() override {
+        VulkanTest::SetUp();
+        if (IsSkipped())
+            return;
+        if (!s_GC->supportsTimelineSemaphores())
+            GTEST_SKIP() << "Compute service needs timeline semaphores";
+
+        m_Primitives = std::make_unique<ComputePrimitives>(s_GC, m_Shaders);
+    }
+
+    void TearDown() override { m_Primitives.reset(); }
+
+    ComputeService &compute() { return s_GC->getComputeService(); }
+
+    template<typename T> DeviceBuffer<T> upload(const std::vector<T> &data) {
+        DeviceBuffer<T> buffer(*s_GC, data.size());
+        compute().write(buffer, std::span<const T>(data));
+        return buffer;
+    }
+
+    static std::vector<uint32_t> randomValues(size_t count, uint32_t max, uint32_t seed) {
+        std::mt19937                            random(seed);
+        std::uniform_int_distribution<uint32_t> distribution(0, max);
+
+        std::vector<uint32_t> values(count);
+        for (auto &value : values)
+            value = distribution(random);
+        return values;
+    }
+
+    ShaderCompiler                     m_Shaders;
+    std::unique_ptr<ComputePrimitives> m_Primitives;
+};
+
+TEST_F(Compute, KernelFromSpirvWithPushConstants) {
+    const ShaderSource source{.name  = "scale.comp",
+                              .code  = "#version 450\n"
+                                       "layout(local_size_x = 64) in;\n"
+                                       "layout(set = 0, binding = 0, std430) buffer Data { uint data[]; };\n"
+                                       "layout(push_constant) uniform Params { uint count; uint factor; };\n"
+                                       "void main() { uint i = gl_GlobalInvocationID.x; if (i < count) data[i] *= factor; }\n",
+                              .stage = ShaderStage::Compute};
+    const ComputeKernel kernel(*s_GC, {.name = "scale", .spirv = m_Shaders.compile(source), .bufferCount = 1, .pushConstantSize = 8});
+
+    std::vector<uint32_t> data(1000);
+    std::iota(data.begin(), data.end(), 0);
+    DeviceBuffer<uint32_t> buffer = upload(data);
+
+    const std::array<uint32_t, 2> params = {1000, 3};
+    ComputeBatch                  batch  = compute().begin();
+    batch.dispatch(kernel, {buffer}, params, (1000 + 63) / 64);
+    const ComputeToken token = compute().submit(std::move(batch));
+
+    compute().wait(token);
+    EXPECT_TRUE(compute().isComplete(token));
+
+    const std::vector<uint32_t> result = compute().read(buffer);
+    for (uint32_t i = 0; i < 1000; i++)
+        EXPECT_EQ(result[i], i * 3);
+
+    // the layout is checked before anything is recorded
+    ComputeBatch wrong = compute().begin();
+    EXPECT_THROW((wrong.dispatch(kernel, {buffer, buffer}, params, 1)), std::runtime_error);
+    EXPECT_THROW(wrong.dispatch(kernel, {buffer}, uint32_t{1}, 1), std::runtime_error);
+}
+
+TEST_F(Compute, TokensCompleteInSubmitOrder) {
+    DeviceBuffer<uint32_t> buffer(*s_GC, 4096, ComputeMemory::Host);
+
+    std::vector<ComputeToken> tokens;
+    for (uint32_t i = 0; i < 40; i++) {
+        ComputeBatch batch = compute().begin();
+        batch.fill(buffer, i);
+        tokens.push_back(compute().submit(std::move(batch)));
+    }
+
+    // more batches than maxBatchesInFlight, so begin() had to recycle slots
+    compute().wait(tokens.back());
+    for (const ComputeToken &token : tokens)
+        EXPECT_TRUE(compute().isComplete(token));
+    for (const uint32_t value : buffer.getHostData())
+        EXPECT_EQ(value, 39u);
+
+    // a dropped batch is discarded, not submitted
+    const uint64_t submitted = compute().getStats().batchesSubmitted;
+    {
+        ComputeBatch batch = compute().begin();
+        batch.fill(buffer, 7);
+    }
+    EXPECT_EQ(compute().getStats().batchesSubmitted, submitted);
+    EXPECT_EQ(compute().read(buffer, 1)[0], 39u);
+}
+
+TEST_F(Compute, UploadAndScratchInOneBatch) {
+    std::vector<uint32_t> data(100000);
+    std::iota(data.begin(), data.end(), 5);
+
+    DeviceBuffer<uint32_t> result(*s_GC, data.size());
+    ComputeBatch           batch   = compute().begin();
+    const ComputeBinding   scratch = batch.allocateScratch(data.size() * sizeof(uint32_t));
+    batch.upload(scratch, std::as_bytes(std::span(data)));
+    batch.copy(scratch, result);
+    compute().wait(compute().submit(std::move(batch)));
+
+    EXPECT_EQ(compute().read(result), data);
+}
+
+TEST_F(Compute, ReduceMatchesCpu) {
+    for (const size_t count : {size_t{0}, size_t{1}, size_t{2047}, size_t{2048}, size_t{2049}, size_t{100000}, size_t{(1 << 20) + 3}}) {
+        const std::vector<uint32_t> values = randomValues(count, 1000, static_cast<uint32_t>(count));
+        DeviceBuffer<uint32_t>      input  = upload(values);
+        DeviceBuffer<uint32_t>      sum(*s_GC, 1), min(*s_GC, 1), max(*s_GC, 1);
+
+        ComputeBatch batch = compute().begin();
+        m_Primitives->reduce(batch, input, sum, ReduceOp::Add);
+        m_Primitives->reduce(batch, input, min, ReduceOp::Min);
+        m_Primitives->reduce(batch, input, max, ReduceOp::Max);
+        compute().wait(compute().submit(std::move(batch)));
+
+        EXPECT_EQ(compute().read(sum)[0], std::accumulate(values.begin(), values.end(), 0u)) << count;
+        EXPECT_EQ(compute().read(min)[0], count == 0 ? UINT32_MAX : *std::ranges::min_element(values)) << count;
+        EXPECT_EQ(compute().read(max)[0], count == 0 ? 0u : *std::ranges::max_element(values)) << count;
+    }
+}
+
+TEST_F(Compute, ReduceSignedAndFloat) {
+    std::mt19937                           random(3);
+    std::uniform_int_distribution<int32_t> ints(-100000, 100000);
+    std::uniform_real_distribution<float>  floats(0.f, 1.f);
+
+    std::vector<int32_t> intValues(300000);
+    std::vector<float>   floatValues(300000);
+    for (size_t i = 0; i < intValues.size(); i++) {
+        intValues[i]   = ints(random);
+        floatValues[i] = floats(random);
+    }
+
+    DeviceBuffer<int32_t> intInput   = upload(intValues);
+    DeviceBuffer<float>   floatInput = upload(floatValues);
+    DeviceBuffer<int32_t> intMin(*s_GC, 1);
+    DeviceBuffer<float>   floatSum(*s_GC, 1), floatMax(*s_GC, 1);
+
+    ComputeBatch batch = compute().begin();
+    m_Primitives->reduce(batch, intInput, intMin, ReduceOp::Min);
+    m_Primitives->reduce(batch, floatInput, floatSum, ReduceOp::Add);
+    m_Primitives->reduce(batch, floatInput, floatMax, ReduceOp::Max);
+    compute().wait(compute().submit(std::move(batch)));
+
+    EXPECT_EQ(compute().read(intMin)[0], *std::ranges::min_element(intValues));
+    EXPECT_EQ(compute().read(floatMax)[0], *std::ranges::max_element(floatValues));
+
+    // summed in a different order than on the CPU
+    const double expected = std::accumulate(floatValues.begin(), floatValues.end(), 0.0);
+    EXPECT_NEAR(compute().read(floatSum)[0], expected, expected * 1e-4);
+}
+
+TEST_F(Compute, ExclusiveScanMatchesCpu) {
+    // one tile, two levels, three levels
+    for (const size_t count : {size_t{1}, size_t{2000}, size_t{2049}, size_t{300000}, size_t{(1 << 22) + 17}}) {
+        const std::vector<uint32_t> values = randomValues(count, 100, static_cast<uint32_t>(count));
+        DeviceBuffer<uint32_t>      input  = upload(values);
+        DeviceBuffer<uint32_t>      output(*s_GC, count);
+
+        ComputeBatch batch = compute().begin();
+        m_Primitives->exclusiveScan(batch, input, output);
+        compute().wait(compute().submit(std::move(batch)));
+
+        std::vector<uint32_t> expected(count);
+        std::exclusive_scan(values.begin(), values.end(), expected.begin(), 0u);
+        EXPECT_EQ(compute().read(output), expected) << count;
+    }
+}
+
+TEST_F(Compute, ExclusiveScanInPlace) {
+    const std::vector<uint32_t> values = randomValues(50000, 1000, 11);
+    DeviceBuffer<uint32_t>      buffer = upload(values);
+
+    ComputeBatch batch = compute().begin();
+    m_Primitives->exclusiveScan(batch, buffer, buffer);
+    compute().wait(compute().submit(std::move(batch)));
+
+    std::vector<uint32_t> expected(values.size());
+    std::exclusive_scan(values.begin(), values.end(), expected.begin(), 0u);
+    EXPECT_EQ(compute().read(buffer), expected);
+}
+
+TEST_F(Compute, CompactKeepsOrder) {
+    for (const size_t count : {size_t{0}, size_t{1}, size_t{5000}, size_t{250000}}) {
+        std::vector<uint32_t> values(count);
+        std::iota(values.begin(), values.end(), 0);
+
+        // flags other than 1 count as set too
+        std::vector<uint32_t> flags = randomValues(count, 3, static_cast<uint32_t>(count) + 1);
+        for (auto &flag : flags)
+            flag = flag == 0 ? 0 : flag * 2;
+
+        DeviceBuffer<uint32_t> valueBuffer = upload(values);
+        DeviceBuffer<uint32_t> flagBuffer  = upload(flags);
+        DeviceBuffer<uint32_t> output(*s_GC, count);
+        DeviceBuffer<uint32_t> kept(*s_GC, 1);
+
+        ComputeBatch batch = compute().begin();
+        batch.fill(kept, 12345);
+        m_Primitives->compact(batch, valueBuffer, flagBuffer, output, kept);
+        compute().wait(compute().submit(std::move(batch)));
+
+        std::vector<uint32_t> expected;
+        for (size_t i = 0; i < count; i++) {
+            if (flags[i] != 0)
+                expected.push_back(values[i]);
+        }
+
+        const uint32_t keptCount = compute().read(kept)[0];
+        ASSERT_EQ(keptCount, expected.size()) << count;
+        EXPECT_EQ(compute().read(output, keptCount), expected) << count;
+    }
+}
+
+TEST_F(Compute, RadixSortMatchesStableSort) {
+    for (const size_t count : {size_t{1}, size_t{2}, size_t{1000}, size_t{1025}, size_t{200000}}) {
+        const std::vector<uint32_t> keys      = randomValues(count, UINT32_MAX, static_cast<uint32_t>(count));
+        DeviceBuffer<uint32_t>      keyBuffer = upload(keys);
+
+        ComputeBatch batch = compute().begin();
+        m_Primitives->radixSort(batch, keyBuffer);
+        compute().wait(compute().submit(std::move(batch)));
+
+        std::vector<uint32_t> expected = keys;
+        std::ranges::sort(expected);
+        EXPECT_EQ(compute().read(keyBuffer), expected) << count;
+    }
+}
+
+TEST_F(Compute, RadixSortMovesValuesStably) {
+    // few distinct keys, so stability shows; 12 bits is an odd number of passes
+    const size_t                count = 100000;
+    const std::vector<uint32_t> keys  = randomValues(count, 4095, 7);
+    std::vector<uint32_t>       values(count);
+    std::iota(values.begin(), values.end(), 0);
+
+    DeviceBuffer<uint32_t> keyBuffer   = upload(keys);
+    DeviceBuffer<uint32_t> valueBuffer = upload(values);
+
+    ComputeBatch batch = compute().begin();
+    m_Primitives->radixSort(batch, keyBuffer, &valueBuffer, 12);
+    compute().wait(compute().submit(std::move(batch)));
+
+    std::ranges::stable_sort(values, [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+    std::vector<uint32_t> expectedKeys(count);
+    for (size_t i = 0; i < count; i++)
+        expectedKeys[i] = keys[values[i]];
+
+    EXPECT_EQ(compute().read(keyBuffer), expectedKeys);
+    EXPECT_EQ(compute().read(valueBuffer), values);
+}
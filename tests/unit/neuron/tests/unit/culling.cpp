@@ -0,0 +1,270 @@
+#include "gtest/gtest.h"
+
+#include "neuron/graphics/culling.hpp"
+#include "neuron/tests/unit/vulkan_fixture.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <set>
+
+using namespace neuron::graphics;
+
+class Culling : public neuron::tests::VulkanTest {
+  protected:
+    static constexpr uint32_t BATCH_COUNT         = 4;
+    static constexpr uint32_t INSTANCES_PER_BATCH = 1000;
+
+    void SetUp() override {
+        VulkanTest::SetUp();
+        if (IsSkipped())
+            return;
+
+        m_Pipelines = std::make_unique<PipelineManager>(s_GC, m_Shaders);
+
+        const auto &device = s_GC->getDevice();
+        m_Pool             = device.createCommandPool(vk::CommandPoolCreateInfo({}, s_GC->getQueueFamily(QueueType::Primary).value()));
+        m_Cmd              = device.allocateCommandBuffers(vk::CommandBufferAllocateInfo(m_Pool, vk::CommandBufferLevel::ePrimary, 1)).front();
+        m_Fence            = device.createFence(vk::FenceCreateInfo());
+
+        m_View.view       = glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+        m_View.projection = glm::perspectiveRH_ZO(glm::radians(60.f), 1.f, 0.1f, 100.f);
+        m_View.zNear      = 0.1f;
+    }
+
+    void TearDown() override {
+        if (!m_Pool)
+            return;
+
+        m_Culler.reset();
+        m_Pipelines.reset();
+        for (auto &buffer : m_Buffers)
+            s_GC->getAllocator().destroy(buffer);
+        s_GC->getDevice().destroyFence(m_Fence);
+        s_GC->getDevice().destroyCommandPool(m_Pool);
+    }
+
+    GpuCuller &culler() {
+        m_Culler = std::make_unique<GpuCuller>(s_GC, *m_Pipelines, CullerSettings{.framesInFlight = 1, .maxInstances = 1 << 14, .maxBatches = 64});
+        return *m_Culler;
+    }
+
+    template<typename T> vk::Buffer upload(const std::vector<T> &data) {
+        auto &buffer = m_Buffers.emplace_back(
+            m_Culler->createBuffer(data.size() * sizeof(T), vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eHostVisible));
+        std::memcpy(buffer.allocation.mapped, data.data(), data.size() * sizeof(T));
+        s_GC->getAllocator().flush(buffer.allocation);
+        return buffer.buffer;
+    }
+
+    // instances whose sphere clearly is inside or outside the frustum, so float differences between CPU and GPU don't matter
+    std::vector<CullInstance> makeInstances() const {
+        const auto   planes = extractFrustumPlanes(m_View.projection * m_View.view);
+        std::mt19937 random(11);
+
+        std::vector<CullInstance> instances;
+        while (instances.size() < BATCH_COUNT * INSTANCES_PER_BATCH) {
+            const glm::vec3 center(static_cast<float>(random() % 2000) / 10.f - 100.f, static_cast<float>(random() % 400) / 10.f - 20.f,
+                                   -static_cast<float>(random() % 1200) / 10.f + 10.f);
+            const float     radius = 0.5f;
+
+            float margin = std::numeric_limits<float>::max();
+            for (const glm::vec4 &plane : planes)
+                margin = std::min(margin, glm::dot(glm::vec3(plane), center) + plane.w + radius);
+            if (std::abs(margin) < 0.01f)
+                continue;
+
+            instances.push_back({.sphere = glm::vec4(center, radius), .batch = static_cast<uint32_t>(instances.size() % BATCH_COUNT)});
+        }
+        return instances;
+    }
+
+    static bool isInsideFrustum(const CullInstance &instance, const std::array<glm::vec4, 6> &planes) {
+        return std::ranges::all_of(planes, [&](const glm::vec4 &plane) { return glm::dot(glm::vec3(plane), glm::vec3(instance.sphere)) + plane.w >= -instance.sphere.w; });
+    }
+
+    std::vector<CullBatch> makeBatches() const {
+        std::vector<CullBatch> batches;
+        for (uint32_t batch = 0; batch < BATCH_COUNT; batch++)
+            batches.push_back({.indexCount = 36 + batch, .firstIndex = batch * 100, .vertexOffset = -static_cast<int32_t>(batch), .firstInstance = batch * INSTANCES_PER_BATCH});
+        return batches;
+    }
+
+    struct Results {
+        uint32_t                                    count = 0;
+        std::vector<vk::DrawIndexedIndirectCommand> commands;
+        std::vector<uint32_t>                       visible;
+    };
+
+    // copies the outputs of frame 0 to the host, after whatever record() recorded into m_Cmd
+    Results readBack(uint32_t batchCount, uint32_t instanceCount) {
+        const vk::DeviceSize commandBytes = batchCount * sizeof(vk::DrawIndexedIndirectCommand);
+        const vk::DeviceSize visibleBytes = instanceCount * sizeof(uint32_t);
+
+        auto staging = s_GC->getAllocator().createBuffer(vk::BufferCreateInfo({}, sizeof(uint32_t) + commandBytes + visibleBytes, vk::BufferUsageFlagBits::eTransferDst,
+                                                                              vk::SharingMode::eExclusive),
+                                                         vk::MemoryPropertyFlagBits::eHostVisible);
+
+        m_Cmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eDrawIndirect, vk::PipelineStageFlagBits::eTransfer, {},
+                              vk::MemoryBarrier(vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eTransferRead), {}, {});
+        m_Cmd.copyBuffer(m_Culler->getCountBuffer(0), staging.buffer, vk::BufferCopy(0, 0, sizeof(uint32_t)));
+        m_Cmd.copyBuffer(m_Culler->getCommandBuffer(0), staging.buffer, vk::BufferCopy(0, sizeof(uint32_t), commandBytes));
+        m_Cmd.copyBuffer(m_Culler->getVisibleBuffer(0), staging.buffer, vk::BufferCopy(0, sizeof(uint32_t) + commandBytes, visibleBytes));
+        m_Cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {},
+                              vk::MemoryBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead), {}, {});
+        m_Cmd.end();
+
+        s_GC->submit(s_GC->getPrimaryQueue(), vk::SubmitInfo({}, {}, m_Cmd), m_Fence);
+        (void)s_GC->getDevice().waitForFences(m_Fence, true, UINT64_MAX);
+        s_GC->getDevice().resetFences(m_Fence);
+        s_GC->getAllocator().invalidate(staging.allocation);
+
+        Results     results;
+        const auto *bytes = static_cast<const std::byte *>(staging.allocation.mapped);
+        std::memcpy(&results.count, bytes, sizeof(uint32_t));
+        results.commands.resize(batchCount);
+        std::memcpy(results.commands.data(), bytes + sizeof(uint32_t), commandBytes);
+        results.visible.resize(instanceCount);
+        std::memcpy(results.visible.data(), bytes + sizeof(uint32_t) + commandBytes, visibleBytes);
+
+        s_GC->getAllocator().destroy(staging);
+        return results;
+    }
+
+    // every batch with survivors has exactly one command, listing exactly the instances the CPU finds visible
+    void expectMatchesReference(const Results &results, const std::vector<CullInstance> &instances, const std::vector<CullBatch> &batches) {
+        const auto planes = extractFrustumPlanes(m_View.projection * m_View.view);
+
+        std::vector<std::set<uint32_t>> expected(batches.size());
+        for (uint32_t i = 0; i < instances.size(); i++) {
+            if (isInsideFrustum(instances[i], planes))
+                expected[instances[i].batch].insert(i);
+        }
+
+        // without drawIndirectCount every batch has its command in place and nothing is counted
+        const bool     counted = m_Culler->supportsIndirectCount();
+        const uint32_t draws   = counted ? results.count : static_cast<uint32_t>(batches.size());
+        if (counted) {
+            const auto nonEmpty = std::ranges::count_if(expected, [](const auto &set) { return !set.empty(); });
+            ASSERT_EQ(results.count, static_cast<uint32_t>(nonEmpty));
+        }
+
+        std::set<uint32_t> seen;
+        for (uint32_t draw = 0; draw < draws; draw++) {
+            const auto &command = results.commands[draw];
+            const auto  batch   = command.firstInstance / INSTANCES_PER_BATCH;
+            ASSERT_LT(batch, batches.size());
+            EXPECT_TRUE(seen.insert(batch).second);
+            EXPECT_EQ(command.indexCount, batches[batch].indexCount);
+            EXPECT_EQ(command.firstIndex, batches[batch].firstIndex);
+            EXPECT_EQ(command.vertexOffset, batches[batch].vertexOffset);
+
+            const std::set<uint32_t> visible(results.visible.begin() + command.firstInstance, results.visible.begin() + command.firstInstance + command.instanceCount);
+            EXPECT_EQ(command.instanceCount, visible.size());
+            EXPECT_EQ(visible, expected[batch]);
+        }
+    }
+
+    ShaderCompiler                   m_Shaders;
+    std::unique_ptr<PipelineManager> m_Pipelines;
+    std::unique_ptr<GpuCuller>       m_Culler;
+    std::vector<AllocatedBuffer>     m_Buffers;
+
+    vk::CommandPool   m_Pool;
+    vk::CommandBuffer m_Cmd;
+    vk::Fence         m_Fence;
+    CullView          m_View;
+};
+
+TEST(Frustum, PlanesPointInwards) {
+    const glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(90.f), 1.f, 0.5f, 100.f);
+    const auto      planes     = extractFrustumPlanes(projection);
+    const auto      distance   = [&](int plane, glm::vec3 point) { return glm::dot(glm::vec3(planes[plane]), point) + planes[plane].w; };
+
+    for (int plane = 0; plane < 6; plane++)
+        EXPECT_GT(distance(plane, {0.f, 0.f, -10.f}), 0.f);
+
+    // normalized, so these are distances in view space
+    EXPECT_NEAR(distance(4, {0.f, 0.f, 0.f}), -0.5f, 1e-4f);
+    EXPECT_NEAR(distance(5, {0.f, 0.f, -110.f}), -10.f, 1e-3f);
+    EXPECT_NEAR(distance(0, {-20.f, 0.f, -10.f}), -10.f * std::sqrt(0.5f), 1e-3f);
+    EXPECT_LT(distance(3, {0.f, 20.f, -10.f}), 0.f);
+}
+
+TEST_F(Culling, FrustumCullingMatchesTheCpu) {
+    auto      &gpu       = culler();
+    const auto instances = makeInstances();
+    const auto batches   = makeBatches();
+    const CullInputs inputs{upload(instances), static_cast<uint32_t>(instances.size()), upload(batches), static_cast<uint32_t>(batches.size())};
+
+    m_Cmd.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+    gpu.record(m_Cmd, 0, inputs, m_View);
+    expectMatchesReference(readBack(inputs.batchCount, inputs.instanceCount), instances, batches);
+}
+
+TEST_F(Culling, AsyncSubmitSignalsTheTimeline) {
+    if (!s_GC->supportsTimelineSemaphores())
+        GTEST_SKIP() << "No timeline semaphores";
+
+    auto      &gpu       = culler();
+    const auto instances = makeInstances();
+    const auto batches   = makeBatches();
+    const CullInputs inputs{upload(instances), static_cast<uint32_t>(instances.size()), upload(batches), static_cast<uint32_t>(batches.size())};
+
+    const uint64_t value = gpu.submitAsync(0, inputs, m_View);
+    ASSERT_EQ(s_GC->getDevice().waitSemaphores(vk::SemaphoreWaitInfo({}, gpu.getTimeline(), value), UINT64_MAX), vk::Result::eSuccess);
+
+    m_Cmd.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+    expectMatchesReference(readBack(inputs.batchCount, inputs.instanceCount), instances, batches);
+}
+
+TEST_F(Culling, HiZRejectsOccludedInstances) {
+    auto &gpu = culler();
+
+    // a wall at depth 0.99, about 9 units away with this projection
+    auto depth = s_GC->getAllocator().createImage(vk::ImageCreateInfo({}, vk::ImageType::e2D, vk::Format::eR32Sfloat, vk::Extent3D(37, 23, 1), 1, 1,
+                                                                      vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal,
+                                                                      vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst, vk::SharingMode::eExclusive),
+                                                  vk::MemoryPropertyFlagBits::eDeviceLocal);
+    const auto view = s_GC->getDevice().createImageView(
+        vk::ImageViewCreateInfo({}, depth.image, vk::ImageViewType::e2D, vk::Format::eR32Sfloat, STANDARD_COMPONENT_MAPPING, BASIC_ISR));
+
+    const std::vector<CullInstance> instances = {
+        {.sphere = {0.f, 0.f, -3.f, 0.5f}, .batch = 0},
+        {.sphere = {1.f, 0.f, -50.f, 0.5f}, .batch = 0},
+        {.sphere = {0.f, 1.f, -8.f, 0.5f}, .batch = 1},
+        {.sphere = {0.f, 0.f, -80.f, 5.f}, .batch = 1},
+    };
+    const std::vector<CullBatch> batches = {{.indexCount = 3, .firstInstance = 0}, {.indexCount = 6, .firstInstance = 2}};
+    const CullInputs             inputs{upload(instances), 4, upload(batches), 2};
+
+    m_Cmd.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+    m_Cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, {}, {},
+                          vk::ImageMemoryBarrier({}, vk::AccessFlagBits::eTransferWrite, vk::ImageLayout::eUndefined, vk::ImageLayout::eGeneral, VK_QUEUE_FAMILY_IGNORED,
+                                                 VK_QUEUE_FAMILY_IGNORED, depth.image, BASIC_ISR));
+    m_Cmd.clearColorImage(depth.image, vk::ImageLayout::eGeneral, vk::ClearColorValue(std::array<float, 4>{0.99f, 0.f, 0.f, 0.f}), BASIC_ISR);
+    m_Cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {},
+                          vk::MemoryBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead), {}, {});
+
+    gpu.buildHiZ(m_Cmd, 0, view, vk::ImageLayout::eGeneral, {37, 23});
+    gpu.record(m_Cmd, 0, inputs, {.view = m_View.view, .projection = m_View.projection, .zNear = m_View.zNear, .occlusion = true});
+    const auto results = readBack(2, 4);
+
+    // the instances in front of the wall survive, the ones behind it don't, however large; without drawIndirectCount both commands are in place
+    if (gpu.supportsIndirectCount())
+        ASSERT_EQ(results.count, 2);
+
+    std::set<uint32_t> survivors;
+    for (uint32_t draw = 0; draw < 2; draw++) {
+        EXPECT_EQ(results.commands[draw].instanceCount, 1);
+        survivors.insert(results.visible[results.commands[draw].firstInstance]);
+    }
+    EXPECT_EQ(survivors, std::set<uint32_t>({0, 2}));
+
+    s_GC->getDevice().destroyImageView(view);
+    s_GC->getAllocator().destroy(depth);
+}
@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+
+#include "neuron/graphics/descriptors.hpp"
+#include "neuron/tests/unit/vulkan_fixture.hpp"
+
+#include <algorithm>
+
+using namespace neuron::graphics;
+
+class Descriptors : public neuron::tests::VulkanTest {
+  protected:
+    void SetUp() override {
+        VulkanTest::SetUp();
+        if (IsSkipped())
+            return;
+
+        m_Buffer = s_GC->getAllocator().createBuffer(vk::BufferCreateInfo({}, 1024, vk::BufferUsageFlagBits::eStorageBuffer, vk::SharingMode::eExclusive),
+                                                     vk::MemoryPropertyFlagBits::eDeviceLocal);
+    }
+
+    void TearDown() override {
+        if (m_Buffer.buffer)
+            s_GC->getAllocator().destroy(m_Buffer);
+    }
+
+    AllocatedBuffer m_Buffer;
+};
+
+TEST_F(Descriptors, BindlessIndicesAreRecycledAfterFramesInFlight) {
+    if (!s_GC->getFastPaths().descriptorIndexing)
+        GTEST_SKIP() << "No descriptor indexing";
+
+    BindlessHeap heap(s_GC, {.storageBuffers = 4, .framesInFlight = 2});
+    EXPECT_EQ(heap.getCapacity(BindlessType::StorageBuffer), 4);
+
+    std::vector<uint32_t> indices;
+    for (int i = 0; i < 4; i++)
+        indices.push_back(heap.registerStorageBuffer(m_Buffer.buffer, i * 256, 256));
+    EXPECT_EQ(indices, (std::vector<uint32_t>{0, 1, 2, 3}));
+    EXPECT_THROW((void)heap.registerStorageBuffer(m_Buffer.buffer), std::runtime_error);
+
+    // frames still in flight may use index 2, so it comes back only once both began again
+    heap.release(BindlessType::StorageBuffer, 2);
+    EXPECT_EQ(heap.getUsedCount(BindlessType::StorageBuffer), 4);
+    EXPECT_THROW(heap.release(BindlessType::StorageBuffer, 2), std::runtime_error);
+    heap.beginFrame();
+    EXPECT_THROW((void)heap.registerStorageBuffer(m_Buffer.buffer), std::runtime_error);
+    heap.beginFrame();
+    EXPECT_EQ(heap.getUsedCount(BindlessType::StorageBuffer), 3);
+    EXPECT_EQ(heap.registerStorageBuffer(m_Buffer.buffer), 2);
+
+    // the arrays are independent
+    EXPECT_EQ(heap.getUsedCount(BindlessType::SampledImage), 0);
+    EXPECT_THROW(heap.release(BindlessType::StorageImage, 0), std::runtime_error);
+}
+
+TEST_F(Descriptors, BindlessArraysShareThePerStageBudget) {
+    if (!s_GC->getFastPaths().descriptorIndexing)
+        GTEST_SKIP() << "No descriptor indexing";
+
+    const auto     properties = s_GC->getGpu().getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceVulkan12Properties>().get<vk::PhysicalDeviceVulkan12Properties>();
+    const uint32_t budget     = properties.maxPerStageUpdateAfterBindResources;
+    if (budget > (1u << 22))
+        GTEST_SKIP() << "Per stage budget too large to fill in a test";
+
+    // every array asks for the whole budget, which only fits once they are scaled down
+    BindlessHeap   heap(s_GC, {.sampledImages = budget, .storageImages = budget, .storageBuffers = budget});
+    const uint64_t total = uint64_t{heap.getCapacity(BindlessType::SampledImage)} + heap.getCapacity(BindlessType::StorageImage) +
+                           heap.getCapacity(BindlessType::StorageBuffer);
+    EXPECT_LE(total, budget);
+
+    // proportionally, not by wrapping around
+    if (std::min(properties.maxDescriptorSetUpdateAfterBindStorageBuffers, properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers) >= budget)
+        EXPECT_GE(heap.getCapacity(BindlessType::StorageBuffer), budget / 3);
+}
+
+TEST_F(Descriptors, FramePoolsGrowAndResetInBulk) {
+    const vk::DescriptorSetLayoutBinding binding(0, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute);
+    const auto layout = s_GC->getDevice().createDescriptorSetLayout(vk::DescriptorSetLayoutCreateInfo({}, binding));
+
+    FrameDescriptorAllocator allocator(s_GC, {.framesInFlight = 2, .setsPerPool = 4, .descriptorsPerSet = {{vk::DescriptorType::eStorageBuffer, 1}}});
+    for (uint32_t frame = 0; frame < 6; frame++) {
+        allocator.beginFrame(frame % 2);
+
+        std::vector<vk::DescriptorSet> sets;
+        for (int i = 0; i < 10; i++)
+            sets.push_back(allocator.allocate(layout));
+
+        const vk::DescriptorBufferInfo info(m_Buffer.buffer, 0, VK_WHOLE_SIZE);
+        s_GC->getDevice().updateDescriptorSets(vk::WriteDescriptorSet(sets.back(), 0, 0, vk::DescriptorType::eStorageBuffer, {}, info), {});
+
+        // 10 sets need 3 pools of 4 per frame; once both frames have theirs, resetting reuses them
+        EXPECT_EQ(allocator.getPoolCount(), frame == 0 ? 3 : 6);
+    }
+    EXPECT_THROW(allocator.beginFrame(2), std::runtime_error);
+
+    s_GC->getDevice().destroyDescriptorSetLayout(layout);
+}
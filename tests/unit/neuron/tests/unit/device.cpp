@@ -0,0 +1,88 @@
+#include "gtest/gtest.h"
+
+#include "neuron/graphics/device.hpp"
+#include "neuron/tests/unit/vulkan_fixture.hpp"
+
+using namespace neuron::graphics;
+
+TEST(DeviceFeatures, SetOperations) {
+    DeviceFeatures supported;
+    supported.core.geometryShader        = true;
+    supported.vulkan12.timelineSemaphore = true;
+    supported.vulkan13.dynamicRendering  = true;
+
+    DeviceFeatures wanted;
+    wanted.vulkan12.timelineSemaphore = true;
+    EXPECT_TRUE(supported.contains(wanted));
+
+    wanted.vulkan13.synchronization2 = true;
+    EXPECT_FALSE(supported.contains(wanted));
+    EXPECT_EQ(supported.listMissing(wanted), std::vector<std::string>{"synchronization2"});
+
+    const DeviceFeatures both = supported.intersect(wanted);
+    EXPECT_EQ(both.count(), 1);
+    EXPECT_TRUE(both.vulkan12.timelineSemaphore);
+
+    supported |= wanted;
+    EXPECT_TRUE(supported.contains(wanted));
+    EXPECT_EQ(supported.count(), 4);
+}
+
+TEST(DeviceFeatures, FastPathsNeedAllTheirFeatures) {
+    DeviceFeatures features;
+    features.vulkan12.descriptorIndexing = true;
+    EXPECT_FALSE(FastPaths::from(features).descriptorIndexing);
+
+    features.vulkan12.runtimeDescriptorArray          = true;
+    features.vulkan12.descriptorBindingPartiallyBound = true;
+    EXPECT_TRUE(FastPaths::from(features).descriptorIndexing);
+}
+
+TEST(DeviceSelection, PrimaryQueueFamilyNeedNotBeTheFirst) {
+    using Flags = vk::QueueFlagBits;
+
+    const std::vector<vk::QueueFamilyProperties> families = {
+        {Flags::eTransfer, 2},
+        {Flags::eGraphics | Flags::eTransfer, 1},
+        {Flags::eGraphics | Flags::eCompute | Flags::eTransfer, 16},
+    };
+    EXPECT_EQ(findPrimaryQueueFamily(families), 2u);
+    EXPECT_EQ(findPrimaryQueueFamily(std::span(families).first(2)), 1u);
+    EXPECT_EQ(findPrimaryQueueFamily(std::span(families).first(1)), std::nullopt);
+}
+
+class DeviceSelectionTest : public neuron::tests::VulkanTest {};
+
+TEST_F(DeviceSelectionTest, PicksTheBestSuitableDevice) {
+    const vk::Instance instance   = neuron::Context::get()->getInstance();
+    const auto         candidates = rankDevices(instance, {});
+    ASSERT_FALSE(candidates.empty());
+
+    for (size_t i = 1; i < candidates.size(); i++) {
+        if (candidates[i].isSuitable())
+            EXPECT_GE(candidates[i - 1].score, candidates[i].score);
+    }
+
+    EXPECT_EQ(selectDevice(instance, {}, {}).gpu, candidates.front().gpu);
+    EXPECT_EQ(selectDevice(instance, {}, {.uuid = candidates.front().uuid}).gpu, candidates.front().gpu);
+}
+
+TEST_F(DeviceSelectionTest, MissingRequirementsReject) {
+    const vk::Instance instance = neuron::Context::get()->getInstance();
+
+    DeviceRequirements requirements;
+    requirements.requiredExtensions = {"VK_NEURON_not_an_extension"};
+    for (const auto &candidate : rankDevices(instance, requirements))
+        EXPECT_FALSE(candidate.isSuitable());
+    EXPECT_THROW((void)selectDevice(instance, requirements, {}), std::runtime_error);
+
+    EXPECT_THROW((void)selectDevice(instance, {}, {.uuid = "00000000-0000-0000-0000-000000000000"}), std::runtime_error);
+}
+
+TEST_F(DeviceSelectionTest, ReportsEnabledFeatures) {
+    const DeviceFeatures supported = DeviceFeatures::query(s_GC->getGpu());
+
+    EXPECT_TRUE(supported.contains(s_GC->getEnabledFeatures()));
+    EXPECT_EQ(s_GC->supportsTimelineSemaphores(), supported.vulkan12.timelineSemaphore == VK_TRUE);
+    EXPECT_EQ(s_GC->getFastPaths().synchronization2, supported.vulkan13.synchronization2 == VK_TRUE);
+}
@@ -0,0 +1,89 @@
+#include "gtest/gtest.h"
+
+#include "neuron/graphics/device_pool.hpp"
+#include "neuron/tests/unit/vulkan_fixture.hpp"
+
+#include <atomic>
+#include <stdexcept>
+
+using namespace neuron::graphics;
+
+using DevicePools = neuron::tests::VulkanTest;
+
+/**
+ * Fills a word on the job's own device and reads it back.
+ */
+static uint32_t fillAndRead(GContext &gc, uint32_t value) {
+    const vk::Device &device = gc.getDevice();
+
+    AllocatedBuffer       buffer = gc.getAllocator().createBuffer(vk::BufferCreateInfo({}, sizeof(uint32_t), vk::BufferUsageFlagBits::eTransferDst, vk::SharingMode::eExclusive),
+                                                                  vk::MemoryPropertyFlagBits::eHostVisible);
+    const vk::CommandPool pool   = device.createCommandPool(vk::CommandPoolCreateInfo({}, gc.getQueueFamily(QueueType::Primary).value()));
+    const vk::Fence       fence  = device.createFence(vk::FenceCreateInfo());
+
+    const vk::CommandBuffer cmd = device.allocateCommandBuffers(vk::CommandBufferAllocateInfo(pool, vk::CommandBufferLevel::ePrimary, 1)).front();
+    cmd.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+    cmd.fillBuffer(buffer.buffer, 0, sizeof(uint32_t), value);
+    const vk::MemoryBarrier barrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead);
+    cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {}, barrier, {}, {});
+    cmd.end();
+
+    gc.submit(gc.getPrimaryQueue(), vk::SubmitInfo({}, {}, cmd), fence);
+    (void) device.waitForFences(fence, true, UINT64_MAX);
+
+    gc.getAllocator().invalidate(buffer.allocation);
+    const uint32_t result = *static_cast<const uint32_t *>(buffer.allocation.mapped);
+
+    device.destroyFence(fence);
+    device.destroyCommandPool(pool);
+    gc.getAllocator().destroy(buffer);
+    return result;
+}
+
+TEST_F(DevicePools, SpreadsJobsOverLogicalDevices) {
+    DevicePool pool({.devices = {DeviceSelection{}}, .contextsPerDevice = 3});
+    ASSERT_EQ(pool.getSize(), 3);
+    EXPECT_NE(pool.getContext(0)->getDevice(), pool.getContext(1)->getDevice());
+    EXPECT_NE(pool.getContext(1)->getDevice(), pool.getContext(2)->getDevice());
+
+    const auto results = pool.map(48, [](const std::shared_ptr<GContext> &gc, uint32_t i) { return fillAndRead(*gc, i * 7 + 1); });
+    ASSERT_EQ(results.size(), 48);
+    for (uint32_t i = 0; i < results.size(); i++)
+        EXPECT_EQ(results[i], i * 7 + 1);
+
+    uint64_t completed = 0;
+    for (const auto &stats : pool.getStats()) {
+        EXPECT_GT(stats.completed, 0);
+        EXPECT_EQ(stats.outstanding, 0);
+        completed += stats.completed;
+    }
+    EXPECT_EQ(completed, 48);
+}
+
+TEST_F(DevicePools, RethrowsAfterEveryJobFinished) {
+    DevicePool pool({.devices = {DeviceSelection{}}, .contextsPerDevice = 2});
+
+    std::atomic<uint32_t> finished = 0;
+    EXPECT_THROW((void) pool.map(16,
+                                 [&](const std::shared_ptr<GContext> &, uint32_t i) {
+                                     finished++;
+                                     if (i == 3)
+                                         throw std::runtime_error("job failed");
+                                     return i;
+                                 }),
+                 std::runtime_error);
+    EXPECT_EQ(finished.load(), 16);
+
+    // the pool keeps working
+    EXPECT_EQ(pool.submit([](const std::shared_ptr<GContext> &gc) { return fillAndRead(*gc, 99); }).get(), 99);
+    pool.waitIdle();
+}
+
+TEST_F(DevicePools, UsesEverySuitableDeviceByDefault) {
+    DevicePool pool;
+    EXPECT_GE(pool.getSize(), 1);
+}
+
+TEST_F(DevicePools, RejectsZeroContextsPerDevice) {
+    EXPECT_THROW(DevicePool({.contextsPerDevice = 0}), std::runtime_error);
+}
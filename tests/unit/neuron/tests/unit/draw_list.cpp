@@ -0,0 +1,118 @@
+#include "gtest/gtest.h"
+
+#include "neuron/graphics/draw_list.hpp"
+
+#include <algorithm>
+#include <random>
+
+using namespace neuron::graphics;
+
+static entt::entity addRenderable(entt::registry &registry, Renderable renderable, float depth) {
+    const auto entity = registry.create();
+    registry.emplace<WorldTransform>(entity, WorldTransform{.matrix = glm::mat4(1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, -depth, 1.f)});
+    registry.emplace<Renderable>(entity, renderable);
+    return entity;
+}
+
+TEST(DrawList, RadixSortIsStable) {
+    std::mt19937_64         random(7);
+    std::vector<DrawPacket> packets(10000), scratch;
+    for (uint32_t i = 0; i < packets.size(); i++)
+        packets[i] = {.key = (random() % 4) << 60 | (random() % 100) << 16 | random() % 3, .object = i};
+
+    auto expected = packets;
+    std::ranges::stable_sort(expected, {}, &DrawPacket::key);
+    radixSortPackets(packets, scratch);
+
+    for (size_t i = 0; i < packets.size(); i++) {
+        EXPECT_EQ(packets[i].key, expected[i].key);
+        EXPECT_EQ(packets[i].object, expected[i].object);
+    }
+}
+
+TEST(DrawList, MergesRunsIntoInstancedDraws) {
+    entt::registry registry;
+    const auto     farthest = addRenderable(registry, {.mesh = 1, .material = 2, .pipeline = 1}, 30.f);
+    const auto     nearest  = addRenderable(registry, {.mesh = 1, .material = 2, .pipeline = 1}, 10.f);
+    addRenderable(registry, {.mesh = 1, .material = 2, .pipeline = 1}, 20.f);
+    addRenderable(registry, {.mesh = 3, .material = 2, .pipeline = 1}, 5.f);
+    addRenderable(registry, {.mesh = 1, .material = 1, .pipeline = 1}, 5.f);
+    addRenderable(registry, {.mesh = 1, .material = 2, .pipeline = 0, .pass = 1}, 1.f);
+
+    // without a Renderable it isn't drawn
+    registry.emplace<WorldTransform>(registry.create());
+
+    DrawList list;
+    list.extract(registry);
+
+    // by pass, pipeline, material and mesh
+    const auto &batches = list.getBatches();
+    ASSERT_EQ(batches.size(), 4);
+    EXPECT_EQ(batches[0].material, 1);
+    EXPECT_EQ(batches[1].mesh, 1);
+    EXPECT_EQ(batches[1].material, 2);
+    EXPECT_EQ(batches[1].instanceCount, 3);
+    EXPECT_EQ(batches[2].mesh, 3);
+    EXPECT_EQ(batches[3].pass, 1);
+    EXPECT_EQ(batches[3].pipeline, 0);
+
+    // the instances of a batch are contiguous and front to back
+    EXPECT_EQ(batches[1].firstInstance, 1);
+    EXPECT_EQ(list.getPackets()[1].entity, nearest);
+    EXPECT_EQ(list.getPackets()[3].entity, farthest);
+    EXPECT_EQ(list.getInstances()[1][3].z, -10.f);
+    EXPECT_EQ(list.getInstances()[3][3].z, -30.f);
+
+    EXPECT_EQ(list.getStats().drawsBeforeBatching, 6);
+    EXPECT_EQ(list.getStats().drawsAfterBatching, 4);
+}
+
+TEST(DrawList, BackToFrontPassesKeepTheBlendingOrder) {
+    entt::registry registry;
+    const auto     middle = addRenderable(registry, {.mesh = 1, .material = 1}, 20.f);
+    const auto     far    = addRenderable(registry, {.mesh = 1, .material = 1}, 30.f);
+    const auto     near   = addRenderable(registry, {.mesh = 2, .material = 1}, 10.f);
+
+    DrawList list;
+    list.extract(registry, {.backToFrontPasses = 1});
+
+    // depth goes before state, objects with the same mesh and material still share a draw where they end up adjacent
+    const auto &packets = list.getPackets();
+    ASSERT_EQ(packets.size(), 3);
+    EXPECT_EQ(packets[0].entity, far);
+    EXPECT_EQ(packets[1].entity, middle);
+    EXPECT_EQ(packets[2].entity, near);
+    ASSERT_EQ(list.getBatches().size(), 2);
+    EXPECT_EQ(list.getBatches()[0].instanceCount, 2);
+}
+
+TEST(DrawList, ParallelExtractionMatchesSerial) {
+    entt::registry registry;
+    std::mt19937   random(3);
+    for (int i = 0; i < 20000; i++) {
+        const Renderable renderable{.mesh     = static_cast<uint16_t>(random() % 16),
+                                    .material = static_cast<uint16_t>(random() % 8),
+                                    .pipeline = static_cast<uint16_t>(random() % 4),
+                                    .pass     = static_cast<uint8_t>(random() % 2)};
+        addRenderable(registry, renderable, static_cast<float>(random() % 500));
+    }
+
+    neuron::utils::JobSystem jobs({.workerCount = 4});
+    DrawList                 serial, parallel;
+    serial.extract(registry);
+    parallel.extract(registry, {.jobs = &jobs, .grain = 1000});
+
+    ASSERT_EQ(serial.getPackets().size(), parallel.getPackets().size());
+    for (size_t i = 0; i < serial.getPackets().size(); i++)
+        EXPECT_EQ(serial.getPackets()[i].key, parallel.getPackets()[i].key);
+    EXPECT_EQ(serial.getBatches().size(), parallel.getBatches().size());
+    EXPECT_LE(serial.getStats().drawsAfterBatching, 2 * 4 * 8 * 16);
+}
+
+TEST(DrawList, RejectsOutOfRangePasses) {
+    entt::registry registry;
+    addRenderable(registry, {.pass = MAX_DRAW_PASSES}, 1.f);
+
+    DrawList list;
+    EXPECT_THROW(list.extract(registry), std::runtime_error);
+}
@@ -0,0 +1,251 @@
+#include "gtest/gtest.h"
+
+#include "neuron/graphics/frame_capture.hpp"
+#include "neuron/tests/unit/vulkan_fixture.hpp"
+
+#include <array>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+#include <stb_image.h>
+
+using namespace neuron::graphics;
+
+namespace {
+    // a straight reading of the QOI specification, independent of the encoder
+    std::vector<std::byte> decodeQoi(const std::vector<std::byte> &file, uint32_t &width, uint32_t &height) {
+        const auto *data   = reinterpret_cast<const uint8_t *>(file.data());
+        const auto  read32 = [&](size_t at) { return uint32_t{data[at]} << 24 | uint32_t{data[at + 1]} << 16 | uint32_t{data[at + 2]} << 8 | uint32_t{data[at + 3]}; };
+
+        if (file.size() < 22 || std::string(reinterpret_cast<const char *>(data), 4) != "qoif")
+            throw std::runtime_error("not a QOI file");
+        width  = read32(4);
+        height = read32(8);
+
+        std::array<std::array<uint8_t, 4>, 64> seen{};
+        std::array<uint8_t, 4>                 pixel = {0, 0, 0, 255};
+        std::vector<std::byte>                 pixels;
+
+        size_t at = 14;
+        while (pixels.size() < static_cast<size_t>(width) * height * 4) {
+            const uint8_t op  = data[at++];
+            uint32_t      run = 1;
+
+            if (op == 0xfe) {
+                pixel = {data[at], data[at + 1], data[at + 2], pixel[3]};
+                at += 3;
+            } else if (op == 0xff) {
+                pixel = {data[at], data[at + 1], data[at + 2], data[at + 3]};
+                at += 4;
+            } else if ((op >> 6) == 0) {
+                pixel = seen[op];
+            } else if ((op >> 6) == 1) {
+                pixel[0] += ((op >> 4) & 3) - 2;
+                pixel[1] += ((op >> 2) & 3) - 2;
+                pixel[2] += (op & 3) - 2;
+            } else if ((op >> 6) == 2) {
+                const int     dg     = (op & 63) - 32;
+                const uint8_t second = data[at++];
+                pixel[0] += dg - 8 + (second >> 4);
+                pixel[1] += dg;
+                pixel[2] += dg - 8 + (second & 15);
+            } else {
+                run = (op & 63) + 1;
+            }
+
+            if ((op >> 6) != 3 || op >= 0xfe)
+                seen[(pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64] = pixel;
+            for (uint32_t i = 0; i < run; i++)
+                for (const uint8_t channel : pixel)
+                    pixels.push_back(static_cast<std::byte>(channel));
+        }
+
+        if (file.size() != at + 8)
+            throw std::runtime_error("QOI end marker missing");
+        return pixels;
+    }
+
+    std::vector<std::byte> readFile(const std::filesystem::path &path) {
+        std::ifstream           file(path, std::ios::binary);
+        const std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        return {reinterpret_cast<const std::byte *>(bytes.data()), reinterpret_cast<const std::byte *>(bytes.data()) + bytes.size()};
+    }
+
+    // flat areas, gradients, noise and alpha changes, so every QOI op shows up
+    std::vector<std::byte> testImage(uint32_t width, uint32_t height) {
+        std::mt19937           random(width * height);
+        std::vector<std::byte> pixels(static_cast<size_t>(width) * height * 4);
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) {
+                std::byte *pixel = &pixels[(static_cast<size_t>(y) * width + x) * 4];
+                if (y < height / 3) {
+                    pixel[0] = pixel[1] = pixel[2] = static_cast<std::byte>(x / 16 * 40);
+                    pixel[3]                       = std::byte{255};
+                } else if (y < height * 2 / 3) {
+                    pixel[0] = static_cast<std::byte>(x);
+                    pixel[1] = static_cast<std::byte>(x + y * 3);
+                    pixel[2] = static_cast<std::byte>(y);
+                    pixel[3] = static_cast<std::byte>(x % 7 == 0 ? 128 : 255);
+                } else {
+                    for (int c = 0; c < 4; c++)
+                        pixel[c] = static_cast<std::byte>(random());
+                }
+            }
+        }
+        return pixels;
+    }
+} // namespace
+
+TEST(FrameCaptureEncoding, QoiRoundTrips) {
+    for (const bool bgra : {false, true}) {
+        const std::vector<std::byte> pixels  = testImage(97, 61);
+        const std::vector<std::byte> encoded = FrameCapture::encodeQoi(pixels, 97, 61, bgra);
+
+        uint32_t                     width = 0, height = 0;
+        const std::vector<std::byte> decoded = decodeQoi(encoded, width, height);
+        EXPECT_EQ(width, 97u);
+        EXPECT_EQ(height, 61u);
+        ASSERT_EQ(decoded.size(), pixels.size());
+
+        for (size_t i = 0; i < pixels.size(); i += 4) {
+            const size_t red  = bgra ? i + 2 : i;
+            const size_t blue = bgra ? i : i + 2;
+            ASSERT_EQ(decoded[i], pixels[red]) << i;
+            ASSERT_EQ(decoded[i + 1], pixels[i + 1]) << i;
+            ASSERT_EQ(decoded[i + 2], pixels[blue]) << i;
+            ASSERT_EQ(decoded[i + 3], pixels[i + 3]) << i;
+        }
+    }
+
+    // a single color compresses to runs
+    const std::vector<std::byte> flat(256 * 256 * 4, std::byte{200});
+    EXPECT_LT(FrameCapture::encodeQoi(flat, 256, 256).size(), 2000u);
+}
+
+TEST(FrameCaptureEncoding, PngDecodesWithStb) {
+    const std::vector<std::byte> pixels  = testImage(40, 30);
+    const std::vector<std::byte> encoded = FrameCapture::encodePng(pixels, 40, 30, true);
+
+    int      width = 0, height = 0, channels = 0;
+    stbi_uc *decoded = stbi_load_from_memory(reinterpret_cast<const stbi_uc *>(encoded.data()), static_cast<int>(encoded.size()), &width, &height, &channels, 4);
+    ASSERT_NE(decoded, nullptr);
+    EXPECT_EQ(width, 40);
+    EXPECT_EQ(height, 30);
+    for (size_t i = 0; i < pixels.size(); i += 4) {
+        EXPECT_EQ(decoded[i], static_cast<stbi_uc>(pixels[i + 2]));
+        EXPECT_EQ(decoded[i + 2], static_cast<stbi_uc>(pixels[i]));
+    }
+    stbi_image_free(decoded);
+}
+
+class FrameCaptureTest : public neuron::tests::VulkanTest {
+  protected:
+    void SetUp() override {
+        VulkanTest::SetUp();
+        m_Directory = std::filesystem::temp_directory_path() / ("neuron_capture_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        std::filesystem::remove_all(m_Directory);
+    }
+
+    void TearDown() override { std::filesystem::remove_all(m_Directory); }
+
+    static void clearTo(vk::CommandBuffer cmd, vk::Image image, const std::array<float, 4> &color) {
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::PipelineStageFlagBits::eTransfer, {}, {}, {},
+                            vk::ImageMemoryBarrier(vk::AccessFlagBits::eColorAttachmentWrite, vk::AccessFlagBits::eTransferWrite, vk::ImageLayout::eColorAttachmentOptimal,
+                                                   vk::ImageLayout::eTransferDstOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image, BASIC_ISR));
+        cmd.clearColorImage(image, vk::ImageLayout::eTransferDstOptimal, vk::ClearColorValue(color), BASIC_ISR);
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eColorAttachmentOutput, {}, {}, {},
+                            vk::ImageMemoryBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eColorAttachmentWrite, vk::ImageLayout::eTransferDstOptimal,
+                                                   vk::ImageLayout::eColorAttachmentOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image, BASIC_ISR));
+    }
+
+    std::filesystem::path m_Directory;
+};
+
+TEST_F(FrameCaptureTest, WritesEveryFrameThroughASmallRing) {
+    ImageRenderTarget target(s_GC, {.extent = {64, 32}, .format = vk::Format::eR8G8B8A8Unorm, .imageCount = 2});
+
+    // more frames than buffers with one worker, so record() has to wait for it now and then
+    {
+        FrameCapture capture(s_GC, {.directory = m_Directory, .format = CaptureFormat::Raw, .ringSize = 2, .workerCount = 1});
+        for (uint8_t i = 0; i < 12; i++) {
+            const FrameContext frame = target.beginFrame();
+            clearTo(frame.commandBuffer, target.getImageTarget(frame.imageIndex), {i / 255.0f, 0.0f, 1.0f, 1.0f});
+            EXPECT_EQ(capture.record(frame, target), i);
+            target.endFrame();
+            capture.commit();
+        }
+        capture.flush();
+
+        const FrameCaptureStats stats = capture.getStats();
+        EXPECT_EQ(stats.framesCaptured, 12u);
+        EXPECT_EQ(stats.framesFailed, 0u);
+        EXPECT_EQ(stats.bytesWritten, 12u * 64 * 32 * 4);
+        EXPECT_TRUE(stats.framesPerSecond > 0.0);
+
+        // the image is back in its attachment layout, so the target's own readback still works
+        EXPECT_EQ(static_cast<uint8_t>(target.readback(1)[0]), 11);
+    }
+
+    for (uint8_t i = 0; i < 12; i++) {
+        const std::vector<std::byte> pixels = readFile(m_Directory / std::format("frame_{:06}.raw", i));
+        ASSERT_EQ(pixels.size(), 64u * 32 * 4);
+        EXPECT_EQ(static_cast<uint8_t>(pixels[0]), i);
+        EXPECT_EQ(static_cast<uint8_t>(pixels[pixels.size() - 2]), 255);
+    }
+}
+
+TEST_F(FrameCaptureTest, EncodesQoiAndPng) {
+    ImageRenderTarget target(s_GC, {.extent = {48, 20}, .format = vk::Format::eB8G8R8A8Unorm, .imageCount = 1});
+
+    for (const CaptureFormat format : {CaptureFormat::Qoi, CaptureFormat::Png}) {
+        FrameCapture capture(s_GC, {.directory = m_Directory, .prefix = format == CaptureFormat::Qoi ? "qoi_" : "png_", .format = format});
+
+        const FrameContext frame = target.beginFrame();
+        clearTo(frame.commandBuffer, target.getImageTarget(), {1.0f, 0.0f, 0.0f, 1.0f});
+        const uint64_t number = capture.record(frame, target);
+        target.endFrame();
+        capture.commit();
+        capture.flush();
+
+        // BGRA is stored as RGBA in both, red stays red
+        std::vector<std::byte> pixels;
+        const auto             file = readFile(capture.getPath(number));
+        if (format == CaptureFormat::Qoi) {
+            uint32_t width = 0, height = 0;
+            pixels = decodeQoi(file, width, height);
+        } else {
+            int      width = 0, height = 0, channels = 0;
+            stbi_uc *decoded = stbi_load_from_memory(reinterpret_cast<const stbi_uc *>(file.data()), static_cast<int>(file.size()), &width, &height, &channels, 4);
+            ASSERT_NE(decoded, nullptr);
+            pixels.assign(reinterpret_cast<const std::byte *>(decoded), reinterpret_cast<const std::byte *>(decoded) + width * height * 4);
+            stbi_image_free(decoded);
+        }
+
+        ASSERT_EQ(pixels.size(), 48u * 20 * 4);
+        EXPECT_EQ(static_cast<uint8_t>(pixels[0]), 255);
+        EXPECT_EQ(static_cast<uint8_t>(pixels[2]), 0);
+    }
+}
+
+TEST_F(FrameCaptureTest, RejectsMisuse) {
+    EXPECT_THROW(FrameCapture(s_GC, {.directory = m_Directory, .ringSize = 0}), std::runtime_error);
+
+    ImageRenderTarget target(s_GC, {.extent = {8, 8}, .format = vk::Format::eR32Sfloat, .imageCount = 1});
+    FrameCapture      capture(s_GC, {.directory = m_Directory});
+    EXPECT_THROW(capture.commit(), std::runtime_error);
+
+    // QOI needs 8-bit color; the frame still has to be submitted
+    const FrameContext frame = target.beginFrame();
+    EXPECT_THROW((void) capture.record(frame, target), std::runtime_error);
+    target.endFrame();
+
+    // without readback the images can't be copied from, like a swapchain without eTransferSrc
+    ImageRenderTarget unreadable(s_GC, {.extent = {8, 8}, .format = vk::Format::eR8G8B8A8Unorm, .imageCount = 1, .enableReadback = false});
+    EXPECT_FALSE(unreadable.getCurrentConfiguration().usage & vk::ImageUsageFlagBits::eTransferSrc);
+
+    const FrameContext unreadableFrame = unreadable.beginFrame();
+    EXPECT_THROW((void) capture.record(unreadableFrame, unreadable), std::runtime_error);
+    unreadable.endFrame();
+}
@@ -0,0 +1,167 @@
+#include "gtest/gtest.h"
+
+#include "neuron/graphics/resources.hpp"
+#include "neuron/tests/unit/vulkan_fixture.hpp"
+#include "neuron/utils/handle_pool.hpp"
+
+#include <string>
+
+using namespace neuron::graphics;
+using neuron::utils::HandlePool;
+
+namespace {
+    struct ThingTag;
+    using Things = HandlePool<ThingTag, uint32_t, std::string>;
+} // namespace
+
+TEST(HandlePool, CreateLookupAndRemove) {
+    Things things;
+    EXPECT_FALSE(things.isValid({}));
+
+    const Things::HandleType a = things.create(1, "a");
+    const Things::HandleType b = things.create(2, "b");
+    const Things::HandleType c = things.create(3, "c");
+    EXPECT_TRUE(a);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(things.size(), 3u);
+    EXPECT_EQ(things.get<0>(b), 2u);
+    EXPECT_EQ(things.get<1>(c), "c");
+
+    things.get<0>(a) = 10;
+    EXPECT_EQ(things.get<0>(a), 10u);
+
+    // the last object fills the hole, the handles to it still work
+    const auto [number, name] = things.remove(a);
+    EXPECT_EQ(number, 10u);
+    EXPECT_EQ(name, "a");
+    EXPECT_FALSE(things.isValid(a));
+    EXPECT_EQ(things.size(), 2u);
+    EXPECT_EQ(things.get<1>(b), "b");
+    EXPECT_EQ(things.get<1>(c), "c");
+    EXPECT_EQ(things.getDenseIndex(c), 0u);
+    EXPECT_EQ(things.getHandle(0), c);
+
+    uint32_t sum = 0;
+    for (const uint32_t value : things.getColumn<0>())
+        sum += value;
+    EXPECT_EQ(sum, 5u);
+
+    EXPECT_THROW(things.destroy(a), std::runtime_error);
+    EXPECT_EQ(Things::HandleType::fromValue(b.getValue()), b);
+}
+
+TEST(HandlePool, StaleHandlesStayStaleWhenSlotsAreReused) {
+    Things things;
+
+    const Things::HandleType first = things.create(0, "first");
+    things.destroy(first);
+
+    // freed slots wait in line before they are reused
+    std::vector<Things::HandleType> handles;
+    for (uint32_t i = 0; i < Things::MIN_FREE_SLOTS; i++)
+        handles.push_back(things.create(i, {}));
+    for (const auto handle : handles)
+        EXPECT_NE(handle.getIndex(), first.getIndex());
+
+    for (const auto handle : handles)
+        things.destroy(handle);
+
+    const Things::HandleType reused = things.create(7, "reused");
+    EXPECT_EQ(reused.getIndex(), first.getIndex());
+    EXPECT_NE(reused.getGeneration(), first.getGeneration());
+    EXPECT_FALSE(things.isValid(first));
+    EXPECT_TRUE(things.isValid(reused));
+
+    if constexpr (neuron::utils::VALIDATE_HANDLES) {
+        EXPECT_THROW((void) things.get<0>(first), std::runtime_error);
+        EXPECT_THROW((void) things.get<0>(Things::HandleType{}), std::runtime_error);
+    }
+}
+
+TEST(HandlePool, GenerationsWrapAroundPastZero) {
+    Things                          things;
+    std::vector<Things::HandleType> filler;
+    for (uint32_t i = 0; i <= Things::MIN_FREE_SLOTS; i++)
+        filler.push_back(things.create(i, {}));
+    for (const auto handle : filler)
+        things.destroy(handle);
+
+    // the free list now cycles through all its slots, so every slot runs through all its generations once
+    const uint32_t slots   = static_cast<uint32_t>(filler.size());
+    uint32_t       wrapped = 0, nullGenerations = 0, staleValid = 0;
+    for (uint32_t i = 0; i < slots * (Things::HandleType::MAX_GENERATION + 1); i++) {
+        const Things::HandleType handle = things.create(i, {});
+        nullGenerations += handle.getGeneration() == 0;
+        wrapped += handle.getIndex() == 0 && handle.getGeneration() == 1;
+        things.destroy(handle);
+
+        // slot 0 is free here, even when its generation came around to the first handle's again
+        staleValid += things.isValid(filler.front());
+    }
+    EXPECT_EQ(nullGenerations, 0u);
+    EXPECT_EQ(wrapped, 1u);
+    EXPECT_EQ(staleValid, 0u);
+}
+
+class Resources : public neuron::tests::VulkanTest {};
+
+TEST_F(Resources, DestructionWaitsForFramesInFlight) {
+    ResourceRegistry registry(s_GC, {.framesInFlight = 2});
+
+    const BufferHandle buffer =
+        registry.createBuffer(vk::BufferCreateInfo({}, 4096, vk::BufferUsageFlagBits::eStorageBuffer, vk::SharingMode::eExclusive), vk::MemoryPropertyFlagBits::eDeviceLocal);
+    const ImageHandle image =
+        registry.createImage(vk::ImageCreateInfo({}, vk::ImageType::e2D, vk::Format::eR8G8B8A8Unorm, vk::Extent3D(32, 16, 1), 1, 1, vk::SampleCountFlagBits::e1,
+                                                 vk::ImageTiling::eOptimal, vk::ImageUsageFlagBits::eSampled, vk::SharingMode::eExclusive, {}, vk::ImageLayout::eUndefined),
+                             vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    EXPECT_TRUE(registry.getBuffer(buffer));
+    EXPECT_EQ(registry.getSize(buffer), 4096u);
+    EXPECT_TRUE(registry.getImageView(image));
+    EXPECT_EQ(registry.getExtent(image), vk::Extent3D(32, 16, 1));
+    EXPECT_EQ(registry.getFormat(image), vk::Format::eR8G8B8A8Unorm);
+    EXPECT_EQ(registry.getStats().buffers, 1u);
+    EXPECT_EQ(registry.getStats().images, 1u);
+
+    // the handles go stale right away, the Vulkan objects stay until frame 0 can't be in flight anymore
+    registry.destroy(buffer);
+    registry.destroy(image);
+    EXPECT_FALSE(registry.isValid(buffer));
+    EXPECT_FALSE(registry.isValid(image));
+    EXPECT_THROW(registry.destroy(buffer), std::runtime_error);
+    EXPECT_EQ(registry.getStats().pendingDestruction, 2u);
+
+    registry.nextFrame();
+    EXPECT_EQ(registry.getStats().pendingDestruction, 2u);
+    registry.nextFrame();
+    EXPECT_EQ(registry.getStats().pendingDestruction, 0u);
+    EXPECT_EQ(registry.getStats().destroyed, 2u);
+}
+
+TEST_F(Resources, BatchesPerFrameAndTeardown) {
+    ResourceRegistry registry(s_GC, {.framesInFlight = 3});
+    const auto       createInfo = vk::BufferCreateInfo({}, 256, vk::BufferUsageFlagBits::eTransferDst, vk::SharingMode::eExclusive);
+
+    // one destroyed per frame; each is destroyed three frames later
+    std::vector<BufferHandle> live;
+    for (uint32_t frame = 0; frame < 10; frame++) {
+        live.push_back(registry.createBuffer(createInfo, vk::MemoryPropertyFlagBits::eDeviceLocal));
+        live.push_back(registry.createBuffer(createInfo, vk::MemoryPropertyFlagBits::eDeviceLocal));
+        registry.destroy(live.front());
+        live.erase(live.begin());
+
+        EXPECT_LE(registry.getStats().pendingDestruction, 3u);
+        registry.nextFrame();
+    }
+
+    EXPECT_EQ(registry.getStats().buffers, 10u);
+    EXPECT_EQ(registry.getStats().pendingDestruction, 2u);
+    for (const BufferHandle handle : live)
+        EXPECT_TRUE(registry.isValid(handle));
+
+    registry.collectAll();
+    EXPECT_EQ(registry.getStats().pendingDestruction, 0u);
+    EXPECT_EQ(registry.getStats().destroyed, 10u);
+
+    EXPECT_THROW(ResourceRegistry(s_GC, {.framesInFlight = 0}), std::runtime_error);
+}
@@ -0,0 +1,131 @@
+#include "gtest/gtest.h"
+
+#include "neuron/utils/jobs.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+using namespace neuron::utils;
+
+TEST(Jobs, RunsEveryTask) {
+    JobSystem jobs({.workerCount = 4});
+
+    std::atomic<uint32_t> count = 0;
+    std::vector<Task>     tasks;
+    for (int i = 0; i < 10000; i++)
+        tasks.push_back(jobs.submit([&] { count++; }));
+
+    for (const Task &task : tasks)
+        jobs.wait(task);
+    EXPECT_EQ(count, 10000);
+    EXPECT_EQ(jobs.getStats().executed, 10000);
+}
+
+TEST(Jobs, DependenciesRunFirst) {
+    JobSystem jobs({.workerCount = 4});
+
+    std::mutex       mutex;
+    std::vector<int> order;
+    auto             log = [&](int value) {
+        return [&, value] {
+            std::lock_guard lock(mutex);
+            order.push_back(value);
+        };
+    };
+
+    // a diamond: 1 before 2 and 3, both before 4
+    const Task first    = jobs.submit(log(1));
+    const Task left     = jobs.then(first, log(2));
+    const Task right    = jobs.then(first, log(3));
+    const Task joined[] = {left, right};
+    const Task last     = jobs.submit(log(4), joined);
+
+    jobs.wait(last);
+    ASSERT_EQ(order.size(), 4);
+    EXPECT_EQ(order.front(), 1);
+    EXPECT_EQ(order.back(), 4);
+    EXPECT_TRUE(first.isDone() && left.isDone() && right.isDone());
+}
+
+TEST(Jobs, NestedWaitsDontDeadlock) {
+    // fewer workers than waiting tasks: every wait inside a task has to help run the children
+    JobSystem jobs({.workerCount = 2});
+
+    std::atomic<uint32_t> count = 0;
+    std::vector<Task>     outer;
+    for (int i = 0; i < 32; i++) {
+        outer.push_back(jobs.submit([&] {
+            std::vector<Task> inner;
+            for (int j = 0; j < 32; j++)
+                inner.push_back(jobs.submit([&] { count++; }));
+            for (const Task &task : inner)
+                jobs.wait(task);
+        }));
+    }
+
+    for (const Task &task : outer)
+        jobs.wait(task);
+    EXPECT_EQ(count, 32 * 32);
+}
+
+TEST(Jobs, WaitRethrows) {
+    JobSystem jobs({.workerCount = 1});
+
+    std::atomic<bool> continued = false;
+    const Task        failing   = jobs.submit([] { throw std::runtime_error("broken"); });
+    const Task        after     = jobs.then(failing, [&] { continued = true; });
+
+    EXPECT_THROW(jobs.wait(failing), std::runtime_error);
+    jobs.wait(after);
+    EXPECT_TRUE(continued);
+}
+
+TEST(Jobs, ParallelForCoversTheRange) {
+    JobSystem jobs({.workerCount = 3});
+
+    std::vector<uint32_t> values(100003, 0);
+    jobs.parallelFor(static_cast<uint32_t>(values.size()), 1000, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++)
+            values[i]++;
+    });
+
+    EXPECT_EQ(std::accumulate(values.begin(), values.end(), uint64_t{0}), values.size());
+    EXPECT_TRUE(std::ranges::all_of(values, [](uint32_t value) { return value == 1; }));
+}
+
+TEST(Jobs, ParallelForWaitsBeforeRethrowing) {
+    JobSystem jobs({.workerCount = 3});
+
+    std::atomic<uint32_t> finished = 0;
+    EXPECT_THROW(jobs.parallelFor(64, 1,
+                                  [&](uint32_t begin, uint32_t) {
+                                      if (begin == 0)
+                                          throw std::runtime_error("first range failed");
+                                      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                                      finished++;
+                                  }),
+                 std::runtime_error);
+    EXPECT_EQ(finished, 63);
+}
+
+TEST(Jobs, TaskGroupWaitsForItsOwnTasks) {
+    JobSystem jobs({.workerCount = 2});
+
+    std::atomic<uint32_t> count = 0;
+    {
+        TaskGroup group(jobs);
+        for (int i = 0; i < 500; i++)
+            group.submit([&] { count++; });
+        group.wait();
+        EXPECT_TRUE(group.isIdle());
+        EXPECT_EQ(count, 500);
+
+        // the destructor waits for these
+        for (int i = 0; i < 500; i++)
+            group.submit([&] { count++; });
+    }
+    EXPECT_EQ(count, 1000);
+}
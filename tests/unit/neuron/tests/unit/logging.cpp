@@ -0,0 +1,56 @@
+#include "gtest/gtest.h"
+
+#include "neuron/utils/logging.hpp"
+
+using namespace neuron::utils;
+
+constexpr uint64_t SECOND = 1'000'000'000;
+
+TEST(ValidationFilter, RateLimitsRepeatsPerWindow) {
+    ValidationFilter filter({.messagesPerWindow = 3, .windowNanoseconds = SECOND});
+
+    EXPECT_EQ(filter.filter(7, "VUID-a", 1), ValidationVerdict::Log);
+    EXPECT_EQ(filter.filter(7, "VUID-a", 2), ValidationVerdict::Log);
+    EXPECT_EQ(filter.filter(7, "VUID-a", 3), ValidationVerdict::LogLast);
+    for (uint64_t i = 0; i < 100; i++)
+        EXPECT_EQ(filter.filter(7, "VUID-a", 4 + i), ValidationVerdict::Drop);
+
+    // other ids have their own budget, and the next window starts over
+    EXPECT_EQ(filter.filter(8, "VUID-b", 200), ValidationVerdict::Log);
+    EXPECT_EQ(filter.filter(7, "VUID-a", 1 + SECOND), ValidationVerdict::Log);
+}
+
+TEST(ValidationFilter, AllowAndDenyLists) {
+    ValidationFilter filter({.messagesPerWindow = 1, .allowedIds = {1}, .deniedIds = {2}});
+
+    for (uint64_t i = 0; i < 10; i++) {
+        EXPECT_EQ(filter.filter(1, "allowed", i + 1), ValidationVerdict::Log);
+        EXPECT_EQ(filter.filter(2, "denied", i + 1), ValidationVerdict::Drop);
+    }
+}
+
+TEST(ValidationFilter, SummariesCountSuppressedMessages) {
+    ValidationFilter filter({.messagesPerWindow = 2, .windowNanoseconds = 100 * SECOND, .summaryNanoseconds = SECOND, .deniedIds = {9}});
+
+    for (uint64_t i = 0; i < 12; i++)
+        (void) filter.filter(5, "VUID-five", i + 1);
+    for (uint64_t i = 0; i < 4; i++)
+        (void) filter.filter(6, "VUID-six", i + 1);
+    (void) filter.filter(9, "denied", 1);
+
+    ValidationSummary summary;
+    EXPECT_FALSE(filter.takeSummary(SECOND / 2, summary));
+    ASSERT_TRUE(filter.takeSummary(SECOND + 1, summary));
+
+    EXPECT_EQ(summary.logged, 4);
+    EXPECT_EQ(summary.suppressed, 12);
+    EXPECT_EQ(summary.denied, 1);
+    ASSERT_EQ(summary.ids.size(), 2);
+    EXPECT_EQ(summary.ids[0].id, 5);
+    EXPECT_EQ(summary.ids[0].name, "VUID-five");
+    EXPECT_EQ(summary.ids[0].suppressed, 10);
+    EXPECT_EQ(summary.ids[1].suppressed, 2);
+
+    // the counts were reset
+    EXPECT_FALSE(filter.takeSummary(3 * SECOND, summary, true));
+}
@@ -0,0 +1,87 @@
+#include "gtest/gtest.h"
+
+#include "neuron/tests/unit/vulkan_fixture.hpp"
+
+#include <algorithm>
+
+using namespace neuron::graphics;
+
+using Memory = neuron::tests::VulkanTest;
+
+static vk::MemoryRequirements hostRequirements(vk::DeviceSize size, vk::DeviceSize alignment = 16) {
+    return {size, alignment, ~0U};
+}
+
+TEST_F(Memory, BuddyAllocationsDontOverlapAndMerge) {
+    MemoryAllocator &allocator = s_GC->getAllocator();
+    const auto       before    = allocator.getStats();
+
+    std::vector<Allocation> allocations;
+    for (vk::DeviceSize size : {300, 4096, 17, 65536, 1000, 256}) {
+        allocations.push_back(allocator.allocate(hostRequirements(size), vk::MemoryPropertyFlagBits::eHostVisible));
+        EXPECT_EQ(allocations.back().getStrategy(), AllocationStrategy::Buddy);
+        EXPECT_NE(allocations.back().mapped, nullptr);
+    }
+
+    auto sorted = allocations;
+    std::ranges::sort(sorted, [](const auto &a, const auto &b) { return std::tie(a.memory, a.offset) < std::tie(b.memory, b.offset); });
+    for (size_t i = 1; i < sorted.size(); i++) {
+        if (sorted[i].memory == sorted[i - 1].memory) {
+            EXPECT_GE(sorted[i].offset, sorted[i - 1].offset + sorted[i - 1].size);
+        }
+    }
+
+    EXPECT_EQ(allocator.getStats().allocationCount, before.allocationCount + allocations.size());
+
+    for (auto &allocation : allocations)
+        allocator.free(allocation);
+
+    const auto after = allocator.getStats();
+    EXPECT_EQ(after.bytesUsed, before.bytesUsed);
+    EXPECT_EQ(after.getFragmentation(), 0.0f);
+}
+
+TEST_F(Memory, OversizedRequestsAreDedicated) {
+    MemoryAllocator &allocator  = s_GC->getAllocator();
+    Allocation       allocation = allocator.allocate(hostRequirements(MemoryAllocatorSettings{}.blockSize + 1), vk::MemoryPropertyFlagBits::eHostVisible);
+
+    EXPECT_EQ(allocation.getStrategy(), AllocationStrategy::Dedicated);
+    EXPECT_EQ(allocation.offset, 0);
+    allocator.free(allocation);
+    EXPECT_FALSE(allocation);
+}
+
+TEST_F(Memory, PoolReusesSlots) {
+    PoolAllocator pool(s_GC->getAllocator(), hostRequirements(200, 64), vk::MemoryPropertyFlagBits::eHostVisible, {}, ResourceKind::Linear, 4);
+
+    Allocation a = pool.allocate();
+    Allocation b = pool.allocate();
+    EXPECT_EQ(b.offset - a.offset, 256);
+
+    const vk::DeviceSize freed = a.offset;
+    pool.free(a);
+    Allocation c = pool.allocate();
+    EXPECT_EQ(c.offset, freed);
+
+    std::vector<Allocation> more;
+    for (int i = 0; i < 3; i++)
+        more.push_back(pool.allocate());
+    EXPECT_EQ(pool.getStats().blockCount, 2);
+    EXPECT_EQ(pool.getStats().allocationCount, 5);
+}
+
+TEST_F(Memory, LinearRespectsGranularityBetweenKinds) {
+    MemoryAllocator &allocator = s_GC->getAllocator();
+    LinearAllocator  linear(allocator, 1 << 20, ~0U, vk::MemoryPropertyFlagBits::eHostVisible);
+
+    Allocation buffer = linear.allocate(100, 4, ResourceKind::Linear);
+    Allocation image  = linear.allocate(100, 4, ResourceKind::Optimal);
+
+    const vk::DeviceSize granularity = allocator.getBufferImageGranularity();
+    EXPECT_EQ(image.offset % granularity, 0);
+    EXPECT_GE(image.offset, buffer.offset + buffer.size);
+
+    linear.reset();
+    EXPECT_EQ(linear.getUsed(), 0);
+    EXPECT_THROW((void)linear.allocate(2 << 20, 4), std::runtime_error);
+}
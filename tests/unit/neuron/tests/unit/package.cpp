@@ -0,0 +1,82 @@
+#include "gtest/gtest.h"
+
+#include "neuron/assets/package.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace neuron::assets;
+
+class Packages : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        m_Path = std::filesystem::temp_directory_path() / ("neuron_package_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()) + ".npak");
+        std::filesystem::remove(m_Path);
+    }
+
+    void TearDown() override { std::filesystem::remove(m_Path); }
+
+    static std::vector<std::byte> bytes(size_t count, uint8_t seed) {
+        std::vector<std::byte> data(count);
+        for (size_t i = 0; i < count; i++)
+            data[i] = static_cast<std::byte>(seed + i * 7);
+        return data;
+    }
+
+    std::filesystem::path m_Path;
+};
+
+TEST_F(Packages, RoundTripsAssets) {
+    PackageWriter writer;
+    for (uint32_t i = 0; i < 100; i++)
+        writer.add("textures/" + std::to_string(i) + ".png", AssetType::Texture, bytes(1000 + i * 37, static_cast<uint8_t>(i)));
+    writer.add("shaders/cull.spv", AssetType::Shader, bytes(12, 3));
+    writer.add("empty", AssetType::Blob, {});
+    writer.write(m_Path);
+
+    Package package(m_Path);
+    EXPECT_EQ(package.getEntries().size(), 102);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(package.getMapping().data()) % PACKAGE_DEFAULT_ALIGNMENT, 0);
+
+    for (uint32_t i = 0; i < 100; i++) {
+        const PackageAsset asset    = package.get("textures/" + std::to_string(i) + ".png");
+        const auto         expected = bytes(1000 + i * 37, static_cast<uint8_t>(i));
+        EXPECT_EQ(asset.type, AssetType::Texture);
+        EXPECT_EQ(asset.offset % PACKAGE_DEFAULT_ALIGNMENT, 0);
+        ASSERT_EQ(asset.data.size(), expected.size());
+        EXPECT_EQ(std::memcmp(asset.data.data(), expected.data(), expected.size()), 0);
+    }
+
+    EXPECT_EQ(package.get("shaders/cull.spv").type, AssetType::Shader);
+    EXPECT_TRUE(package.get("empty").data.empty());
+    EXPECT_FALSE(package.find("textures/100.png").has_value());
+    EXPECT_THROW((void)package.get("missing"), std::runtime_error);
+}
+
+TEST_F(Packages, RejectsDuplicatesAndBadFiles) {
+    PackageWriter writer(64);
+    writer.add("a", AssetType::Blob, bytes(10, 1));
+    EXPECT_THROW(writer.add("a", AssetType::Blob, bytes(10, 1)), std::runtime_error);
+    EXPECT_THROW(PackageWriter(100), std::runtime_error);
+
+    EXPECT_THROW(Package(m_Path), std::runtime_error);
+
+    std::ofstream(m_Path, std::ios::binary) << std::string(256, 'x');
+    EXPECT_THROW(Package(m_Path), std::runtime_error);
+
+    // a package cut off in the middle of its data
+    writer.add("b", AssetType::Blob, bytes(1000, 2));
+    writer.write(m_Path);
+    std::filesystem::resize_file(m_Path, std::filesystem::file_size(m_Path) - 500);
+    EXPECT_THROW(Package(m_Path), std::runtime_error);
+}
+
+TEST(PackageTypes, FromExtension) {
+    EXPECT_EQ(assetTypeFromPath("a/b.SPV"), AssetType::Shader);
+    EXPECT_EQ(assetTypeFromPath("albedo.ktx2"), AssetType::Texture);
+    EXPECT_EQ(assetTypeFromPath("level.glb"), AssetType::Mesh);
+    EXPECT_EQ(assetTypeFromPath("README"), AssetType::Blob);
+}
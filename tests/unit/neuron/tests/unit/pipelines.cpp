@@ -0,0 +1,88 @@
+#include "gtest/gtest.h"
+
+#include "neuron/graphics/pipelines.hpp"
+#include "neuron/tests/unit/vulkan_fixture.hpp"
+
+#include <fstream>
+
+using namespace neuron::graphics;
+
+class Pipelines : public neuron::tests::VulkanTest {
+  protected:
+    void SetUp() override {
+        VulkanTest::SetUp();
+        if (IsSkipped())
+            return;
+
+        m_Layout    = s_GC->getDevice().createPipelineLayout(vk::PipelineLayoutCreateInfo());
+        m_CachePath = std::filesystem::temp_directory_path() / "neuron_unit_pipelines.bin";
+        std::filesystem::remove(m_CachePath);
+    }
+
+    void TearDown() override {
+        if (m_Layout)
+            s_GC->getDevice().destroy(m_Layout);
+        std::filesystem::remove(m_CachePath);
+    }
+
+    [[nodiscard]] ComputePipelineDesc computeDesc(int variant) const {
+        ShaderSource shader{.name  = "fill.comp",
+                            .code  = "#version 450\n"
+                                     "layout(local_size_x = 64) in;\n"
+                                     "layout(binding = 0) buffer Data { uint values[]; };\n"
+                                     "void main() { values[gl_GlobalInvocationID.x] = VARIANT; }\n",
+                            .stage = ShaderStage::Compute};
+        shader.defines.emplace_back("VARIANT", std::to_string(variant));
+        return {.shader = shader, .layout = m_Layout};
+    }
+
+    ShaderCompiler        m_Shaders;
+    vk::PipelineLayout    m_Layout;
+    std::filesystem::path m_CachePath;
+};
+
+TEST_F(Pipelines, IdenticalDescsShareAPipeline) {
+    PipelineManager pipelines(s_GC, m_Shaders);
+
+    const vk::Pipeline a = pipelines.get(computeDesc(1));
+    const vk::Pipeline b = pipelines.get(computeDesc(1));
+    const vk::Pipeline c = pipelines.get(computeDesc(2));
+
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_EQ(pipelines.getStats().created, 2);
+    EXPECT_EQ(pipelines.getStats().reused, 1);
+}
+
+TEST_F(Pipelines, BuildsInTheBackground) {
+    PipelineManager pipelines(s_GC, m_Shaders);
+
+    for (int i = 0; i < 8; i++)
+        pipelines.prefetch(computeDesc(i));
+    pipelines.waitIdle();
+
+    EXPECT_EQ(pipelines.getStats().created, 8);
+    for (int i = 0; i < 8; i++)
+        EXPECT_TRUE(pipelines.tryGet(computeDesc(i)).has_value());
+}
+
+TEST_F(Pipelines, CacheSurvivesRestart) {
+    {
+        PipelineManager pipelines(s_GC, m_Shaders, {.cachePath = m_CachePath});
+        EXPECT_FALSE(pipelines.getStats().cacheLoaded);
+        (void)pipelines.get(computeDesc(1));
+    }
+    ASSERT_TRUE(std::filesystem::exists(m_CachePath));
+
+    PipelineManager pipelines(s_GC, m_Shaders, {.cachePath = m_CachePath});
+    EXPECT_TRUE(pipelines.getStats().cacheLoaded);
+    EXPECT_TRUE(pipelines.get(computeDesc(1)));
+}
+
+TEST_F(Pipelines, ForeignCacheIsIgnored) {
+    std::ofstream(m_CachePath, std::ios::binary) << "definitely not a pipeline cache";
+
+    PipelineManager pipelines(s_GC, m_Shaders, {.cachePath = m_CachePath});
+    EXPECT_FALSE(pipelines.getStats().cacheLoaded);
+    EXPECT_TRUE(pipelines.get(computeDesc(1)));
+}
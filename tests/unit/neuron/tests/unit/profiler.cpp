@@ -0,0 +1,129 @@
+#include "gtest/gtest.h"
+
+#include "neuron/graphics/gpu_profiler.hpp"
+#include "neuron/tests/unit/vulkan_fixture.hpp"
+
+#include <algorithm>
+#include <thread>
+
+using namespace neuron::utils;
+
+static std::vector<ProfileEvent> eventsNamed(const std::vector<ProfileEvent> &events, std::string_view name) {
+    std::vector<ProfileEvent> result;
+    std::ranges::copy_if(events, std::back_inserter(result), [&](const ProfileEvent &event) { return name == event.name; });
+    return result;
+}
+
+TEST(Profiler, RecordsScopesPerThread) {
+    auto &profiler = Profiler::get();
+    profiler.clear();
+
+    std::vector<std::jthread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([] {
+            for (int i = 0; i < 100; i++) {
+                const ProfileScope outer("outer");
+                const ProfileScope inner("inner");
+            }
+        });
+    }
+    threads.clear();
+
+    const auto events = profiler.takeEvents();
+    const auto outer  = eventsNamed(events, "outer");
+    const auto inner  = eventsNamed(events, "inner");
+    ASSERT_EQ(outer.size(), 400);
+    ASSERT_EQ(inner.size(), 400);
+
+    // every thread records in order, and inner scopes finish before their outer scope
+    for (size_t i = 0; i < outer.size(); i++) {
+        EXPECT_EQ(inner[i].track, outer[i].track);
+        EXPECT_LE(outer[i].begin, inner[i].begin);
+        EXPECT_LE(inner[i].end, outer[i].end);
+    }
+}
+
+TEST(Profiler, DropsWhenThreadBufferIsFull) {
+    auto &profiler = Profiler::get();
+    profiler.clear();
+    const uint64_t dropped = profiler.getStats().dropped;
+
+    std::jthread([] {
+        for (uint32_t i = 0; i < Profiler::EVENTS_PER_THREAD + 10; i++)
+            Profiler::get().record("filler", i, i + 1);
+    }).join();
+
+    EXPECT_EQ(profiler.getStats().dropped - dropped, 10);
+    EXPECT_EQ(eventsNamed(profiler.takeEvents(), "filler").size(), Profiler::EVENTS_PER_THREAD);
+}
+
+TEST(Profiler, ExportsChromeTrace) {
+    auto &profiler = Profiler::get();
+    profiler.clear();
+
+    const uint32_t track = profiler.addTrack("render \"thread\"");
+    profiler.record(track, profiler.intern(std::string("pass\\one")), 1'000'500, 1'003'250);
+
+    const std::string trace = profiler.toChromeTrace();
+    EXPECT_TRUE(trace.starts_with("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    EXPECT_TRUE(trace.ends_with("]}"));
+    EXPECT_NE(trace.find("\"args\":{\"name\":\"render \\\"thread\\\"\"}"), std::string::npos);
+    EXPECT_NE(trace.find("{\"ph\":\"X\",\"name\":\"pass\\\\one\",\"pid\":1,\"tid\":" + std::to_string(track) + ",\"ts\":1000.500,\"dur\":2.750}"), std::string::npos);
+    profiler.clear();
+}
+
+using GpuProfilers = neuron::tests::VulkanTest;
+
+TEST_F(GpuProfilers, ResolvesScopesWhenTheSlotComesAround) {
+    using namespace neuron::graphics;
+
+    GpuProfiler profiler(s_GC, {.framesInFlight = 1});
+    if (!profiler.isSupported())
+        GTEST_SKIP() << "The primary queue has no timestamps";
+
+    const auto &device = s_GC->getDevice();
+    const auto  pool   = device.createCommandPool(vk::CommandPoolCreateInfo(vk::CommandPoolCreateFlagBits::eResetCommandBuffer, s_GC->getQueueFamily(QueueType::Primary).value()));
+    const auto  cmd    = device.allocateCommandBuffers(vk::CommandBufferAllocateInfo(pool, vk::CommandBufferLevel::ePrimary, 1)).front();
+    const auto  fence  = device.createFence(vk::FenceCreateInfo());
+    auto        buffer = s_GC->getAllocator().createBuffer(vk::BufferCreateInfo({}, 1 << 20, vk::BufferUsageFlagBits::eTransferDst, vk::SharingMode::eExclusive),
+                                                           vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    uint64_t submitted = 0, finished = 0;
+    for (int frame = 0; frame < 2; frame++) {
+        cmd.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+        profiler.beginFrame(0, cmd);
+        if (frame == 1) {
+            // the scopes of the first frame, resolved now that its fence signaled
+            ASSERT_EQ(profiler.getResolved().size(), 2);
+            const auto &frameScope = profiler.getResolved()[0];
+            const auto &fillScope  = profiler.getResolved()[1];
+            EXPECT_STREQ(frameScope.name, "frame");
+            EXPECT_STREQ(fillScope.name, "fill");
+            EXPECT_EQ(fillScope.track, profiler.getTrack());
+            EXPECT_LE(frameScope.begin, fillScope.begin);
+            EXPECT_LE(fillScope.end, frameScope.end);
+
+            // converted to the CPU clock, give or take the calibration error
+            constexpr uint64_t slack = 50'000'000;
+            EXPECT_GT(frameScope.begin + slack, submitted);
+            EXPECT_LT(frameScope.end, finished + slack);
+        }
+
+        {
+            const GpuScope frameScope(profiler, cmd, "frame");
+            const GpuScope fillScope(profiler, cmd, "fill");
+            cmd.fillBuffer(buffer.buffer, 0, VK_WHOLE_SIZE, 7);
+        }
+        cmd.end();
+
+        submitted = Profiler::now();
+        s_GC->submit(s_GC->getPrimaryQueue(), vk::SubmitInfo({}, {}, cmd), fence);
+        (void)device.waitForFences(fence, true, UINT64_MAX);
+        finished = Profiler::now();
+        device.resetFences(fence);
+    }
+
+    s_GC->getAllocator().destroy(buffer);
+    device.destroyFence(fence);
+    device.destroyCommandPool(pool);
+}
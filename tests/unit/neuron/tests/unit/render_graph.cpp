@@ -0,0 +1,113 @@
+#include "gtest/gtest.h"
+
+#include "neuron/graphics/render_graph.hpp"
+#include "neuron/tests/unit/vulkan_fixture.hpp"
+
+#include <array>
+
+using namespace neuron::graphics;
+
+using RenderGraphs = neuron::tests::VulkanTest;
+
+static constexpr RGImageDesc COLOR_64 = {.format = vk::Format::eR8G8B8A8Unorm, .extent = {64, 64}};
+
+TEST_F(RenderGraphs, CullsPassesNothingReads) {
+    ImageRenderTarget target(s_GC, {.extent = {64, 64}, .format = vk::Format::eR8G8B8A8Unorm, .imageCount = 1});
+    RenderGraph       graph(s_GC, 1);
+
+    graph.beginFrame(0);
+    const RGImage output = graph.importTarget("output", target, 0);
+
+    RGImage unused, debug;
+    graph.addPass("unused", [&](RGPassBuilder &builder) { unused = builder.createImage("unused", COLOR_64); builder.use(unused, RGAccess::TransferDst); }, {});
+    graph.addPass("debug", [&](RGPassBuilder &builder) { debug = builder.createImage("debug", COLOR_64); builder.use(debug, RGAccess::TransferDst); }, {});
+    graph.addPass("readsDebug", [&](RGPassBuilder &builder) { builder.use(debug, RGAccess::TransferSrc); }, {});
+    graph.addPass("present", [&](RGPassBuilder &builder) { builder.use(output, RGAccess::TransferDst); }, {});
+    graph.addPass("capture", [&](RGPassBuilder &) {}, {});
+    graph.compile();
+
+    // reading a transient doesn't keep a pass alive, only writing something that is needed does
+    EXPECT_TRUE(graph.isCulled("unused"));
+    EXPECT_TRUE(graph.isCulled("debug"));
+    EXPECT_TRUE(graph.isCulled("readsDebug"));
+    EXPECT_TRUE(graph.isCulled("capture"));
+    EXPECT_FALSE(graph.isCulled("present"));
+    EXPECT_EQ(graph.getStats().passes, 1);
+    EXPECT_EQ(graph.getStats().culledPasses, 4);
+    EXPECT_EQ(graph.getStats().transientImages, 0);
+}
+
+TEST_F(RenderGraphs, AliasesTransientsWithDisjointLifetimes) {
+    ImageRenderTarget target(s_GC, {.extent = {64, 64}, .format = vk::Format::eR8G8B8A8Unorm, .imageCount = 1});
+    RenderGraph       graph(s_GC, 1);
+
+    graph.beginFrame(0);
+    const RGImage output = graph.importTarget("output", target, 0);
+
+    // a -> b -> c -> output: a is dead by the time c is written, so they can share memory
+    RGImage a, b, c;
+    graph.addPass("a", [&](RGPassBuilder &builder) { a = builder.createImage("a", COLOR_64); builder.use(a, RGAccess::TransferDst); }, {});
+    graph.addPass("b", [&](RGPassBuilder &builder) { b = builder.createImage("b", COLOR_64); builder.use(a, RGAccess::TransferSrc); builder.use(b, RGAccess::TransferDst); }, {});
+    graph.addPass("c", [&](RGPassBuilder &builder) { c = builder.createImage("c", COLOR_64); builder.use(b, RGAccess::TransferSrc); builder.use(c, RGAccess::TransferDst); }, {});
+    graph.addPass("output", [&](RGPassBuilder &builder) { builder.use(c, RGAccess::TransferSrc); builder.use(output, RGAccess::TransferDst); }, {});
+    graph.compile();
+
+    const auto &stats = graph.getStats();
+    EXPECT_EQ(stats.transientImages, 3);
+    EXPECT_GT(stats.getAliasingSavings(), 0);
+    EXPECT_LE(stats.allocatedBytes * 3, stats.transientBytes * 2);
+}
+
+TEST_F(RenderGraphs, MergesReadsAfterOneBarrier) {
+    RenderGraph graph(s_GC, 1);
+
+    graph.beginFrame(0);
+    RGBuffer data;
+    graph.addPass("write", [&](RGPassBuilder &builder) { data = builder.createBuffer("data", {1024}); builder.use(data, RGAccess::StorageWriteCompute); }, {});
+    for (const char *name : {"read0", "read1", "read2"}) {
+        graph.addPass(name, [&](RGPassBuilder &builder) { builder.use(data, RGAccess::StorageReadCompute); builder.setSideEffects(); }, {});
+    }
+    graph.compile();
+
+    // the first read waits for the write, the others are covered by that barrier
+    EXPECT_EQ(graph.getStats().bufferBarriers, 1);
+    EXPECT_EQ(graph.getStats().barrierBatches, 1);
+}
+
+TEST_F(RenderGraphs, CopiesThroughTransientIntoTarget) {
+    ImageRenderTarget target(s_GC, {.extent = {64, 64}, .format = vk::Format::eR8G8B8A8Unorm, .imageCount = 2});
+    RenderGraph       graph(s_GC, target.getImageCount());
+
+    for (uint8_t i = 0; i < 4; i++) {
+        auto frame = target.beginFrame();
+        graph.beginFrame(frame.frameIndex);
+
+        const RGImage output = graph.importTarget("output", target, frame.imageIndex);
+        RGImage       scratch;
+        graph.addPass(
+            "clear", [&](RGPassBuilder &builder) { scratch = builder.createImage("scratch", COLOR_64); builder.use(scratch, RGAccess::TransferDst); },
+            [&](vk::CommandBuffer cmd, const RGResources &resources) {
+                cmd.clearColorImage(resources.getImage(scratch), vk::ImageLayout::eTransferDstOptimal, vk::ClearColorValue(std::array{i / 255.0f, 0.0f, 1.0f, 1.0f}),
+                                    BASIC_ISR);
+            });
+        graph.addPass(
+            "copy", [&](RGPassBuilder &builder) { builder.use(scratch, RGAccess::TransferSrc); builder.use(output, RGAccess::TransferDst); },
+            [&](vk::CommandBuffer cmd, const RGResources &resources) {
+                const vk::ImageSubresourceLayers layers(vk::ImageAspectFlagBits::eColor, 0, 0, 1);
+                cmd.copyImage(resources.getImage(scratch), vk::ImageLayout::eTransferSrcOptimal, resources.getImage(output), vk::ImageLayout::eTransferDstOptimal,
+                              vk::ImageCopy(layers, {}, layers, {}, vk::Extent3D(resources.getExtent(output), 1)));
+            });
+        graph.execute(frame.commandBuffer);
+        target.endFrame();
+
+        // undefined -> dst for the clear, src and dst for the copy, back to a color attachment at the end
+        EXPECT_EQ(graph.getStats().imageBarriers, 4);
+        EXPECT_EQ(graph.getStats().barrierBatches, 3);
+        EXPECT_EQ(graph.getStats().resourcesCreated, i < 2);
+
+        auto pixels = target.readback(frame.imageIndex);
+        ASSERT_EQ(pixels.size(), 64 * 64 * 4);
+        EXPECT_EQ(static_cast<uint8_t>(pixels[0]), i);
+        EXPECT_EQ(static_cast<uint8_t>(pixels[pixels.size() - 2]), 255);
+    }
+}
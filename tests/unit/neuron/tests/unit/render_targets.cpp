@@ -0,0 +1,51 @@
+#include "gtest/gtest.h"
+
+#include "neuron/tests/unit/vulkan_fixture.hpp"
+
+#include <array>
+#include <cstring>
+
+using RenderTargets = neuron::tests::VulkanTest;
+
+static void clearTo(vk::CommandBuffer cmd, vk::Image image, const std::array<float, 4> &color) {
+    using namespace neuron::graphics;
+    cmd.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::PipelineStageFlagBits::eTransfer, {}, {}, {},
+                        vk::ImageMemoryBarrier(vk::AccessFlagBits::eColorAttachmentWrite, vk::AccessFlagBits::eTransferWrite, vk::ImageLayout::eColorAttachmentOptimal,
+                                               vk::ImageLayout::eTransferDstOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image, BASIC_ISR));
+    cmd.clearColorImage(image, vk::ImageLayout::eTransferDstOptimal, vk::ClearColorValue(color), BASIC_ISR);
+    cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eColorAttachmentOutput, {}, {}, {},
+                        vk::ImageMemoryBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eColorAttachmentWrite, vk::ImageLayout::eTransferDstOptimal,
+                                               vk::ImageLayout::eColorAttachmentOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image, BASIC_ISR));
+}
+
+TEST_F(RenderTargets, ImageTargetReadsBackEachFrame) {
+    neuron::graphics::ImageRenderTarget target(s_GC, {.extent = {64, 32}, .format = vk::Format::eR8G8B8A8Unorm, .imageCount = 3});
+    EXPECT_TRUE(target.isMultiBuffered());
+    EXPECT_EQ(target.getImageCount(), 3);
+
+    for (uint8_t i = 0; i < 6; i++) {
+        auto frame = target.beginFrame();
+        clearTo(frame.commandBuffer, target.getImageTarget(frame.imageIndex), {i / 255.0f, 0.0f, 1.0f, 1.0f});
+        target.endFrame();
+
+        auto pixels = target.readback(frame.imageIndex);
+        ASSERT_EQ(pixels.size(), 64 * 32 * 4);
+        EXPECT_EQ(static_cast<uint8_t>(pixels[0]), i);
+        EXPECT_EQ(static_cast<uint8_t>(pixels[pixels.size() - 2]), 255);
+    }
+
+    EXPECT_EQ(target.getFramesSubmitted(), 6);
+}
+
+TEST_F(RenderTargets, ImageTargetResize) {
+    neuron::graphics::ImageRenderTarget target(s_GC, {.extent = {16, 16}, .imageCount = 1});
+    EXPECT_FALSE(target.isMultiBuffered());
+
+    target.resizeTarget({40, 8});
+    EXPECT_EQ(target.getCurrentConfiguration().extent, vk::Extent2D(40, 8));
+
+    auto frame = target.beginFrame();
+    clearTo(frame.commandBuffer, target.getImageTarget(), {1.0f, 1.0f, 1.0f, 1.0f});
+    target.endFrame();
+    EXPECT_EQ(target.readback(0).size(), 40 * 8 * 4);
+}
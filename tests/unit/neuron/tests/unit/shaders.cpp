@@ -0,0 +1,107 @@
+#include "gtest/gtest.h"
+
+#include "neuron/graphics/shaders.hpp"
+
+#include <fstream>
+
+using namespace neuron::graphics;
+
+class Shaders : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        m_Directory = std::filesystem::temp_directory_path() / ("neuron_shaders_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        std::filesystem::remove_all(m_Directory);
+        std::filesystem::create_directories(m_Directory / "include");
+
+        writeFile("include/common.glsl", "const uint SCALE = 2;\n");
+    }
+
+    void TearDown() override { std::filesystem::remove_all(m_Directory); }
+
+    void writeFile(const std::string &name, const std::string &contents) const { std::ofstream(m_Directory / name) << contents; }
+
+    [[nodiscard]] ShaderCompilerSettings settings() const { return {.cacheDirectory = m_Directory / "cache", .includeDirectories = {m_Directory / "include"}}; }
+
+    static ShaderSource computeShader(const std::string &name) {
+        return {.name  = name,
+                .code  = "#version 450\n"
+                         "#include <common.glsl>\n"
+                         "layout(local_size_x = 64) in;\n"
+                         "layout(binding = 0) buffer Data { uint values[]; };\n"
+                         "void main() { values[gl_GlobalInvocationID.x] *= SCALE; }\n",
+                .stage = ShaderStage::Compute};
+    }
+
+    std::filesystem::path m_Directory;
+};
+
+TEST_F(Shaders, CompilesAndHitsMemoryCache) {
+    ShaderCompiler compiler(settings());
+
+    const Spirv first = compiler.compile(computeShader("a.comp"));
+    ASSERT_FALSE(first.empty());
+    EXPECT_EQ(first[0], 0x07230203u);
+
+    const Spirv second = compiler.compile(computeShader("a.comp"));
+    EXPECT_EQ(first, second);
+
+    const ShaderCacheStats stats = compiler.getStats();
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.memoryHits, 1);
+}
+
+TEST_F(Shaders, WarmStartSkipsCompiler) {
+    Spirv cold;
+    {
+        ShaderCompiler compiler(settings());
+        cold = compiler.compile(computeShader("a.comp"));
+    }
+
+    ShaderCompiler compiler(settings());
+    const Spirv    warm = compiler.compile(computeShader("a.comp"));
+
+    EXPECT_EQ(cold, warm);
+    EXPECT_EQ(compiler.getStats().misses, 0);
+    EXPECT_EQ(compiler.getStats().diskHits, 1);
+}
+
+TEST_F(Shaders, KeyCoversIncludesAndDefines) {
+    ShaderCompiler compiler(settings());
+
+    ShaderSource source = computeShader("a.comp");
+    const auto   before = compiler.getKey(source);
+
+    writeFile("include/common.glsl", "const uint SCALE = 3;\n");
+    EXPECT_NE(compiler.getKey(source), before);
+
+    const auto withoutDefine = compiler.getKey(source);
+    source.defines.emplace_back("FAST", "1");
+    EXPECT_NE(compiler.getKey(source), withoutDefine);
+}
+
+TEST_F(Shaders, CompilesInParallel) {
+    ShaderCompiler compiler(settings());
+
+    std::vector<ShaderSource> sources;
+    for (int i = 0; i < 16; i++) {
+        ShaderSource source = computeShader("s" + std::to_string(i) + ".comp");
+        source.defines.emplace_back("VARIANT", std::to_string(i));
+        sources.push_back(source);
+    }
+
+    const auto results = compiler.compileAll(sources);
+    ASSERT_EQ(results.size(), sources.size());
+    for (const auto &spirv : results)
+        EXPECT_FALSE(spirv.empty());
+    EXPECT_EQ(compiler.getStats().misses, sources.size());
+}
+
+TEST_F(Shaders, ErrorsAreReported) {
+    ShaderCompiler compiler(settings());
+
+    ShaderSource broken = computeShader("broken.comp");
+    broken.code += "this is not glsl\n";
+
+    EXPECT_THROW((void)compiler.compile(broken), std::runtime_error);
+    EXPECT_EQ(compiler.getStats().failures, 1);
+}
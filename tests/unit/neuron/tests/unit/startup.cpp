@@ -0,0 +1,92 @@
+#include "gtest/gtest.h"
+
+#include "neuron/os/window.hpp"
+#include "neuron/utils/startup.hpp"
+#include "neuron/tests/unit/vulkan_fixture.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+
+using namespace neuron::utils;
+
+static bool hasPhase(const StartupTimings &timings, std::string_view name) {
+    return std::ranges::any_of(timings.getPhases(), [&](const StartupPhase &phase) { return phase.name == name; });
+}
+
+TEST(StartupTimings, MeasuresPhasesInStartOrder) {
+    StartupTimings timings;
+    timings.add("second", 200, 300);
+    timings.add("first", 100, 150);
+
+    EXPECT_EQ(timings.measure("value", [] { return 42; }), 42);
+
+    const auto phases = timings.getPhases();
+    ASSERT_EQ(phases.size(), 3);
+    EXPECT_EQ(std::string_view(phases[0].name), "first");
+    EXPECT_EQ(std::string_view(phases[1].name), "second");
+    EXPECT_EQ(std::string_view(phases[2].name), "value");
+    EXPECT_LE(phases[2].begin, phases[2].end);
+}
+
+TEST(StartupTimings, WallTimeOverlapsConcurrentPhases) {
+    StartupTimings timings;
+    timings.add("a", 1'000'000, 5'000'000);
+    timings.add("b", 2'000'000, 4'000'000);
+    timings.add("c", 4'000'000, 6'000'000);
+
+    EXPECT_EQ(timings.getWallNanoseconds(), 5'000'000);
+
+    const std::string text = timings.format();
+    EXPECT_TRUE(text.starts_with("5.00 ms ("));
+    EXPECT_NE(text.find("a 4.00 ms, b 2.00 ms, c 2.00 ms"), std::string::npos);
+}
+
+TEST(StartupTimings, RecordsPhasesThatThrow) {
+    StartupTimings timings;
+    EXPECT_THROW(timings.measure("failing", [] { throw std::runtime_error("no"); }), std::runtime_error);
+    EXPECT_TRUE(hasPhase(timings, "failing"));
+}
+
+TEST(StartupTimings, ConcurrentPhases) {
+    StartupTimings timings;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++)
+        threads.emplace_back([&] {
+            for (int j = 0; j < 100; j++)
+                timings.measure("phase", [] {});
+        });
+    for (auto &thread : threads)
+        thread.join();
+
+    EXPECT_EQ(timings.getPhases().size(), 400);
+}
+
+TEST_F(neuron::tests::VulkanTest, StartupIsTimedInPhases) {
+    const StartupTimings &context = neuron::Context::get()->getStartupTimings();
+    for (const char *name : {"loggers", "job system", "vulkan loader", "instance"})
+        EXPECT_TRUE(hasPhase(context, name)) << name;
+
+    // offscreen processes never touch GLFW
+    EXPECT_FALSE(hasPhase(context, "window system"));
+    EXPECT_FALSE(neuron::os::isWindowSystemInitialized());
+
+    const StartupTimings &device = s_GC->getStartupTimings();
+    for (const char *name : {"device selection", "device", "allocator"})
+        EXPECT_TRUE(hasPhase(device, name)) << name;
+    EXPECT_GT(device.getWallNanoseconds(), 0);
+}
+
+TEST_F(neuron::tests::VulkanTest, UploadServiceIsCreatedOnFirstUse) {
+    if (!s_GC->supportsTimelineSemaphores())
+        GTEST_SKIP() << "No timeline semaphores";
+
+    auto &first  = s_GC->getUploadService();
+    auto &second = s_GC->getUploadService();
+    EXPECT_EQ(&first, &second);
+
+    const auto phases = s_GC->getStartupTimings().getPhases();
+    EXPECT_EQ(std::ranges::count_if(phases, [](const StartupPhase &phase) { return std::string_view(phase.name) == "upload service"; }), 1);
+}
@@ -0,0 +1,135 @@
+#include "gtest/gtest.h"
+
+#include "neuron/os/headless_surface.hpp"
+#include "neuron/tests/unit/vulkan_fixture.hpp"
+
+using namespace neuron::graphics;
+
+/**
+ * Runs the swapchain path on VK_EXT_headless_surface, while a batch on another queue, or on the primary queue itself, stays pending.
+ */
+class Swapchain : public neuron::tests::VulkanTest {
+  protected:
+    static void SetUpTestSuite() {
+        initialize({.name                        = "neuron_unit_tests",
+                    .version                     = {0, 1, 0},
+                    .offscreenRenderingOnly      = true,
+                    .requestedInstanceExtensions = {VK_KHR_SURFACE_EXTENSION_NAME, VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME}},
+                   [] {
+                       auto families = neuron::Context::get()->getInstance().enumeratePhysicalDevices().front().getQueueFamilyProperties();
+
+                       s_SideQueue = std::nullopt;
+                       for (const auto &family : families) {
+                           if (!(family.queueFlags & vk::QueueFlagBits::eGraphics) && (family.queueFlags & vk::QueueFlagBits::eTransfer) &&
+                               !(family.queueFlags & vk::QueueFlagBits::eCompute)) {
+                               s_SideQueue = QueueType::Transfer;
+                           }
+                       }
+                       if (!s_SideQueue.has_value() && families.front().queueCount > 1) {
+                           s_SideQueue = QueueType::Primary;
+                       }
+
+                       GCSettings settings{{}, {VK_KHR_SWAPCHAIN_EXTENSION_NAME}};
+                       if (s_SideQueue.has_value()) {
+                           settings.queueRequests.push_back({s_SideQueue.value(), 1});
+                       }
+                       return settings;
+                   });
+    }
+
+    static inline std::optional<QueueType> s_SideQueue;
+
+    // an empty batch that can't complete until the host opens its gate, so any device or queue wait-idle while it is pending would hang
+    struct GatedBatch {
+        vk::Semaphore   gate;
+        vk::Semaphore   done;
+        vk::CommandPool pool;
+    };
+
+    static GatedBatch submitGated(vk::Queue queue, uint32_t family) {
+        const vk::Device &device = s_GC->getDevice();
+
+        vk::SemaphoreTypeCreateInfo timelineType(vk::SemaphoreType::eTimeline, 0);
+        GatedBatch                  batch;
+        batch.gate = device.createSemaphore(vk::SemaphoreCreateInfo({}, &timelineType));
+        batch.done = device.createSemaphore(vk::SemaphoreCreateInfo({}, &timelineType));
+        batch.pool = device.createCommandPool(vk::CommandPoolCreateInfo({}, family));
+
+        vk::CommandBuffer cmd = device.allocateCommandBuffers(vk::CommandBufferAllocateInfo(batch.pool, vk::CommandBufferLevel::ePrimary, 1)).front();
+        cmd.begin(vk::CommandBufferBeginInfo());
+        cmd.end();
+
+        uint64_t                        one       = 1;
+        vk::PipelineStageFlags          waitStage = vk::PipelineStageFlagBits::eTransfer;
+        vk::TimelineSemaphoreSubmitInfo timelineInfo(one, one);
+        s_GC->submit(queue, vk::SubmitInfo(batch.gate, waitStage, cmd, batch.done, &timelineInfo));
+        return batch;
+    }
+
+    static bool isDone(const GatedBatch &batch) { return s_GC->getDevice().getSemaphoreCounterValue(batch.done) > 0; }
+
+    static void openAndDestroy(const GatedBatch &batch) {
+        const vk::Device &device = s_GC->getDevice();
+
+        device.signalSemaphore(vk::SemaphoreSignalInfo(batch.gate, 1));
+        EXPECT_EQ(device.waitSemaphores(vk::SemaphoreWaitInfo({}, batch.done, 1), 5'000'000'000ULL), vk::Result::eSuccess);
+
+        device.destroy(batch.pool);
+        device.destroy(batch.gate);
+        device.destroy(batch.done);
+    }
+};
+
+TEST_F(Swapchain, ResizeWhileOtherQueueIsBusy) {
+    if (!s_SideQueue.has_value())
+        GTEST_SKIP() << "Device has no second queue to keep busy";
+    if (!s_GC->supportsTimelineSemaphores())
+        GTEST_SKIP() << "Blocking the side queue needs timeline semaphores";
+
+    const uint32_t   family = s_GC->getQueueFamily(s_SideQueue.value()).value();
+    const GatedBatch busy   = submitGated(s_GC->getDevice().getQueue(family, 0), family);
+
+    {
+        auto                surfaceProvider = std::make_shared<neuron::os::HeadlessSurface>();
+        SurfaceRenderTarget target(s_GC, surfaceProvider, {.fallbackExtent = {64, 64}});
+
+        for (uint32_t i = 0; i < 24; i++) {
+            target.resizeTarget({64 + i * 8, 64 + (i % 3) * 16});
+
+            (void)target.beginFrame();
+            target.endFrame();
+
+            EXPECT_EQ(target.getCurrentConfiguration().extent, vk::Extent2D(64 + i * 8, 64 + (i % 3) * 16));
+            EXPECT_FALSE(isDone(busy));
+        }
+
+        EXPECT_LE(target.getRetiredSwapchainCount(), target.getFramesInFlight() + 1);
+    }
+
+    openAndDestroy(busy);
+}
+
+TEST_F(Swapchain, ResizeWhilePrimaryQueueIsBusy) {
+    if (!s_GC->supportsTimelineSemaphores())
+        GTEST_SKIP() << "Blocking the primary queue needs timeline semaphores";
+
+    // runs on single-queue devices too; the frames queue up behind the gated batch, so only framesInFlight of them fit before beginFrame() would wait for one
+    const GatedBatch busy = submitGated(s_GC->getPrimaryQueue(), s_GC->getQueueFamily(QueueType::Primary).value());
+
+    auto                surfaceProvider = std::make_shared<neuron::os::HeadlessSurface>();
+    SurfaceRenderTarget target(s_GC, surfaceProvider, {.fallbackExtent = {64, 64}});
+
+    for (uint32_t i = 0; i < target.getFramesInFlight(); i++) {
+        target.resizeTarget({96 + i * 8, 80 - i * 8});
+
+        (void)target.beginFrame();
+        target.endFrame();
+
+        EXPECT_EQ(target.getCurrentConfiguration().extent, vk::Extent2D(96 + i * 8, 80 - i * 8));
+        EXPECT_FALSE(isDone(busy));
+    }
+    EXPECT_GE(target.getRetiredSwapchainCount(), 1u);
+
+    // the target waits for its frames when destroyed, so the gate opens first
+    openAndDestroy(busy);
+}
@@ -0,0 +1,60 @@
+#include "gtest/gtest.h"
+
+#include "neuron/graphics/texture.hpp"
+#include "neuron/tests/unit/vulkan_fixture.hpp"
+
+#include <cstring>
+#include <format>
+
+using namespace neuron::graphics;
+
+class Texture : public neuron::tests::VulkanTest {
+  protected:
+    void SetUp() override {
+        VulkanTest::SetUp();
+        if (!IsSkipped() && !s_GC->supportsTimelineSemaphores())
+            GTEST_SKIP() << "Texture loading needs timeline semaphores";
+    }
+
+    // binary PPM, which stb_image decodes and is trivial to write by hand
+    static std::vector<std::byte> makePpm(uint32_t width, uint32_t height) {
+        const std::string header = std::format("P6\n{} {}\n255\n", width, height);
+
+        std::vector<std::byte> encoded(header.size() + static_cast<size_t>(width) * height * 3);
+        std::memcpy(encoded.data(), header.data(), header.size());
+        for (size_t i = header.size(); i < encoded.size(); i++)
+            encoded[i] = static_cast<std::byte>(i * 13);
+        return encoded;
+    }
+};
+
+TEST_F(Texture, LoadsManyWithMips) {
+    TextureLoader loader(s_GC, {.mipBatchSize = 8});
+
+    std::vector<TextureHandle> textures;
+    for (uint32_t i = 0; i < 20; i++) {
+        textures.push_back(loader.loadFromMemory(makePpm(64 + i, 32), std::format("texture{}", i)));
+    }
+    loader.waitAll();
+
+    for (uint32_t i = 0; i < textures.size(); i++) {
+        const TextureHandle &texture = textures[i];
+        ASSERT_TRUE(texture.isReady()) << texture.getError();
+        EXPECT_EQ(texture.getExtent(), vk::Extent2D(64 + i, 32));
+        EXPECT_TRUE(texture.getImageView());
+        EXPECT_GE(texture.getMipLevels(), 1);
+        EXPECT_LE(texture.getMipLevels(), 7);
+    }
+}
+
+TEST_F(Texture, BrokenDataFails) {
+    TextureLoader loader(s_GC);
+
+    std::vector<std::byte> garbage(100, std::byte{0x42});
+    TextureHandle          texture = loader.loadFromMemory(std::move(garbage), "garbage");
+    loader.wait(texture);
+
+    EXPECT_TRUE(texture.hasFailed());
+    EXPECT_FALSE(texture.isReady());
+    EXPECT_FALSE(texture.getError().empty());
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "gtest/gtest.h"
+
+#include "neuron/graphics/gcontext.hpp"
+#include "neuron/neuron.hpp"
+
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace neuron::tests {
+
+    /**
+     * Fixture for tests that need a real device. Runs headless so it works on software drivers (lavapipe), and skips instead of failing when no Vulkan driver is installed.
+     */
+    class VulkanTest : public ::testing::Test {
+      protected:
+        static void SetUpTestSuite() { initialize({.name = "neuron_unit_tests", .version = {0, 1, 0}, .offscreenRenderingOnly = true}); }
+
+        /**
+         * Suites that need extra instance extensions or queues hide SetUpTestSuite() and call this instead. gcSettings may inspect the instance to pick its queues.
+         */
+        static void initialize(const neuron::Settings &settings, const std::function<neuron::graphics::GCSettings()> &gcSettings = {}) {
+            try {
+                neuron::init(settings);
+                s_GC = std::make_shared<neuron::graphics::GContext>(gcSettings ? gcSettings() : neuron::graphics::GCSettings{});
+            } catch (const std::exception &e) {
+                s_Error = e.what();
+            }
+        }
+
+        static void TearDownTestSuite() {
+            s_GC.reset();
+            neuron::cleanup();
+        }
+
+        void SetUp() override {
+            if (!s_GC) {
+                GTEST_SKIP() << "No usable Vulkan device: " << s_Error;
+            }
+        }
+
+        static inline std::shared_ptr<neuron::graphics::GContext> s_GC;
+        static inline std::string                                 s_Error;
+    };
+
+} // namespace neuron::tests
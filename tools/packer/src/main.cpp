@@ -0,0 +1,68 @@
+#include <neuron/assets/package.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <charconv>
+#include <exception>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// neuron_packer [--alignment <bytes>] <output> <file or directory>...
+//
+// files in directories are named by their path relative to the directory, with forward slashes; files given directly by their file name
+int main(int argc, char **argv) {
+    uint32_t                           alignment = neuron::assets::PACKAGE_DEFAULT_ALIGNMENT;
+    std::vector<std::filesystem::path> paths;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string_view argument = argv[i];
+        if (argument == "--alignment" && i + 1 < argc) {
+            const std::string_view value = argv[++i];
+            if (std::from_chars(value.data(), value.data() + value.size(), alignment).ec != std::errc()) {
+                spdlog::error("Invalid alignment {}", value);
+                return 1;
+            }
+        } else {
+            paths.emplace_back(argument);
+        }
+    }
+
+    if (paths.size() < 2) {
+        spdlog::error("Usage: neuron_packer [--alignment <bytes>] <output> <file or directory>...");
+        return 1;
+    }
+
+    try {
+        neuron::assets::PackageWriter writer(alignment);
+
+        for (size_t i = 1; i < paths.size(); i++) {
+            const std::filesystem::path &input = paths[i];
+            if (!std::filesystem::is_directory(input)) {
+                writer.addFile(input.filename().generic_string(), neuron::assets::assetTypeFromPath(input), input);
+                continue;
+            }
+
+            // sorted, so the same inputs always give the same package
+            std::vector<std::filesystem::path> files;
+            for (const auto &entry : std::filesystem::recursive_directory_iterator(input)) {
+                if (entry.is_regular_file())
+                    files.push_back(entry.path());
+            }
+            std::ranges::sort(files);
+
+            for (const auto &file : files)
+                writer.addFile(std::filesystem::relative(file, input).generic_string(), neuron::assets::assetTypeFromPath(file), file);
+        }
+
+        writer.write(paths[0]);
+        spdlog::info("Packed {} assets into {} ({} bytes)", writer.getAssetCount(), paths[0].string(), std::filesystem::file_size(paths[0]));
+    } catch (const std::exception &e) {
+        spdlog::error("{}", e.what());
+        return 1;
+    }
+
+    return 0;
+}